@@ -0,0 +1,343 @@
+//
+// Created by jan on 19.10.2026.
+//
+
+#include "bdd.h"
+
+enum
+{
+    BDD_OP_AND = 1,
+    BDD_OP_OR = 2,
+};
+
+static inline u32 bdd_hash(u32 level, rmod_bdd_ref low, rmod_bdd_ref high)
+{
+    u64 h = (u64)level * 0x9E3779B97F4A7C15u;
+    h ^= (u64)low + 0x7F4A7C159E3779B9u + (h << 6) + (h >> 2);
+    h ^= (u64)high + 0x94D049BB133111EBu + (h << 6) + (h >> 2);
+    h ^= h >> 31;
+    return (u32)h;
+}
+
+static rmod_result bdd_grow_unique_table(rmod_bdd_manager* const bdd)
+{
+    const u32 new_capacity = bdd->unique_capacity << 1;
+    rmod_bdd_ref* const new_table = jalloc(sizeof(*new_table) * new_capacity);
+    if (!new_table)
+    {
+        RMOD_ERROR("Failed jalloc(%zu)", sizeof(*new_table) * new_capacity);
+        return RMOD_RESULT_NOMEM;
+    }
+    memset(new_table, 0, sizeof(*new_table) * new_capacity);
+    for (u32 i = 2; i < bdd->node_count; ++i)
+    {
+        const rmod_bdd_node* const node = bdd->nodes + i;
+        u32 slot = bdd_hash(node->level, node->low, node->high) & (new_capacity - 1);
+        while (new_table[slot])
+        {
+            slot = (slot + 1) & (new_capacity - 1);
+        }
+        new_table[slot] = i;
+    }
+    jfree(bdd->unique_table);
+    bdd->unique_table = new_table;
+    bdd->unique_capacity = new_capacity;
+    return RMOD_RESULT_SUCCESS;
+}
+
+static rmod_result bdd_make_node(rmod_bdd_manager* const bdd, const u32 level, const rmod_bdd_ref low, const rmod_bdd_ref high, rmod_bdd_ref* const p_out)
+{
+    if (low == high)
+    {
+        *p_out = low;
+        return RMOD_RESULT_SUCCESS;
+    }
+    u32 slot = bdd_hash(level, low, high) & (bdd->unique_capacity - 1);
+    rmod_bdd_ref existing;
+    while ((existing = bdd->unique_table[slot]))
+    {
+        const rmod_bdd_node* const node = bdd->nodes + existing;
+        if (node->level == level && node->low == low && node->high == high)
+        {
+            *p_out = existing;
+            return RMOD_RESULT_SUCCESS;
+        }
+        slot = (slot + 1) & (bdd->unique_capacity - 1);
+    }
+
+    //  Node does not exist yet, so it has to be made
+    if (bdd->node_count == bdd->node_limit)
+    {
+        RMOD_ERROR("Binary decision diagram grew beyond the limit of %u nodes", bdd->node_limit);
+        return RMOD_RESULT_NOMEM;
+    }
+    if (bdd->node_count == bdd->node_capacity)
+    {
+        const u32 new_capacity = bdd->node_capacity << 1;
+        rmod_bdd_node* const new_nodes = jrealloc(bdd->nodes, sizeof(*new_nodes) * new_capacity);
+        if (!new_nodes)
+        {
+            RMOD_ERROR("Failed jrealloc(%p, %zu)", bdd->nodes, sizeof(*new_nodes) * new_capacity);
+            return RMOD_RESULT_NOMEM;
+        }
+        bdd->nodes = new_nodes;
+        bdd->node_capacity = new_capacity;
+    }
+    const rmod_bdd_ref new_ref = bdd->node_count++;
+    bdd->nodes[new_ref] = (rmod_bdd_node){.level = level, .low = low, .high = high};
+    bdd->unique_table[slot] = new_ref;
+    //  Keep load factor of the table at most 1/2
+    if (bdd->node_count << 1 > bdd->unique_capacity)
+    {
+        const rmod_result res = bdd_grow_unique_table(bdd);
+        if (res != RMOD_RESULT_SUCCESS)
+        {
+            return res;
+        }
+    }
+    *p_out = new_ref;
+    return RMOD_RESULT_SUCCESS;
+}
+
+static rmod_result bdd_apply(rmod_bdd_manager* const bdd, const u32 op, rmod_bdd_ref f, rmod_bdd_ref g, rmod_bdd_ref* const p_out)
+{
+    //  Terminal cases
+    if (f == g)
+    {
+        *p_out = f;
+        return RMOD_RESULT_SUCCESS;
+    }
+    if (op == BDD_OP_AND)
+    {
+        if (f == RMOD_BDD_FALSE || g == RMOD_BDD_FALSE)
+        {
+            *p_out = RMOD_BDD_FALSE;
+            return RMOD_RESULT_SUCCESS;
+        }
+        if (f == RMOD_BDD_TRUE)
+        {
+            *p_out = g;
+            return RMOD_RESULT_SUCCESS;
+        }
+        if (g == RMOD_BDD_TRUE)
+        {
+            *p_out = f;
+            return RMOD_RESULT_SUCCESS;
+        }
+    }
+    else
+    {
+        assert(op == BDD_OP_OR);
+        if (f == RMOD_BDD_TRUE || g == RMOD_BDD_TRUE)
+        {
+            *p_out = RMOD_BDD_TRUE;
+            return RMOD_RESULT_SUCCESS;
+        }
+        if (f == RMOD_BDD_FALSE)
+        {
+            *p_out = g;
+            return RMOD_RESULT_SUCCESS;
+        }
+        if (g == RMOD_BDD_FALSE)
+        {
+            *p_out = f;
+            return RMOD_RESULT_SUCCESS;
+        }
+    }
+    //  Both operations are commutative, so order the arguments for better cache hits
+    if (f > g)
+    {
+        const rmod_bdd_ref tmp = f;
+        f = g;
+        g = tmp;
+    }
+    const u32 cache_slot = bdd_hash(op, f, g) & (bdd->cache_capacity - 1);
+    const rmod_bdd_cache_entry* const entry = bdd->cache + cache_slot;
+    if (entry->op == op && entry->f == f && entry->g == g)
+    {
+        *p_out = entry->result;
+        return RMOD_RESULT_SUCCESS;
+    }
+
+    //  Node array may be reallocated by recursive calls, so copy the nodes instead of keeping pointers
+    const rmod_bdd_node node_f = bdd->nodes[f];
+    const rmod_bdd_node node_g = bdd->nodes[g];
+    const u32 level = node_f.level < node_g.level ? node_f.level : node_g.level;
+    const rmod_bdd_ref f_low = node_f.level == level ? node_f.low : f;
+    const rmod_bdd_ref f_high = node_f.level == level ? node_f.high : f;
+    const rmod_bdd_ref g_low = node_g.level == level ? node_g.low : g;
+    const rmod_bdd_ref g_high = node_g.level == level ? node_g.high : g;
+
+    rmod_result res;
+    rmod_bdd_ref low, high;
+    if ((res = bdd_apply(bdd, op, f_low, g_low, &low)) != RMOD_RESULT_SUCCESS)
+    {
+        return res;
+    }
+    if ((res = bdd_apply(bdd, op, f_high, g_high, &high)) != RMOD_RESULT_SUCCESS)
+    {
+        return res;
+    }
+    rmod_bdd_ref result;
+    if ((res = bdd_make_node(bdd, level, low, high, &result)) != RMOD_RESULT_SUCCESS)
+    {
+        return res;
+    }
+    bdd->cache[cache_slot] = (rmod_bdd_cache_entry){.op = op, .f = f, .g = g, .result = result};
+    *p_out = result;
+    return RMOD_RESULT_SUCCESS;
+}
+
+rmod_result rmod_bdd_create(u32 var_count, const u32* var_order, u32 node_limit, rmod_bdd_manager* p_out)
+{
+    RMOD_ENTER_FUNCTION;
+    rmod_bdd_manager bdd = {.var_count = var_count, .node_limit = node_limit < 2 ? 2 : node_limit};
+    bdd.level_to_var = jalloc(sizeof(*bdd.level_to_var) * var_count);
+    if (!bdd.level_to_var)
+    {
+        RMOD_ERROR("Failed jalloc(%zu)", sizeof(*bdd.level_to_var) * var_count);
+        goto failed;
+    }
+    bdd.var_to_level = jalloc(sizeof(*bdd.var_to_level) * var_count);
+    if (!bdd.var_to_level)
+    {
+        RMOD_ERROR("Failed jalloc(%zu)", sizeof(*bdd.var_to_level) * var_count);
+        goto failed;
+    }
+    for (u32 i = 0; i < var_count; ++i)
+    {
+        bdd.var_to_level[i] = var_count;
+    }
+    for (u32 i = 0; i < var_count; ++i)
+    {
+        const u32 var = var_order ? var_order[i] : i;
+        if (var >= var_count || bdd.var_to_level[var] != var_count)
+        {
+            RMOD_ERROR("Variable order is not a permutation of %u variables (variable %u at position %u)", var_count, var, i);
+            jfree(bdd.var_to_level);
+            jfree(bdd.level_to_var);
+            RMOD_LEAVE_FUNCTION;
+            return RMOD_RESULT_BAD_VALUE;
+        }
+        bdd.level_to_var[i] = var;
+        bdd.var_to_level[var] = i;
+    }
+
+    bdd.node_capacity = 1 << 10;
+    bdd.nodes = jalloc(sizeof(*bdd.nodes) * bdd.node_capacity);
+    if (!bdd.nodes)
+    {
+        RMOD_ERROR("Failed jalloc(%zu)", sizeof(*bdd.nodes) * bdd.node_capacity);
+        goto failed;
+    }
+    bdd.nodes[RMOD_BDD_FALSE] = (rmod_bdd_node){.level = var_count, .low = RMOD_BDD_FALSE, .high = RMOD_BDD_FALSE};
+    bdd.nodes[RMOD_BDD_TRUE] = (rmod_bdd_node){.level = var_count, .low = RMOD_BDD_TRUE, .high = RMOD_BDD_TRUE};
+    bdd.node_count = 2;
+
+    bdd.unique_capacity = bdd.node_capacity << 1;
+    bdd.unique_table = jalloc(sizeof(*bdd.unique_table) * bdd.unique_capacity);
+    if (!bdd.unique_table)
+    {
+        RMOD_ERROR("Failed jalloc(%zu)", sizeof(*bdd.unique_table) * bdd.unique_capacity);
+        goto failed;
+    }
+    memset(bdd.unique_table, 0, sizeof(*bdd.unique_table) * bdd.unique_capacity);
+
+    bdd.cache_capacity = 1 << 16;
+    bdd.cache = jalloc(sizeof(*bdd.cache) * bdd.cache_capacity);
+    if (!bdd.cache)
+    {
+        RMOD_ERROR("Failed jalloc(%zu)", sizeof(*bdd.cache) * bdd.cache_capacity);
+        goto failed;
+    }
+    memset(bdd.cache, 0, sizeof(*bdd.cache) * bdd.cache_capacity);
+
+    *p_out = bdd;
+    RMOD_LEAVE_FUNCTION;
+    return RMOD_RESULT_SUCCESS;
+
+failed:
+    jfree(bdd.cache);
+    jfree(bdd.unique_table);
+    jfree(bdd.nodes);
+    jfree(bdd.var_to_level);
+    jfree(bdd.level_to_var);
+    RMOD_LEAVE_FUNCTION;
+    return RMOD_RESULT_NOMEM;
+}
+
+void rmod_bdd_destroy(rmod_bdd_manager* bdd)
+{
+    jfree(bdd->cache);
+    jfree(bdd->unique_table);
+    jfree(bdd->nodes);
+    jfree(bdd->var_to_level);
+    jfree(bdd->level_to_var);
+    memset(bdd, 0, sizeof(*bdd));
+}
+
+rmod_result rmod_bdd_variable(rmod_bdd_manager* bdd, u32 var, rmod_bdd_ref* p_out)
+{
+    RMOD_ENTER_FUNCTION;
+    if (var >= bdd->var_count)
+    {
+        RMOD_ERROR("Variable %u is out of range, since manager only has %u variables", var, bdd->var_count);
+        RMOD_LEAVE_FUNCTION;
+        return RMOD_RESULT_BAD_VALUE;
+    }
+    const rmod_result res = bdd_make_node(bdd, bdd->var_to_level[var], RMOD_BDD_FALSE, RMOD_BDD_TRUE, p_out);
+    RMOD_LEAVE_FUNCTION;
+    return res;
+}
+
+rmod_result rmod_bdd_and(rmod_bdd_manager* bdd, rmod_bdd_ref f, rmod_bdd_ref g, rmod_bdd_ref* p_out)
+{
+    RMOD_ENTER_FUNCTION;
+    const rmod_result res = bdd_apply(bdd, BDD_OP_AND, f, g, p_out);
+    RMOD_LEAVE_FUNCTION;
+    return res;
+}
+
+rmod_result rmod_bdd_or(rmod_bdd_manager* bdd, rmod_bdd_ref f, rmod_bdd_ref g, rmod_bdd_ref* p_out)
+{
+    RMOD_ENTER_FUNCTION;
+    const rmod_result res = bdd_apply(bdd, BDD_OP_OR, f, g, p_out);
+    RMOD_LEAVE_FUNCTION;
+    return res;
+}
+
+f64 rmod_bdd_probability(const rmod_bdd_manager* bdd, rmod_bdd_ref f, const f64* p_var, f64* work)
+{
+    //  Children always have lower index than their parents, so a single forward pass is enough
+    work[RMOD_BDD_FALSE] = 0.0;
+    work[RMOD_BDD_TRUE] = 1.0;
+    for (u32 i = 2; i <= f; ++i)
+    {
+        const rmod_bdd_node* const node = bdd->nodes + i;
+        const f64 p = p_var[bdd->level_to_var[node->level]];
+        work[i] = p * work[node->high] + (1.0 - p) * work[node->low];
+    }
+    return work[f];
+}
+
+u32 rmod_bdd_size(const rmod_bdd_manager* bdd, rmod_bdd_ref f, u8* work)
+{
+    memset(work, 0, sizeof(*work) * (f + 1));
+    work[f] = 1;
+    u32 count = 0;
+    for (u32 i = f + 1; i > 0; --i)
+    {
+        if (!work[i - 1])
+        {
+            continue;
+        }
+        count += 1;
+        const rmod_bdd_node* const node = bdd->nodes + (i - 1);
+        if (i - 1 > RMOD_BDD_TRUE)
+        {
+            work[node->low] = 1;
+            work[node->high] = 1;
+        }
+    }
+    return count;
+}
@@ -0,0 +1,69 @@
+//
+// Created by jan on 19.10.2026.
+//
+
+#ifndef RMOD_BDD_H
+#define RMOD_BDD_H
+#include "../common/rmod.h"
+
+//  Reduced ordered binary decision diagram. Nodes are never freed individually, all of them live until the manager
+//  is destroyed. Node references are indices into the node array, with the two terminals always at indices 0 and 1.
+typedef u32 rmod_bdd_ref;
+#define RMOD_BDD_FALSE ((rmod_bdd_ref)0)
+#define RMOD_BDD_TRUE ((rmod_bdd_ref)1)
+
+typedef struct rmod_bdd_node_struct rmod_bdd_node;
+struct rmod_bdd_node_struct
+{
+    u32 level;          //  Position of the node's variable in the variable order (terminals are at level var_count)
+    rmod_bdd_ref low;   //  Node taken when variable is false
+    rmod_bdd_ref high;  //  Node taken when variable is true
+};
+
+typedef struct rmod_bdd_cache_entry_struct rmod_bdd_cache_entry;
+struct rmod_bdd_cache_entry_struct
+{
+    u32 op;
+    rmod_bdd_ref f;
+    rmod_bdd_ref g;
+    rmod_bdd_ref result;
+};
+
+typedef struct rmod_bdd_manager_struct rmod_bdd_manager;
+struct rmod_bdd_manager_struct
+{
+    u32 var_count;
+    u32* level_to_var;                  //  Which variable is at which level
+    u32* var_to_level;                  //  Which level each variable is at
+
+    u32 node_limit;                     //  Maximum number of nodes which can be created before giving up
+    u32 node_count;
+    u32 node_capacity;
+    rmod_bdd_node* nodes;
+
+    u32 unique_capacity;                //  Always a power of two
+    rmod_bdd_ref* unique_table;         //  Open addressing hash table of nodes, with 0 marking an empty slot
+
+    u32 cache_capacity;                 //  Always a power of two
+    rmod_bdd_cache_entry* cache;        //  Direct-mapped cache of results of previous operations
+};
+
+rmod_result rmod_bdd_create(u32 var_count, const u32* var_order, u32 node_limit, rmod_bdd_manager* p_out);
+
+void rmod_bdd_destroy(rmod_bdd_manager* bdd);
+
+rmod_result rmod_bdd_variable(rmod_bdd_manager* bdd, u32 var, rmod_bdd_ref* p_out);
+
+rmod_result rmod_bdd_and(rmod_bdd_manager* bdd, rmod_bdd_ref f, rmod_bdd_ref g, rmod_bdd_ref* p_out);
+
+rmod_result rmod_bdd_or(rmod_bdd_manager* bdd, rmod_bdd_ref f, rmod_bdd_ref g, rmod_bdd_ref* p_out);
+
+//  Computes probability of function being true given probability of each variable being true. Array work must be
+//  large enough to hold node_count values. Takes time proportional to number of nodes in the manager.
+f64 rmod_bdd_probability(const rmod_bdd_manager* bdd, rmod_bdd_ref f, const f64* p_var, f64* work);
+
+//  Counts nodes reachable from the function's root (including terminals). Array work must be large enough to hold
+//  node_count values.
+u32 rmod_bdd_size(const rmod_bdd_manager* bdd, rmod_bdd_ref f, u8* work);
+
+#endif //RMOD_BDD_H
@@ -0,0 +1,146 @@
+//
+// Created by jan on 19.10.2026.
+//
+#include "bdd.h"
+
+//  Checks probabilities of structures, which are built from the decision diagram, against ones found by hand
+
+#define ASSERT(x) if ((x) == false) {fprintf(stderr, "Failed assertion: \"" #x "\"\n"); __builtin_trap(); exit(EXIT_FAILURE);} (void)0
+#define ASSERT_CLOSE(x, y) if (fabs((x) - (y)) > 1e-12 * (1.0 + fabs(y))) {fprintf(stderr, "Failed assertion: \"" #x "\" (%.17g) is not \"" #y "\" (%.17g)\n", (f64)(x), (f64)(y)); __builtin_trap(); exit(EXIT_FAILURE);} (void)0
+#define N_PAIRS 2000
+#define NODE_LIMIT (1 << 20)
+
+static rmod_bdd_ref variable(rmod_bdd_manager* bdd, u32 var)
+{
+    rmod_bdd_ref ref;
+    ASSERT(rmod_bdd_variable(bdd, var, &ref) == RMOD_RESULT_SUCCESS);
+    return ref;
+}
+
+static rmod_bdd_ref and(rmod_bdd_manager* bdd, rmod_bdd_ref f, rmod_bdd_ref g)
+{
+    rmod_bdd_ref ref;
+    ASSERT(rmod_bdd_and(bdd, f, g, &ref) == RMOD_RESULT_SUCCESS);
+    return ref;
+}
+
+static rmod_bdd_ref or(rmod_bdd_manager* bdd, rmod_bdd_ref f, rmod_bdd_ref g)
+{
+    rmod_bdd_ref ref;
+    ASSERT(rmod_bdd_or(bdd, f, g, &ref) == RMOD_RESULT_SUCCESS);
+    return ref;
+}
+
+//  Series, parallel, and 2-out-of-3 structures of three components, for the given order of variables
+static void check_small_structures(const u32* var_order)
+{
+    const f64 p[3] = {0.9, 0.75, 0.6};
+    rmod_bdd_manager bdd;
+    ASSERT(rmod_bdd_create(3, var_order, NODE_LIMIT, &bdd) == RMOD_RESULT_SUCCESS);
+    const rmod_bdd_ref x0 = variable(&bdd, 0), x1 = variable(&bdd, 1), x2 = variable(&bdd, 2);
+
+    const rmod_bdd_ref series = and(&bdd, and(&bdd, x0, x1), x2);
+    const rmod_bdd_ref parallel = or(&bdd, or(&bdd, x0, x1), x2);
+    const rmod_bdd_ref two_of_three = or(&bdd, or(&bdd, and(&bdd, x0, x1), and(&bdd, x0, x2)), and(&bdd, x1, x2));
+    //  Same function built in a different way must give the same node
+    ASSERT(and(&bdd, x2, and(&bdd, x1, x0)) == series);
+    ASSERT(and(&bdd, or(&bdd, x0, x1), or(&bdd, and(&bdd, x0, x1), x2)) == two_of_three);
+    ASSERT(and(&bdd, x0, RMOD_BDD_TRUE) == x0);
+    ASSERT(or(&bdd, x0, RMOD_BDD_FALSE) == x0);
+    ASSERT(and(&bdd, x0, RMOD_BDD_FALSE) == RMOD_BDD_FALSE);
+    ASSERT(or(&bdd, x0, RMOD_BDD_TRUE) == RMOD_BDD_TRUE);
+
+    f64* const work = jalloc(sizeof(*work) * bdd.node_count);
+    u8* const marks = jalloc(sizeof(*marks) * bdd.node_count);
+    ASSERT(work && marks);
+    ASSERT_CLOSE(rmod_bdd_probability(&bdd, series, p, work), p[0] * p[1] * p[2]);
+    ASSERT_CLOSE(rmod_bdd_probability(&bdd, parallel, p, work), 1.0 - (1.0 - p[0]) * (1.0 - p[1]) * (1.0 - p[2]));
+    ASSERT_CLOSE(rmod_bdd_probability(&bdd, two_of_three, p, work), p[0] * p[1] + p[0] * p[2] + p[1] * p[2] - 2.0 * p[0] * p[1] * p[2]);
+    ASSERT_CLOSE(rmod_bdd_probability(&bdd, RMOD_BDD_TRUE, p, work), 1.0);
+    ASSERT_CLOSE(rmod_bdd_probability(&bdd, RMOD_BDD_FALSE, p, work), 0.0);
+    //  Series and parallel structures have a node per variable, 2-out-of-3 has one more, all with two terminals
+    ASSERT(rmod_bdd_size(&bdd, series, marks) == 5);
+    ASSERT(rmod_bdd_size(&bdd, parallel, marks) == 5);
+    ASSERT(rmod_bdd_size(&bdd, two_of_three, marks) == 6);
+    jfree(marks);
+    jfree(work);
+    rmod_bdd_destroy(&bdd);
+}
+
+//  Series of parallel pairs, which makes enough nodes for the node array and the unique table to grow
+static void check_large_structure(void)
+{
+    rmod_bdd_manager bdd;
+    ASSERT(rmod_bdd_create(2 * N_PAIRS, NULL, NODE_LIMIT, &bdd) == RMOD_RESULT_SUCCESS);
+    f64* const p = jalloc(sizeof(*p) * 2 * N_PAIRS);
+    ASSERT(p);
+    rmod_bdd_ref f = RMOD_BDD_TRUE;
+    f64 expected = 1.0;
+    //  Built from the last pair, so that each new node is above all the existing ones
+    for (u32 i = N_PAIRS; i > 0; --i)
+    {
+        const u32 a = 2 * (i - 1), b = a + 1;
+        p[a] = 0.5 + 0.4 * (f64)(i % 7) / 7.0;
+        p[b] = 0.3 + 0.5 * (f64)(i % 5) / 5.0;
+        f = and(&bdd, or(&bdd, variable(&bdd, a), variable(&bdd, b)), f);
+        expected *= 1.0 - (1.0 - p[a]) * (1.0 - p[b]);
+    }
+    ASSERT(bdd.node_count > 1024);
+    //  Building it again with arguments swapped must not create any new nodes
+    const u32 node_count = bdd.node_count;
+    rmod_bdd_ref g = RMOD_BDD_TRUE;
+    for (u32 i = N_PAIRS; i > 0; --i)
+    {
+        g = and(&bdd, g, or(&bdd, variable(&bdd, 2 * i - 1), variable(&bdd, 2 * (i - 1))));
+    }
+    ASSERT(g == f);
+    ASSERT(bdd.node_count == node_count);
+
+    f64* const work = jalloc(sizeof(*work) * bdd.node_count);
+    u8* const marks = jalloc(sizeof(*marks) * bdd.node_count);
+    ASSERT(work && marks);
+    ASSERT_CLOSE(rmod_bdd_probability(&bdd, f, p, work), expected);
+    ASSERT(rmod_bdd_size(&bdd, f, marks) == 2 * N_PAIRS + 2);
+    jfree(marks);
+    jfree(work);
+    jfree(p);
+    rmod_bdd_destroy(&bdd);
+
+    //  Limit of nodes is reported instead of growing past it
+    ASSERT(rmod_bdd_create(2 * N_PAIRS, NULL, 64, &bdd) == RMOD_RESULT_SUCCESS);
+    rmod_result res = RMOD_RESULT_SUCCESS;
+    f = RMOD_BDD_TRUE;
+    for (u32 i = N_PAIRS; i > 0 && res == RMOD_RESULT_SUCCESS; --i)
+    {
+        rmod_bdd_ref a, b;
+        if ((res = rmod_bdd_variable(&bdd, 2 * (i - 1), &a)) != RMOD_RESULT_SUCCESS
+            || (res = rmod_bdd_variable(&bdd, 2 * i - 1, &b)) != RMOD_RESULT_SUCCESS
+            || (res = rmod_bdd_or(&bdd, a, b, &a)) != RMOD_RESULT_SUCCESS)
+        {
+            break;
+        }
+        res = rmod_bdd_and(&bdd, a, f, &f);
+    }
+    ASSERT(res == RMOD_RESULT_NOMEM);
+    ASSERT(bdd.node_count <= 64);
+    rmod_bdd_destroy(&bdd);
+}
+
+int main()
+{
+    G_JALLOCATOR = jallocator_create((1 << 20), (1 << 19), 1);
+    ASSERT(G_JALLOCATOR);
+    rmod_error_init_thread("bdd test", RMOD_ERROR_LEVEL_NONE, 32, 32);
+
+    check_small_structures(NULL);
+    const u32 reversed[3] = {2, 1, 0};
+    check_small_structures(reversed);
+    const u32 mixed[3] = {1, 2, 0};
+    check_small_structures(mixed);
+    check_large_structure();
+    printf("Decision diagrams gave expected probabilities\n");
+
+    rmod_error_cleanup_thread();
+    jallocator_destroy(G_JALLOCATOR);
+    return 0;
+}
@@ -0,0 +1,921 @@
+//
+// Created by jan on 19.10.2026.
+//
+
+#include "ctmc.h"
+#include "../simulation/simulation_run.h"
+#include <inttypes.h>
+
+//  Limit on the number of states, so that graphs which are too large fail instead of using up all the memory
+#define RMOD_CTMC_STATE_LIMIT (1 << 22)
+//  Limit on states and transitions visited by all steps of uniformization, so that chains which would take minutes
+//  to solve fail instead
+#define RMOD_CTMC_WORK_LIMIT 1e10
+//  Tolerance used to stop uniformization and steady state iteration
+#define RMOD_CTMC_TOLERANCE 1e-12
+//  Limit on the number of sweeps of Gauss-Seidel iteration for the steady state
+#define RMOD_CTMC_MAX_SWEEPS 100000
+
+//  States which are always present. Fatal and truncated states are absorbing, with no flow through the graph.
+enum
+{
+    CTMC_STATE_FATAL = 0,
+    CTMC_STATE_TRUNCATED = 1,
+    CTMC_STATE_INITIAL = 2,
+};
+
+//  Each state is a key with an entry for each node, followed by the phase of maintenance delay (0 when maintenance is
+//  not pending). Node entry is CTMC_NODE_WORK, CTMC_NODE_INACTIVE, or CTMC_NODE_DOWN plus which of its members failed.
+enum
+{
+    CTMC_NODE_WORK = 0,
+    CTMC_NODE_INACTIVE = 1,
+    CTMC_NODE_DOWN = 2,
+};
+
+typedef struct
+{
+    u32 src;
+    u32 dst;
+    f64 rate;
+} ctmc_transition;
+
+typedef struct
+{
+    const rmod_graph* graph;
+    u32 node_count;
+    u32 key_length;
+    u32 phase_count;
+    u32 max_down;
+    f64 repair_limit;
+
+    u32 state_count;
+    u32 state_capacity;
+    u16* keys;
+    f64* flow;                          //  Flow through the graph in each state
+    f64* exit_rate;                     //  Total rate of leaving each state
+    f64* maintenance_rate;              //  Rate of maintenance visits from each state
+    f64* cost_rate;                     //  Rate of maintenance cost from each state
+
+    u32 table_capacity;
+    u32* table;                         //  Open addressing hash table of state indices, with -1 marking empty slots
+
+    u64 transition_count;
+    u64 transition_capacity;
+    ctmc_transition* transitions;
+} ctmc_builder;
+
+static inline u32 member_begin(const rmod_graph* const graph, const u32 node)
+{
+    return graph->member_offsets ? graph->member_offsets[node] : node;
+}
+
+static inline u32 member_end(const rmod_graph* const graph, const u32 node)
+{
+    return graph->member_offsets ? graph->member_offsets[node + 1] : node + 1;
+}
+
+static inline const rmod_graph_node_type* member_type(const rmod_graph* const graph, const u32 member)
+{
+    return graph->type_list + (graph->member_offsets ? graph->member_types[member] : graph->node_list[member].type_id);
+}
+
+//  Rate at which the node fails because of the member. Node's failure rate is split between its members in proportion
+//  to their own failure rates, since surrogate nodes fail less often than their members combined.
+static f64 member_failure_rate(const rmod_graph* const graph, const u32 node, const u32 member)
+{
+    const f64 rate = member_type(graph, member)->failure_rate;
+    if (!graph->member_offsets)
+    {
+        return rate;
+    }
+    f64 total = 0.0;
+    for (u32 m = member_begin(graph, node); m < member_end(graph, node); ++m)
+    {
+        total += member_type(graph, m)->failure_rate;
+    }
+    return total > 0.0 ? graph->type_list[graph->node_list[node].type_id].failure_rate * rate / total : 0.0;
+}
+
+static inline u32 key_hash(const u16* const key, const u32 key_length)
+{
+    u64 h = 0xCBF29CE484222325u;
+    for (u32 i = 0; i < key_length; ++i)
+    {
+        h ^= key[i];
+        h *= 0x100000001B3u;
+    }
+    h ^= h >> 29;
+    return (u32)h;
+}
+
+//  Same as flow through the graph computed by the simulation
+static f64 graph_flow(const rmod_graph* const graph, const rmod_element_status* const status, f64* const value)
+{
+    for (u32 i = 0; i < graph->node_count; ++i)
+    {
+        const rmod_graph_node* const node = graph->node_list + i;
+        if (status[i] != RMOD_ELEMENT_STATUS_WORK)
+        {
+            value[i] = 0.0;
+            continue;
+        }
+        f64 input = (f64)(node->parent_count == 0);
+        for (u32 j = 0; j < node->parent_count; ++j)
+        {
+            input += value[node->parents[j]];
+        }
+        value[i] = graph->type_list[node->type_id].effect * input;
+    }
+    return value[graph->node_count - 1];
+}
+
+//  Same as deactivation of nodes after a failure done by the simulation, returns true if maintenance is needed
+static bool deactivate_nodes(const rmod_graph* const graph, rmod_element_status* const status, const u32 fail_idx)
+{
+    bool any_working_parents = false;
+    for (u32 i = fail_idx + 1; i < graph->node_count; ++i)
+    {
+        if (status[i] != RMOD_ELEMENT_STATUS_WORK)
+        {
+            continue;
+        }
+        const rmod_graph_node* const node = graph->node_list + i;
+        u32 working_parents = 0;
+        for (u32 j = 0; j < node->parent_count; ++j)
+        {
+            working_parents += status[node->parents[j]] == RMOD_ELEMENT_STATUS_WORK;
+        }
+        if (working_parents == 0)
+        {
+            status[i] = RMOD_ELEMENT_STATUS_INACTIVE;
+        }
+        else
+        {
+            any_working_parents = true;
+        }
+    }
+    bool any_working_children = false;
+    for (u32 i = fail_idx; i > 0; --i)
+    {
+        if (status[i - 1] != RMOD_ELEMENT_STATUS_WORK)
+        {
+            continue;
+        }
+        const rmod_graph_node* const node = graph->node_list + i - 1;
+        u32 working_children = 0;
+        for (u32 j = 0; j < node->child_count; ++j)
+        {
+            working_children += status[node->children[j]] == RMOD_ELEMENT_STATUS_WORK;
+        }
+        if (working_children == 0)
+        {
+            status[i - 1] = RMOD_ELEMENT_STATUS_INACTIVE;
+        }
+        else
+        {
+            any_working_children = true;
+        }
+    }
+    return !any_working_parents || !any_working_children;
+}
+
+//  Same as time to maintain the graph computed by the simulation: longest path through the graph, where each down node
+//  adds the repair time of its failed member
+static f64 time_to_maintain(const rmod_graph* const graph, const u16* const key, f64* const value)
+{
+    for (u32 i = 0; i < graph->node_count; ++i)
+    {
+        const rmod_graph_node* const node = graph->node_list + i;
+        f64 t = 0.0;
+        for (u32 j = 0; j < node->parent_count; ++j)
+        {
+            if (value[node->parents[j]] > t)
+            {
+                t = value[node->parents[j]];
+            }
+        }
+        if (key[i] >= CTMC_NODE_DOWN)
+        {
+            t += member_type(graph, member_begin(graph, i) + key[i] - CTMC_NODE_DOWN)->repair_time;
+        }
+        value[i] = t;
+    }
+    return value[graph->node_count - 1];
+}
+
+//  Cost of repairing all nodes which are down
+static f64 repair_cost(const rmod_graph* const graph, const u16* const key)
+{
+    f64 cost = 0.0;
+    for (u32 i = 0; i < graph->node_count; ++i)
+    {
+        if (key[i] >= CTMC_NODE_DOWN)
+        {
+            cost += member_type(graph, member_begin(graph, i) + key[i] - CTMC_NODE_DOWN)->cost;
+        }
+    }
+    return cost;
+}
+
+//  Number of states with at most max_down components down, each either not waiting for maintenance or in one of its
+//  phases. Nodes made inactive are not counted, but reachable states are usually far fewer, since maintenance is needed
+//  long before every combination of components is down, so chains with more states than this are not built.
+static u64 estimate_state_count(const rmod_graph* const graph, const u32 phase_count, const u32 max_down)
+{
+    const u64 n = graph->component_count;
+    u64 combinations = 1, down_states = 1;
+    for (u64 d = 1; d <= max_down && d <= n && down_states <= RMOD_CTMC_STATE_LIMIT; ++d)
+    {
+        combinations = combinations * (n - d + 1) / d;
+        down_states += combinations;
+    }
+    return CTMC_STATE_INITIAL + down_states * ((u64)phase_count + 1);
+}
+
+static rmod_result builder_grow_table(ctmc_builder* const builder)
+{
+    const u32 new_capacity = builder->table_capacity << 1;
+    u32* const new_table = jalloc(sizeof(*new_table) * new_capacity);
+    if (!new_table)
+    {
+        RMOD_ERROR("Failed jalloc(%zu)", sizeof(*new_table) * new_capacity);
+        return RMOD_RESULT_NOMEM;
+    }
+    memset(new_table, 0xFF, sizeof(*new_table) * new_capacity);
+    for (u32 i = CTMC_STATE_INITIAL; i < builder->state_count; ++i)
+    {
+        u32 slot = key_hash(builder->keys + (u64)i * builder->key_length, builder->key_length) & (new_capacity - 1);
+        while (new_table[slot] != (u32)-1)
+        {
+            slot = (slot + 1) & (new_capacity - 1);
+        }
+        new_table[slot] = i;
+    }
+    jfree(builder->table);
+    builder->table = new_table;
+    builder->table_capacity = new_capacity;
+    return RMOD_RESULT_SUCCESS;
+}
+
+static rmod_result builder_grow_states(ctmc_builder* const builder)
+{
+    const u32 new_capacity = builder->state_capacity << 1;
+    u16* const new_keys = jrealloc(builder->keys, sizeof(*new_keys) * builder->key_length * new_capacity);
+    if (!new_keys)
+    {
+        RMOD_ERROR("Failed jrealloc(%p, %zu)", builder->keys, sizeof(*new_keys) * builder->key_length * new_capacity);
+        return RMOD_RESULT_NOMEM;
+    }
+    builder->keys = new_keys;
+    f64** const arrays[] = {&builder->flow, &builder->exit_rate, &builder->maintenance_rate, &builder->cost_rate};
+    for (u32 i = 0; i < sizeof(arrays) / sizeof(*arrays); ++i)
+    {
+        f64* const new_array = jrealloc(*arrays[i], sizeof(*new_array) * new_capacity);
+        if (!new_array)
+        {
+            RMOD_ERROR("Failed jrealloc(%p, %zu)", *arrays[i], sizeof(*new_array) * new_capacity);
+            return RMOD_RESULT_NOMEM;
+        }
+        *arrays[i] = new_array;
+    }
+    builder->state_capacity = new_capacity;
+    return RMOD_RESULT_SUCCESS;
+}
+
+//  Finds index of the state with the given key, adding it if it is not yet present
+static rmod_result builder_find_state(ctmc_builder* const builder, const u16* const key, u32* const p_idx)
+{
+    rmod_result res;
+    const u32 key_length = builder->key_length;
+    u32 slot = key_hash(key, key_length) & (builder->table_capacity - 1);
+    while (builder->table[slot] != (u32)-1)
+    {
+        const u32 idx = builder->table[slot];
+        if (memcmp(builder->keys + (u64)idx * key_length, key, sizeof(*key) * key_length) == 0)
+        {
+            *p_idx = idx;
+            return RMOD_RESULT_SUCCESS;
+        }
+        slot = (slot + 1) & (builder->table_capacity - 1);
+    }
+
+    if (builder->state_count == RMOD_CTMC_STATE_LIMIT)
+    {
+        RMOD_ERROR("Markov chain has more than %u states, reduce the graph or lower the number of nodes allowed to be down at once", RMOD_CTMC_STATE_LIMIT);
+        return RMOD_RESULT_BAD_VALUE;
+    }
+    if (builder->state_count == builder->state_capacity && (res = builder_grow_states(builder)) != RMOD_RESULT_SUCCESS)
+    {
+        return res;
+    }
+    const u32 idx = builder->state_count++;
+    memcpy(builder->keys + (u64)idx * key_length, key, sizeof(*key) * key_length);
+    builder->flow[idx] = 0.0;
+    builder->exit_rate[idx] = 0.0;
+    builder->maintenance_rate[idx] = 0.0;
+    builder->cost_rate[idx] = 0.0;
+    builder->table[slot] = idx;
+    *p_idx = idx;
+    if (2 * builder->state_count > builder->table_capacity)
+    {
+        return builder_grow_table(builder);
+    }
+    return RMOD_RESULT_SUCCESS;
+}
+
+static rmod_result builder_add_transition(ctmc_builder* const builder, const u32 src, const u32 dst, const f64 rate)
+{
+    if (src == dst || rate == 0.0)
+    {
+        return RMOD_RESULT_SUCCESS;
+    }
+    if (builder->transition_count == builder->transition_capacity)
+    {
+        const u64 new_capacity = builder->transition_capacity << 1;
+        ctmc_transition* const new_transitions = jrealloc(builder->transitions, sizeof(*new_transitions) * new_capacity);
+        if (!new_transitions)
+        {
+            RMOD_ERROR("Failed jrealloc(%p, %zu)", builder->transitions, sizeof(*new_transitions) * new_capacity);
+            return RMOD_RESULT_NOMEM;
+        }
+        builder->transitions = new_transitions;
+        builder->transition_capacity = new_capacity;
+    }
+    builder->transitions[builder->transition_count++] = (ctmc_transition){.src = src, .dst = dst, .rate = rate};
+    builder->exit_rate[src] += rate;
+    return RMOD_RESULT_SUCCESS;
+}
+
+//  Adds the transition caused by maintenance of the graph in the state given by key
+static rmod_result builder_add_maintenance(ctmc_builder* const builder, const u32 src, const u16* const key, const f64 rate)
+{
+    builder->maintenance_rate[src] += rate;
+    builder->cost_rate[src] += rate * repair_cost(builder->graph, key);
+    return builder_add_transition(builder, src, CTMC_STATE_INITIAL, rate);
+}
+
+static rmod_result build_chain(ctmc_builder* const builder, const u16* const initial_key)
+{
+    RMOD_ENTER_FUNCTION;
+    rmod_result res;
+    void* const base = lin_jalloc_get_current(G_LIN_JALLOCATOR);
+    const rmod_graph* const graph = builder->graph;
+    const u32 node_count = builder->node_count;
+    const u32 key_length = builder->key_length;
+
+    u16* const current = lin_jalloc(G_LIN_JALLOCATOR, sizeof(*current) * key_length);
+    u16* const next = lin_jalloc(G_LIN_JALLOCATOR, sizeof(*next) * key_length);
+    rmod_element_status* const status = lin_jalloc(G_LIN_JALLOCATOR, sizeof(*status) * node_count);
+    rmod_element_status* const next_status = lin_jalloc(G_LIN_JALLOCATOR, sizeof(*next_status) * node_count);
+    f64* const value = lin_jalloc(G_LIN_JALLOCATOR, sizeof(*value) * node_count);
+    if (!current || !next || !status || !next_status || !value)
+    {
+        RMOD_ERROR("Failed lin_jalloc(%p, %zu)", G_LIN_JALLOCATOR, (sizeof(*current) * 2 + sizeof(*status) * 2 + sizeof(*value)) * key_length);
+        res = RMOD_RESULT_NOMEM;
+        goto end;
+    }
+
+    u32 idx;
+    if ((res = builder_find_state(builder, initial_key, &idx)) != RMOD_RESULT_SUCCESS)
+    {
+        goto end;
+    }
+    assert(idx == CTMC_STATE_INITIAL);
+
+    //  States are explored in order they were found in
+    for (u32 src = CTMC_STATE_INITIAL; src < builder->state_count; ++src)
+    {
+        memcpy(current, builder->keys + (u64)src * key_length, sizeof(*current) * key_length);
+        const u32 phase = current[node_count];
+        u32 down_count = 0;
+        for (u32 i = 0; i < node_count; ++i)
+        {
+            switch (current[i])
+            {
+            case CTMC_NODE_WORK:
+                status[i] = RMOD_ELEMENT_STATUS_WORK;
+                break;
+            case CTMC_NODE_INACTIVE:
+                status[i] = RMOD_ELEMENT_STATUS_INACTIVE;
+                break;
+            default:
+                status[i] = RMOD_ELEMENT_STATUS_DOWN;
+                down_count += 1;
+                break;
+            }
+        }
+        builder->flow[src] = graph_flow(graph, status, value);
+
+        //  Progress of maintenance delay through its phases, with the last one ending in maintenance. Mean delay is
+        //  the time to maintain the graph in its current state.
+        if (phase != 0)
+        {
+            const f64 delay = time_to_maintain(graph, current, value);
+            assert(delay > 0.0);
+            const f64 rate = (f64)builder->phase_count / delay;
+            if (phase < builder->phase_count)
+            {
+                memcpy(next, current, sizeof(*next) * key_length);
+                next[node_count] = phase + 1;
+                if ((res = builder_find_state(builder, next, &idx)) != RMOD_RESULT_SUCCESS
+                    || (res = builder_add_transition(builder, src, idx, rate)) != RMOD_RESULT_SUCCESS)
+                {
+                    goto end;
+                }
+            }
+            else if ((res = builder_add_maintenance(builder, src, current, rate)) != RMOD_RESULT_SUCCESS)
+            {
+                goto end;
+            }
+        }
+
+        //  Failures of each member of each working node
+        for (u32 i = 0; i < node_count; ++i)
+        {
+            if (status[i] != RMOD_ELEMENT_STATUS_WORK)
+            {
+                continue;
+            }
+            for (u32 m = member_begin(graph, i); m < member_end(graph, i); ++m)
+            {
+                const rmod_graph_node_type* const type = member_type(graph, m);
+                const f64 rate = member_failure_rate(graph, i, m);
+                if (rate == 0.0)
+                {
+                    continue;
+                }
+                if (type->failure_type == RMOD_FAILURE_TYPE_FATAL)
+                {
+                    idx = CTMC_STATE_FATAL;
+                    goto add_failure;
+                }
+                if (down_count + 1 > builder->max_down)
+                {
+                    idx = CTMC_STATE_TRUNCATED;
+                    goto add_failure;
+                }
+
+                memcpy(next_status, status, sizeof(*next_status) * node_count);
+                next_status[i] = RMOD_ELEMENT_STATUS_DOWN;
+                bool need_maintenance = deactivate_nodes(graph, next_status, i);
+                for (u32 j = 0; j < node_count; ++j)
+                {
+                    switch (next_status[j])
+                    {
+                    case RMOD_ELEMENT_STATUS_WORK:
+                        next[j] = CTMC_NODE_WORK;
+                        break;
+                    case RMOD_ELEMENT_STATUS_INACTIVE:
+                        next[j] = CTMC_NODE_INACTIVE;
+                        break;
+                    case RMOD_ELEMENT_STATUS_DOWN:
+                        next[j] = current[j];
+                        break;
+                    }
+                }
+                next[i] = CTMC_NODE_DOWN + (m - member_begin(graph, i));
+                next[node_count] = phase;
+                //  Failures while maintenance is already pending do not trigger it again
+                if (phase == 0)
+                {
+                    need_maintenance |= type->failure_type == RMOD_FAILURE_TYPE_CRITICAL;
+                    need_maintenance |= graph_flow(graph, next_status, value) < builder->repair_limit;
+                    if (need_maintenance)
+                    {
+                        if (time_to_maintain(graph, next, value) > 0.0)
+                        {
+                            next[node_count] = 1;
+                        }
+                        else
+                        {
+                            //  Nothing to wait for, so maintenance happens right away
+                            if ((res = builder_add_maintenance(builder, src, next, rate)) != RMOD_RESULT_SUCCESS)
+                            {
+                                goto end;
+                            }
+                            continue;
+                        }
+                    }
+                }
+                if ((res = builder_find_state(builder, next, &idx)) != RMOD_RESULT_SUCCESS)
+                {
+                    goto end;
+                }
+            add_failure:
+                if ((res = builder_add_transition(builder, src, idx, rate)) != RMOD_RESULT_SUCCESS)
+                {
+                    goto end;
+                }
+            }
+        }
+    }
+
+    res = RMOD_RESULT_SUCCESS;
+end:
+    lin_jalloc_set_current(G_LIN_JALLOCATOR, base);
+    RMOD_LEAVE_FUNCTION;
+    return res;
+}
+
+//  Weighted sums of flow, maintenance rate, and cost rate over the probability distribution
+static inline void distribution_rewards(const ctmc_builder* const builder, const f64* const p, f64* const p_flow, f64* const p_visits, f64* const p_cost)
+{
+    f64 flow = 0.0, visits = 0.0, cost = 0.0;
+    for (u32 i = CTMC_STATE_INITIAL; i < builder->state_count; ++i)
+    {
+        flow += p[i] * builder->flow[i];
+        visits += p[i] * builder->maintenance_rate[i];
+        cost += p[i] * builder->cost_rate[i];
+    }
+    *p_flow = flow;
+    *p_visits = visits;
+    *p_cost = cost;
+}
+
+//  Transient solution using uniformization: with Poisson process of rate lambda, distribution at time t is the sum
+//  of p_k = p_0 P^k weighted by probability of k events, where P = I + Q / lambda. Integral over [0, t] weighs each
+//  p_k by probability of more than k events instead, divided by lambda.
+static rmod_result solve_transient(
+        const ctmc_builder* const builder, const u32* const in_offsets, const u32* const in_src, const f64* const in_rate,
+        f64* p, f64* p_next, rmod_ctmc_result* const result)
+{
+    RMOD_ENTER_FUNCTION;
+    const u32 state_count = builder->state_count;
+    const f64 interval = result->interval;
+    f64 lambda = 0.0;
+    for (u32 i = 0; i < state_count; ++i)
+    {
+        if (builder->exit_rate[i] > lambda)
+        {
+            lambda = builder->exit_rate[i];
+        }
+    }
+    memset(p, 0, sizeof(*p) * state_count);
+    p[CTMC_STATE_INITIAL] = 1.0;
+    if (lambda == 0.0)
+    {
+        //  Nothing ever fails
+        result->point_flow = builder->flow[CTMC_STATE_INITIAL];
+        result->mean_flow = builder->flow[CTMC_STATE_INITIAL];
+        RMOD_LEAVE_FUNCTION;
+        return RMOD_RESULT_SUCCESS;
+    }
+    //  Slightly larger rate keeps P aperiodic, so that convergence of p_k can be detected
+    lambda *= 1.02;
+    const f64 a = lambda * interval;
+    const f64 log_a = log(a);
+    //  Number of steps is about a, unless the distribution stops changing before that
+    const f64 work = a * ((f64)state_count + (f64)builder->transition_count);
+    if (work > RMOD_CTMC_WORK_LIMIT)
+    {
+        RMOD_ERROR("Transient solution of the Markov chain would take about %.3g steps over %u states and %"PRIu64" transitions, which is too many. Shorten the interval, lower the number of phases, or simulate the graph instead", a, state_count, builder->transition_count);
+        RMOD_LEAVE_FUNCTION;
+        return RMOD_RESULT_BAD_VALUE;
+    }
+
+    f64 point_flow = 0.0, point_fatal = 0.0, point_truncated = 0.0;
+    f64 integral_flow = 0.0, integral_visits = 0.0, integral_cost = 0.0;
+    f64 cdf = 0.0, tail_sum = 0.0;
+    u64 k;
+    for (k = 0; ; ++k)
+    {
+        f64 flow, visits, cost;
+        distribution_rewards(builder, p, &flow, &visits, &cost);
+        const f64 pmf = exp(-a + (f64)k * log_a - lgamma((f64)k + 1.0));
+        cdf += pmf;
+        const f64 tail = cdf < 1.0 ? 1.0 - cdf : 0.0;
+        point_flow += pmf * flow;
+        point_fatal += pmf * p[CTMC_STATE_FATAL];
+        point_truncated += pmf * p[CTMC_STATE_TRUNCATED];
+        integral_flow += tail * flow;
+        integral_visits += tail * visits;
+        integral_cost += tail * cost;
+        tail_sum += tail;
+        if (tail < RMOD_CTMC_TOLERANCE && (f64)k > a)
+        {
+            break;
+        }
+
+        //  p_next = p P, with each state gathering probability from states which lead to it
+        f64 change = 0.0;
+        for (u32 j = 0; j < state_count; ++j)
+        {
+            f64 v = p[j] * (1.0 - builder->exit_rate[j] / lambda);
+            for (u32 e = in_offsets[j]; e < in_offsets[j + 1]; ++e)
+            {
+                v += p[in_src[e]] * in_rate[e] / lambda;
+            }
+            p_next[j] = v;
+            change += fabs(v - p[j]);
+        }
+        f64* const tmp = p;
+        p = p_next;
+        p_next = tmp;
+
+        //  Once the distribution stops changing, all remaining terms are the same
+        if (change * (a - (f64)k > 1.0 ? a - (f64)k : 1.0) < RMOD_CTMC_TOLERANCE)
+        {
+            k += 1;
+            distribution_rewards(builder, p, &flow, &visits, &cost);
+            const f64 remaining_tail = a - tail_sum > 0.0 ? a - tail_sum : 0.0;
+            point_flow += tail * flow;
+            point_fatal += tail * p[CTMC_STATE_FATAL];
+            point_truncated += tail * p[CTMC_STATE_TRUNCATED];
+            integral_flow += remaining_tail * flow;
+            integral_visits += remaining_tail * visits;
+            integral_cost += remaining_tail * cost;
+            break;
+        }
+    }
+    result->uniformization_steps = k;
+    result->point_flow = point_flow;
+    result->mean_flow = integral_flow / lambda / interval;
+    result->expected_visits = integral_visits / lambda;
+    result->expected_cost = integral_cost / lambda;
+    result->fatal_probability = point_fatal;
+    result->truncated_probability = point_truncated;
+
+    RMOD_LEAVE_FUNCTION;
+    return RMOD_RESULT_SUCCESS;
+}
+
+//  Steady state solution of pi Q = 0 using Gauss-Seidel iteration, only valid when there are no absorbing states
+static rmod_result solve_steady_state(
+        const ctmc_builder* const builder, const u32* const in_offsets, const u32* const in_src, const f64* const in_rate,
+        f64* const pi, rmod_ctmc_result* const result)
+{
+    RMOD_ENTER_FUNCTION;
+    const u32 state_count = builder->state_count;
+    const u32 live_count = state_count - CTMC_STATE_INITIAL;
+    pi[CTMC_STATE_FATAL] = 0.0;
+    pi[CTMC_STATE_TRUNCATED] = 0.0;
+    for (u32 i = CTMC_STATE_INITIAL; i < state_count; ++i)
+    {
+        pi[i] = 1.0 / (f64)live_count;
+    }
+
+    bool converged = false;
+    for (u32 sweep = 0; sweep < RMOD_CTMC_MAX_SWEEPS && !converged; ++sweep)
+    {
+        f64 change = 0.0, total = 0.0;
+        for (u32 j = CTMC_STATE_INITIAL; j < state_count; ++j)
+        {
+            if (builder->exit_rate[j] == 0.0)
+            {
+                continue;
+            }
+            f64 v = 0.0;
+            for (u32 e = in_offsets[j]; e < in_offsets[j + 1]; ++e)
+            {
+                v += pi[in_src[e]] * in_rate[e];
+            }
+            v /= builder->exit_rate[j];
+            change += fabs(v - pi[j]);
+            pi[j] = v;
+            total += v;
+        }
+        for (u32 j = CTMC_STATE_INITIAL; j < state_count; ++j)
+        {
+            pi[j] /= total;
+        }
+        converged = change / total < RMOD_CTMC_TOLERANCE * (f64)live_count;
+    }
+    if (!converged)
+    {
+        RMOD_WARN("Steady state iteration did not converge after %u sweeps", RMOD_CTMC_MAX_SWEEPS);
+    }
+    result->steady_converged = converged;
+    distribution_rewards(builder, pi, &result->steady_flow, &result->visit_rate, &result->cost_rate);
+
+    RMOD_LEAVE_FUNCTION;
+    return RMOD_RESULT_SUCCESS;
+}
+
+rmod_result rmod_ctmc_analysis(
+        const rmod_graph* graph, f64 interval, f64 repair_limit, u32 phase_count, u32 max_down, rmod_ctmc_result* p_out)
+{
+    RMOD_ENTER_FUNCTION;
+    rmod_result res;
+#ifndef _WIN32
+    struct timespec t_begin;
+    int time_res = clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &t_begin);
+    assert(time_res >= 0);
+#else
+    LARGE_INTEGER t_begin;
+    QueryPerformanceCounter(&t_begin);
+#endif
+    assert(phase_count > 0 && phase_count < UINT16_MAX);
+    const u64 state_estimate = estimate_state_count(graph, phase_count, max_down);
+    if (state_estimate > RMOD_CTMC_STATE_LIMIT)
+    {
+        RMOD_ERROR("Markov chain with %u phases and up to %u of %"PRIuFAST32" components down could have %"PRIu64" states, more than the limit of %u. Lower the number of phases, reduce the graph, or simulate it instead", phase_count, max_down, graph->component_count, state_estimate, RMOD_CTMC_STATE_LIMIT);
+        RMOD_LEAVE_FUNCTION;
+        return RMOD_RESULT_BAD_VALUE;
+    }
+    const u32 node_count = graph->node_count;
+    for (u32 i = 0; i < node_count; ++i)
+    {
+        if (member_end(graph, i) - member_begin(graph, i) > UINT16_MAX - CTMC_NODE_DOWN)
+        {
+            RMOD_ERROR("Node %u of the graph has too many members", i);
+            RMOD_LEAVE_FUNCTION;
+            return RMOD_RESULT_BAD_VALUE;
+        }
+    }
+    rmod_ctmc_result result =
+            {
+            .interval = interval,
+            .phase_count = phase_count,
+            .phases_converged = false,
+            .phase_change = INFINITY,
+            .max_down = max_down,
+            };
+    ctmc_builder builder =
+            {
+            .graph = graph,
+            .node_count = node_count,
+            .key_length = node_count + 1,
+            .phase_count = phase_count,
+            .max_down = max_down,
+            .repair_limit = repair_limit,
+            .state_count = CTMC_STATE_INITIAL,
+            .state_capacity = 1 << 10,
+            .table_capacity = 1 << 11,
+            .transition_capacity = 1 << 12,
+            };
+    u16* initial_key = NULL;
+    u32* in_offsets = NULL;
+    u32* in_src = NULL;
+    f64* in_rate = NULL;
+    f64* p = NULL;
+    f64* p_next = NULL;
+
+    builder.keys = jalloc(sizeof(*builder.keys) * builder.key_length * builder.state_capacity);
+    builder.flow = jalloc(sizeof(*builder.flow) * builder.state_capacity);
+    builder.exit_rate = jalloc(sizeof(*builder.exit_rate) * builder.state_capacity);
+    builder.maintenance_rate = jalloc(sizeof(*builder.maintenance_rate) * builder.state_capacity);
+    builder.cost_rate = jalloc(sizeof(*builder.cost_rate) * builder.state_capacity);
+    builder.table = jalloc(sizeof(*builder.table) * builder.table_capacity);
+    builder.transitions = jalloc(sizeof(*builder.transitions) * builder.transition_capacity);
+    initial_key = jalloc(sizeof(*initial_key) * builder.key_length);
+    if (!builder.keys || !builder.flow || !builder.exit_rate || !builder.maintenance_rate || !builder.cost_rate || !builder.table || !builder.transitions || !initial_key)
+    {
+        RMOD_ERROR("Failed allocating memory for the Markov chain builder");
+        res = RMOD_RESULT_NOMEM;
+        goto end;
+    }
+    memset(builder.table, 0xFF, sizeof(*builder.table) * builder.table_capacity);
+    memset(initial_key, 0, sizeof(*initial_key) * builder.key_length);
+    //  Absorbing states have no keys in the table, but are still given flow and rates
+    for (u32 i = 0; i < CTMC_STATE_INITIAL; ++i)
+    {
+        memset(builder.keys + (u64)i * builder.key_length, 0xFF, sizeof(*builder.keys) * builder.key_length);
+        builder.flow[i] = 0.0;
+        builder.exit_rate[i] = 0.0;
+        builder.maintenance_rate[i] = 0.0;
+        builder.cost_rate[i] = 0.0;
+    }
+
+    if ((res = build_chain(&builder, initial_key)) != RMOD_RESULT_SUCCESS)
+    {
+        RMOD_ERROR("Failed building the Markov chain, reason: %s", rmod_result_str(res));
+        goto end;
+    }
+    const u32 state_count = builder.state_count;
+    result.state_count = state_count;
+    result.transition_count = builder.transition_count;
+    result.max_flow = builder.flow[CTMC_STATE_INITIAL];
+
+    //  Transitions are sorted by their destination, since each state gathers probability from those leading to it
+    in_offsets = jalloc(sizeof(*in_offsets) * (state_count + 1));
+    in_src = jalloc(sizeof(*in_src) * (builder.transition_count + 1));
+    in_rate = jalloc(sizeof(*in_rate) * (builder.transition_count + 1));
+    p = jalloc(sizeof(*p) * state_count);
+    p_next = jalloc(sizeof(*p_next) * state_count);
+    if (!in_offsets || !in_src || !in_rate || !p || !p_next)
+    {
+        RMOD_ERROR("Failed allocating memory for the generator matrix");
+        res = RMOD_RESULT_NOMEM;
+        goto end;
+    }
+    memset(in_offsets, 0, sizeof(*in_offsets) * (state_count + 1));
+    for (u64 i = 0; i < builder.transition_count; ++i)
+    {
+        in_offsets[builder.transitions[i].dst + 1] += 1;
+    }
+    for (u32 i = 0; i < state_count; ++i)
+    {
+        in_offsets[i + 1] += in_offsets[i];
+    }
+    //  Use the next distribution as the fill position temporarily
+    u32* const fill = (u32*)p_next;
+    assert(sizeof(*p_next) >= sizeof(*fill));
+    memcpy(fill, in_offsets, sizeof(*fill) * state_count);
+    for (u64 i = 0; i < builder.transition_count; ++i)
+    {
+        const ctmc_transition* const t = builder.transitions + i;
+        const u32 pos = fill[t->dst]++;
+        in_src[pos] = t->src;
+        in_rate[pos] = t->rate;
+    }
+    jfree(builder.transitions);
+    builder.transitions = NULL;
+
+    if ((res = solve_transient(&builder, in_offsets, in_src, in_rate, p, p_next, &result)) != RMOD_RESULT_SUCCESS)
+    {
+        RMOD_ERROR("Failed finding transient solution of the Markov chain, reason: %s", rmod_result_str(res));
+        goto end;
+    }
+    result.has_steady_state = in_offsets[CTMC_STATE_TRUNCATED + 1] == 0;
+    if (result.has_steady_state && (res = solve_steady_state(&builder, in_offsets, in_src, in_rate, p, &result)) != RMOD_RESULT_SUCCESS)
+    {
+        RMOD_ERROR("Failed finding steady state solution of the Markov chain, reason: %s", rmod_result_str(res));
+        goto end;
+    }
+
+#ifndef _WIN32
+    struct timespec t_end;
+    time_res = clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &t_end);
+    assert(time_res >= 0);
+    result.duration = (f32)(t_end.tv_sec - t_begin.tv_sec) + (f32)((f64)(t_end.tv_nsec - t_begin.tv_nsec) / 1e9);
+#else
+    LARGE_INTEGER t_end, freq;
+    QueryPerformanceCounter(&t_end);
+    QueryPerformanceFrequency(&freq);
+    result.duration = (f32)((f64)(t_end.QuadPart - t_begin.QuadPart) / (f64)freq.QuadPart);
+#endif
+    *p_out = result;
+    res = RMOD_RESULT_SUCCESS;
+
+end:
+    jfree(p_next);
+    jfree(p);
+    jfree(in_rate);
+    jfree(in_src);
+    jfree(in_offsets);
+    jfree(initial_key);
+    jfree(builder.transitions);
+    jfree(builder.table);
+    jfree(builder.cost_rate);
+    jfree(builder.maintenance_rate);
+    jfree(builder.exit_rate);
+    jfree(builder.flow);
+    jfree(builder.keys);
+    RMOD_LEAVE_FUNCTION;
+    return res;
+}
+
+static f64 relative_change(const f64 old_value, const f64 new_value)
+{
+    if (old_value == new_value)
+    {
+        return 0.0;
+    }
+    return fabs(new_value - old_value) / fmax(fabs(old_value), fabs(new_value));
+}
+
+rmod_result rmod_ctmc_analysis_adaptive(
+        const rmod_graph* graph, f64 interval, f64 repair_limit, u32 initial_phase_count, u32 max_phase_count,
+        f64 tolerance, u32 max_down, rmod_ctmc_result* p_out)
+{
+    RMOD_ENTER_FUNCTION;
+    assert(initial_phase_count > 0 && initial_phase_count <= max_phase_count && max_phase_count < UINT16_MAX);
+    rmod_ctmc_result result;
+    rmod_result res = rmod_ctmc_analysis(graph, interval, repair_limit, initial_phase_count, max_down, &result);
+    if (res != RMOD_RESULT_SUCCESS)
+    {
+        RMOD_LEAVE_FUNCTION;
+        return res;
+    }
+    fprintf(stdout, "\tSolved Markov chain with %u phases (%u states) in %g seconds\n", result.phase_count, result.state_count, result.duration);
+    f32 duration = result.duration;
+    while (!result.phases_converged && result.phase_count <= max_phase_count / 2)
+    {
+        const u64 state_estimate = estimate_state_count(graph, 2 * result.phase_count, max_down);
+        if (state_estimate > RMOD_CTMC_STATE_LIMIT)
+        {
+            fprintf(stdout, "\tStopped doubling phases, since the chain with %u phases could have %"PRIu64" states\n", 2 * result.phase_count, state_estimate);
+            break;
+        }
+        rmod_ctmc_result next;
+        if ((res = rmod_ctmc_analysis(graph, interval, repair_limit, 2 * result.phase_count, max_down, &next)) != RMOD_RESULT_SUCCESS)
+        {
+            //  Chain with more phases may be too large, but results with fewer are still valid, just not converged
+            RMOD_WARN("Could not solve Markov chain with %u phases, reason: %s", 2 * result.phase_count, rmod_result_str(res));
+            break;
+        }
+        duration += next.duration;
+        f64 change = relative_change(result.mean_flow, next.mean_flow);
+        change = fmax(change, relative_change(result.expected_visits, next.expected_visits));
+        change = fmax(change, relative_change(result.expected_cost, next.expected_cost));
+        next.phase_change = change;
+        next.phases_converged = change < tolerance;
+        result = next;
+        fprintf(stdout, "\tSolved Markov chain with %u phases (%u states) in %g seconds, results changed by %.2e\n", result.phase_count, result.state_count, result.duration, change);
+    }
+    result.duration = duration;
+    *p_out = result;
+    RMOD_LEAVE_FUNCTION;
+    return RMOD_RESULT_SUCCESS;
+}
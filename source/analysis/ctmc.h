@@ -0,0 +1,57 @@
+//
+// Created by jan on 19.10.2026.
+//
+
+#ifndef RMOD_CTMC_H
+#define RMOD_CTMC_H
+#include "../common/rmod.h"
+#include "../simulation/compile.h"
+
+//  Results of solving the continuous-time Markov chain which the simulation approximates. Maintenance delay, which is
+//  deterministic in the simulation, is approximated by an Erlang distribution with the same mean.
+typedef struct rmod_ctmc_result_struct rmod_ctmc_result;
+struct rmod_ctmc_result_struct
+{
+    f32 duration;                       //  Processor time used by the analysis
+    f64 interval;                       //  Length of interval which transient results were computed for
+    u32 phase_count;                    //  Number of phases of the Erlang distribution of maintenance delay
+    bool phases_converged;              //  False if results still changed by more than the tolerance when doubling phases
+    f64 phase_change;                   //  Largest relative change of results when phases were last doubled
+    u32 max_down;                       //  States with more nodes down than this were merged into the truncated state
+    u32 state_count;                    //  Number of states of the chain
+    u64 transition_count;               //  Number of non-zero off-diagonal entries of the generator matrix
+    u64 uniformization_steps;           //  Number of matrix-vector products used for the transient solution
+
+    f64 max_flow;                       //  Flow through the system when everything works
+    f64 point_flow;                     //  Expected flow at the end of the interval
+    f64 mean_flow;                      //  Expected flow averaged over the interval
+    f64 expected_visits;                //  Expected number of maintenance visits during the interval
+    f64 expected_cost;                  //  Expected cost of maintenance during the interval
+    f64 fatal_probability;              //  Probability of a fatal failure happening during the interval
+    f64 truncated_probability;          //  Probability of reaching the truncated state, which bounds the error
+
+    bool has_steady_state;              //  False if a fatal failure or truncation is possible, since these absorb
+    bool steady_converged;              //  False if iteration for the steady state did not converge
+    f64 steady_flow;                    //  Expected flow in steady state
+    f64 visit_rate;                     //  Maintenance visits per unit time in steady state
+    f64 cost_rate;                      //  Cost of maintenance per unit time in steady state
+};
+
+//  Builds the generator matrix of the chain with states reachable from the state where every node works, following
+//  the same rules as the simulation: failed nodes deactivate nodes which depend on them, maintenance is needed when
+//  flow drops below repair_limit, a critical failure occurs, or no node can provide for any other, after which all
+//  nodes are repaired once the time to maintain the graph passes. Expected flow over the interval is found using
+//  uniformization, and the steady state using Gauss-Seidel iteration. Graphs which could give too many states, or whose
+//  transient solution would take too many steps, fail with RMOD_RESULT_BAD_VALUE before they are built or solved.
+rmod_result rmod_ctmc_analysis(
+        const rmod_graph* graph, f64 interval, f64 repair_limit, u32 phase_count, u32 max_down, rmod_ctmc_result* p_out);
+
+//  Solves the chain starting with initial_phase_count phases, doubling them until mean flow, expected visits, and
+//  expected cost change by less than tolerance relative to their values, or max_phase_count would be passed, or the
+//  chain could become too large to solve. Progress is printed after each solution. Results are those of the largest
+//  number of phases solved, with processor time added up over all of them.
+rmod_result rmod_ctmc_analysis_adaptive(
+        const rmod_graph* graph, f64 interval, f64 repair_limit, u32 initial_phase_count, u32 max_phase_count,
+        f64 tolerance, u32 max_down, rmod_ctmc_result* p_out);
+
+#endif //RMOD_CTMC_H
@@ -0,0 +1,493 @@
+//
+// Created by jan on 19.10.2026.
+//
+
+#include "cut_sets.h"
+#include "../common/parallel.h"
+#include <inttypes.h>
+
+//  Size of memory reserved by each worker for lists of cut sets
+#define RMOD_CUT_SET_ARENA_SIZE ((u64)1 << 28)
+//  Maximum number of cut sets kept for each node, past which the ones with the highest order are discarded
+#define RMOD_CUT_SET_LIMIT (1 << 16)
+
+typedef struct cut_set_list_struct cut_set_list;
+struct cut_set_list_struct
+{
+    u32 count;
+    u64* sets;
+};
+
+typedef struct cut_set_context_struct cut_set_context;
+struct cut_set_context_struct
+{
+    const rmod_graph* graph;
+    u32 n_words;
+    u32 max_order;
+    const u32* level_nodes;             //  Nodes on the level currently being expanded
+    cut_set_list* lists;                //  Cut sets of each node
+    bool* truncated;                    //  Set for each node which had any of its cut sets discarded
+    linear_jallocator** arenas;         //  Memory of each worker, which lists are allocated from
+};
+
+static inline u32 set_order(const u64* const set, const u32 n_words)
+{
+    u32 order = 0;
+    for (u32 i = 0; i < n_words; ++i)
+    {
+        order += __builtin_popcountll(set[i]);
+    }
+    return order;
+}
+
+static inline bool set_is_subset(const u64* const a, const u64* const b, const u32 n_words)
+{
+    for (u32 i = 0; i < n_words; ++i)
+    {
+        if (a[i] & ~b[i])
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+//  Removes all sets which contain any other set of the list, leaving the remaining ones sorted by order
+static rmod_result minimize_cut_sets(linear_jallocator* const arena, const u32 n_words, const u32 max_order, cut_set_list* const list, bool* const p_truncated)
+{
+    const u32 count = list->count;
+    if (count < 2)
+    {
+        return RMOD_RESULT_SUCCESS;
+    }
+    const u64 set_size = sizeof(*list->sets) * n_words;
+    u32* const orders = lin_jalloc(arena, sizeof(*orders) * count);
+    if (!orders)
+    {
+        RMOD_ERROR("Failed lin_jalloc(%p, %zu)", arena, sizeof(*orders) * count);
+        return RMOD_RESULT_NOMEM;
+    }
+    u64* const sorted = lin_jalloc(arena, set_size * count);
+    if (!sorted)
+    {
+        RMOD_ERROR("Failed lin_jalloc(%p, %zu)", arena, set_size * count);
+        lin_jfree(arena, orders);
+        return RMOD_RESULT_NOMEM;
+    }
+
+    //  Bucket sort by order, so that any set can only be absorbed by sets before it
+    u32 bucket_offsets[max_order + 2];
+    memset(bucket_offsets, 0, sizeof(bucket_offsets));
+    for (u32 i = 0; i < count; ++i)
+    {
+        orders[i] = set_order(list->sets + i * n_words, n_words);
+        assert(orders[i] <= max_order);
+        bucket_offsets[orders[i] + 1] += 1;
+    }
+    for (u32 i = 1; i < max_order + 2; ++i)
+    {
+        bucket_offsets[i] += bucket_offsets[i - 1];
+    }
+    for (u32 i = 0; i < count; ++i)
+    {
+        memcpy(sorted + (bucket_offsets[orders[i]]++) * n_words, list->sets + i * n_words, set_size);
+    }
+
+    u32 kept = 0;
+    for (u32 i = 0; i < count; ++i)
+    {
+        const u64* const set = sorted + i * n_words;
+        u32 j;
+        for (j = 0; j < kept; ++j)
+        {
+            if (set_is_subset(list->sets + j * n_words, set, n_words))
+            {
+                break;
+            }
+        }
+        if (j == kept)
+        {
+            memcpy(list->sets + (kept++) * n_words, set, set_size);
+        }
+    }
+
+    if (kept > RMOD_CUT_SET_LIMIT)
+    {
+        //  Drop all sets of the order at which the limit is crossed, so that the lower orders remain complete
+        const u32 dropped_order = set_order(list->sets + RMOD_CUT_SET_LIMIT * n_words, n_words);
+        kept = RMOD_CUT_SET_LIMIT;
+        while (kept && set_order(list->sets + (kept - 1) * n_words, n_words) >= dropped_order)
+        {
+            kept -= 1;
+        }
+        *p_truncated = true;
+    }
+    list->count = kept;
+
+    lin_jfree(arena, orders);
+    return RMOD_RESULT_SUCCESS;
+}
+
+//  Finds minimal cut sets of a conjunction of two failure functions, which is given by unions of all pairs of their
+//  cut sets. Resulting list is allocated on top of the arena.
+static rmod_result cross_cut_sets(linear_jallocator* const arena, const u32 n_words, const u32 max_order, const cut_set_list* const a, const cut_set_list* const b, cut_set_list* const p_out, bool* const p_truncated)
+{
+    const u64 set_size = sizeof(*a->sets) * n_words;
+    u64 capacity = 64;
+    u32 count = 0;
+    u64* sets = lin_jalloc(arena, set_size * capacity);
+    if (!sets)
+    {
+        RMOD_ERROR("Failed lin_jalloc(%p, %zu)", arena, set_size * capacity);
+        return RMOD_RESULT_NOMEM;
+    }
+    for (u32 i = 0; i < a->count; ++i)
+    {
+        const u64* const set_a = a->sets + i * n_words;
+        for (u32 j = 0; j < b->count; ++j)
+        {
+            const u64* const set_b = b->sets + j * n_words;
+            u32 order = 0;
+            for (u32 k = 0; k < n_words; ++k)
+            {
+                order += __builtin_popcountll(set_a[k] | set_b[k]);
+            }
+            if (order > max_order)
+            {
+                *p_truncated = true;
+                continue;
+            }
+            if (count == capacity)
+            {
+                capacity <<= 1;
+                u64* const new_ptr = lin_jrealloc(arena, sets, set_size * capacity);
+                if (!new_ptr)
+                {
+                    RMOD_ERROR("Failed lin_jrealloc(%p, %p, %zu)", arena, sets, set_size * capacity);
+                    lin_jfree(arena, sets);
+                    return RMOD_RESULT_NOMEM;
+                }
+                sets = new_ptr;
+            }
+            u64* const set = sets + (u64)count * n_words;
+            for (u32 k = 0; k < n_words; ++k)
+            {
+                set[k] = set_a[k] | set_b[k];
+            }
+            count += 1;
+        }
+    }
+
+    cut_set_list result = {.count = count, .sets = sets};
+    const rmod_result res = minimize_cut_sets(arena, n_words, max_order, &result, p_truncated);
+    if (res != RMOD_RESULT_SUCCESS)
+    {
+        lin_jfree(arena, sets);
+        return res;
+    }
+    *p_out = result;
+    return RMOD_RESULT_SUCCESS;
+}
+
+static rmod_result expand_node(void* param, u32 worker_idx, u32 task_idx)
+{
+    RMOD_ENTER_FUNCTION;
+    rmod_result res;
+    const cut_set_context* const ctx = param;
+    linear_jallocator* const arena = ctx->arenas[worker_idx];
+    const u32 n_words = ctx->n_words;
+    const u64 set_size = sizeof(u64) * n_words;
+    const u32 node_idx = ctx->level_nodes[task_idx];
+    const rmod_graph_node* const node = ctx->graph->node_list + node_idx;
+    void* const base = lin_jalloc_get_current(arena);
+    bool truncated = false;
+
+    //  Node fails when it fails itself or when all of its parents fail. List for the parents is found first, with one
+    //  extra slot left at the end for the node itself.
+    cut_set_list product = {.count = 0, .sets = NULL};
+    if (node->parent_count)
+    {
+        const cut_set_list* const first = ctx->lists + node->parents[0];
+        product.sets = lin_jalloc(arena, set_size * (first->count + 1));
+        if (!product.sets)
+        {
+            RMOD_ERROR("Failed lin_jalloc(%p, %zu)", arena, set_size * (first->count + 1));
+            res = RMOD_RESULT_NOMEM;
+            goto failed;
+        }
+        memcpy(product.sets, first->sets, set_size * first->count);
+        product.count = first->count;
+        for (u32 i = 1; i < node->parent_count; ++i)
+        {
+            cut_set_list combined;
+            if ((res = cross_cut_sets(arena, n_words, ctx->max_order, &product, ctx->lists + node->parents[i], &combined, &truncated)) != RMOD_RESULT_SUCCESS)
+            {
+                goto failed;
+            }
+            //  Move the combination down to where the product was, releasing the memory above it
+            memmove(product.sets, combined.sets, set_size * combined.count);
+            product.count = combined.count;
+            product.sets = lin_jrealloc(arena, product.sets, set_size * (product.count + 1));
+            assert(product.sets);
+        }
+    }
+    else
+    {
+        product.sets = lin_jalloc(arena, set_size);
+        if (!product.sets)
+        {
+            RMOD_ERROR("Failed lin_jalloc(%p, %zu)", arena, set_size);
+            res = RMOD_RESULT_NOMEM;
+            goto failed;
+        }
+    }
+
+    //  Node itself can not be in any of the sets of its parents, so the singleton can be added without minimizing
+    u64* const singleton = product.sets + (u64)product.count * n_words;
+    memset(singleton, 0, set_size);
+    singleton[node_idx / 64] = (u64)1 << (node_idx % 64);
+    product.count += 1;
+
+    ctx->lists[node_idx] = product;
+    ctx->truncated[node_idx] = truncated;
+    RMOD_LEAVE_FUNCTION;
+    return RMOD_RESULT_SUCCESS;
+
+failed:
+    lin_jalloc_set_current(arena, base);
+    RMOD_LEAVE_FUNCTION;
+    return res;
+}
+
+rmod_result rmod_find_minimal_cut_sets(const rmod_graph* graph, u32 max_order, u32 thread_count, rmod_cut_sets* p_out)
+{
+    RMOD_ENTER_FUNCTION;
+    rmod_result res;
+#ifndef _WIN32
+    struct timespec t_begin;
+    int time_res = clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &t_begin);
+    assert(time_res >= 0);
+#else
+    LARGE_INTEGER t_begin;
+    QueryPerformanceCounter(&t_begin);
+#endif
+    if (thread_count == 0)
+    {
+        thread_count = 1;
+    }
+    if (max_order == 0 || max_order > 64)
+    {
+        RMOD_ERROR("Maximum order of cut sets must be in range [1, 64], but %u was given", max_order);
+        RMOD_LEAVE_FUNCTION;
+        return RMOD_RESULT_BAD_VALUE;
+    }
+    const u32 node_count = graph->node_count;
+    const u32 n_words = (node_count + 63) / 64;
+    const u64 set_size = sizeof(u64) * n_words;
+    void* const base = lin_jalloc_get_current(G_LIN_JALLOCATOR);
+    rmod_cut_sets result = {.max_order = max_order, .n_words = n_words};
+
+    linear_jallocator** const arenas = lin_jalloc(G_LIN_JALLOCATOR, sizeof(*arenas) * thread_count);
+    if (!arenas)
+    {
+        RMOD_ERROR("Failed lin_jalloc(%p, %zu)", G_LIN_JALLOCATOR, sizeof(*arenas) * thread_count);
+        res = RMOD_RESULT_NOMEM;
+        goto failed;
+    }
+    memset(arenas, 0, sizeof(*arenas) * thread_count);
+    for (u32 i = 0; i < thread_count; ++i)
+    {
+        arenas[i] = lin_jallocator_create(RMOD_CUT_SET_ARENA_SIZE);
+        if (!arenas[i])
+        {
+            RMOD_ERROR("Failed creating linear allocator of size %"PRIu64" for worker %u", (u64)RMOD_CUT_SET_ARENA_SIZE, i);
+            res = RMOD_RESULT_NOMEM;
+            goto failed;
+        }
+    }
+    cut_set_list* const lists = lin_jalloc(G_LIN_JALLOCATOR, sizeof(*lists) * node_count);
+    if (!lists)
+    {
+        RMOD_ERROR("Failed lin_jalloc(%p, %zu)", G_LIN_JALLOCATOR, sizeof(*lists) * node_count);
+        res = RMOD_RESULT_NOMEM;
+        goto failed;
+    }
+    bool* const truncated = lin_jalloc(G_LIN_JALLOCATOR, sizeof(*truncated) * node_count);
+    if (!truncated)
+    {
+        RMOD_ERROR("Failed lin_jalloc(%p, %zu)", G_LIN_JALLOCATOR, sizeof(*truncated) * node_count);
+        res = RMOD_RESULT_NOMEM;
+        goto failed;
+    }
+    memset(truncated, 0, sizeof(*truncated) * node_count);
+    u32* const level = lin_jalloc(G_LIN_JALLOCATOR, sizeof(*level) * node_count);
+    if (!level)
+    {
+        RMOD_ERROR("Failed lin_jalloc(%p, %zu)", G_LIN_JALLOCATOR, sizeof(*level) * node_count);
+        res = RMOD_RESULT_NOMEM;
+        goto failed;
+    }
+    u32* const level_nodes = lin_jalloc(G_LIN_JALLOCATOR, sizeof(*level_nodes) * node_count);
+    if (!level_nodes)
+    {
+        RMOD_ERROR("Failed lin_jalloc(%p, %zu)", G_LIN_JALLOCATOR, sizeof(*level_nodes) * node_count);
+        res = RMOD_RESULT_NOMEM;
+        goto failed;
+    }
+    //  Parents always come before their children, so the levels can be found in a single pass
+    u32 level_count = 0;
+    for (u32 i = 0; i < node_count; ++i)
+    {
+        const rmod_graph_node* const node = graph->node_list + i;
+        u32 l = 0;
+        for (u32 j = 0; j < node->parent_count; ++j)
+        {
+            assert(node->parents[j] < i);
+            if (level[node->parents[j]] + 1 > l)
+            {
+                l = level[node->parents[j]] + 1;
+            }
+        }
+        level[i] = l;
+        if (l + 1 > level_count)
+        {
+            level_count = l + 1;
+        }
+    }
+    u32* const level_offsets = lin_jalloc(G_LIN_JALLOCATOR, sizeof(*level_offsets) * (level_count + 1));
+    if (!level_offsets)
+    {
+        RMOD_ERROR("Failed lin_jalloc(%p, %zu)", G_LIN_JALLOCATOR, sizeof(*level_offsets) * (level_count + 1));
+        res = RMOD_RESULT_NOMEM;
+        goto failed;
+    }
+    memset(level_offsets, 0, sizeof(*level_offsets) * (level_count + 1));
+    for (u32 i = 0; i < node_count; ++i)
+    {
+        level_offsets[level[i] + 1] += 1;
+    }
+    for (u32 i = 0; i < level_count; ++i)
+    {
+        level_offsets[i + 1] += level_offsets[i];
+    }
+    for (u32 i = 0; i < node_count; ++i)
+    {
+        level_nodes[level_offsets[level[i]]++] = i;
+    }
+    //  Offsets were moved one level forward while sorting
+    for (u32 i = level_count; i > 0; --i)
+    {
+        level_offsets[i] = level_offsets[i - 1];
+    }
+    level_offsets[0] = 0;
+
+    cut_set_context ctx =
+            {
+            .graph = graph,
+            .n_words = n_words,
+            .max_order = max_order,
+            .lists = lists,
+            .truncated = truncated,
+            .arenas = arenas,
+            };
+    for (u32 i = 0; i < level_count; ++i)
+    {
+        ctx.level_nodes = level_nodes + level_offsets[i];
+        res = rmod_parallel_run(thread_count, level_offsets[i + 1] - level_offsets[i], expand_node, &ctx, "cut-sets");
+        if (res != RMOD_RESULT_SUCCESS)
+        {
+            RMOD_ERROR("Failed expanding cut sets of level %u, reason: %s", i, rmod_result_str(res));
+            goto failed;
+        }
+    }
+
+    //  System fails when the last node fails, or when any of the components with fatal failures fails
+    const cut_set_list* const last = lists + node_count - 1;
+    u32 fatal_count = 0;
+    for (u32 i = 0; i < node_count; ++i)
+    {
+        fatal_count += graph->type_list[graph->node_list[i].type_id].failure_type == RMOD_FAILURE_TYPE_FATAL;
+    }
+    cut_set_list system = {.count = last->count, .sets = lin_jalloc(arenas[0], set_size * (last->count + fatal_count))};
+    if (!system.sets)
+    {
+        RMOD_ERROR("Failed lin_jalloc(%p, %zu)", arenas[0], set_size * (last->count + fatal_count));
+        res = RMOD_RESULT_NOMEM;
+        goto failed;
+    }
+    memcpy(system.sets, last->sets, set_size * last->count);
+    for (u32 i = 0; i < node_count; ++i)
+    {
+        if (graph->type_list[graph->node_list[i].type_id].failure_type == RMOD_FAILURE_TYPE_FATAL)
+        {
+            u64* const singleton = system.sets + (u64)(system.count++) * n_words;
+            memset(singleton, 0, set_size);
+            singleton[i / 64] = (u64)1 << (i % 64);
+        }
+    }
+    if ((res = minimize_cut_sets(arenas[0], n_words, max_order, &system, &result.truncated)) != RMOD_RESULT_SUCCESS)
+    {
+        goto failed;
+    }
+    for (u32 i = 0; i < node_count; ++i)
+    {
+        result.truncated |= truncated[i];
+    }
+
+    result.count = system.count;
+    result.sets = jalloc(set_size * (system.count ? system.count : 1));
+    if (!result.sets)
+    {
+        RMOD_ERROR("Failed jalloc(%zu)", set_size * (system.count ? system.count : 1));
+        res = RMOD_RESULT_NOMEM;
+        goto failed;
+    }
+    memcpy(result.sets, system.sets, set_size * system.count);
+
+    for (u32 i = 0; i < thread_count; ++i)
+    {
+        lin_jallocator_destroy(arenas[i]);
+    }
+    lin_jalloc_set_current(G_LIN_JALLOCATOR, base);
+
+#ifndef _WIN32
+    struct timespec t_end;
+    time_res = clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &t_end);
+    assert(time_res >= 0);
+    result.duration = (f32)(t_end.tv_sec - t_begin.tv_sec) + (f32)((f64)(t_end.tv_nsec - t_begin.tv_nsec) / 1e9);
+#else
+    LARGE_INTEGER t_end, freq;
+    QueryPerformanceCounter(&t_end);
+    QueryPerformanceFrequency(&freq);
+    result.duration = (f32)((f64)(t_end.QuadPart - t_begin.QuadPart) / (f64)freq.QuadPart);
+#endif
+    *p_out = result;
+    RMOD_LEAVE_FUNCTION;
+    return RMOD_RESULT_SUCCESS;
+
+failed:
+    if (arenas)
+    {
+        for (u32 i = 0; i < thread_count; ++i)
+        {
+            if (arenas[i])
+            {
+                lin_jallocator_destroy(arenas[i]);
+            }
+        }
+    }
+    lin_jalloc_set_current(G_LIN_JALLOCATOR, base);
+    RMOD_LEAVE_FUNCTION;
+    return res;
+}
+
+void rmod_cut_sets_release(rmod_cut_sets* cut_sets)
+{
+    jfree(cut_sets->sets);
+    memset(cut_sets, 0, sizeof(*cut_sets));
+}
+
+u32 rmod_cut_set_order(const rmod_cut_sets* cut_sets, u32 index)
+{
+    return set_order(cut_sets->sets + (u64)index * cut_sets->n_words, cut_sets->n_words);
+}
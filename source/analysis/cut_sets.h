@@ -0,0 +1,33 @@
+//
+// Created by jan on 19.10.2026.
+//
+
+#ifndef RMOD_CUT_SETS_H
+#define RMOD_CUT_SETS_H
+#include "../common/rmod.h"
+#include "../simulation/compile.h"
+
+//  Minimal cut sets of the graph: smallest sets of nodes, failure of which disconnects the last node from the first
+//  one, or which contain a component with a fatal failure type. Each cut set is stored as a bitset with bit i set when
+//  node i is in the set.
+typedef struct rmod_cut_sets_struct rmod_cut_sets;
+struct rmod_cut_sets_struct
+{
+    f32 duration;               //  Processor time used to find the cut sets
+    u32 max_order;              //  Cut sets with more nodes than this are not found
+    bool truncated;             //  True if any cut sets were discarded due to order or count limit
+    u32 n_words;                //  Number of 64-bit words used by each set
+    u32 count;                  //  Number of cut sets
+    u64* sets;                  //  Array of count * n_words words, with sets sorted by their order
+};
+
+//  Finds minimal cut sets using bottom-up expansion of the failure function of each node: node fails if it fails itself
+//  or if all of its parents fail. Nodes on the same level (same length of the longest path from a node with no parents)
+//  do not depend on one another, so they are expanded in parallel.
+rmod_result rmod_find_minimal_cut_sets(const rmod_graph* graph, u32 max_order, u32 thread_count, rmod_cut_sets* p_out);
+
+void rmod_cut_sets_release(rmod_cut_sets* cut_sets);
+
+u32 rmod_cut_set_order(const rmod_cut_sets* cut_sets, u32 index);
+
+#endif //RMOD_CUT_SETS_H
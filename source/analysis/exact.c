@@ -0,0 +1,512 @@
+//
+// Created by jan on 19.10.2026.
+//
+
+#include "exact.h"
+#include "../common/parallel.h"
+
+//  Limit on the size of the diagram, so that badly ordered graphs fail instead of using up all the memory
+#define RMOD_EXACT_BDD_NODE_LIMIT (1 << 22)
+//  Number of intervals used by Simpson's rule to compute interval averages (must be even)
+#define RMOD_EXACT_QUADRATURE_INTERVALS 128
+
+static rmod_result find_variable_order(const rmod_graph* const graph, u32* const order)
+{
+    RMOD_ENTER_FUNCTION;
+    //  Order variables in the order a depth first search starting at the last node and following the parents visits
+    //  them. This keeps nodes which feed into each other close in the order, which keeps the diagram small for graphs
+    //  which are mostly made of series and parallel chains.
+    const u32 node_count = graph->node_count;
+    u64 edge_count = 0;
+    for (u32 i = 0; i < node_count; ++i)
+    {
+        edge_count += graph->node_list[i].parent_count;
+    }
+    void* const base = lin_jalloc_get_current(G_LIN_JALLOCATOR);
+    u32* const stack = lin_jalloc(G_LIN_JALLOCATOR, sizeof(*stack) * (edge_count + 1));
+    if (!stack)
+    {
+        RMOD_ERROR("Failed lin_jalloc(%p, %zu)", G_LIN_JALLOCATOR, sizeof(*stack) * (edge_count + 1));
+        RMOD_LEAVE_FUNCTION;
+        return RMOD_RESULT_NOMEM;
+    }
+    bool* const visited = lin_jalloc(G_LIN_JALLOCATOR, sizeof(*visited) * node_count);
+    if (!visited)
+    {
+        RMOD_ERROR("Failed lin_jalloc(%p, %zu)", G_LIN_JALLOCATOR, sizeof(*visited) * node_count);
+        lin_jalloc_set_current(G_LIN_JALLOCATOR, base);
+        RMOD_LEAVE_FUNCTION;
+        return RMOD_RESULT_NOMEM;
+    }
+    memset(visited, 0, sizeof(*visited) * node_count);
+
+    u32 position = 0;
+    u64 stack_size = 0;
+    stack[stack_size++] = node_count - 1;
+    while (stack_size)
+    {
+        const u32 node_idx = stack[--stack_size];
+        if (visited[node_idx])
+        {
+            continue;
+        }
+        visited[node_idx] = true;
+        order[position++] = node_idx;
+        const rmod_graph_node* const node = graph->node_list + node_idx;
+        //  Push in reverse, so that the first parent is visited first
+        for (u32 j = node->parent_count; j > 0; --j)
+        {
+            const u32 parent = node->parents[j - 1];
+            if (!visited[parent])
+            {
+                stack[stack_size++] = parent;
+            }
+        }
+    }
+    //  Nodes which do not feed the last node do not affect the structure, but still need a place in the order
+    for (u32 i = 0; i < node_count; ++i)
+    {
+        if (!visited[i])
+        {
+            order[position++] = i;
+        }
+    }
+    assert(position == node_count);
+
+    lin_jfree(G_LIN_JALLOCATOR, visited);
+    lin_jfree(G_LIN_JALLOCATOR, stack);
+    RMOD_LEAVE_FUNCTION;
+    return RMOD_RESULT_SUCCESS;
+}
+
+rmod_result rmod_structure_function_build(const rmod_graph* graph, rmod_structure_function* p_out)
+{
+    RMOD_ENTER_FUNCTION;
+    rmod_result res;
+    const u32 node_count = graph->node_count;
+    void* const base = lin_jalloc_get_current(G_LIN_JALLOCATOR);
+    rmod_bdd_manager bdd = {0};
+    u32* const order = lin_jalloc(G_LIN_JALLOCATOR, sizeof(*order) * node_count);
+    if (!order)
+    {
+        RMOD_ERROR("Failed lin_jalloc(%p, %zu)", G_LIN_JALLOCATOR, sizeof(*order) * node_count);
+        res = RMOD_RESULT_NOMEM;
+        goto failed;
+    }
+    if ((res = find_variable_order(graph, order)) != RMOD_RESULT_SUCCESS)
+    {
+        RMOD_ERROR("Could not find variable order for the graph, reason: %s", rmod_result_str(res));
+        goto failed;
+    }
+    if ((res = rmod_bdd_create(node_count, order, RMOD_EXACT_BDD_NODE_LIMIT, &bdd)) != RMOD_RESULT_SUCCESS)
+    {
+        RMOD_ERROR("Could not create binary decision diagram manager, reason: %s", rmod_result_str(res));
+        goto failed;
+    }
+    lin_jfree(G_LIN_JALLOCATOR, order);
+
+    //  Function for each node is true when the node works and at least one of its parents has flow through it. Since
+    //  the nodes are sorted so that parents come before their children, this can be done in a single pass.
+    rmod_bdd_ref* const node_function = lin_jalloc(G_LIN_JALLOCATOR, sizeof(*node_function) * node_count);
+    if (!node_function)
+    {
+        RMOD_ERROR("Failed lin_jalloc(%p, %zu)", G_LIN_JALLOCATOR, sizeof(*node_function) * node_count);
+        res = RMOD_RESULT_NOMEM;
+        goto failed;
+    }
+    for (u32 i = 0; i < node_count; ++i)
+    {
+        const rmod_graph_node* const node = graph->node_list + i;
+        rmod_bdd_ref f;
+        if ((res = rmod_bdd_variable(&bdd, i, &f)) != RMOD_RESULT_SUCCESS)
+        {
+            goto failed;
+        }
+        if (node->parent_count)
+        {
+            rmod_bdd_ref input = RMOD_BDD_FALSE;
+            for (u32 j = 0; j < node->parent_count; ++j)
+            {
+                assert(node->parents[j] < i);
+                if ((res = rmod_bdd_or(&bdd, input, node_function[node->parents[j]], &input)) != RMOD_RESULT_SUCCESS)
+                {
+                    goto failed;
+                }
+            }
+            if ((res = rmod_bdd_and(&bdd, f, input, &f)) != RMOD_RESULT_SUCCESS)
+            {
+                goto failed;
+            }
+        }
+        node_function[i] = f;
+    }
+
+    //  Any fatal failure ends the simulation, so those components are in series with the rest of the system
+    rmod_bdd_ref root = node_function[node_count - 1];
+    for (u32 i = 0; i < node_count; ++i)
+    {
+        if (graph->type_list[graph->node_list[i].type_id].failure_type != RMOD_FAILURE_TYPE_FATAL)
+        {
+            continue;
+        }
+        rmod_bdd_ref x;
+        if ((res = rmod_bdd_variable(&bdd, i, &x)) != RMOD_RESULT_SUCCESS
+            || (res = rmod_bdd_and(&bdd, root, x, &root)) != RMOD_RESULT_SUCCESS)
+        {
+            goto failed;
+        }
+    }
+    lin_jfree(G_LIN_JALLOCATOR, node_function);
+
+    p_out->bdd = bdd;
+    p_out->root = root;
+    RMOD_LEAVE_FUNCTION;
+    return RMOD_RESULT_SUCCESS;
+
+failed:
+    rmod_bdd_destroy(&bdd);
+    lin_jalloc_set_current(G_LIN_JALLOCATOR, base);
+    RMOD_LEAVE_FUNCTION;
+    return res;
+}
+
+void rmod_structure_function_destroy(rmod_structure_function* structure)
+{
+    rmod_bdd_destroy(&structure->bdd);
+    structure->root = RMOD_BDD_FALSE;
+}
+
+//  Unavailability of an alternating renewal process with exponential failures and repairs which starts as working.
+//  Components with fatal failures are never repaired.
+static f64 component_unavailability(const rmod_graph_node_type* const type, const f64 t)
+{
+    const f64 lambda = type->failure_rate;
+    if (lambda == 0.0)
+    {
+        return 0.0;
+    }
+    if (type->failure_type == RMOD_FAILURE_TYPE_FATAL)
+    {
+        return -expm1(-lambda * t);
+    }
+    if (type->repair_time == 0.0f)
+    {
+        return 0.0;
+    }
+    const f64 s = lambda + 1.0 / type->repair_time;
+    return lambda / s * -expm1(-s * t);
+}
+
+static f64 component_steady_unavailability(const rmod_graph_node_type* const type)
+{
+    const f64 lambda = type->failure_rate;
+    if (lambda == 0.0)
+    {
+        return 0.0;
+    }
+    if (type->failure_type == RMOD_FAILURE_TYPE_FATAL)
+    {
+        return 1.0;
+    }
+    return lambda * type->repair_time / (1.0 + lambda * type->repair_time);
+}
+
+static f64 component_mean_unavailability(const rmod_graph_node_type* const type, const f64 t)
+{
+    const f64 lambda = type->failure_rate;
+    if (lambda == 0.0 || t <= 0.0)
+    {
+        return 0.0;
+    }
+    if (type->failure_type == RMOD_FAILURE_TYPE_FATAL)
+    {
+        return 1.0 + expm1(-lambda * t) / (lambda * t);
+    }
+    if (type->repair_time == 0.0f)
+    {
+        return 0.0;
+    }
+    const f64 s = lambda + 1.0 / type->repair_time;
+    return lambda / s * (1.0 + expm1(-s * t) / (s * t));
+}
+
+//  Expected flow through the system given the probability of each component working. Flow of each node is a product of
+//  its own state with sums of flows of its parents, so as long as no fatal components are involved, linearity of
+//  expectation allows it to be computed in a single pass. Fatal components stop the whole system, so the flow is
+//  computed conditioned on them all working and then multiplied by the probability of that.
+static f64 expected_flow(const rmod_graph* const graph, const f64* const p_work, f64* const value)
+{
+    f64 fatal_factor = 1.0;
+    for (u32 i = 0; i < graph->node_count; ++i)
+    {
+        const rmod_graph_node* const node = graph->node_list + i;
+        const rmod_graph_node_type* const type = graph->type_list + node->type_id;
+        f64 input = node->parent_count == 0 ? 1.0 : 0.0;
+        for (u32 j = 0; j < node->parent_count; ++j)
+        {
+            input += value[node->parents[j]];
+        }
+        f64 p = p_work[i];
+        if (type->failure_type == RMOD_FAILURE_TYPE_FATAL)
+        {
+            fatal_factor *= p;
+            p = 1.0;
+        }
+        value[i] = p * type->effect * input;
+    }
+    return value[graph->node_count - 1] * fatal_factor;
+}
+
+rmod_result rmod_exact_analysis(const rmod_graph* graph, f64 interval, rmod_exact_result* p_out)
+{
+    RMOD_ENTER_FUNCTION;
+    rmod_result res;
+#ifndef _WIN32
+    struct timespec t_begin;
+    int time_res = clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &t_begin);
+    assert(time_res >= 0);
+#else
+    LARGE_INTEGER t_begin;
+    QueryPerformanceCounter(&t_begin);
+#endif
+    const u32 node_count = graph->node_count;
+    rmod_exact_result result = {.interval = interval, .n_components = node_count};
+    void* const base = lin_jalloc_get_current(G_LIN_JALLOCATOR);
+
+    if ((res = rmod_structure_function_build(graph, &result.structure)) != RMOD_RESULT_SUCCESS)
+    {
+        RMOD_ERROR("Could not build structure function of the graph, reason: %s", rmod_result_str(res));
+        goto failed;
+    }
+    const rmod_bdd_manager* const bdd = &result.structure.bdd;
+    const rmod_bdd_ref root = result.structure.root;
+
+    result.steady_unavailability = jalloc(sizeof(*result.steady_unavailability) * node_count);
+    if (!result.steady_unavailability)
+    {
+        RMOD_ERROR("Failed jalloc(%zu)", sizeof(*result.steady_unavailability) * node_count);
+        res = RMOD_RESULT_NOMEM;
+        goto failed;
+    }
+    result.point_unavailability = jalloc(sizeof(*result.point_unavailability) * node_count);
+    if (!result.point_unavailability)
+    {
+        RMOD_ERROR("Failed jalloc(%zu)", sizeof(*result.point_unavailability) * node_count);
+        res = RMOD_RESULT_NOMEM;
+        goto failed;
+    }
+    result.mean_unavailability = jalloc(sizeof(*result.mean_unavailability) * node_count);
+    if (!result.mean_unavailability)
+    {
+        RMOD_ERROR("Failed jalloc(%zu)", sizeof(*result.mean_unavailability) * node_count);
+        res = RMOD_RESULT_NOMEM;
+        goto failed;
+    }
+
+    f64* const p_work = lin_jalloc(G_LIN_JALLOCATOR, sizeof(*p_work) * node_count);
+    if (!p_work)
+    {
+        RMOD_ERROR("Failed lin_jalloc(%p, %zu)", G_LIN_JALLOCATOR, sizeof(*p_work) * node_count);
+        res = RMOD_RESULT_NOMEM;
+        goto failed;
+    }
+    f64* const value = lin_jalloc(G_LIN_JALLOCATOR, sizeof(*value) * node_count);
+    if (!value)
+    {
+        RMOD_ERROR("Failed lin_jalloc(%p, %zu)", G_LIN_JALLOCATOR, sizeof(*value) * node_count);
+        res = RMOD_RESULT_NOMEM;
+        goto failed;
+    }
+    f64* const bdd_work = lin_jalloc(G_LIN_JALLOCATOR, sizeof(*bdd_work) * bdd->node_count);
+    if (!bdd_work)
+    {
+        RMOD_ERROR("Failed lin_jalloc(%p, %zu)", G_LIN_JALLOCATOR, sizeof(*bdd_work) * bdd->node_count);
+        res = RMOD_RESULT_NOMEM;
+        goto failed;
+    }
+    result.bdd_size = rmod_bdd_size(bdd, root, (u8*)bdd_work);
+
+    //  Everything working
+    for (u32 i = 0; i < node_count; ++i)
+    {
+        p_work[i] = 1.0;
+    }
+    result.max_flow = expected_flow(graph, p_work, value);
+
+    //  Steady state
+    for (u32 i = 0; i < node_count; ++i)
+    {
+        const rmod_graph_node_type* const type = graph->type_list + graph->node_list[i].type_id;
+        result.steady_unavailability[i] = component_steady_unavailability(type);
+        result.point_unavailability[i] = component_unavailability(type, interval);
+        result.mean_unavailability[i] = component_mean_unavailability(type, interval);
+        p_work[i] = 1.0 - result.steady_unavailability[i];
+    }
+    result.steady_availability = rmod_bdd_probability(bdd, root, p_work, bdd_work);
+    result.steady_flow = expected_flow(graph, p_work, value);
+
+    //  Interval averages are found with Simpson's rule, with the last point also giving the values at the end
+    const f64 h = interval / RMOD_EXACT_QUADRATURE_INTERVALS;
+    f64 sum_availability = 0.0, sum_flow = 0.0;
+    for (u32 k = 0; k <= RMOD_EXACT_QUADRATURE_INTERVALS; ++k)
+    {
+        const f64 t = h * (f64)k;
+        for (u32 i = 0; i < node_count; ++i)
+        {
+            p_work[i] = 1.0 - component_unavailability(graph->type_list + graph->node_list[i].type_id, t);
+        }
+        const f64 availability = rmod_bdd_probability(bdd, root, p_work, bdd_work);
+        const f64 flow = expected_flow(graph, p_work, value);
+        const f64 weight = (k == 0 || k == RMOD_EXACT_QUADRATURE_INTERVALS) ? 1.0 : ((k & 1) ? 4.0 : 2.0);
+        sum_availability += weight * availability;
+        sum_flow += weight * flow;
+        if (k == RMOD_EXACT_QUADRATURE_INTERVALS)
+        {
+            result.point_availability = availability;
+            result.point_flow = flow;
+        }
+    }
+    result.mean_availability = sum_availability / (3.0 * RMOD_EXACT_QUADRATURE_INTERVALS);
+    result.mean_flow = sum_flow / (3.0 * RMOD_EXACT_QUADRATURE_INTERVALS);
+
+    lin_jfree(G_LIN_JALLOCATOR, bdd_work);
+    lin_jfree(G_LIN_JALLOCATOR, value);
+    lin_jfree(G_LIN_JALLOCATOR, p_work);
+
+#ifndef _WIN32
+    struct timespec t_end;
+    time_res = clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &t_end);
+    assert(time_res >= 0);
+    result.duration = (f32)(t_end.tv_sec - t_begin.tv_sec) + (f32)((f64)(t_end.tv_nsec - t_begin.tv_nsec) / 1e9);
+#else
+    LARGE_INTEGER t_end, freq;
+    QueryPerformanceCounter(&t_end);
+    QueryPerformanceFrequency(&freq);
+    result.duration = (f32)((f64)(t_end.QuadPart - t_begin.QuadPart) / (f64)freq.QuadPart);
+#endif
+
+    *p_out = result;
+    RMOD_LEAVE_FUNCTION;
+    return RMOD_RESULT_SUCCESS;
+
+failed:
+    lin_jalloc_set_current(G_LIN_JALLOCATOR, base);
+    rmod_exact_result_release(&result);
+    RMOD_LEAVE_FUNCTION;
+    return res;
+}
+
+typedef struct importance_context_struct importance_context;
+struct importance_context_struct
+{
+    const rmod_exact_result* exact;
+    f64 availability;
+    rmod_importance* importance;
+    u32 n_components;
+    f64* p_work;                        //  Probability of each component working, one array per worker
+    f64* bdd_work;                      //  Work array for the decision diagram evaluation, one array per worker
+};
+
+static rmod_result component_importance(void* param, u32 worker_idx, u32 task_idx)
+{
+    const importance_context* const ctx = param;
+    const rmod_bdd_manager* const bdd = &ctx->exact->structure.bdd;
+    const rmod_bdd_ref root = ctx->exact->structure.root;
+    f64* const p_work = ctx->p_work + (u64)worker_idx * ctx->n_components;
+    f64* const bdd_work = ctx->bdd_work + (u64)worker_idx * bdd->node_count;
+    for (u32 i = 0; i < ctx->n_components; ++i)
+    {
+        p_work[i] = 1.0 - ctx->exact->mean_unavailability[i];
+    }
+    p_work[task_idx] = 1.0;
+    const f64 availability_working = rmod_bdd_probability(bdd, root, p_work, bdd_work);
+    p_work[task_idx] = 0.0;
+    const f64 availability_failed = rmod_bdd_probability(bdd, root, p_work, bdd_work);
+
+    const f64 q = 1.0 - ctx->availability;
+    const f64 q_working = 1.0 - availability_working;
+    const f64 q_failed = 1.0 - availability_failed;
+    rmod_importance* const importance = ctx->importance + task_idx;
+    importance->birnbaum = availability_working - availability_failed;
+    importance->fussell_vesely = q > 0.0 ? (q - q_working) / q : 0.0;
+    importance->risk_achievement = q > 0.0 ? q_failed / q : (q_failed > 0.0 ? INFINITY : 1.0);
+    importance->risk_reduction = q_working > 0.0 ? q / q_working : (q > 0.0 ? INFINITY : 1.0);
+    return RMOD_RESULT_SUCCESS;
+}
+
+rmod_result rmod_exact_importance(const rmod_graph* graph, u32 thread_count, rmod_exact_result* exact)
+{
+    RMOD_ENTER_FUNCTION;
+    rmod_result res;
+    (void)graph;
+    assert(graph->node_count == exact->n_components);
+    if (thread_count == 0)
+    {
+        thread_count = 1;
+    }
+    const u32 n_components = exact->n_components;
+    const rmod_bdd_manager* const bdd = &exact->structure.bdd;
+    void* const base = lin_jalloc_get_current(G_LIN_JALLOCATOR);
+    rmod_importance* const importance = jalloc(sizeof(*importance) * n_components);
+    if (!importance)
+    {
+        RMOD_ERROR("Failed jalloc(%zu)", sizeof(*importance) * n_components);
+        res = RMOD_RESULT_NOMEM;
+        goto failed;
+    }
+    f64* const p_work = lin_jalloc(G_LIN_JALLOCATOR, sizeof(*p_work) * n_components * thread_count);
+    if (!p_work)
+    {
+        RMOD_ERROR("Failed lin_jalloc(%p, %zu)", G_LIN_JALLOCATOR, sizeof(*p_work) * n_components * thread_count);
+        res = RMOD_RESULT_NOMEM;
+        goto failed;
+    }
+    f64* const bdd_work = lin_jalloc(G_LIN_JALLOCATOR, sizeof(*bdd_work) * bdd->node_count * thread_count);
+    if (!bdd_work)
+    {
+        RMOD_ERROR("Failed lin_jalloc(%p, %zu)", G_LIN_JALLOCATOR, sizeof(*bdd_work) * bdd->node_count * thread_count);
+        res = RMOD_RESULT_NOMEM;
+        goto failed;
+    }
+    for (u32 i = 0; i < n_components; ++i)
+    {
+        p_work[i] = 1.0 - exact->mean_unavailability[i];
+    }
+    importance_context ctx =
+            {
+            .exact = exact,
+            .availability = rmod_bdd_probability(bdd, exact->structure.root, p_work, bdd_work),
+            .importance = importance,
+            .n_components = n_components,
+            .p_work = p_work,
+            .bdd_work = bdd_work,
+            };
+    if ((res = rmod_parallel_run(thread_count, n_components, component_importance, &ctx, "importance")) != RMOD_RESULT_SUCCESS)
+    {
+        RMOD_ERROR("Failed computing component importance, reason: %s", rmod_result_str(res));
+        goto failed;
+    }
+    lin_jfree(G_LIN_JALLOCATOR, bdd_work);
+    lin_jfree(G_LIN_JALLOCATOR, p_work);
+
+    exact->importance_unavailability = 1.0 - ctx.availability;
+    exact->importance = importance;
+    RMOD_LEAVE_FUNCTION;
+    return RMOD_RESULT_SUCCESS;
+
+failed:
+    jfree(importance);
+    lin_jalloc_set_current(G_LIN_JALLOCATOR, base);
+    RMOD_LEAVE_FUNCTION;
+    return res;
+}
+
+void rmod_exact_result_release(rmod_exact_result* result)
+{
+    jfree(result->importance);
+    jfree(result->mean_unavailability);
+    jfree(result->point_unavailability);
+    jfree(result->steady_unavailability);
+    rmod_structure_function_destroy(&result->structure);
+    memset(result, 0, sizeof(*result));
+}
@@ -0,0 +1,72 @@
+//
+// Created by jan on 19.10.2026.
+//
+
+#ifndef RMOD_EXACT_H
+#define RMOD_EXACT_H
+#include "../common/rmod.h"
+#include "../simulation/compile.h"
+#include "bdd.h"
+
+//  Structure function of the graph: true when the last node of the graph is connected to the first one through working
+//  nodes and no component with a fatal failure type is down. Variable i of the diagram is true when node i works.
+typedef struct rmod_structure_function_struct rmod_structure_function;
+struct rmod_structure_function_struct
+{
+    rmod_bdd_manager bdd;
+    rmod_bdd_ref root;
+};
+
+//  Importance measures of a component, based on its unavailability averaged over the interval
+typedef struct rmod_importance_struct rmod_importance;
+struct rmod_importance_struct
+{
+    f64 birnbaum;                       //  Change in system availability between component working and failed
+    f64 fussell_vesely;                 //  Fraction of system unavailability removed if component was perfect
+    f64 risk_achievement;               //  Ratio of system unavailability with component failed to the current one
+    f64 risk_reduction;                 //  Ratio of current system unavailability to the one with perfect component
+};
+
+typedef struct rmod_exact_result_struct rmod_exact_result;
+struct rmod_exact_result_struct
+{
+    f32 duration;                       //  Processor time used by the analysis
+    f64 interval;                       //  Length of interval which results were computed for
+    u32 bdd_size;                       //  Number of nodes in the structure function's diagram
+
+    u32 n_components;
+    f64* steady_unavailability;         //  Per-component unavailability in steady state
+    f64* point_unavailability;          //  Per-component unavailability at the end of the interval
+    f64* mean_unavailability;           //  Per-component unavailability averaged over the interval
+
+    f64 steady_availability;            //  Probability of system structure working in steady state
+    f64 point_availability;             //  Probability of system structure working at the end of the interval
+    f64 mean_availability;              //  Probability of system structure working averaged over the interval
+
+    f64 max_flow;                       //  Flow through the system when everything works
+    f64 steady_flow;                    //  Expected flow in steady state
+    f64 point_flow;                     //  Expected flow at the end of the interval
+    f64 mean_flow;                      //  Expected flow averaged over the interval
+
+    f64 importance_unavailability;      //  System unavailability which importance measures are relative to
+    rmod_importance* importance;        //  Per-component importance measures, NULL when not computed
+
+    rmod_structure_function structure;
+};
+
+rmod_result rmod_structure_function_build(const rmod_graph* graph, rmod_structure_function* p_out);
+
+void rmod_structure_function_destroy(rmod_structure_function* structure);
+
+//  Computes exact availability of the graph under the assumption that each component is repaired independently of all
+//  others, with exponentially distributed repair time with mean equal to its repair time. Components with fatal
+//  failure type are never repaired.
+rmod_result rmod_exact_analysis(const rmod_graph* graph, f64 interval, rmod_exact_result* p_out);
+
+//  Computes importance measures of each component from the structure function, with the components split between
+//  thread_count threads
+rmod_result rmod_exact_importance(const rmod_graph* graph, u32 thread_count, rmod_exact_result* exact);
+
+void rmod_exact_result_release(rmod_exact_result* result);
+
+#endif //RMOD_EXACT_H
@@ -0,0 +1,178 @@
+//
+// Created by jan on 19.10.2026.
+//
+#include "histogram.h"
+#include <float.h>
+#include <math.h>
+#include <string.h>
+
+//  Smallest power of two, which is not below width, for which buckets aligned to it cover [lo, hi]
+static f64 covering_width(const f64 lo, const f64 hi, f64 width)
+{
+    if (width == 0.0)
+    {
+        width = fmax(ldexp(1.0, ilogb((hi - lo) / RMOD_HISTOGRAM_BUCKETS)), DBL_MIN);
+    }
+    while (hi >= floor(lo / width) * width + width * RMOD_HISTOGRAM_BUCKETS)
+    {
+        width *= 2.0;
+    }
+    return width;
+}
+
+static u32 bucket_of(const rmod_histogram* histogram, const f64 value)
+{
+    const f64 position = floor((value - histogram->origin) / histogram->width);
+    if (position < 0.0)
+    {
+        return 0;
+    }
+    if (position >= RMOD_HISTOGRAM_BUCKETS)
+    {
+        return RMOD_HISTOGRAM_BUCKETS - 1;
+    }
+    return (u32)position;
+}
+
+//  Moves counts to buckets of the given width, starting with the one which contains lo. Width must not be smaller than
+//  the current one, so each old bucket goes into a single new one.
+static void rebin(rmod_histogram* histogram, const f64 lo, const f64 width)
+{
+    u32 counts[RMOD_HISTOGRAM_BUCKETS];
+    memcpy(counts, histogram->buckets, sizeof(counts));
+    memset(histogram->buckets, 0, sizeof(histogram->buckets));
+    const f64 old_origin = histogram->origin;
+    const f64 old_width = histogram->width;
+    histogram->origin = floor(lo / width) * width;
+    histogram->width = width;
+    if (old_width == 0.0)
+    {
+        //  All values were equal to the minimum, so they were counted in the first bucket
+        histogram->buckets[bucket_of(histogram, histogram->min)] = counts[0];
+        return;
+    }
+    for (u32 i = 0; i < RMOD_HISTOGRAM_BUCKETS; ++i)
+    {
+        if (counts[i])
+        {
+            histogram->buckets[bucket_of(histogram, old_origin + old_width * i)] += counts[i];
+        }
+    }
+}
+
+void rmod_histogram_clear(rmod_histogram* histogram)
+{
+    memset(histogram, 0, sizeof(*histogram));
+    histogram->min = INFINITY;
+    histogram->max = -INFINITY;
+}
+
+void rmod_histogram_add(rmod_histogram* histogram, f64 value)
+{
+    if (!histogram->count)
+    {
+        histogram->min = value;
+        histogram->max = value;
+        histogram->origin = value;
+        histogram->width = 0.0;
+    }
+    else if (value < histogram->min || value > histogram->max)
+    {
+        const f64 lo = value < histogram->min ? value : histogram->min;
+        const f64 hi = value > histogram->max ? value : histogram->max;
+        if (histogram->width == 0.0 || value < histogram->origin || value >= histogram->origin + histogram->width * RMOD_HISTOGRAM_BUCKETS)
+        {
+            rebin(histogram, lo, covering_width(lo, hi, histogram->width));
+        }
+        histogram->min = lo;
+        histogram->max = hi;
+    }
+    histogram->count += 1;
+    histogram->buckets[histogram->width != 0.0 ? bucket_of(histogram, value) : 0] += 1;
+}
+
+void rmod_histogram_merge(rmod_histogram* histogram, const rmod_histogram* other)
+{
+    if (!other->count)
+    {
+        return;
+    }
+    if (!histogram->count)
+    {
+        *histogram = *other;
+        return;
+    }
+    const f64 lo = other->min < histogram->min ? other->min : histogram->min;
+    const f64 hi = other->max > histogram->max ? other->max : histogram->max;
+    if (lo != hi)
+    {
+        const f64 width = covering_width(lo, hi, histogram->width > other->width ? histogram->width : other->width);
+        if (width != histogram->width || floor(lo / width) * width != histogram->origin)
+        {
+            rebin(histogram, lo, width);
+        }
+    }
+    histogram->min = lo;
+    histogram->max = hi;
+    histogram->count += other->count;
+    if (histogram->width == 0.0)
+    {
+        //  Both only had values equal to the same minimum
+        histogram->buckets[0] += other->count;
+        return;
+    }
+    if (other->width == 0.0)
+    {
+        histogram->buckets[bucket_of(histogram, other->min)] += other->buckets[0];
+        return;
+    }
+    for (u32 i = 0; i < RMOD_HISTOGRAM_BUCKETS; ++i)
+    {
+        if (other->buckets[i])
+        {
+            histogram->buckets[bucket_of(histogram, other->origin + other->width * i)] += other->buckets[i];
+        }
+    }
+}
+
+f64 rmod_histogram_quantile(const rmod_histogram* histogram, f64 q)
+{
+    if (!histogram->count)
+    {
+        return NAN;
+    }
+    if (histogram->width == 0.0)
+    {
+        return histogram->min;
+    }
+    //  Rank of the value which is looked for, counting from 1
+    u64 rank = (u64)ceil(q * (f64)histogram->count);
+    if (rank < 1)
+    {
+        rank = 1;
+    }
+    if (rank > histogram->count)
+    {
+        rank = histogram->count;
+    }
+    f64 value = histogram->max;
+    u64 seen = 0;
+    for (u32 i = 0; i < RMOD_HISTOGRAM_BUCKETS; ++i)
+    {
+        seen += histogram->buckets[i];
+        if (seen >= rank)
+        {
+            value = histogram->origin + histogram->width * i;
+            break;
+        }
+    }
+    if (value < histogram->min)
+    {
+        value = histogram->min;
+    }
+    if (value > histogram->max)
+    {
+        value = histogram->max;
+    }
+    return value;
+}
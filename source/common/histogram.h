@@ -0,0 +1,37 @@
+//
+// Created by jan on 19.10.2026.
+//
+
+#ifndef RMOD_HISTOGRAM_H
+#define RMOD_HISTOGRAM_H
+#include "common.h"
+
+//  Number of buckets, so quantiles are known to within 1/512 of the range of values added
+#define RMOD_HISTOGRAM_BUCKETS 2048
+
+//  Histogram with buckets of equal width, which cover the range of values added so far. Width is a power of two and
+//  buckets start at a multiple of it, so when a value outside of them is added, pairs of buckets are merged until they
+//  cover it. Histograms of different workers are merged by bringing them to the same buckets and adding their counts.
+typedef struct rmod_histogram_struct rmod_histogram;
+struct rmod_histogram_struct
+{
+    u64 count;
+    f64 min;
+    f64 max;
+    f64 origin;                                 //  Lower edge of the first bucket
+    f64 width;                                  //  Width of buckets, zero while all values added were equal to min
+    u32 buckets[RMOD_HISTOGRAM_BUCKETS];
+};
+
+void rmod_histogram_clear(rmod_histogram* histogram);
+
+void rmod_histogram_add(rmod_histogram* histogram, f64 value);
+
+void rmod_histogram_merge(rmod_histogram* histogram, const rmod_histogram* other);
+
+//  Finds the value below which the fraction q of values lies. It is the lower edge of the bucket which contains it,
+//  which is exact for integer values when the range is below the number of buckets, but is never outside the range of
+//  values added. Returns NAN if the histogram is empty.
+f64 rmod_histogram_quantile(const rmod_histogram* histogram, f64 q);
+
+#endif //RMOD_HISTOGRAM_H
@@ -0,0 +1,136 @@
+//
+// Created by jan on 19.10.2026.
+//
+#include "histogram.h"
+#include <math.h>
+
+//  Checks quantiles of distributions, which are known exactly, split between histograms which are then merged
+
+#define ASSERT(x) if ((x) == false) {fprintf(stderr, "Failed assertion: \"" #x "\"\n"); __builtin_trap(); exit(EXIT_FAILURE);} (void)0
+#define N_PARTS 4
+#define N_VALUES 100000
+
+static rmod_histogram parts[N_PARTS];
+
+static u64 bucket_sum(const rmod_histogram* histogram)
+{
+    u64 sum = 0;
+    for (u32 i = 0; i < RMOD_HISTOGRAM_BUCKETS; ++i)
+    {
+        sum += histogram->buckets[i];
+    }
+    return sum;
+}
+
+//  Values are given to parts in a scattered order, so each of them grows its buckets differently
+static rmod_histogram* merged_parts(void)
+{
+    for (u32 i = 1; i < N_PARTS; ++i)
+    {
+        rmod_histogram_merge(parts, parts + i);
+    }
+    ASSERT(bucket_sum(parts) == parts->count);
+    return parts;
+}
+
+static void clear_parts(void)
+{
+    for (u32 i = 0; i < N_PARTS; ++i)
+    {
+        rmod_histogram_clear(parts + i);
+    }
+}
+
+//  Integers from 0 to 999, for which quantiles must be exact
+static void check_integers(void)
+{
+    clear_parts();
+    for (u32 i = 0; i < 1000; ++i)
+    {
+        const u32 v = (i * 383) % 1000;
+        rmod_histogram_add(parts + i % N_PARTS, (f64)v);
+    }
+    const rmod_histogram* const h = merged_parts();
+    ASSERT(h->count == 1000);
+    ASSERT(h->min == 0.0 && h->max == 999.0);
+    ASSERT(rmod_histogram_quantile(h, 0.05) == 49.0);
+    ASSERT(rmod_histogram_quantile(h, 0.5) == 499.0);
+    ASSERT(rmod_histogram_quantile(h, 0.95) == 949.0);
+    ASSERT(rmod_histogram_quantile(h, 0.0) == 0.0);
+    ASSERT(rmod_histogram_quantile(h, 1.0) == 999.0);
+}
+
+//  Uniform distribution in a narrow band far from zero, which is how mean flow of a reliable system looks
+static void check_narrow_band(void)
+{
+    const f64 lo = 13.1974, hi = 13.1982;
+    clear_parts();
+    for (u32 i = 0; i < N_VALUES; ++i)
+    {
+        const u32 j = (u32)(((u64)i * 7919) % N_VALUES);
+        rmod_histogram_add(parts + i % N_PARTS, lo + (hi - lo) * ((f64)j + 0.5) / N_VALUES);
+    }
+    const rmod_histogram* const h = merged_parts();
+    const f64 tolerance = (hi - lo) / (RMOD_HISTOGRAM_BUCKETS / 4);
+    const f64 q[3] = {0.05, 0.5, 0.95};
+    for (u32 i = 0; i < 3; ++i)
+    {
+        ASSERT(fabs(rmod_histogram_quantile(h, q[i]) - (lo + (hi - lo) * q[i])) < tolerance);
+    }
+    ASSERT(rmod_histogram_quantile(h, 0.05) < rmod_histogram_quantile(h, 0.5));
+    ASSERT(rmod_histogram_quantile(h, 0.5) < rmod_histogram_quantile(h, 0.95));
+}
+
+//  Exponential distribution sampled at its quantiles, with an outlier at the end which makes the buckets wider
+static void check_exponential(void)
+{
+    clear_parts();
+    for (u32 i = 0; i < N_VALUES; ++i)
+    {
+        rmod_histogram_add(parts + (i * 3) % N_PARTS, -log(1.0 - ((f64)i + 0.5) / N_VALUES));
+    }
+    rmod_histogram_add(parts + 1, -100.0);
+    const rmod_histogram* const h = merged_parts();
+    ASSERT(h->count == N_VALUES + 1);
+    ASSERT(h->min == -100.0);
+    const f64 tolerance = (h->max - h->min) / (RMOD_HISTOGRAM_BUCKETS / 4);
+    const f64 q[3] = {0.05, 0.5, 0.95};
+    for (u32 i = 0; i < 3; ++i)
+    {
+        ASSERT(fabs(rmod_histogram_quantile(h, q[i]) - -log(1.0 - q[i])) < tolerance);
+    }
+    ASSERT(rmod_histogram_quantile(h, 0.0) == -100.0);
+}
+
+static void check_degenerate(void)
+{
+    rmod_histogram h;
+    rmod_histogram_clear(&h);
+    ASSERT(isnan(rmod_histogram_quantile(&h, 0.5)));
+    rmod_histogram_add(&h, 2.5);
+    rmod_histogram_add(&h, 2.5);
+    ASSERT(rmod_histogram_quantile(&h, 0.05) == 2.5);
+    ASSERT(rmod_histogram_quantile(&h, 0.95) == 2.5);
+
+    //  Merging into an empty histogram and one with a single distinct value
+    rmod_histogram other;
+    rmod_histogram_clear(&other);
+    rmod_histogram_merge(&other, &h);
+    ASSERT(other.count == 2 && rmod_histogram_quantile(&other, 0.5) == 2.5);
+    rmod_histogram_clear(&h);
+    rmod_histogram_add(&h, -1.0);
+    rmod_histogram_merge(&other, &h);
+    ASSERT(other.count == 3 && bucket_sum(&other) == 3);
+    ASSERT(rmod_histogram_quantile(&other, 0.3) == -1.0);
+    ASSERT(rmod_histogram_quantile(&other, 0.5) == 2.5);
+}
+
+int main()
+{
+    check_integers();
+    check_narrow_band();
+    check_exponential();
+    check_degenerate();
+    printf("Histogram quantiles matched the distributions\n");
+    return 0;
+}
@@ -0,0 +1,158 @@
+//
+// Created by jan on 19.10.2026.
+//
+
+#include "parallel.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+
+typedef struct parallel_state_struct parallel_state;
+struct parallel_state_struct
+{
+    rmod_parallel_task_fn task_fn;
+    void* param;
+    const char* name;
+    u32 task_count;
+    atomic_uint next_task;
+    atomic_int first_error;
+};
+
+//  Message reported by a worker thread, which is reported again by the calling thread once the worker is done, since
+//  only the calling thread's messages reach its error hook
+typedef struct forwarded_message_struct forwarded_message;
+struct forwarded_message_struct
+{
+    forwarded_message* next;
+    rmod_error_level level;
+    u32 line;
+    const char* file;
+    const char* function;
+    char message[];
+};
+
+typedef struct parallel_worker_struct parallel_worker;
+struct parallel_worker_struct
+{
+    parallel_state* state;
+    u32 worker_idx;
+    forwarded_message* messages;        //  Oldest message first
+};
+
+static void parallel_work(parallel_state* const state, const u32 worker_idx)
+{
+    for (;;)
+    {
+        if (atomic_load(&state->first_error) != RMOD_RESULT_SUCCESS)
+        {
+            break;
+        }
+        const u32 task_idx = atomic_fetch_add(&state->next_task, 1);
+        if (task_idx >= state->task_count)
+        {
+            break;
+        }
+        const rmod_result res = state->task_fn(state->param, worker_idx, task_idx);
+        if (res != RMOD_RESULT_SUCCESS)
+        {
+            RMOD_ERROR("Task %u of \"%s\" failed, reason: %s", task_idx, state->name, rmod_result_str(res));
+            int expected = RMOD_RESULT_SUCCESS;
+            atomic_compare_exchange_strong(&state->first_error, &expected, (int)res);
+            break;
+        }
+    }
+}
+
+static i32 forward_message(
+        u32 total_count, u32 index, rmod_error_level level, u32 line, const char* file, const char* function,
+        const char* message, void* param)
+{
+    (void)total_count;
+    (void)index;
+    parallel_worker* const worker = param;
+    const size_t len = strlen(message);
+    forwarded_message* const msg = malloc(sizeof(*msg) + len + 1);
+    if (!msg)
+    {
+        return -1;
+    }
+    *msg = (forwarded_message){.next = worker->messages, .level = level, .line = line, .file = file, .function = function};
+    memcpy(msg->message, message, len + 1);
+    //  Messages are processed from the newest one, so prepending them leaves the oldest one first
+    worker->messages = msg;
+    return 0;
+}
+
+static void* parallel_worker_wrapper(void* param)
+{
+    parallel_worker* const worker = param;
+    char thrd_name[32];
+    snprintf(thrd_name, sizeof(thrd_name), "rmod-%s-%02u", worker->state->name, worker->worker_idx);
+    rmod_error_init_thread(thrd_name,
+#ifndef NDEBUG
+                           RMOD_ERROR_LEVEL_NONE,
+#else
+                           RMOD_ERROR_LEVEL_WARN,
+#endif
+                           4, 16);
+    RMOD_ENTER_FUNCTION;
+    parallel_work(worker->state, worker->worker_idx);
+    RMOD_LEAVE_FUNCTION;
+    rmod_error_process(forward_message, worker);
+    rmod_error_cleanup_thread();
+    return NULL;
+}
+
+rmod_result rmod_parallel_run(u32 thread_count, u32 task_count, rmod_parallel_task_fn task_fn, void* param, const char* name)
+{
+    RMOD_ENTER_FUNCTION;
+    parallel_state state =
+            {
+            .task_fn = task_fn,
+            .param = param,
+            .name = name,
+            .task_count = task_count,
+            };
+    atomic_init(&state.next_task, 0);
+    atomic_init(&state.first_error, RMOD_RESULT_SUCCESS);
+    if (thread_count > task_count)
+    {
+        thread_count = task_count;
+    }
+    if (thread_count < 2)
+    {
+        parallel_work(&state, 0);
+        RMOD_LEAVE_FUNCTION;
+        return (rmod_result)atomic_load(&state.first_error);
+    }
+
+    //  Thread count is bounded by the configuration, so this stays small
+    pthread_t thread_ids[thread_count - 1];
+    parallel_worker workers[thread_count - 1];
+    u32 threads_created;
+    for (threads_created = 0; threads_created < thread_count - 1; ++threads_created)
+    {
+        workers[threads_created] = (parallel_worker){.state = &state, .worker_idx = threads_created + 1, .messages = NULL};
+        const int create_result = pthread_create(thread_ids + threads_created, NULL, parallel_worker_wrapper, workers + threads_created);
+        if (create_result != 0)
+        {
+            //  Remaining work will be done by the threads which were created
+            RMOD_WARN("Failed creating worker thread number %u, reason: %s", threads_created + 1, strerror(create_result));
+            break;
+        }
+    }
+    parallel_work(&state, 0);
+    for (u32 i = 0; i < threads_created; ++i)
+    {
+        pthread_join(thread_ids[i], NULL);
+        for (forwarded_message* msg = workers[i].messages, *next; msg; msg = next)
+        {
+            next = msg->next;
+            rmod_error_push(msg->level, msg->line, msg->file, msg->function, "%s", msg->message);
+            free(msg);
+        }
+    }
+
+    RMOD_LEAVE_FUNCTION;
+    return (rmod_result)atomic_load(&state.first_error);
+}
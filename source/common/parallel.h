@@ -0,0 +1,19 @@
+//
+// Created by jan on 19.10.2026.
+//
+
+#ifndef RMOD_PARALLEL_H
+#define RMOD_PARALLEL_H
+#include "rmod.h"
+
+//  Task function called for each task index. Worker index is in range [0, thread_count) and is the same for all tasks
+//  which are executed by the same thread, so it can be used to pick per-thread resources. Calling thread is always
+//  worker 0. Since the global allocators are not thread-safe, tasks must not use them.
+typedef rmod_result (*rmod_parallel_task_fn)(void* param, u32 worker_idx, u32 task_idx);
+
+//  Runs task_count tasks on up to thread_count threads, including the calling thread. Once any task fails, no new
+//  tasks are started and the result of the first failed task is returned. Errors and warnings reported by other threads are reported
+//  again by the calling thread once they are done.
+rmod_result rmod_parallel_run(u32 thread_count, u32 task_count, rmod_parallel_task_fn task_fn, void* param, const char* name);
+
+#endif //RMOD_PARALLEL_H
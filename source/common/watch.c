@@ -0,0 +1,250 @@
+//
+// Created by jan on 19.10.2026.
+//
+
+#include "watch.h"
+
+#ifndef _WIN32
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <poll.h>
+#include <signal.h>
+#include <unistd.h>
+
+static volatile sig_atomic_t INTERRUPTED = 0;
+static struct sigaction OLD_SIGINT_ACTION;
+
+static void on_interrupt(int signal)
+{
+    (void)signal;
+    INTERRUPTED = 1;
+}
+
+rmod_result rmod_watch_create(u32 file_count, const rmod_memory_file* files, rmod_watch* p_watch)
+{
+    RMOD_ENTER_FUNCTION;
+    rmod_result res;
+    rmod_watch this = {.fd = -1, .file_count = 0};
+    this.files = jalloc(sizeof(*this.files) * file_count);
+    if (!this.files)
+    {
+        RMOD_ERROR("Failed jalloc(%zu)", sizeof(*this.files) * file_count);
+        res = RMOD_RESULT_NOMEM;
+        goto failed;
+    }
+    this.fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (this.fd < 0)
+    {
+        RMOD_ERROR("Could not create inotify instance, reason: %s", RMOD_ERRNO_MESSAGE);
+        res = RMOD_RESULT_ERROR;
+        goto failed;
+    }
+    for (u32 i = 0; i < file_count; ++i)
+    {
+        rmod_watched_file* const file = this.files + i;
+        const u64 len = strlen(files[i].name);
+        file->path = jalloc(len + 1);
+        if (!file->path)
+        {
+            RMOD_ERROR("Failed jalloc(%zu)", len + 1);
+            res = RMOD_RESULT_NOMEM;
+            goto failed;
+        }
+        memcpy(file->path, files[i].name, len + 1);
+        this.file_count += 1;
+        struct stat file_stats;
+        if (stat(file->path, &file_stats) < 0)
+        {
+            RMOD_ERROR("Could not retrieve stats for file \"%s\", reason: %s", file->path, RMOD_ERRNO_MESSAGE);
+            res = RMOD_RESULT_BAD_PATH;
+            goto failed;
+        }
+        file->device = file_stats.st_dev;
+        file->inode = file_stats.st_ino;
+        file->changed = false;
+        file->replaced = false;
+        //  Paths of model files are real paths, so they always have a directory
+        char* const separator = strrchr(file->path, '/');
+        assert(separator);
+        file->base_name = separator + 1;
+        *separator = 0;
+        file->wd = inotify_add_watch(this.fd, separator == file->path ? "/" : file->path, IN_CLOSE_WRITE | IN_MOVED_TO);
+        *separator = '/';
+        if (file->wd < 0)
+        {
+            RMOD_ERROR("Could not watch directory of file \"%s\", reason: %s", file->path, RMOD_ERRNO_MESSAGE);
+            res = RMOD_RESULT_BAD_PATH;
+            goto failed;
+        }
+    }
+
+    //  SA_RESTART is not given, so that poll is interrupted by the signal
+    INTERRUPTED = 0;
+    struct sigaction action = {.sa_handler = on_interrupt};
+    sigemptyset(&action.sa_mask);
+    if (sigaction(SIGINT, &action, &OLD_SIGINT_ACTION) < 0)
+    {
+        RMOD_ERROR("Could not set handler of SIGINT, reason: %s", RMOD_ERRNO_MESSAGE);
+        res = RMOD_RESULT_ERROR;
+        goto failed;
+    }
+
+    *p_watch = this;
+    RMOD_LEAVE_FUNCTION;
+    return RMOD_RESULT_SUCCESS;
+
+failed:
+    for (u32 i = 0; i < this.file_count; ++i)
+    {
+        jfree(this.files[i].path);
+    }
+    jfree(this.files);
+    if (this.fd >= 0)
+    {
+        close(this.fd);
+    }
+    RMOD_LEAVE_FUNCTION;
+    return res;
+}
+
+//  Reads all events which are queued and marks the files they are about, returning the number of files marked by them
+static rmod_result read_events(rmod_watch* const this, u32* const p_marked)
+{
+    RMOD_ENTER_FUNCTION;
+    rmod_result res = RMOD_RESULT_SUCCESS;
+    u32 marked = 0;
+    _Alignas(struct inotify_event) char buffer[4096];
+    for (;;)
+    {
+        const ssize_t len = read(this->fd, buffer, sizeof(buffer));
+        if (len < 0)
+        {
+            if (errno != EAGAIN && errno != EINTR)
+            {
+                RMOD_ERROR("Could not read inotify events, reason: %s", RMOD_ERRNO_MESSAGE);
+                res = RMOD_RESULT_ERROR;
+            }
+            break;
+        }
+        for (const char* ptr = buffer; ptr < buffer + len;)
+        {
+            const struct inotify_event* const event = (const struct inotify_event*)ptr;
+            ptr += sizeof(*event) + event->len;
+            if (!event->len)
+            {
+                continue;
+            }
+            for (u32 i = 0; i < this->file_count; ++i)
+            {
+                rmod_watched_file* const file = this->files + i;
+                if (file->wd == event->wd && strcmp(file->base_name, event->name) == 0)
+                {
+                    marked += !file->changed;
+                    file->changed = true;
+                }
+            }
+        }
+    }
+    *p_marked = marked;
+    RMOD_LEAVE_FUNCTION;
+    return res;
+}
+
+rmod_result rmod_watch_wait(rmod_watch* watch, bool* p_interrupted)
+{
+    RMOD_ENTER_FUNCTION;
+    rmod_watch* const this = watch;
+    rmod_result res = RMOD_RESULT_SUCCESS;
+    for (u32 i = 0; i < this->file_count; ++i)
+    {
+        this->files[i].changed = false;
+    }
+    struct pollfd poll_fd = {.fd = this->fd, .events = POLLIN};
+    u32 changed_count = 0;
+    //  Until something changes the wait is not limited, then it is only as long as the debounce interval
+    while (!INTERRUPTED)
+    {
+        const int r = poll(&poll_fd, 1, changed_count ? RMOD_WATCH_DEBOUNCE_MS : -1);
+        if (r < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            RMOD_ERROR("Could not poll inotify instance, reason: %s", RMOD_ERRNO_MESSAGE);
+            res = RMOD_RESULT_ERROR;
+            goto end;
+        }
+        if (r == 0)
+        {
+            break;
+        }
+        u32 marked;
+        if ((res = read_events(this, &marked)) != RMOD_RESULT_SUCCESS)
+        {
+            goto end;
+        }
+        changed_count += marked;
+    }
+
+    for (u32 i = 0; i < this->file_count; ++i)
+    {
+        rmod_watched_file* const file = this->files + i;
+        if (INTERRUPTED)
+        {
+            file->changed = false;
+        }
+        if (!file->changed)
+        {
+            continue;
+        }
+        //  File which can not be found at all is not the one which was watched
+        struct stat file_stats;
+        file->replaced = stat(file->path, &file_stats) < 0 || (u64)file_stats.st_dev != file->device || (u64)file_stats.st_ino != file->inode;
+    }
+end:
+    *p_interrupted = INTERRUPTED != 0;
+    RMOD_LEAVE_FUNCTION;
+    return res;
+}
+
+void rmod_watch_destroy(rmod_watch* watch)
+{
+    RMOD_ENTER_FUNCTION;
+    sigaction(SIGINT, &OLD_SIGINT_ACTION, NULL);
+    for (u32 i = 0; i < watch->file_count; ++i)
+    {
+        jfree(watch->files[i].path);
+    }
+    jfree(watch->files);
+    close(watch->fd);
+    memset(watch, 0, sizeof(*watch));
+    RMOD_LEAVE_FUNCTION;
+}
+
+#else
+
+rmod_result rmod_watch_create(u32 file_count, const rmod_memory_file* files, rmod_watch* p_watch)
+{
+    RMOD_ENTER_FUNCTION;
+    (void)file_count;
+    (void)files;
+    (void)p_watch;
+    RMOD_ERROR("Watching files for changes is not supported on Windows");
+    RMOD_LEAVE_FUNCTION;
+    return RMOD_RESULT_ERROR;
+}
+
+rmod_result rmod_watch_wait(rmod_watch* watch, bool* p_interrupted)
+{
+    (void)watch;
+    *p_interrupted = true;
+    return RMOD_RESULT_ERROR;
+}
+
+void rmod_watch_destroy(rmod_watch* watch)
+{
+    (void)watch;
+}
+
+#endif
@@ -0,0 +1,43 @@
+//
+// Created by jan on 19.10.2026.
+//
+
+#ifndef RMOD_WATCH_H
+#define RMOD_WATCH_H
+#include "rmod.h"
+
+typedef struct rmod_watched_file_struct rmod_watched_file;
+struct rmod_watched_file_struct
+{
+    char* path;
+    const char* base_name;              //  Part of the path after the directory
+    int wd;                             //  Watch of the directory which contains the file
+    u64 device;                         //  Device and inode of the file when the watch was created
+    u64 inode;
+    bool changed;                       //  Set by rmod_watch_wait
+    bool replaced;                      //  File at the path is no longer the one it was when the watch was created
+};
+
+typedef struct rmod_watch_struct rmod_watch;
+struct rmod_watch_struct
+{
+    int fd;
+    u32 file_count;
+    rmod_watched_file* files;
+};
+
+//  Starts watching the files for changes. Directories which contain them are watched instead of the files themselves,
+//  so that files which are replaced by renaming another file over them, as most editors do, are still noticed. SIGINT
+//  is caught until the watch is destroyed, so that waiting can be interrupted.
+rmod_result rmod_watch_create(u32 file_count, const rmod_memory_file* files, rmod_watch* p_watch);
+
+//  Blocks until at least one of the files is written or replaced, then waits until there were no more changes for
+//  RMOD_WATCH_DEBOUNCE_MS, so that a file saved in several steps is only reported once. Files which changed are marked
+//  as such. If SIGINT was received before or while waiting, p_interrupted is set to true and no files are marked.
+rmod_result rmod_watch_wait(rmod_watch* watch, bool* p_interrupted);
+
+void rmod_watch_destroy(rmod_watch* watch);
+
+#define RMOD_WATCH_DEBOUNCE_MS 200
+
+#endif //RMOD_WATCH_H
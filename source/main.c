@@ -14,6 +14,11 @@
 #include "fmt/sformatted.h"
 #include "simulation/postprocessing.h"
 #include "parsing/cli_parsing.h"
+#include "simulation/reduce.h"
+#include "simulation/hierarchy.h"
+#include "simulation/uncertainty.h"
+#include "simulation/graph_cache.h"
+#include "common/watch.h"
 
 static i32 error_hook(const char* thread_name, u32 stack_trace_count, const char*const* stack_trace, rmod_error_level level, u32 line, const char* file, const char* function, const char* message, void* param)
 {
@@ -48,6 +53,344 @@ static i32 error_hook(const char* thread_name, u32 stack_trace_count, const char
 # define PATH_MAX 4096
 #endif
 
+enum
+{
+    RMOD_ANALYSIS_BDD,
+    RMOD_ANALYSIS_CUT_SETS,
+    RMOD_ANALYSIS_CTMC,
+    RMOD_ANALYSIS_SENSITIVITY,
+    RMOD_ANALYSIS_UPGRADE,
+    RMOD_ANALYSIS_REMOVAL,
+    RMOD_ANALYSIS_COUNT,
+};
+
+static const char* const ANALYSIS_NAMES[RMOD_ANALYSIS_COUNT] =
+        {
+        [RMOD_ANALYSIS_BDD] = "bdd",
+        [RMOD_ANALYSIS_CUT_SETS] = "cuts",
+        [RMOD_ANALYSIS_CTMC] = "ctmc",
+        [RMOD_ANALYSIS_SENSITIVITY] = "sensitivity",
+        [RMOD_ANALYSIS_UPGRADE] = "upgrade",
+        [RMOD_ANALYSIS_REMOVAL] = "removal",
+        };
+
+enum
+{
+    RMOD_OPTIMIZATION_REDUCE,
+    RMOD_OPTIMIZATION_HIERARCHY,
+    RMOD_OPTIMIZATION_QMC,
+    RMOD_OPTIMIZATION_COUNT,
+};
+
+static const char* const OPTIMIZATION_NAMES[RMOD_OPTIMIZATION_COUNT] =
+        {
+        [RMOD_OPTIMIZATION_REDUCE] = "reduce",
+        [RMOD_OPTIMIZATION_HIERARCHY] = "hierarchy",
+        [RMOD_OPTIMIZATION_QMC] = "qmc",
+        };
+
+//  Largest number of components in a cut set which is still looked for
+#define CUT_SET_MAX_ORDER 4
+//  Number of phases of the Erlang distribution which approximates maintenance delay in the Markov chain, which is
+//  doubled until results change by less than the tolerance, unless the number of phases is given as an option
+#define CTMC_INITIAL_PHASE_COUNT 8
+#define CTMC_MAX_PHASE_COUNT 64
+#define CTMC_PHASE_TOLERANCE 1e-3
+//  Largest number of nodes which can be down at once in the Markov chain before the state is truncated
+#define CTMC_MAX_DOWN 4
+//  Largest number of values of each parameter of the sweep
+#define SWEEP_MAX_VALUES 64
+//  Largest number of horizons at which results are also reported
+#define HORIZON_MAX_COUNT 64
+
+//  Settings of the run which are used again each time watched model files change
+typedef struct watch_job_struct watch_job;
+struct watch_job_struct
+{
+    const char* program_filename;
+    const char* chain_name;
+    const char* out_file_name;              //  NULL if results are printed to the stdout
+    f64 sim_time;
+    f64 repair_limit;
+    u32 sim_reps;
+    u32 preview_reps;
+    u32 thread_count;
+    u32 optimization_flags;
+    rmod_sim_flags sim_flags;
+    u32 profile_bins;
+    u32 horizon_count;
+    const f32* horizons;
+    int argc;
+    const char** argv;
+};
+
+static rmod_result simulate_watched(
+        const watch_job* const job, const rmod_graph* const graph_sim, const u32 reps, const rmod_sim_flags flags,
+        const u32 profile_bins, const u32 horizon_count, rmod_sim_result* const p_results)
+{
+    if (job->thread_count < 2)
+    {
+        return rmod_simulate_graph(graph_sim, (f32) job->sim_time, reps, p_results, (f32) job->repair_limit, flags, profile_bins, horizon_count, job->horizons);
+    }
+    return rmod_simulate_graph_mt(graph_sim, (f32) job->sim_time, reps, p_results, job->thread_count, (f32) job->repair_limit, flags, profile_bins, horizon_count, job->horizons);
+}
+
+static void release_sim_results(rmod_sim_result* const results)
+{
+    jfree(results->failures_per_component);
+    jfree(results->downtime_per_component);
+    jfree(results->sensitivity_per_type);
+    jfree(results->profile);
+    jfree(results->horizons);
+    memset(results, 0, sizeof(*results));
+}
+
+//  Simulates the graph again, first with the preview number of replications, results of which are only summarized, and
+//  then with the full number, which are reported the same way as results of the first run
+static rmod_result simulate_changed_model(const watch_job* const job, const rmod_program* const program, const rmod_graph* const graph)
+{
+    RMOD_ENTER_FUNCTION;
+    rmod_result res;
+    rmod_graph graph_reduced = {0};
+    const rmod_graph* graph_sim = graph;
+    rmod_surrogate_report surrogate_report = {0};
+    rmod_sim_result results = {0};
+    string_stream* ss_out = NULL;
+    if (job->optimization_flags & (1 << RMOD_OPTIMIZATION_HIERARCHY))
+    {
+        if ((res = rmod_build_surrogate_graph(graph, job->sim_time, &surrogate_report, &graph_reduced)) != RMOD_RESULT_SUCCESS)
+        {
+            RMOD_ERROR("Failed replacing sub-chains of graph [%s - %s] with surrogates, reason: %s", graph->module_name, graph->graph_type, rmod_result_str(res));
+            goto end;
+        }
+        graph_sim = &graph_reduced;
+    }
+    else if (job->optimization_flags & (1 << RMOD_OPTIMIZATION_REDUCE))
+    {
+        if ((res = rmod_reduce_graph(graph, &graph_reduced)) != RMOD_RESULT_SUCCESS)
+        {
+            RMOD_ERROR("Failed reducing graph [%s - %s], reason: %s", graph->module_name, graph->graph_type, rmod_result_str(res));
+            goto end;
+        }
+        graph_sim = &graph_reduced;
+    }
+
+    //  Preview only needs the overview, so nothing else is found for it
+    res = simulate_watched(job, graph_sim, job->preview_reps, job->sim_flags & ~RMOD_SIM_FLAGS_SENSITIVITY, 0, 0, &results);
+    if (res != RMOD_RESULT_SUCCESS)
+    {
+        RMOD_ERROR("Failed simulating graph [%s - %s], reason: %s", graph->module_name, graph->graph_type, rmod_result_str(res));
+        goto end;
+    }
+    const f64 mean_flow = results.total_flow / (job->sim_time * (f64)results.sim_count);
+    printf("Preview from %"PRIu64" replications: mean flow %g (%.2f%% availability), mean maintenance visits %g, mean costs %g\n",
+           results.sim_count, mean_flow, mean_flow / results.max_flow * 100.0,
+           (f64)results.total_maintenance_visits / (f64)results.sim_count, (f64)results.total_costs / (f64)results.sim_count);
+    fflush(stdout);
+    release_sim_results(&results);
+
+    printf("Simulating graph built from chain \"%s\" containing %"PRIuFAST32" individual nodes with %u replications\n", graph->graph_type, graph_sim->node_count, job->sim_reps);
+    res = simulate_watched(job, graph_sim, job->sim_reps, job->sim_flags, job->profile_bins, job->horizon_count, &results);
+    if (res != RMOD_RESULT_SUCCESS)
+    {
+        RMOD_ERROR("Failed simulating graph [%s - %s], reason: %s", graph->module_name, graph->graph_type, rmod_result_str(res));
+        goto end;
+    }
+
+    if ((res = string_stream_create(G_JALLOCATOR, &ss_out)) != RMOD_RESULT_SUCCESS)
+    {
+        RMOD_ERROR("Failed creating output string stream, reason: %s", rmod_result_str(res));
+        goto end;
+    }
+    res = rmod_postprocess_results(&results, job->sim_time, job->repair_limit, graph, job->thread_count, program, job->argc, job->argv, ss_out);
+    if (res == RMOD_RESULT_SUCCESS && (job->optimization_flags & (1 << RMOD_OPTIMIZATION_HIERARCHY)))
+    {
+        res = rmod_postprocess_surrogate_report(&surrogate_report, graph, ss_out);
+    }
+    if (res == RMOD_RESULT_SUCCESS && results.sensitivity_per_type)
+    {
+        res = rmod_postprocess_sensitivity(&results, graph, ss_out);
+    }
+    if (res == RMOD_RESULT_SUCCESS && results.horizons)
+    {
+        res = rmod_postprocess_horizons(&results, job->sim_time, graph, ss_out);
+    }
+    if (res == RMOD_RESULT_SUCCESS && results.profile)
+    {
+        res = rmod_postprocess_profile(&results, job->sim_time, ss_out);
+    }
+    if (res != RMOD_RESULT_SUCCESS)
+    {
+        RMOD_ERROR("Could not postprocess simulation results, reason: %s", rmod_result_str(res));
+        goto end;
+    }
+
+    if (job->out_file_name)
+    {
+        printf("Saving simulation output to file \"%s\"\n", job->out_file_name);
+        FILE* f_out = fopen(job->out_file_name, "w");
+        if (!f_out)
+        {
+            RMOD_ERROR("Failed opening file \"%s\" to output results, reason: %s", job->out_file_name, RMOD_ERRNO_MESSAGE);
+            res = RMOD_RESULT_BAD_PATH;
+            goto end;
+        }
+        fprintf(f_out, "%s\n", string_stream_contents(ss_out));
+        if (ferror(f_out))
+        {
+            RMOD_ERROR("Error occurred while trying to write to file \"%s\", reason: %s", job->out_file_name, RMOD_ERRNO_MESSAGE);
+            res = RMOD_RESULT_ERROR;
+        }
+        fclose(f_out);
+    }
+    else
+    {
+        printf("%s", string_stream_contents(ss_out));
+    }
+
+end:
+    if (ss_out)
+    {
+        string_stream_cleanup(ss_out);
+    }
+    release_sim_results(&results);
+    rmod_surrogate_report_release(&surrogate_report);
+    if (graph_sim != graph)
+    {
+        rmod_destroy_graph(&graph_reduced);
+    }
+    RMOD_LEAVE_FUNCTION;
+    return res;
+}
+
+//  Waits for files of the model to change and simulates it again each time they do. When only values of parameters of
+//  blocks in files which were replaced changed, the program and the graph are patched with them. Otherwise, as well as
+//  when a file was written in place, which changes the memory the program's names point to, the program is created and
+//  compiled again. Returns once SIGINT is received.
+static void watch_model(const watch_job* const job, rmod_program* const program, rmod_graph* const graph)
+{
+    RMOD_ENTER_FUNCTION;
+    rmod_result res;
+    rmod_watch watch;
+    if ((res = rmod_watch_create(program->n_files, program->mem_files, &watch)) != RMOD_RESULT_SUCCESS)
+    {
+        RMOD_ERROR("Could not watch model files for changes, reason: %s", rmod_result_str(res));
+        RMOD_LEAVE_FUNCTION;
+        return;
+    }
+    //  Program which could not be created again is not changed, but it can not be patched until it is
+    bool stale = false;
+    for (;;)
+    {
+        printf("Watching %u model files for changes, interrupt to stop\n", watch.file_count);
+        fflush(stdout);
+        bool interrupted;
+        if ((res = rmod_watch_wait(&watch, &interrupted)) != RMOD_RESULT_SUCCESS)
+        {
+            RMOD_ERROR("Failed waiting for model files to change, reason: %s", rmod_result_str(res));
+            break;
+        }
+        if (interrupted)
+        {
+            break;
+        }
+
+        bool reload = stale;
+        bool failed = false;
+        u32 changed_count = 0;
+        u32* const changed_types = jalloc(sizeof(*changed_types) * program->n_types);
+        if (!changed_types)
+        {
+            RMOD_ERROR("Failed jalloc(%zu)", sizeof(*changed_types) * program->n_types);
+            break;
+        }
+        for (u32 i = 0; i < watch.file_count && !reload; ++i)
+        {
+            const rmod_watched_file* const file = watch.files + i;
+            if (!file->changed)
+            {
+                continue;
+            }
+            printf("Model file \"%s\" changed\n", file->path);
+            if (!file->replaced)
+            {
+                reload = true;
+                break;
+            }
+            bool same_structure;
+            u32 file_changed_count;
+            res = rmod_program_update_file(program, i, &same_structure, &file_changed_count, changed_types + changed_count);
+            if (res != RMOD_RESULT_SUCCESS)
+            {
+                RMOD_ERROR("Could not convert model file \"%s\" again, reason: %s", file->path, rmod_result_str(res));
+                failed = true;
+                continue;
+            }
+            reload = !same_structure;
+            changed_count += file_changed_count;
+        }
+        //  Graph is patched even if not everything could be converted, so that it always matches the program
+        for (u32 i = 0; i < changed_count && !reload; ++i)
+        {
+            rmod_graph_update_block(graph, &program->p_types[changed_types[i]].block);
+        }
+        jfree(changed_types);
+
+        if (reload)
+        {
+            printf("Creating simulation program from file \"%s\" again, since structure of the model changed\n", job->program_filename);
+            rmod_program new_program;
+            rmod_graph new_graph;
+            if ((res = rmod_program_create(job->program_filename, job->thread_count ? job->thread_count : 1, &new_program)) != RMOD_RESULT_SUCCESS)
+            {
+                RMOD_ERROR("Could not create program to simulate, reason: %s", rmod_result_str(res));
+                stale = true;
+                continue;
+            }
+            if ((res = rmod_compile(&new_program, &new_graph, job->chain_name, "main module", job->thread_count ? job->thread_count : 1)) != RMOD_RESULT_SUCCESS)
+            {
+                RMOD_ERROR("Failed compiling chain \"%s\", reason: %s", job->chain_name, rmod_result_str(res));
+                rmod_program_delete(&new_program);
+                stale = true;
+                continue;
+            }
+            rmod_destroy_graph(graph);
+            rmod_program_delete(program);
+            *program = new_program;
+            *graph = new_graph;
+            stale = false;
+            //  Files which are included may have changed as well
+            rmod_watch_destroy(&watch);
+            if ((res = rmod_watch_create(program->n_files, program->mem_files, &watch)) != RMOD_RESULT_SUCCESS)
+            {
+                RMOD_ERROR("Could not watch model files for changes, reason: %s", rmod_result_str(res));
+                RMOD_LEAVE_FUNCTION;
+                return;
+            }
+        }
+        else if (failed)
+        {
+            continue;
+        }
+        else if (!changed_count)
+        {
+            printf("No parameters of blocks changed, so results are the same as before\n");
+            continue;
+        }
+        else
+        {
+            printf("Patched parameters of %u block types\n", changed_count);
+        }
+
+        if ((res = simulate_changed_model(job, program, graph)) != RMOD_RESULT_SUCCESS)
+        {
+            RMOD_ERROR("Could not simulate changed model, reason: %s", rmod_result_str(res));
+        }
+    }
+    rmod_watch_destroy(&watch);
+    RMOD_LEAVE_FUNCTION;
+}
+
 int main(int argc, const char* argv[])
 {
     printf("RMOD  Copyright (C) 2023  Jan Roth\n"
@@ -80,7 +423,11 @@ int main(int argc, const char* argv[])
     rmod_error_set_hook(error_hook, NULL);
     rmod_result res;
     const char* arg_job_desc = NULL;
-    string_segment out_file_name_segment = {0, 0}, out_intermediate = { 0, 0};
+    string_segment out_file_name_segment = {0, 0}, out_intermediate = { 0, 0}, cache_dir = {0, 0};
+    uintmax_t watch_preview_reps = 0;
+    uintmax_t ctmc_phase_count = 0;
+    u32 analysis_flags = 0;
+    u32 optimization_flags = 0;
     //  Process arguments
     bool args_wrong = false;
     rmod_cli_config_entry cli_cfg_entries[] =
@@ -105,7 +452,57 @@ int main(int argc, const char* argv[])
                    },
                    .found = false,
                    .usage = "-I --intermediate <file>\toutput intermediate types with all substitutions present to <file>"
-            }
+            },
+            [2] = {
+                   .display_name = "analysis",
+                   .short_name = "a",
+                   .long_name = "analysis",
+                   .converter = {
+                           .c_flags = { .type = RMOD_CFG_VALUE_FLAGS, .n_flags = RMOD_ANALYSIS_COUNT, .flag_names = ANALYSIS_NAMES, .p_out = &analysis_flags },
+                   },
+                   .found = false,
+                   .usage = "-a --analysis <list>\tcomma separated list of additional analyses to perform: \"bdd\" (exact availability using the binary decision diagram of the graph), \"cuts\" (minimal cut sets and component importance), \"ctmc\" (exact solution of the Markov chain of the simulated process), \"sensitivity\" (derivatives of simulated flow and costs with respect to failure rate of each type), \"upgrade\" (ranking of components by the change when each is made perfect), \"removal\" (ranking of components by the change when each is removed)"
+            },
+            [3] = {
+                   .display_name = "optimization",
+                   .short_name = "O",
+                   .long_name = "optimize",
+                   .converter = {
+                           .c_flags = { .type = RMOD_CFG_VALUE_FLAGS, .n_flags = RMOD_OPTIMIZATION_COUNT, .flag_names = OPTIMIZATION_NAMES, .p_out = &optimization_flags },
+                   },
+                   .found = false,
+                   .usage = "-O --optimize <list>\tcomma separated list of optimizations of the graph to simulate: \"reduce\" (collapse series strings of nodes into single nodes), \"hierarchy\" (replace each sub-chain with a surrogate node characterized once per distinct sub-chain), \"qmc\" (draw first failure times and failed components of each replication from a scrambled Sobol sequence)"
+            },
+            [4] = {
+                   .display_name = "cache directory",
+                   .short_name = "C",
+                   .long_name = "cache",
+                   .converter = {
+                           .c_str = { .type = RMOD_CFG_VALUE_STR, .p_out = &cache_dir },
+                   },
+                   .found = false,
+                   .usage = "-C --cache <dir>\tkeep compiled chains in <dir> and reuse them while none of the files they were built from change"
+            },
+            [5] = {
+                   .display_name = "watch",
+                   .short_name = "w",
+                   .long_name = "watch",
+                   .converter = {
+                           .c_uint = { .type = RMOD_CFG_VALUE_UINT, .v_min = 1, .v_max = UINT32_MAX, .p_out = &watch_preview_reps },
+                   },
+                   .found = false,
+                   .usage = "-w --watch <reps>\tafter the run, keep watching the model files and simulate again whenever they change, first with <reps> replications as a quick preview and then with the full number"
+            },
+            [6] = {
+                   .display_name = "Markov chain phases",
+                   .short_name = "P",
+                   .long_name = "phases",
+                   .converter = {
+                           .c_uint = { .type = RMOD_CFG_VALUE_UINT, .v_min = 1, .v_max = UINT16_MAX - 1, .p_out = &ctmc_phase_count },
+                   },
+                   .found = false,
+                   .usage = "-P --phases <n>\tuse <n> Erlang phases for maintenance delay in the \"ctmc\" analysis, instead of doubling them from 8 until results change by less than 0.1%"
+            },
             };
     const u32 n_cli_cfg_entries = sizeof(cli_cfg_entries) / sizeof(*cli_cfg_entries);
     if (argc < 2)
@@ -141,13 +538,31 @@ int main(int argc, const char* argv[])
     string_segment segment_chain;
     uintmax_t thrd_count;
     f64 repair_limit;
+    u32 sweep_sim_time_count = 0, sweep_repair_limit_count = 0, sweep_mtbf_scale_count = 0;
+    f64 sweep_sim_time[SWEEP_MAX_VALUES], sweep_repair_limit[SWEEP_MAX_VALUES], sweep_mtbf_scale[SWEEP_MAX_VALUES];
+    const rmod_xml_config_entry sweep_children[] = {
+            {.name = "sim_time", .child_count = 0, .optional = true, .converter = {.c_real_list = {.type = RMOD_CFG_VALUE_REAL_LIST, .v_min = FLT_EPSILON, .v_max = INFINITY, .capacity = SWEEP_MAX_VALUES, .p_count = &sweep_sim_time_count, .p_out = sweep_sim_time}}},
+            {.name = "repair_limit", .child_count = 0, .optional = true, .converter = {.c_real_list = {.type = RMOD_CFG_VALUE_REAL_LIST, .v_min = 0.0, .v_max = INFINITY, .capacity = SWEEP_MAX_VALUES, .p_count = &sweep_repair_limit_count, .p_out = sweep_repair_limit}}},
+            {.name = "mtbf_scale", .child_count = 0, .optional = true, .converter = {.c_real_list = {.type = RMOD_CFG_VALUE_REAL_LIST, .v_min = FLT_EPSILON, .v_max = INFINITY, .capacity = SWEEP_MAX_VALUES, .p_count = &sweep_mtbf_scale_count, .p_out = sweep_mtbf_scale}}},
+    };
+    uintmax_t uncertainty_samples = 0;
+    uintmax_t profile_bins = 0;
+    u32 horizon_count = 0;
+    f64 horizon_values[HORIZON_MAX_COUNT];
+    const rmod_xml_config_entry uncertainty_children[] = {
+            {.name = "samples", .child_count = 0, .converter = {.c_uint = {.type = RMOD_CFG_VALUE_UINT, .v_min = 1, .v_max = UINT32_MAX, .p_out = &uncertainty_samples}}},
+    };
     const rmod_xml_config_entry config_children[] =  {
             {.name = "sim_time", .child_count = 0, .converter = {.c_real = {.p_out = &sim_time, .v_max = INFINITY, .v_min = FLT_EPSILON, .type = RMOD_CFG_VALUE_REAL }}},
             {.name = "sim_reps", .child_count = 0, .converter = {.c_uint = {.p_out = &sim_reps, .v_min = 1, .v_max = UINTMAX_MAX, .type = RMOD_CFG_VALUE_UINT}}},
             {.name = "filename", .child_count = 0, .converter = {.c_str = {.type = RMOD_CFG_VALUE_STR, .p_out = &segment_filename}}},
             {.name = "chain", .child_count = 0, .converter = {.c_str = {.type = RMOD_CFG_VALUE_STR, .p_out = &segment_chain}}},
             {.name = "threads", .child_count = 0, .converter = {.c_uint = {.type = RMOD_CFG_VALUE_UINT, .v_min = 0, .v_max = 256, .p_out = &thrd_count}}},
-            {.name = "repair_limit", .child_count = 0, .converter = {.c_real = {.type = RMOD_CFG_VALUE_REAL, .v_min = 0.0, .v_max = INFINITY, .p_out = &repair_limit}}}
+            {.name = "repair_limit", .child_count = 0, .converter = {.c_real = {.type = RMOD_CFG_VALUE_REAL, .v_min = 0.0, .v_max = INFINITY, .p_out = &repair_limit}}},
+            {.name = "sweep", .child_count = sizeof(sweep_children) / sizeof(*sweep_children), .child_array = sweep_children, .optional = true},
+            {.name = "uncertainty", .child_count = sizeof(uncertainty_children) / sizeof(*uncertainty_children), .child_array = uncertainty_children, .optional = true},
+            {.name = "horizons", .child_count = 0, .optional = true, .converter = {.c_real_list = {.type = RMOD_CFG_VALUE_REAL_LIST, .v_min = FLT_EPSILON, .v_max = INFINITY, .capacity = HORIZON_MAX_COUNT, .p_count = &horizon_count, .p_out = horizon_values}}},
+            {.name = "profile_bins", .child_count = 0, .optional = true, .converter = {.c_uint = {.type = RMOD_CFG_VALUE_UINT, .v_min = 1, .v_max = UINT32_MAX, .p_out = &profile_bins}}},
     };
     const rmod_xml_config_entry config_master =
             {
@@ -203,21 +618,48 @@ int main(int argc, const char* argv[])
 
 
     rmod_program program;
-    printf("Creating simulation program from file \"%s\"\n", program_filename);
-    res = rmod_program_create(program_filename, &program);
-    lin_jfree(G_LIN_JALLOCATOR, program_filename);
-    if (res != RMOD_RESULT_SUCCESS)
+    const bool use_cache = cache_dir.begin && cache_dir.len;
+    const bool watch = watch_preview_reps != 0;
+    bool cache_hit = false;
+    //  Program loaded from the cache does not know which files it was built from, so they could not be watched
+    if (use_cache && !watch)
+    {
+        res = rmod_graph_cache_load(cache_dir.begin, program_filename, chain_to_compile, &program, &cache_hit);
+        if (res != RMOD_RESULT_SUCCESS)
+        {
+            RMOD_WARN("Could not load chain \"%s\" from cache \"%s\", reason: %s", chain_to_compile, cache_dir.begin, rmod_result_str(res));
+            cache_hit = false;
+        }
+    }
+    if (cache_hit)
+    {
+        printf("Loaded compiled chain \"%s\" of file \"%s\" from cache \"%s\"\n", chain_to_compile, program_filename, cache_dir.begin);
+    }
+    else
     {
-        RMOD_ERROR_CRIT("Could not create program to simulate, reason: %s", rmod_result_str(res));
+        printf("Creating simulation program from file \"%s\"\n", program_filename);
+        res = rmod_program_create(program_filename, thrd_count ? (u32)thrd_count : 1, &program);
+        if (res != RMOD_RESULT_SUCCESS)
+        {
+            RMOD_ERROR_CRIT("Could not create program to simulate, reason: %s", rmod_result_str(res));
+        }
     }
     rmod_graph graph_a;
     printf("Compiling program chain \"%s\" to graph\n", chain_to_compile);
-    res = rmod_compile(&program, &graph_a, chain_to_compile, "main module");
+    res = rmod_compile(&program, &graph_a, chain_to_compile, "main module", thrd_count ? (u32)thrd_count : 1);
     if (res != RMOD_RESULT_SUCCESS)
     {
         RMOD_ERROR_CRIT("Failed compiling chain \"%s\", reason: %s", chain_to_compile, rmod_result_str(res));
     }
-    lin_jfree(G_LIN_JALLOCATOR, chain_to_compile);
+    if (use_cache && !cache_hit)
+    {
+        printf("Storing compiled chain \"%s\" in cache \"%s\"\n", chain_to_compile, cache_dir.begin);
+        res = rmod_graph_cache_store(cache_dir.begin, program_filename, chain_to_compile, &program);
+        if (res != RMOD_RESULT_SUCCESS)
+        {
+            RMOD_WARN("Could not store chain \"%s\" in cache \"%s\", reason: %s", chain_to_compile, cache_dir.begin, rmod_result_str(res));
+        }
+    }
 
     if (out_intermediate.begin && out_intermediate.len)
     {
@@ -254,11 +696,186 @@ int main(int argc, const char* argv[])
     }
 
 after_intermediate_out:;
+    //  Graph which is simulated, results of which are still reported for nodes of the original graph
+    rmod_graph graph_reduced = {0};
+    const rmod_graph* graph_sim = &graph_a;
+    rmod_surrogate_report surrogate_report = {0};
+    if ((optimization_flags & (1 << RMOD_OPTIMIZATION_HIERARCHY)) && (optimization_flags & (1 << RMOD_OPTIMIZATION_REDUCE)))
+    {
+        RMOD_WARN("Series reduction can not be combined with surrogate sub-chains, so only the latter are used");
+        optimization_flags &= ~(1 << RMOD_OPTIMIZATION_REDUCE);
+    }
+    if (optimization_flags & (1 << RMOD_OPTIMIZATION_HIERARCHY))
+    {
+        res = rmod_build_surrogate_graph(&graph_a, sim_time, &surrogate_report, &graph_reduced);
+        if (res != RMOD_RESULT_SUCCESS)
+        {
+            RMOD_ERROR_CRIT("Failed replacing sub-chains of graph [%s - %s] with surrogates, reason: %s", graph_a.module_name, graph_a.graph_type, rmod_result_str(res));
+        }
+        printf("Replaced %u sub-chains (%u distinct) of graph built from chain \"%s\" with surrogates, going from %"PRIuFAST32" to %"PRIuFAST32" nodes\n", surrogate_report.block_count, surrogate_report.characterized_count, graph_a.graph_type, graph_a.node_count, graph_reduced.node_count);
+        graph_sim = &graph_reduced;
+    }
+    if (optimization_flags & (1 << RMOD_OPTIMIZATION_REDUCE))
+    {
+        res = rmod_reduce_graph(&graph_a, &graph_reduced);
+        if (res != RMOD_RESULT_SUCCESS)
+        {
+            RMOD_ERROR_CRIT("Failed reducing graph [%s - %s], reason: %s", graph_a.module_name, graph_a.graph_type, rmod_result_str(res));
+        }
+        printf("Reduced graph built from chain \"%s\" from %"PRIuFAST32" to %"PRIuFAST32" nodes\n", graph_a.graph_type, graph_a.node_count, graph_reduced.node_count);
+        graph_sim = &graph_reduced;
+    }
+
+    rmod_exact_result exact_results = {0};
+    rmod_cut_sets cut_sets = {0};
+    rmod_ctmc_result ctmc_results = {0};
+    //  Importance measures need the structure function, so cut sets require the exact analysis as well
+    if (analysis_flags & (1 << RMOD_ANALYSIS_CUT_SETS))
+    {
+        analysis_flags |= (1 << RMOD_ANALYSIS_BDD);
+    }
+    if (analysis_flags & (1 << RMOD_ANALYSIS_BDD))
+    {
+        printf("Performing exact analysis of graph built from chain \"%s\"\n", graph_a.graph_type);
+        res = rmod_exact_analysis(&graph_a, sim_time, &exact_results);
+        if (res != RMOD_RESULT_SUCCESS)
+        {
+            RMOD_ERROR_CRIT("Failed exact analysis of graph [%s - %s], reason: %s", graph_a.module_name, graph_a.graph_type, rmod_result_str(res));
+        }
+    }
+    if (analysis_flags & (1 << RMOD_ANALYSIS_CUT_SETS))
+    {
+        printf("Finding minimal cut sets of graph built from chain \"%s\"\n", graph_a.graph_type);
+        res = rmod_find_minimal_cut_sets(&graph_a, CUT_SET_MAX_ORDER, thrd_count, &cut_sets);
+        if (res != RMOD_RESULT_SUCCESS)
+        {
+            RMOD_ERROR_CRIT("Failed finding minimal cut sets of graph [%s - %s], reason: %s", graph_a.module_name, graph_a.graph_type, rmod_result_str(res));
+        }
+        res = rmod_exact_importance(&graph_a, thrd_count, &exact_results);
+        if (res != RMOD_RESULT_SUCCESS)
+        {
+            RMOD_ERROR_CRIT("Failed computing component importance of graph [%s - %s], reason: %s", graph_a.module_name, graph_a.graph_type, rmod_result_str(res));
+        }
+    }
+
+    if (analysis_flags & (1 << RMOD_ANALYSIS_CTMC))
+    {
+        printf("Solving Markov chain of graph built from chain \"%s\" containing %"PRIuFAST32" individual nodes\n", graph_a.graph_type, graph_sim->node_count);
+        if (ctmc_phase_count)
+        {
+            res = rmod_ctmc_analysis(graph_sim, sim_time, repair_limit, (u32)ctmc_phase_count, CTMC_MAX_DOWN, &ctmc_results);
+        }
+        else
+        {
+            res = rmod_ctmc_analysis_adaptive(graph_sim, sim_time, repair_limit, CTMC_INITIAL_PHASE_COUNT, CTMC_MAX_PHASE_COUNT, CTMC_PHASE_TOLERANCE, CTMC_MAX_DOWN, &ctmc_results);
+        }
+        if (res != RMOD_RESULT_SUCCESS)
+        {
+            RMOD_ERROR_CRIT("Failed solving Markov chain of graph [%s - %s], reason: %s", graph_a.module_name, graph_a.graph_type, rmod_result_str(res));
+        }
+    }
+
     rmod_sim_result results = {0};
-    if (thrd_count < 2)
+    //  Parameters which are not swept keep the value given in the job description
+    const u32 sweep_point_count = (sweep_sim_time_count ? sweep_sim_time_count : 1) * (sweep_repair_limit_count ? sweep_repair_limit_count : 1) * (sweep_mtbf_scale_count ? sweep_mtbf_scale_count : 1);
+    const bool do_sweep = sweep_sim_time_count || sweep_repair_limit_count || sweep_mtbf_scale_count;
+    if (do_sweep && (analysis_flags & (1 << RMOD_ANALYSIS_SENSITIVITY)))
+    {
+        RMOD_WARN("Sensitivity is not found for points of a sweep");
+        analysis_flags &= ~(1 << RMOD_ANALYSIS_SENSITIVITY);
+    }
+    if (do_sweep && (analysis_flags & ((1 << RMOD_ANALYSIS_UPGRADE) | (1 << RMOD_ANALYSIS_REMOVAL))))
+    {
+        RMOD_WARN("What-if study of components is not performed for points of a sweep");
+        analysis_flags &= ~((1 << RMOD_ANALYSIS_UPGRADE) | (1 << RMOD_ANALYSIS_REMOVAL));
+    }
+    if (do_sweep && (optimization_flags & (1 << RMOD_OPTIMIZATION_QMC)))
+    {
+        RMOD_WARN("Quasi-random numbers are not used for points of a sweep");
+        optimization_flags &= ~(1 << RMOD_OPTIMIZATION_QMC);
+    }
+    if (do_sweep && profile_bins)
     {
-        printf("Simulating graph built from chain \"%s\" containing %"PRIuFAST32" individual nodes\n", graph_a.graph_type, graph_a.node_count);
-        res = rmod_simulate_graph(&graph_a, (f32) sim_time, (u32) sim_reps, &results, (f32) repair_limit);
+        RMOD_WARN("Flow profile is not found for points of a sweep");
+        profile_bins = 0;
+    }
+    if (do_sweep && horizon_count)
+    {
+        RMOD_WARN("Results at horizons are not found for points of a sweep");
+        horizon_count = 0;
+    }
+    //  Horizons are reported in increasing order, and the simulation duration is the last of them
+    f32 horizons[HORIZON_MAX_COUNT];
+    u32 horizons_used = 0;
+    for (u32 i = 0; i < horizon_count; ++i)
+    {
+        const f32 h = (f32)horizon_values[i];
+        if (h >= (f32)sim_time)
+        {
+            if (h > (f32)sim_time)
+            {
+                RMOD_WARN("Horizon %g is longer than simulation duration (%g), so it is ignored", horizon_values[i], sim_time);
+            }
+            continue;
+        }
+        u32 j = 0;
+        while (j < horizons_used && horizons[j] < h)
+        {
+            j += 1;
+        }
+        if (j < horizons_used && horizons[j] == h)
+        {
+            continue;
+        }
+        memmove(horizons + j + 1, horizons + j, sizeof(*horizons) * (horizons_used - j));
+        horizons[j] = h;
+        horizons_used += 1;
+    }
+    rmod_sim_flags sim_flags = RMOD_SIM_FLAGS_NONE;
+    if (analysis_flags & (1 << RMOD_ANALYSIS_SENSITIVITY))
+    {
+        sim_flags |= RMOD_SIM_FLAGS_SENSITIVITY;
+    }
+    if (optimization_flags & (1 << RMOD_OPTIMIZATION_QMC))
+    {
+        sim_flags |= RMOD_SIM_FLAGS_QMC;
+    }
+    rmod_sweep_point* sweep_points = NULL;
+    rmod_sim_result* sweep_results = NULL;
+    rmod_paired_difference* sweep_differences = NULL;
+    if (do_sweep)
+    {
+        sweep_points = jalloc(sizeof(*sweep_points) * sweep_point_count);
+        sweep_results = jalloc(sizeof(*sweep_results) * sweep_point_count);
+        sweep_differences = jalloc(sizeof(*sweep_differences) * sweep_point_count);
+        if (!sweep_points || !sweep_results || !sweep_differences)
+        {
+            RMOD_ERROR_CRIT("Failed allocating memory for %u points of the sweep, reason: %s", sweep_point_count, rmod_result_str(RMOD_RESULT_NOMEM));
+        }
+        for (u32 i = 0; i < sweep_point_count; ++i)
+        {
+            u32 idx = i;
+            rmod_sweep_point* const point = sweep_points + i;
+            point->simulation_duration = (f32)(sweep_sim_time_count ? sweep_sim_time[idx % sweep_sim_time_count] : sim_time);
+            idx /= sweep_sim_time_count ? sweep_sim_time_count : 1;
+            point->repair_limit = (f32)(sweep_repair_limit_count ? sweep_repair_limit[idx % sweep_repair_limit_count] : repair_limit);
+            idx /= sweep_repair_limit_count ? sweep_repair_limit_count : 1;
+            point->mtbf_scale = (f32)(sweep_mtbf_scale_count ? sweep_mtbf_scale[idx % sweep_mtbf_scale_count] : 1.0);
+            point->change = RMOD_SWEEP_CHANGE_NONE;
+            point->component = 0;
+            point->types = NULL;
+        }
+        printf("Simulating %u points of the sweep of graph built from chain \"%s\" containing %"PRIuFAST32" individual nodes using %u threads\n", sweep_point_count, graph_a.graph_type, graph_sim->node_count, thrd_count ? (u32)thrd_count : 1);
+        res = rmod_simulate_sweep(graph_sim, sweep_point_count, sweep_points, (u32) sim_reps, thrd_count, sweep_results, sweep_differences);
+        if (res != RMOD_RESULT_SUCCESS)
+        {
+            RMOD_ERROR_CRIT("Failed sweep of graph [%s - %s], reason: %s", graph_a.module_name, graph_a.graph_type, rmod_result_str(res));
+        }
+    }
+    else if (thrd_count < 2)
+    {
+        printf("Simulating graph built from chain \"%s\" containing %"PRIuFAST32" individual nodes\n", graph_a.graph_type, graph_sim->node_count);
+        res = rmod_simulate_graph(graph_sim, (f32) sim_time, (u32) sim_reps, &results, (f32) repair_limit, sim_flags, (u32) profile_bins, horizons_used, horizons);
         if (res != RMOD_RESULT_SUCCESS)
         {
             RMOD_ERROR_CRIT("Failed simulating graph [%s - %s], reason: %s", graph_a.module_name, graph_a.graph_type, rmod_result_str(res));
@@ -266,14 +883,80 @@ after_intermediate_out:;
     }
     else
     {
-        printf("Simulating graph built from chain \"%s\" containing %"PRIuFAST32" individual nodes using %u threads\n", graph_a.graph_type, graph_a.node_count, (u32)thrd_count);
-        res = rmod_simulate_graph_mt(&graph_a, (f32) sim_time, (u32) sim_reps, &results, thrd_count, (f32)repair_limit);
+        printf("Simulating graph built from chain \"%s\" containing %"PRIuFAST32" individual nodes using %u threads\n", graph_a.graph_type, graph_sim->node_count, (u32)thrd_count);
+        res = rmod_simulate_graph_mt(graph_sim, (f32) sim_time, (u32) sim_reps, &results, thrd_count, (f32)repair_limit, sim_flags, (u32) profile_bins, horizons_used, horizons);
         if (res != RMOD_RESULT_SUCCESS)
         {
             RMOD_ERROR_CRIT("Failed simulating graph [%s - %s], reason: %s", graph_a.module_name, graph_a.graph_type, rmod_result_str(res));
         }
     }
 
+    //  What-if study changes nodes of the original graph, so it does not use the reduced one. The first point is the
+    //  unchanged graph, which all others are compared to.
+    const bool do_upgrade = (analysis_flags & (1 << RMOD_ANALYSIS_UPGRADE)) != 0;
+    const bool do_removal = (analysis_flags & (1 << RMOD_ANALYSIS_REMOVAL)) != 0;
+    u32 what_if_count = 0;
+    rmod_sweep_point* what_if_points = NULL;
+    rmod_sim_result* what_if_results = NULL;
+    rmod_paired_difference* what_if_differences = NULL;
+    if (do_upgrade || do_removal)
+    {
+        const u32 max_count = 1 + (u32)graph_a.node_count * ((u32)do_upgrade + (u32)do_removal);
+        what_if_points = jalloc(sizeof(*what_if_points) * max_count);
+        what_if_results = jalloc(sizeof(*what_if_results) * max_count);
+        what_if_differences = jalloc(sizeof(*what_if_differences) * max_count);
+        if (!what_if_points || !what_if_results || !what_if_differences)
+        {
+            RMOD_ERROR_CRIT("Failed allocating memory for %u variants of the what-if study, reason: %s", max_count, rmod_result_str(RMOD_RESULT_NOMEM));
+        }
+        const rmod_sweep_point unchanged =
+                {
+                .simulation_duration = (f32)sim_time,
+                .repair_limit = (f32)repair_limit,
+                .mtbf_scale = 1.0f,
+                .change = RMOD_SWEEP_CHANGE_NONE,
+                .component = 0,
+                .types = NULL,
+                };
+        what_if_points[what_if_count++] = unchanged;
+        for (u32 i = 0; i < graph_a.node_count; ++i)
+        {
+            //  Components which never fail can not be improved
+            if (do_upgrade && graph_a.type_list[graph_a.node_list[i].type_id].failure_rate > 0.0f)
+            {
+                rmod_sweep_point* const point = what_if_points + what_if_count++;
+                *point = unchanged;
+                point->change = RMOD_SWEEP_CHANGE_PERFECT;
+                point->component = i;
+            }
+            if (do_removal)
+            {
+                rmod_sweep_point* const point = what_if_points + what_if_count++;
+                *point = unchanged;
+                point->change = RMOD_SWEEP_CHANGE_REMOVED;
+                point->component = i;
+            }
+        }
+        printf("Simulating %u variants of graph built from chain \"%s\" with a single component changed using %u threads\n", what_if_count - 1, graph_a.graph_type, thrd_count ? (u32)thrd_count : 1);
+        res = rmod_simulate_sweep(&graph_a, what_if_count, what_if_points, (u32) sim_reps, thrd_count, what_if_results, what_if_differences);
+        if (res != RMOD_RESULT_SUCCESS)
+        {
+            RMOD_ERROR_CRIT("Failed what-if study of graph [%s - %s], reason: %s", graph_a.module_name, graph_a.graph_type, rmod_result_str(res));
+        }
+    }
+
+    //  Parameters are sampled for types of the original graph, since surrogate types can not be recharacterized
+    rmod_uncertainty_result uncertainty_results = {0};
+    if (uncertainty_samples)
+    {
+        printf("Simulating %u samples of uncertain parameters of graph built from chain \"%s\" using %u threads\n", (u32)uncertainty_samples, graph_a.graph_type, thrd_count ? (u32)thrd_count : 1);
+        res = rmod_propagate_uncertainty(&graph_a, (f32) sim_time, (f32) repair_limit, (u32) uncertainty_samples, (u32) sim_reps, thrd_count, &uncertainty_results);
+        if (res != RMOD_RESULT_SUCCESS)
+        {
+            RMOD_ERROR_CRIT("Failed propagating uncertainty of parameters of graph [%s - %s], reason: %s", graph_a.module_name, graph_a.graph_type, rmod_result_str(res));
+        }
+    }
+
 #ifndef NDEBUG
     printf("Rng was called %"PRIu64" times\n", MSWS_TIMES_CALLED);
 #endif //NDEBUG
@@ -312,10 +995,93 @@ after_intermediate_out:;
         RMOD_ERROR_CRIT("Failed creating output string stream, reason: %s", rmod_result_str(RMOD_RESULT_NOMEM));
     }
 
-    res = rmod_postprocess_results(&results, sim_time, repair_limit, &graph_a, thrd_count, &program, argc, argv, ss_out);
-    if (res != RMOD_RESULT_SUCCESS)
+    if (do_sweep)
+    {
+        res = rmod_postprocess_sweep_results(sweep_point_count, sweep_points, sweep_results, sweep_differences, (const char*)graph_a.graph_type, ss_out);
+        if (res != RMOD_RESULT_SUCCESS)
+        {
+            RMOD_ERROR_CRIT("Could not postprocess sweep results, reason: %s", rmod_result_str(res));
+        }
+    }
+    else
+    {
+        res = rmod_postprocess_results(&results, sim_time, repair_limit, &graph_a, thrd_count, &program, argc, argv, ss_out);
+        if (res != RMOD_RESULT_SUCCESS)
+        {
+            RMOD_ERROR_CRIT("Could not postprocess simulation results, reason: %s", rmod_result_str(res));
+        }
+    }
+    if (optimization_flags & (1 << RMOD_OPTIMIZATION_HIERARCHY))
+    {
+        res = rmod_postprocess_surrogate_report(&surrogate_report, &graph_a, ss_out);
+        if (res != RMOD_RESULT_SUCCESS)
+        {
+            RMOD_ERROR_CRIT("Could not postprocess surrogate sub-chains, reason: %s", rmod_result_str(res));
+        }
+    }
+    if (analysis_flags & (1 << RMOD_ANALYSIS_BDD))
+    {
+        res = rmod_postprocess_exact_results(&exact_results, &results, sim_time, &graph_a, ss_out);
+        if (res != RMOD_RESULT_SUCCESS)
+        {
+            RMOD_ERROR_CRIT("Could not postprocess exact analysis results, reason: %s", rmod_result_str(res));
+        }
+    }
+    if (analysis_flags & (1 << RMOD_ANALYSIS_CUT_SETS))
+    {
+        res = rmod_postprocess_cut_sets(&cut_sets, &exact_results, &graph_a, ss_out);
+        if (res != RMOD_RESULT_SUCCESS)
+        {
+            RMOD_ERROR_CRIT("Could not postprocess minimal cut sets, reason: %s", rmod_result_str(res));
+        }
+    }
+    if (analysis_flags & (1 << RMOD_ANALYSIS_CTMC))
     {
-        RMOD_ERROR_CRIT("Could not postprocess simulation results, reason: %s", rmod_result_str(res));
+        res = rmod_postprocess_ctmc_results(&ctmc_results, &results, sim_time, ss_out);
+        if (res != RMOD_RESULT_SUCCESS)
+        {
+            RMOD_ERROR_CRIT("Could not postprocess Markov chain results, reason: %s", rmod_result_str(res));
+        }
+    }
+    if (uncertainty_samples)
+    {
+        res = rmod_postprocess_uncertainty(&uncertainty_results, &graph_a, ss_out);
+        if (res != RMOD_RESULT_SUCCESS)
+        {
+            RMOD_ERROR_CRIT("Could not postprocess uncertainty of parameters, reason: %s", rmod_result_str(res));
+        }
+    }
+    if (what_if_count)
+    {
+        res = rmod_postprocess_what_if(what_if_count, what_if_points, what_if_results, what_if_differences, &graph_a, ss_out);
+        if (res != RMOD_RESULT_SUCCESS)
+        {
+            RMOD_ERROR_CRIT("Could not postprocess what-if study, reason: %s", rmod_result_str(res));
+        }
+    }
+    if (results.sensitivity_per_type)
+    {
+        res = rmod_postprocess_sensitivity(&results, &graph_a, ss_out);
+        if (res != RMOD_RESULT_SUCCESS)
+        {
+            RMOD_ERROR_CRIT("Could not postprocess sensitivity results, reason: %s", rmod_result_str(res));
+        }
+    }
+    if (results.horizons)
+    {
+        res = rmod_postprocess_horizons(&results, sim_time, &graph_a, ss_out);
+        if (res != RMOD_RESULT_SUCCESS)
+        {
+            RMOD_ERROR_CRIT("Could not postprocess results at horizons, reason: %s", rmod_result_str(res));
+        }
+    }
+    if (results.profile)
+    {
+        res = rmod_postprocess_profile(&results, sim_time, ss_out);
+        if (res != RMOD_RESULT_SUCCESS)
+        {
+            RMOD_ERROR_CRIT("Could not postprocess results over time, reason: %s", rmod_result_str(res));
+        }
     }
 
     if (out_file_name_segment.len && out_file_name_segment.begin)
@@ -349,11 +1115,75 @@ after_intermediate_out:;
     string_stream_cleanup(ss_out);
     ss_out = NULL;
 
+    if (watch)
+    {
+        if (do_sweep || (analysis_flags & ~(1 << RMOD_ANALYSIS_SENSITIVITY)) || uncertainty_samples)
+        {
+            RMOD_WARN("Only the simulation itself is repeated when model files change, not sweeps or other analyses");
+        }
+        const watch_job job =
+                {
+                .program_filename = program_filename,
+                .chain_name = chain_to_compile,
+                .out_file_name = out_file_name_segment.len && out_file_name_segment.begin ? out_file_name_segment.begin : NULL,
+                .sim_time = sim_time,
+                .repair_limit = repair_limit,
+                .sim_reps = (u32) sim_reps,
+                .preview_reps = (u32) watch_preview_reps,
+                .thread_count = (u32) thrd_count,
+                .optimization_flags = optimization_flags,
+                .sim_flags = sim_flags,
+                .profile_bins = (u32) profile_bins,
+                .horizon_count = horizons_used,
+                .horizons = horizons,
+                .argc = argc,
+                .argv = argv,
+                };
+        //  Reduced graph is built again for each change, since it depends on parameters of the original one
+        if (graph_sim != &graph_a)
+        {
+            rmod_destroy_graph(&graph_reduced);
+            graph_sim = &graph_a;
+        }
+        watch_model(&job, &program, &graph_a);
+    }
+
     printf("Cleaning up\n");
     jfree(results.failures_per_component);
     jfree(results.downtime_per_component);
+    jfree(results.sensitivity_per_type);
+    jfree(results.profile);
+    jfree(results.horizons);
+    if (do_sweep)
+    {
+        for (u32 i = 0; i < sweep_point_count; ++i)
+        {
+            jfree(sweep_results[i].failures_per_component);
+            jfree(sweep_results[i].downtime_per_component);
+        }
+        jfree(sweep_differences);
+        jfree(sweep_results);
+        jfree(sweep_points);
+    }
+    for (u32 i = 0; i < what_if_count; ++i)
+    {
+        jfree(what_if_results[i].failures_per_component);
+        jfree(what_if_results[i].downtime_per_component);
+    }
+    jfree(what_if_differences);
+    jfree(what_if_results);
+    jfree(what_if_points);
+    rmod_cut_sets_release(&cut_sets);
+    rmod_exact_result_release(&exact_results);
+    rmod_surrogate_report_release(&surrogate_report);
+    if (graph_sim != &graph_a)
+    {
+        rmod_destroy_graph(&graph_reduced);
+    }
     rmod_destroy_graph(&graph_a);
     rmod_program_delete(&program);
+    lin_jfree(G_LIN_JALLOCATOR, program_filename);
+    lin_jfree(G_LIN_JALLOCATOR, chain_to_compile);
     int_fast32_t i_pool, i_chunk;
     if (jallocator_verify(G_JALLOCATOR, &i_pool, &i_chunk) != 0)
     {
@@ -361,7 +1191,7 @@ after_intermediate_out:;
     }
     uint_fast32_t forgotten_indices[128];
     uint_fast32_t r = jallocator_count_used_blocks(G_JALLOCATOR, 128, forgotten_indices);
-    assert(r != -1);
+    assert(r != (uint_fast32_t)-1);
     if (r > 0)
     {
         RMOD_ERROR("Forgot to jfree %"PRIuFAST32" allocations:\n", r);
@@ -376,7 +1206,7 @@ after_intermediate_out:;
         G_JALLOCATOR = NULL;
         uint_fast32_t blocks[128];
         uint_fast32_t count;
-        if ((count = jallocator_count_used_blocks(jallocator, 128, blocks)) != 0 && count != -1)
+        if ((count = jallocator_count_used_blocks(jallocator, 128, blocks)) != 0 && count != (uint_fast32_t)-1)
         {
             printf("Blocks which were not freed by jfree:\n");
             for (u32 i = 0; i < count; ++i)
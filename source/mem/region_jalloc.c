@@ -0,0 +1,176 @@
+//
+// Created by jan on 19.10.2026.
+//
+
+#include "region_jalloc.h"
+#include <string.h>
+#include <malloc.h>
+
+typedef struct region_struct region;
+struct region_struct
+{
+    region* next;
+    uint_fast64_t size;                 //  Bytes of memory after the header
+};
+
+//  Memory of a region follows its header, which is padded so that the memory stays aligned
+#define REGION_HEADER_SIZE ((sizeof(region) + 15) & ~(uint_fast64_t)15)
+
+struct region_jallocator_struct
+{
+    uint_fast64_t region_size;
+    uint_fast64_t total_size;
+    region* first;
+    region* current;
+    region* absorbed;                   //  Regions taken over from other allocators, which are never reused
+    void* current_top;                  //  First free byte of the current region
+    void* current_max;
+    void* last;                         //  Last allocation, which can be resized in place
+};
+
+region_jallocator* region_jallocator_create(uint_fast64_t region_size)
+{
+    region_jallocator* this = malloc(sizeof(*this));
+    if (!this) return this;
+    *this = (region_jallocator){.region_size = region_size};
+    return this;
+}
+
+static void begin_region(region_jallocator* this, region* r)
+{
+    this->current = r;
+    this->current_top = (void*)r + REGION_HEADER_SIZE;
+    this->current_max = this->current_top + r->size;
+}
+
+//  Moves to the region after the current one if it is large enough, otherwise a new one is put in front of it
+static int next_region(region_jallocator* this, uint_fast64_t size)
+{
+    region** const p_next = this->current ? &this->current->next : &this->first;
+    region* r = *p_next;
+    if (!r || r->size < size)
+    {
+        const uint_fast64_t region_size = size > this->region_size ? size : this->region_size;
+        r = malloc(REGION_HEADER_SIZE + region_size);
+        if (!r) return 0;
+        r->size = region_size;
+        r->next = *p_next;
+        *p_next = r;
+        this->total_size += region_size;
+    }
+    begin_region(this, r);
+    return 1;
+}
+
+void* region_jalloc(region_jallocator* allocator, uint_fast64_t size)
+{
+    if (size & 7)
+    {
+        size += (8 - (size & 7));
+    }
+    region_jallocator* this = allocator;
+    if (!this->current || this->current_top + size > this->current_max)
+    {
+        if (!next_region(this, size))
+        {
+            return NULL;
+        }
+    }
+    void* ret = this->current_top;
+    this->current_top += size;
+    this->last = ret;
+#ifndef NDEBUG
+    memset(ret, 0xCC, size);
+#endif
+    return ret;
+}
+
+void* region_jrealloc(region_jallocator* allocator, void* ptr, uint_fast64_t old_size, uint_fast64_t new_size)
+{
+    if (!ptr) return region_jalloc(allocator, new_size);
+    if (new_size & 7)
+    {
+        new_size += (8 - (new_size & 7));
+    }
+    region_jallocator* this = allocator;
+    if (ptr == this->last && ptr + new_size <= this->current_max)
+    {
+        //  Top of the region is moved to the new end of the last allocation
+#ifndef NDEBUG
+        if (ptr + new_size > this->current_top)
+        {
+            memset(this->current_top, 0xCC, ptr + new_size - this->current_top);
+        }
+#endif
+        this->current_top = ptr + new_size;
+        return ptr;
+    }
+    if (new_size <= old_size)
+    {
+        return ptr;
+    }
+    void* const new_ptr = region_jalloc(allocator, new_size);
+    if (!new_ptr) return NULL;
+    memcpy(new_ptr, ptr, old_size);
+    return new_ptr;
+}
+
+static void free_regions(region* r)
+{
+    for (region* next; r; r = next)
+    {
+        next = r->next;
+        free(r);
+    }
+}
+
+void region_jallocator_reset(region_jallocator* allocator)
+{
+    region_jallocator* this = allocator;
+    this->last = NULL;
+    if (this->first)
+    {
+        begin_region(this, this->first);
+    }
+    for (region* r = this->absorbed; r; r = r->next)
+    {
+        this->total_size -= r->size;
+    }
+    free_regions(this->absorbed);
+    this->absorbed = NULL;
+}
+
+static region** list_end(region** p_list)
+{
+    while (*p_list)
+    {
+        p_list = &(*p_list)->next;
+    }
+    return p_list;
+}
+
+void region_jallocator_absorb(region_jallocator* allocator, region_jallocator* other)
+{
+    region_jallocator* this = allocator;
+    //  None of the other allocator's regions can be reused, so they are all added to the absorbed ones
+    *list_end(&other->first) = other->absorbed;
+    *list_end(&other->first) = this->absorbed;
+    this->absorbed = other->first;
+    this->total_size += other->total_size;
+    free(other);
+}
+
+uint_fast64_t region_jallocator_destroy(region_jallocator* allocator)
+{
+    region_jallocator* this = allocator;
+    const uint_fast64_t ret_v = this->total_size;
+    free_regions(this->first);
+    free_regions(this->absorbed);
+    free(this);
+    return ret_v;
+}
+
+uint_fast64_t region_jallocator_get_size(const region_jallocator* allocator)
+{
+    return allocator->total_size;
+}
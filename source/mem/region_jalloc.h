@@ -0,0 +1,45 @@
+//
+// Created by jan on 19.10.2026.
+//
+
+#ifndef RMOD_REGION_JALLOC_H
+#define RMOD_REGION_JALLOC_H
+#include <stdint.h>
+
+//  Region allocator
+//
+//  Purpose:
+//      Provide memory for many objects which live for as long as the allocator, so that they are all released with a
+//      single call instead of one by one. Memory is taken from regions which are added as they are needed, so unlike
+//      with the linear allocator the total size does not have to be known in advance. The allocations do not need to
+//      be thread-safe.
+//
+//  Requirements:
+//      - Provide dynamic memory allocation capabilities
+//      - Provide lower time overhead than malloc and free
+//      - Release all allocations at once, in time which does not depend on their number
+//      - When no more memory is available, return NULL
+//
+
+typedef struct region_jallocator_struct region_jallocator;
+
+region_jallocator* region_jallocator_create(uint_fast64_t region_size);
+
+void* region_jalloc(region_jallocator* allocator, uint_fast64_t size);
+
+//  Resizes in place if ptr was the last allocation and there is space for it, otherwise copies old_size bytes into a new
+//  allocation. Memory of the old allocation is only released together with the rest of the allocator.
+void* region_jrealloc(region_jallocator* allocator, void* ptr, uint_fast64_t old_size, uint_fast64_t new_size);
+
+//  Releases all allocations, but keeps the regions, so that they are reused by the following allocations
+void region_jallocator_reset(region_jallocator* allocator);
+
+//  Takes over all allocations of the other allocator, which is destroyed, so that they are released together with the
+//  allocations of this one
+void region_jallocator_absorb(region_jallocator* allocator, region_jallocator* other);
+
+uint_fast64_t region_jallocator_destroy(region_jallocator* allocator);
+
+uint_fast64_t region_jallocator_get_size(const region_jallocator* allocator);
+
+#endif //RMOD_REGION_JALLOC_H
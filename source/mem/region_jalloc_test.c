@@ -0,0 +1,106 @@
+//
+// Created by jan on 19.10.2026.
+//
+#include "region_jalloc.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+
+//  Checks resizing of allocations in place and by copying, reuse of regions after a reset, and the size of regions
+//  taken over from another allocator
+
+#define ASSERT(x) if ((x) == false) {fprintf(stderr, "Failed assertion: \"" #x "\"\n"); __builtin_trap(); exit(EXIT_FAILURE);} (void)0
+#define REGION_SIZE 1024
+
+static void check_realloc(void)
+{
+    region_jallocator* const allocator = region_jallocator_create(REGION_SIZE);
+    ASSERT(allocator);
+    unsigned char* const p = region_jalloc(allocator, 16);
+    ASSERT(p);
+    memset(p, 1, 16);
+    //  Last allocation grows and shrinks in place, and the next one follows its new end
+    ASSERT(region_jrealloc(allocator, p, 16, 64) == p);
+    memset(p + 16, 2, 48);
+    ASSERT(region_jrealloc(allocator, p, 64, 24) == p);
+    unsigned char* const q = region_jalloc(allocator, 8);
+    ASSERT(q == p + 24);
+    ASSERT(p[0] == 1 && p[15] == 1 && p[16] == 2 && p[23] == 2);
+    //  Sizes are rounded up to multiples of 8
+    ASSERT(region_jrealloc(allocator, q, 8, 13) == q);
+    ASSERT(region_jalloc(allocator, 8) == q + 16);
+
+    //  Allocation which is not the last one is kept when shrunk, and copied when grown
+    ASSERT(region_jrealloc(allocator, p, 24, 8) == p);
+    unsigned char* const r = region_jrealloc(allocator, p, 24, 32);
+    ASSERT(r && r != p);
+    ASSERT(r[0] == 1 && r[15] == 1 && r[16] == 2 && r[23] == 2);
+
+    //  Last allocation which would not fit into the region is copied into a new one
+    unsigned char* const s = region_jrealloc(allocator, r, 32, 2 * REGION_SIZE);
+    ASSERT(s && s != r);
+    ASSERT(s[0] == 1 && s[23] == 2);
+    ASSERT(region_jallocator_get_size(allocator) == 3 * REGION_SIZE);
+    //  Region filled by the copy has no space left, so another one is added
+    ASSERT(region_jrealloc(allocator, NULL, 0, 8) != NULL);
+    ASSERT(region_jallocator_destroy(allocator) == 4 * REGION_SIZE);
+}
+
+static void check_reset(void)
+{
+    region_jallocator* const allocator = region_jallocator_create(REGION_SIZE);
+    ASSERT(allocator);
+    void* const first = region_jalloc(allocator, REGION_SIZE / 2);
+    void* const second = region_jalloc(allocator, REGION_SIZE);
+    void* const third = region_jalloc(allocator, REGION_SIZE / 2);
+    ASSERT(first && second && third);
+    const uint_fast64_t size = region_jallocator_get_size(allocator);
+    ASSERT(size == 3 * REGION_SIZE);
+
+    //  Same regions are used again in the same order, without allocating new ones
+    region_jallocator_reset(allocator);
+    ASSERT(region_jalloc(allocator, REGION_SIZE / 2) == first);
+    ASSERT(region_jalloc(allocator, REGION_SIZE) == second);
+    ASSERT(region_jalloc(allocator, REGION_SIZE / 2) == third);
+    ASSERT(region_jallocator_get_size(allocator) == size);
+    //  Last allocation before the reset can not be resized in place after it
+    region_jallocator_reset(allocator);
+    ASSERT(region_jrealloc(allocator, third, REGION_SIZE / 2, REGION_SIZE / 2 + 8) == first);
+    ASSERT(region_jallocator_destroy(allocator) == size);
+}
+
+static void check_absorb(void)
+{
+    region_jallocator* const allocator = region_jallocator_create(REGION_SIZE);
+    region_jallocator* const other = region_jallocator_create(REGION_SIZE);
+    region_jallocator* const nested = region_jallocator_create(REGION_SIZE);
+    ASSERT(allocator && other && nested);
+    ASSERT(region_jalloc(allocator, 8));
+    char* const kept = region_jalloc(other, 2 * REGION_SIZE);
+    ASSERT(kept);
+    strcpy(kept, "kept");
+    ASSERT(region_jalloc(nested, 8));
+    //  Regions which the other allocator absorbed are passed on as well
+    region_jallocator_absorb(other, nested);
+    ASSERT(region_jallocator_get_size(other) == 3 * REGION_SIZE);
+    region_jallocator_absorb(allocator, other);
+    ASSERT(region_jallocator_get_size(allocator) == 4 * REGION_SIZE);
+    ASSERT(strcmp(kept, "kept") == 0);
+
+    //  Absorbed regions are not reused, so they are released by a reset
+    region_jallocator_reset(allocator);
+    ASSERT(region_jallocator_get_size(allocator) == REGION_SIZE);
+    ASSERT(region_jalloc(allocator, 2 * REGION_SIZE));
+    ASSERT(region_jallocator_get_size(allocator) == 3 * REGION_SIZE);
+    ASSERT(region_jallocator_destroy(allocator) == 3 * REGION_SIZE);
+}
+
+int main()
+{
+    check_realloc();
+    check_reset();
+    check_absorb();
+    printf("Region allocator kept its allocations and sizes\n");
+    return 0;
+}
@@ -70,13 +70,19 @@ static rmod_result report_child_mismatch(const rmod_xml_element* xml_element, co
 static rmod_result recursive_parse_cfg(const rmod_xml_element* xml_element, const rmod_xml_config_entry* cfg_element
                                        )
 {
-    if (cfg_element->child_count != xml_element->child_count)
+    u32 required_count = 0;
+    for (u32 i = 0; i < cfg_element->child_count; ++i)
+    {
+        required_count += !cfg_element->child_array[i].optional;
+    }
+    if (xml_element->child_count < required_count || xml_element->child_count > cfg_element->child_count)
     {
         return report_child_mismatch(xml_element, cfg_element);
     }
-    if (cfg_element->child_count)
+    if (cfg_element->child_count && xml_element->child_count)
     {
-        const u32 count = cfg_element->child_count;
+        const u32 count = xml_element->child_count;
+        const u32 cfg_count = cfg_element->child_count;
         //  Used to determine xml <-> cfg correspondence (matched[i] = j means that xml[i] <-> cfg[j]
         u32* const matched = lin_jalloc(G_LIN_JALLOCATOR, sizeof*matched * count);
         if (!matched)
@@ -89,12 +95,12 @@ static rmod_result recursive_parse_cfg(const rmod_xml_element* xml_element, cons
         for (u32 i = 0; i < count; ++i)
         {
             const rmod_xml_element* xml_child = xml_element->children + i;
-            for (u32 j = 0; j < count; ++j)
+            for (u32 j = 0; j < cfg_count; ++j)
             {
                 const rmod_xml_config_entry* cfg_child = cfg_element->child_array + j;
                 if (compare_string_segment(xml_child->name.len, cfg_child->name, &xml_child->name))
                 {
-                    if (matched[i] != -1)
+                    if (matched[i] != (u32)-1)
                     {
                         RMOD_ERROR("Configuration element has more than one entry named \"%s\", which is not allowed", cfg_element->name);
                         return RMOD_RESULT_BAD_CFG;
@@ -120,6 +126,26 @@ static rmod_result recursive_parse_cfg(const rmod_xml_element* xml_element, cons
                 }
             }
         }
+        //  All entries which are not optional must be present
+        for (u32 j = 0; j < cfg_count; ++j)
+        {
+            if (cfg_element->child_array[j].optional)
+            {
+                continue;
+            }
+            u32 i;
+            for (i = 0; i < count; ++i)
+            {
+                if (matched[i] == j)
+                {
+                    break;
+                }
+            }
+            if (i == count)
+            {
+                return report_child_mismatch(xml_element, cfg_element);
+            }
+        }
 
         rmod_result res;
         for (u32 i = 0; i < count; ++i)
@@ -133,7 +159,7 @@ static rmod_result recursive_parse_cfg(const rmod_xml_element* xml_element, cons
 
         lin_jfree(G_LIN_JALLOCATOR, matched);
     }
-    else
+    else if (!cfg_element->child_count)
     {
         rmod_result res;
         if ((res = convert_value(xml_element->value, &cfg_element->converter)) != RMOD_RESULT_SUCCESS)
@@ -221,15 +247,25 @@ rmod_result rmod_parse_configuration_file(const char* filename, const rmod_xml_c
         goto failed;
     }
     lin_jfree(G_LIN_JALLOCATOR, real_name);
+    //  Tree of the file is only needed until the configuration is parsed
+    region_jallocator* const tree_allocator = region_jallocator_create(1 << 16);
+    if (!tree_allocator)
+    {
+        RMOD_ERROR("Failed creating region allocator for the tree of the file");
+        rmod_unmap_file(&mem_file);
+        res = RMOD_RESULT_NOMEM;
+        goto failed;
+    }
     rmod_xml_element root;
-    if ((res = rmod_parse_xml(&mem_file, &root)) != RMOD_RESULT_SUCCESS)
+    if ((res = rmod_parse_xml(tree_allocator, &mem_file, &root)) != RMOD_RESULT_SUCCESS)
     {
         RMOD_ERROR("Could not parse xml");
+        region_jallocator_destroy(tree_allocator);
         rmod_unmap_file(&mem_file);
         goto failed;
     }
     res = rmod_parse_xml_configuration(&root, cfg_root);
-    rmod_release_xml(&root);
+    region_jallocator_destroy(tree_allocator);
     if (res != RMOD_RESULT_SUCCESS)
     {
         RMOD_ERROR("Could not parse configuration");
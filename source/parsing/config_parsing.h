@@ -13,6 +13,7 @@ struct rmod_xml_config_entry_struct
     const u32 child_count;                        //  Does it have children, and if so how many
     const rmod_xml_config_entry* child_array;   //  If child count is non-zero, this should point to array of children
     const rmod_config_converter converter;        //  Converter for the entry
+    const bool optional;                          //  Entry may be left out, in which case its converter is not called
 };
 
 rmod_result rmod_parse_xml_configuration(const rmod_xml_element* xml_root, const rmod_xml_config_entry* cfg_root);
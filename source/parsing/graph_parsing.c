@@ -4,16 +4,11 @@
 
 #include "graph_parsing.h"
 #include "parsing_base.h"
+#include "string_table.h"
+#include "../common/parallel.h"
 
 #ifdef _WIN32
 #include <stdio.h>
-#include <unistd.h>
-#include <libgen.h>
-
-#else
-#include <unistd.h>
-#include <libgen.h>
-
 #endif
 
 
@@ -31,6 +26,138 @@ const char* rmod_failure_type_to_str(rmod_failure_type value)
     return name_array[value];
 }
 
+const char* rmod_block_parameter_to_str(rmod_block_parameter value)
+{
+    if (value < 0 || value >= RMOD_BLOCK_PARAMETER_COUNT)
+        return NULL;
+    static const char* const name_array[RMOD_BLOCK_PARAMETER_COUNT] =
+            {
+                    [RMOD_BLOCK_PARAMETER_MTBF] = "mtbf",
+                    [RMOD_BLOCK_PARAMETER_MTBR] = "mtbr",
+                    [RMOD_BLOCK_PARAMETER_EFFECT] = "effect",
+                    [RMOD_BLOCK_PARAMETER_COST] = "cost",
+            };
+    return name_array[value];
+}
+
+const char* rmod_distribution_type_to_str(rmod_distribution_type value)
+{
+    if (value < 0 || value >= RMOD_DISTRIBUTION_COUNT)
+        return NULL;
+    static const char* const name_array[RMOD_DISTRIBUTION_COUNT] =
+            {
+                    [RMOD_DISTRIBUTION_NONE] = "none",
+                    [RMOD_DISTRIBUTION_UNIFORM] = "uniform",
+                    [RMOD_DISTRIBUTION_LOG_UNIFORM] = "loguniform",
+                    [RMOD_DISTRIBUTION_TRIANGULAR] = "triangular",
+            };
+    return name_array[value];
+}
+
+//  Parses attributes of the element which gives value of a parameter of a block, which describe the range of values it
+//  may have. Element without any of them gives the exact value of the parameter.
+static rmod_result parse_parameter_distribution(
+        const rmod_xml_element* element, const rmod_block_parameter parameter, const f32 value, const f32 v_min,
+        rmod_parameter_distribution* p_out)
+{
+    RMOD_ENTER_FUNCTION;
+    rmod_result res;
+    const char* const parameter_name = rmod_block_parameter_to_str(parameter);
+    rmod_parameter_distribution distribution = {.type = RMOD_DISTRIBUTION_NONE, .min = value, .max = value};
+    bool found_type = false, found_min = false, found_max = false;
+    for (u32 i = 0; i < element->attrib_count; ++i)
+    {
+        const string_segment* a_name = element->attribute_names + i;
+        const string_segment* a_valu = element->attribute_values + i;
+        if (COMPARE_STRING_SEGMENT_TO_LITERAL(distribution, a_name))
+        {
+            rmod_distribution_type type;
+            for (type = RMOD_DISTRIBUTION_UNIFORM; type < RMOD_DISTRIBUTION_COUNT; ++type)
+            {
+                const char* const type_name = rmod_distribution_type_to_str(type);
+                if (strlen(type_name) == a_valu->len && strncmp(type_name, a_valu->begin, a_valu->len) == 0)
+                {
+                    break;
+                }
+            }
+            if (type == RMOD_DISTRIBUTION_COUNT)
+            {
+                RMOD_ERROR("Value of attribute \"distribution\" of element \"%s\" was given as \"%.*s\", which is not a valid value", parameter_name, a_valu->len, a_valu->begin);
+                res = RMOD_RESULT_BAD_XML;
+                goto failed;
+            }
+            distribution.type = type;
+            found_type = true;
+        }
+        else if (COMPARE_STRING_SEGMENT_TO_LITERAL(min, a_name) || COMPARE_STRING_SEGMENT_TO_LITERAL(max, a_name))
+        {
+            const bool is_min = COMPARE_STRING_SEGMENT_TO_LITERAL(min, a_name);
+            f32 v;
+            if (a_valu->len == 0 || !parse_string_segment_to_f32(a_valu, &v))
+            {
+                RMOD_ERROR("Value of attribute \"%.*s\" of element \"%s\" was given as \"%.*s\", which is not allowed (only a single float can be given)", a_name->len, a_name->begin, parameter_name, a_valu->len, a_valu->begin);
+                res = RMOD_RESULT_BAD_XML;
+                goto failed;
+            }
+            if (is_min)
+            {
+                distribution.min = v;
+                found_min = true;
+            }
+            else
+            {
+                distribution.max = v;
+                found_max = true;
+            }
+        }
+        else
+        {
+            RMOD_WARN("Unknown attribute \"%.*s\" was found in the element \"%s\" and will be ignored", a_name->len, a_name->begin, parameter_name);
+        }
+    }
+    if (!found_type && !found_min && !found_max)
+    {
+        *p_out = distribution;
+        RMOD_LEAVE_FUNCTION;
+        return RMOD_RESULT_SUCCESS;
+    }
+    if (!found_min || !found_max)
+    {
+        RMOD_ERROR("Element \"%s\" must have both attributes \"min\" and \"max\" to give the range of its value", parameter_name);
+        res = RMOD_RESULT_BAD_XML;
+        goto failed;
+    }
+    if (!found_type)
+    {
+        distribution.type = RMOD_DISTRIBUTION_UNIFORM;
+    }
+    if (distribution.min < v_min || distribution.max < distribution.min)
+    {
+        RMOD_ERROR("Range of element \"%s\" was given as [%g, %g], which is not valid", parameter_name, distribution.min, distribution.max);
+        res = RMOD_RESULT_BAD_XML;
+        goto failed;
+    }
+    if (distribution.type == RMOD_DISTRIBUTION_LOG_UNIFORM && distribution.min <= 0.0f)
+    {
+        RMOD_ERROR("Range of element \"%s\" was given as [%g, %g], but log-uniform distribution needs positive values", parameter_name, distribution.min, distribution.max);
+        res = RMOD_RESULT_BAD_XML;
+        goto failed;
+    }
+    if (distribution.type == RMOD_DISTRIBUTION_TRIANGULAR && (value < distribution.min || value > distribution.max))
+    {
+        RMOD_ERROR("Value of element \"%s\" was given as %g, which is the mode of its triangular distribution, so it must be in its range [%g, %g]", parameter_name, value, distribution.min, distribution.max);
+        res = RMOD_RESULT_BAD_XML;
+        goto failed;
+    }
+    *p_out = distribution;
+
+    RMOD_LEAVE_FUNCTION;
+    return RMOD_RESULT_SUCCESS;
+failed:
+    RMOD_LEAVE_FUNCTION;
+    return res;
+}
+
 const char* rmod_element_type_value_to_str(rmod_element_type_value value)
 {
     if (value < 0 || value >= RMOD_ELEMENT_TYPE_COUNT)
@@ -49,67 +176,130 @@ const char* rmod_element_type_value_to_str(rmod_element_type_value value)
 typedef struct intermediate_element_struct intermediate_element;
 struct intermediate_element_struct
 {
-    const string_segment* label;
-    element_type_id type_id;
+    string_segment label;
+    string_segment type_name;           //  Resolved into the type id once all files are loaded
+    rmod_element_type_value type_value;
     u32 child_count;
     u32 child_capacity;
-    const string_segment** child_names;
+    string_segment* child_names;
     u32 parent_count;
     u32 parent_capacity;
-    const string_segment** parent_names;
+    string_segment* parent_names;
 };
 
-static rmod_result confirm_unique_labels(const intermediate_element* parts, const u32 count)
+//  Reports the cycle, which consists of elements on the stack from the position of the element it closes on to the top
+static void report_cycle(
+        region_jallocator* const allocator, const string_segment* p_name, const rmod_chain_element* elements, const u32* stack, const u32 stack_size,
+        const u32 begin)
 {
-    RMOD_ENTER_FUNCTION;
-    if (count == 1)
+    u64 length = 1;
+    for (u32 i = begin; i < stack_size; ++i)
     {
-        RMOD_LEAVE_FUNCTION;
-        return RMOD_RESULT_SUCCESS;
+        length += elements[stack[i]].label.len + 4;
     }
-    else if (count == 2)
+    length += elements[stack[begin]].label.len;
+    char* const buffer = region_jalloc(allocator, length);
+    if (!buffer)
     {
-        if (compare_string_segment(parts[0].label->len, parts[0].label->begin, parts[1].label))
-        {
-            RMOD_ERROR("Label %.*s appears twice", parts[1].label->len, parts[1].label->begin);
-            RMOD_LEAVE_FUNCTION;
-            return RMOD_RESULT_BAD_XML;
-        }
-        RMOD_LEAVE_FUNCTION;
-        return RMOD_RESULT_SUCCESS;
+        RMOD_ERROR("Cycle detected in chain \"%.*s\" through element \"%.*s\"", p_name->len, p_name->begin, elements[stack[begin]].label.len, elements[stack[begin]].label.begin);
+        return;
     }
-    const u32 half = count / 2;
-
-    rmod_result res = confirm_unique_labels(parts, half);
-    if (res != RMOD_RESULT_SUCCESS)
+    u64 used = 0;
+    for (u32 i = begin; i < stack_size; ++i)
     {
-        RMOD_LEAVE_FUNCTION;
-        return res;
+        const string_segment* const label = &elements[stack[i]].label;
+        memcpy(buffer + used, label->begin, label->len);
+        memcpy(buffer + used + label->len, " -> ", 4);
+        used += label->len + 4;
     }
-    res = confirm_unique_labels(parts + half, count - half);
-    RMOD_LEAVE_FUNCTION;
-    return res;
+    memcpy(buffer + used, elements[stack[begin]].label.begin, elements[stack[begin]].label.len);
+    used += elements[stack[begin]].label.len;
+    buffer[used] = 0;
+    RMOD_ERROR("Cycle detected in chain \"%.*s\": %s", p_name->len, p_name->begin, buffer);
 }
 
-static rmod_result check_flow(const string_segment* p_name, const rmod_chain_element* elements, const u32 element_id, const u32 depth, const u32 max_depth)
+//  Checks that the chain contains no cycles and that the last element can be reached from the first. Uses an iterative
+//  depth-first search, where elements are marked as being on the current path or as finished, so that each element and
+//  each of its children is only visited once. Memory it needs is taken from the allocator.
+static rmod_result check_flow(
+        region_jallocator* const allocator, const string_segment* p_name, const rmod_chain_element* elements, const u32 element_count, const u32 first,
+        const u32 last)
 {
-    if (depth > max_depth)
+    RMOD_ENTER_FUNCTION;
+    rmod_result res;
+    enum {UNVISITED = 0, ON_PATH = 1, FINISHED = 2};
+    u8* const marks = region_jalloc(allocator, sizeof(*marks) * element_count);
+    //  Elements on the current path and index of the next child of each to visit
+    u32* const stack = region_jalloc(allocator, sizeof(*stack) * element_count);
+    u32* const next_child = region_jalloc(allocator, sizeof(*next_child) * element_count);
+    if (!marks || !stack || !next_child)
     {
-        RMOD_ERROR("Cycle detected in chain \"%.*s\"", p_name->len, p_name->begin);
-        return RMOD_RESULT_CYCLICAL_CHAIN;
+        RMOD_ERROR("Failed region_jalloc(%p, %zu)", allocator, (sizeof(*marks) + sizeof(*stack) + sizeof(*next_child)) * element_count);
+        res = RMOD_RESULT_NOMEM;
+        goto end;
     }
+    memset(marks, UNVISITED, sizeof(*marks) * element_count);
 
-    const rmod_chain_element* e = elements + element_id;
-    for (u32 i = 0; i < e->child_count; ++i)
+    //  Search from the first element, then from any others which it did not reach, so that cycles not connected to it
+    //  are found as well
+    for (u32 i = 0; i < element_count; ++i)
     {
-        rmod_result res = check_flow(p_name, elements, e->children[i], depth + 1, max_depth);
-        if (res != RMOD_RESULT_SUCCESS)
+        const u32 root = i == 0 ? first : (i == first ? 0 : i);
+        if (marks[root] != UNVISITED)
         {
-            return res;
+            continue;
+        }
+        if (root != first && marks[last] == UNVISITED)
+        {
+            RMOD_ERROR("Last element \"%.*s\" of chain \"%.*s\" can not be reached from its first element \"%.*s\"", elements[last].label.len, elements[last].label.begin, p_name->len, p_name->begin, elements[first].label.len, elements[first].label.begin);
+            res = RMOD_RESULT_BAD_XML;
+            goto end;
+        }
+        u32 stack_size = 0;
+        stack[stack_size] = root;
+        next_child[stack_size] = 0;
+        stack_size += 1;
+        marks[root] = ON_PATH;
+        while (stack_size)
+        {
+            const u32 id = stack[stack_size - 1];
+            const rmod_chain_element* const e = elements + id;
+            if (next_child[stack_size - 1] == e->child_count)
+            {
+                marks[id] = FINISHED;
+                stack_size -= 1;
+                continue;
+            }
+            const u32 child = (u32)e->children[next_child[stack_size - 1]++];
+            switch (marks[child])
+            {
+            case UNVISITED:
+                marks[child] = ON_PATH;
+                stack[stack_size] = child;
+                next_child[stack_size] = 0;
+                stack_size += 1;
+                break;
+            case ON_PATH:
+            {
+                u32 begin = stack_size - 1;
+                while (stack[begin] != child)
+                {
+                    begin -= 1;
+                }
+                report_cycle(allocator, p_name, elements, stack, stack_size, begin);
+                res = RMOD_RESULT_CYCLICAL_CHAIN;
+                goto end;
+            }
+            default:
+                break;
+            }
         }
     }
+    res = RMOD_RESULT_SUCCESS;
 
-    return RMOD_RESULT_SUCCESS;
+end:
+    RMOD_LEAVE_FUNCTION;
+    return res;
 }
 
 //static rmod_result xml_insert_as_child(rmod_xml_element* p_dest, rmod_xml_element* p_src, u32 where)
@@ -182,1153 +372,1611 @@ static rmod_result check_flow(const string_segment* p_name, const rmod_chain_ele
 //    return RMOD_RESULT_SUCCESS;
 //}
 
-rmod_result rmod_convert_xml(
-        const rmod_xml_element* root, u32* p_file_count, u32* p_file_capacity, rmod_memory_file** pp_files, u32* pn_types,
-        rmod_element_type** pp_types)
+//  Element of the root which is being converted
+typedef enum definition_type_enum definition_type;
+enum definition_type_enum
 {
-    RMOD_ENTER_FUNCTION;
-    u32 type_count = 0;
-    u32 type_capacity = 32;
-    rmod_element_type* types = jalloc(sizeof*types * type_capacity);
-    if (!types)
+    DEFINITION_NONE,                    //  Element which is ignored
+    DEFINITION_BLOCK,
+    DEFINITION_CHAIN,
+    DEFINITION_INCLUDE,
+};
+
+//  Values found so far in the element "block" which is being converted
+typedef struct block_definition_struct block_definition;
+struct block_definition_struct
+{
+    bool found_name, found_mtbf, found_effect, found_failure, found_cost, found_mtbr;
+    string_segment name;
+    f32 mtbf;
+    f32 effect;
+    f32 cost;
+    f32 mtbr;
+    rmod_failure_type failure_type;
+    rmod_parameter_distribution uncertainty[RMOD_BLOCK_PARAMETER_COUNT];
+};
+
+//  Values found so far in the element "chain" which is being converted, its elements are kept by the converter
+typedef struct chain_definition_struct chain_definition;
+struct chain_definition_struct
+{
+    bool found_name, found_first, found_last;
+    string_segment name;
+    string_segment first;
+    string_segment last;
+    bool in_element;                    //  Element "element" is open
+    bool found_type, found_label;       //  Found so far in the open element "element"
+};
+
+//  Type of an element of a chain, which is only looked up once all files are loaded, since it may come from any file
+//  included before the chain
+typedef struct element_type_name_struct element_type_name;
+struct element_type_name_struct
+{
+    string_segment name;
+    rmod_element_type_value type_value;
+};
+
+//  Type defined by a model file. Type ids of elements of a chain are not set until the files are merged.
+typedef struct model_type_struct model_type;
+struct model_type_struct
+{
+    rmod_element_type type;
+    element_type_name* element_types;   //  Type of each element of the chain, NULL for blocks
+};
+
+//  Include of a model file, whose types are added right before the own type of the including file at its position
+typedef struct model_include_struct model_include;
+struct model_include_struct
+{
+    u32 position;                       //  Number of own types of the including file defined before the include
+    u32 file_index;                     //  Set once the file is added to the registry
+    const char* path;                   //  Real path of the included file
+};
+
+//  File which is loaded on its own, possibly by another thread than the one which loads the files including it
+typedef struct model_file_struct model_file;
+struct model_file_struct
+{
+    const char* path;
+    rmod_memory_file mem_file;
+    u32 type_count;
+    u32 type_capacity;
+    model_type* types;
+    u32 include_count;
+    u32 include_capacity;
+    model_include* includes;
+    u64 structure_hash;                 //  Hash of everything in the file except values of parameters of blocks
+};
+
+#define FNV_OFFSET 0xcbf29ce484222325
+#define FNV_PRIME 0x100000001b3
+
+static u64 hash_bytes(u64 hash, const void* const ptr, const u64 size)
+{
+    const u8* const bytes = ptr;
+    for (u64 i = 0; i < size; ++i)
     {
-        RMOD_ERROR("Failed jalloc(%zu)", sizeof*types * type_capacity);
-        return RMOD_RESULT_NOMEM;
+        hash ^= bytes[i];
+        hash *= FNV_PRIME;
     }
-    rmod_result res = RMOD_RESULT_SUCCESS;
-    void* base = lin_jalloc_get_current(G_LIN_JALLOCATOR);
-    u32 part_count = 0;
-    u32 part_capacity = 0;
-    intermediate_element* element_buffer = NULL;
-    if (!COMPARE_STRING_SEGMENT_TO_LITERAL(rmod, &root->name))
+    return hash;
+}
+
+//  Length is hashed as well, so that consecutive segments can not be confused with one another
+static u64 hash_segment(u64 hash, const string_segment* const segment)
+{
+    hash = hash_bytes(hash, &segment->len, sizeof(segment->len));
+    return hash_bytes(hash, segment->begin, segment->len);
+}
+
+//  Converts elements into types as they are reported by the parser, so that only the chain which is being converted
+//  has to be kept in intermediate form. Since this may be done by a worker thread, no memory is taken from jalloc.
+typedef struct type_converter_struct type_converter;
+struct type_converter_struct
+{
+    region_jallocator* allocator;       //  Memory of elements of chains and their relations
+    region_jallocator* info;            //  Memory of types, includes, and the parser, which is kept until files are merged
+    region_jallocator* scratch;         //  Memory of relations of the chain which is being converted
+    model_file* file;
+    definition_type definition;
+    block_definition block;
+    chain_definition chain;
+    u32 part_count;
+    u32 part_capacity;
+    intermediate_element* element_buffer;
+};
+
+static rmod_result add_type(type_converter* const this, const model_type* const type)
+{
+    RMOD_ENTER_FUNCTION;
+    model_file* const file = this->file;
+    if (file->type_count == file->type_capacity)
     {
-        RMOD_ERROR("xml's root tag was not \"rmod\" but was \"%.*s\"", root->name.len, root->name.begin);
-        res = RMOD_RESULT_BAD_XML;
-        goto failed;
+        const u32 new_capacity = file->type_capacity ? file->type_capacity * 2 : 32;
+        model_type* const new_ptr = region_jrealloc(this->info, file->types, sizeof(*new_ptr) * file->type_capacity, sizeof(*new_ptr) * new_capacity);
+        if (!new_ptr)
+        {
+            RMOD_ERROR("Failed region_jrealloc(%p, %p, %zu)", this->info, file->types, sizeof(*new_ptr) * new_capacity);
+            RMOD_LEAVE_FUNCTION;
+            return RMOD_RESULT_NOMEM;
+        }
+        file->types = new_ptr;
+        file->type_capacity = new_capacity;
     }
+    file->types[file->type_count++] = *type;
 
+    //  Values of parameters of blocks are left out, so that changing only them does not change the hash
+    const rmod_element_type_header* const header = &type->type.header;
+    u64 hash = hash_bytes(file->structure_hash, &header->type_value, sizeof(header->type_value));
+    hash = hash_segment(hash, &header->type_name);
+    if (header->type_value == RMOD_ELEMENT_TYPE_CHAIN)
+    {
+        const rmod_chain* const chain = &type->type.chain;
+        hash = hash_bytes(hash, &chain->i_first, sizeof(chain->i_first));
+        hash = hash_bytes(hash, &chain->i_last, sizeof(chain->i_last));
+        for (u32 i = 0; i < chain->element_count; ++i)
+        {
+            const rmod_chain_element* const element = chain->chain_elements + i;
+            hash = hash_segment(hash, &element->label);
+            hash = hash_segment(hash, &type->element_types[i].name);
+            hash = hash_bytes(hash, &type->element_types[i].type_value, sizeof(type->element_types[i].type_value));
+            hash = hash_bytes(hash, &element->parent_count, sizeof(element->parent_count));
+            hash = hash_bytes(hash, element->parents, sizeof(*element->parents) * element->parent_count);
+            hash = hash_bytes(hash, &element->child_count, sizeof(element->child_count));
+            hash = hash_bytes(hash, element->children, sizeof(*element->children) * element->child_count);
+        }
+    }
+    file->structure_hash = hash;
+    RMOD_LEAVE_FUNCTION;
+    return RMOD_RESULT_SUCCESS;
+}
 
-    //  Parse children of the xml file which are 'block' and 'chain' nodes
-    for (u32 i = 0; i < root->child_count; ++i)
+//  Converts a child of the element "block", which gives one of its properties
+static rmod_result convert_block_property(type_converter* const this, const rmod_xml_element* const child)
+{
+    RMOD_ENTER_FUNCTION;
+    rmod_result res;
+    block_definition* const block = &this->block;
+    if (COMPARE_STRING_SEGMENT_TO_LITERAL(name, &child->name))
     {
-        const rmod_xml_element* e = root->children + i;
-        if (COMPARE_STRING_SEGMENT_TO_LITERAL(block, &e->name))
+        //  Name of the block
+        if (block->found_name)
         {
-            //  Process attributes
-            for (u32 k = 0; k < e->attrib_count; ++k)
+            RMOD_WARN("Duplicate \"name\" element was found in the element in \"block\" and will be ignored");
+            goto end;
+        }
+        if (child->value.len == 0)
+        {
+            RMOD_ERROR("Element \"name\" in the element \"block\" was empty");
+            res = RMOD_RESULT_BAD_XML;
+            goto failed;
+        }
+        block->name = child->value;
+        block->found_name = true;
+    }
+    else if (COMPARE_STRING_SEGMENT_TO_LITERAL(mtbf, &child->name))
+    {
+        //  Reliability of the block
+        if (block->found_mtbf)
+        {
+            RMOD_WARN("Duplicate \"mtbf\" element was found in the element in \"block\" and will be ignored");
+            goto end;
+        }
+        if (child->value.len == 0)
+        {
+            RMOD_ERROR("Element \"mtbf\" in the element \"block\" was empty");
+            res = RMOD_RESULT_BAD_XML;
+            goto failed;
+        }
+        if (!parse_string_segment_to_f32(&child->value, &block->mtbf))
+        {
+            RMOD_ERROR("Value of \"mtbf\" was given as \"%.*s\" in the element \"block\", which is not allowed (only a single positive float can be given)", child->value.len, child->value.begin);
+            res = RMOD_RESULT_BAD_XML;
+            goto failed;
+        }
+        if (block->mtbf < 0.0f)
+        {
+            RMOD_ERROR("Value of \"mtbf\" was given as \"%g\" in the element \"block\", which is must be positive", block->mtbf);
+            res = RMOD_RESULT_BAD_XML;
+            goto failed;
+        }
+        if ((res = parse_parameter_distribution(child, RMOD_BLOCK_PARAMETER_MTBF, block->mtbf, 0.0f, block->uncertainty + RMOD_BLOCK_PARAMETER_MTBF)) != RMOD_RESULT_SUCCESS)
+        {
+            goto failed;
+        }
+        block->found_mtbf = true;
+    }
+    else if (COMPARE_STRING_SEGMENT_TO_LITERAL(mtbr, &child->name))
+    {
+        //  Reliability of the block
+        if (block->found_mtbr)
+        {
+            RMOD_WARN("Duplicate \"mtbr\" element was found in the element in \"block\" and will be ignored");
+            goto end;
+        }
+        if (child->value.len == 0)
+        {
+            RMOD_ERROR("Element \"mtbr\" in the element \"block\" was empty");
+            res = RMOD_RESULT_BAD_XML;
+            goto failed;
+        }
+        if (!parse_string_segment_to_f32(&child->value, &block->mtbr))
+        {
+            RMOD_ERROR("Value of \"mtbr\" was given as \"%.*s\" in the element \"block\", which is not allowed (only a single positive float can be given)", child->value.len, child->value.begin);
+            res = RMOD_RESULT_BAD_XML;
+            goto failed;
+        }
+        if (block->mtbr < 0.0f)
+        {
+            RMOD_ERROR("Value of \"mtbr\" was given as \"%g\" in the element \"block\", which is must be positive", block->mtbr);
+            res = RMOD_RESULT_BAD_XML;
+            goto failed;
+        }
+        if ((res = parse_parameter_distribution(child, RMOD_BLOCK_PARAMETER_MTBR, block->mtbr, 0.0f, block->uncertainty + RMOD_BLOCK_PARAMETER_MTBR)) != RMOD_RESULT_SUCCESS)
+        {
+            goto failed;
+        }
+        block->found_mtbr = true;
+    }
+    else if (COMPARE_STRING_SEGMENT_TO_LITERAL(effect, &child->name))
+    {
+        //  Effect of the block
+        if (block->found_effect)
+        {
+            RMOD_WARN("Duplicate \"effect\" element was found in the element in \"block\" and will be ignored");
+            goto end;
+        }
+        if (child->value.len == 0)
+        {
+            RMOD_ERROR("Element \"effect\" in the element \"block\" was empty");
+            res = RMOD_RESULT_BAD_XML;
+            goto failed;
+        }
+        if (!parse_string_segment_to_f32(&child->value, &block->effect))
+        {
+            RMOD_ERROR("Value of \"effect\" was given as \"%.*s\" in the element \"block\", which is not allowed (only a single float in range (0, 1] can be given)", child->value.len, child->value.begin);
+            res = RMOD_RESULT_BAD_XML;
+            goto failed;
+        }
+        if (block->effect == 0.0f)
+        {
+            RMOD_ERROR("Value of \"effect\" was given as \"%g\" in the element \"block\", which is not allowed to be zero", block->effect);
+            res = RMOD_RESULT_BAD_XML;
+            goto failed;
+        }
+        if ((res = parse_parameter_distribution(child, RMOD_BLOCK_PARAMETER_EFFECT, block->effect, 0.0f, block->uncertainty + RMOD_BLOCK_PARAMETER_EFFECT)) != RMOD_RESULT_SUCCESS)
+        {
+            goto failed;
+        }
+        block->found_effect = true;
+    }
+    else if (COMPARE_STRING_SEGMENT_TO_LITERAL(failure, &child->name))
+    {
+        //  Failure type of the block
+        if (block->found_failure)
+        {
+            RMOD_WARN("Duplicate \"failure\" element was found in the element in \"block\" and will be ignored");
+            goto end;
+        }
+        if (COMPARE_CASE_STRING_SEGMENT_TO_LITERAL(normal, &child->value))
+        {
+            block->failure_type = RMOD_FAILURE_TYPE_ACCEPTABLE;
+        }
+        else if (COMPARE_CASE_STRING_SEGMENT_TO_LITERAL(critical, &child->value))
+        {
+            block->failure_type = RMOD_FAILURE_TYPE_CRITICAL;
+        }
+        else if (COMPARE_CASE_STRING_SEGMENT_TO_LITERAL(fatal, &child->value))
+        {
+            block->failure_type = RMOD_FAILURE_TYPE_FATAL;
+        }
+        else
+        {
+            RMOD_ERROR("Value of \"failure\" element was given as \"%.*s\", which is not a valid value", child->value.len, child->value.begin);
+            res = RMOD_RESULT_BAD_XML;
+            goto failed;
+        }
+        block->found_failure = true;
+    }
+    else if (COMPARE_STRING_SEGMENT_TO_LITERAL(cost, &child->name))
+    {
+        //  Failure type of the block
+        if (block->found_cost)
+        {
+            RMOD_WARN("Duplicate \"cost\" element was found in the element in \"block\" and will be ignored");
+            goto end;
+        }
+        if (child->value.len == 0)
+        {
+            RMOD_ERROR("Element \"cost\" in the element \"block\" was empty");
+            res = RMOD_RESULT_BAD_XML;
+            goto failed;
+        }
+        if (!parse_string_segment_to_f32(&child->value, &block->cost))
+        {
+            RMOD_ERROR("Value of \"cost\" was given as \"%.*s\" in the element \"block\", which is not allowed (only a single float can be given)", child->value.len, child->value.begin);
+            res = RMOD_RESULT_BAD_XML;
+            goto failed;
+        }
+        if ((res = parse_parameter_distribution(child, RMOD_BLOCK_PARAMETER_COST, block->cost, -INFINITY, block->uncertainty + RMOD_BLOCK_PARAMETER_COST)) != RMOD_RESULT_SUCCESS)
+        {
+            goto failed;
+        }
+        block->found_cost = true;
+    }
+    else
+    {
+        RMOD_WARN("Unknown element \"%.*s\" was found in the element \"block\" and will be ignored", child->name.len, child->name.begin);
+    }
+
+end:
+    RMOD_LEAVE_FUNCTION;
+    return RMOD_RESULT_SUCCESS;
+failed:
+    RMOD_LEAVE_FUNCTION;
+    return res;
+}
+
+//  Adds the block once all of its properties were found
+static rmod_result finish_block(type_converter* const this)
+{
+    RMOD_ENTER_FUNCTION;
+    const block_definition* const block = &this->block;
+    if (!block->found_name)
+    {
+        RMOD_ERROR("Element \"block\" did not include element \"name\"");
+    }
+    if (!block->found_mtbf)
+    {
+        RMOD_ERROR("Element \"block\" did not include element \"mtbf\"");
+    }
+    if (!block->found_mtbr)
+    {
+        RMOD_ERROR("Element \"block\" did not include element \"mtbr\"");
+    }
+    if (!block->found_effect)
+    {
+        RMOD_ERROR("Element \"block\" did not include element \"effect\"");
+    }
+    if (!block->found_failure)
+    {
+        RMOD_ERROR("Element \"block\" did not include element \"failure\"");
+    }
+    if (!block->found_cost)
+    {
+        RMOD_ERROR("Element \"block\" did not include element \"cost\"");
+    }
+
+    if (!block->found_name || !block->found_mtbf || !block->found_effect || !block->found_failure || !block->found_cost || !block->found_mtbr)
+    {
+        RMOD_ERROR("Element \"block\" was not complete");
+        RMOD_LEAVE_FUNCTION;
+        return RMOD_RESULT_BAD_XML;
+    }
+    model_type type =
             {
-                const string_segment* a_name = e->attribute_names + k;
-                const string_segment* a_valu = e->attribute_values + k;
+            .type.block =
                 {
-                    RMOD_WARN("Unknown attribute \"%.*s\" was found in the element \"element\" and will be ignored", a_name->len, a_name->begin);
+                .header = { .type_value = RMOD_ELEMENT_TYPE_BLOCK, .type_name = block->name },
+                .effect = block->effect,
+                .failure_type = block->failure_type,
+                .mtbf = block->mtbf,
+                .mtbr = block->mtbr,
+                .cost = block->cost,
                 }
+            };
+    memcpy(type.type.block.uncertainty, block->uncertainty, sizeof(block->uncertainty));
+    const rmod_result res = add_type(this, &type);
+    RMOD_LEAVE_FUNCTION;
+    return res;
+}
 
-            }
-            //  This is a block type definition
-            bool found_name = false, found_mtbf = false, found_effect = false, found_failure = false, found_cost = false, found_mtbr = false;
-            string_segment name_v = {};
-            f32 mtbf_v = 0.0f;
-            f32 effect_v = 0.0f;
-            f32 cost_v = 0.0f;
-            f32 mtbr_v = 0.0f;
-            rmod_failure_type failure_type_v = RMOD_FAILURE_TYPE_NONE;
-            for (u32 j = 0; j < e->child_count; ++j)
-            {
-                const rmod_xml_element* child = e->children + j;
-                if (COMPARE_STRING_SEGMENT_TO_LITERAL(name, &child->name))
-                {
-                    //  Name of the block
-                    if (found_name)
-                    {
-                        RMOD_WARN("Duplicate \"name\" element was found in the element in \"block\" and will be ignored");
-                        continue;
-                    }
-                    if (child->value.len == 0)
-                    {
-                        RMOD_ERROR("Element \"name\" in the element \"block\" was empty");
-                        res = RMOD_RESULT_BAD_XML;
-                        goto failed;
-                    }
-                    name_v = child->value;
-                    found_name = true;
-                }
-                else if (COMPARE_STRING_SEGMENT_TO_LITERAL(mtbf, &child->name))
-                {
-                    //  Reliability of the block
-                    if (found_mtbf)
-                    {
-                        RMOD_WARN("Duplicate \"mtbf\" element was found in the element in \"block\" and will be ignored");
-                        continue;
-                    }
-                    if (child->value.len == 0)
-                    {
-                        RMOD_ERROR("Element \"mtbf\" in the element \"block\" was empty");
-                        res = RMOD_RESULT_BAD_XML;
-                        goto failed;
-                    }
-                    char* end_pos;
-                    mtbf_v = strtof(child->value.begin, &end_pos);
-                    if (end_pos != child->value.begin + child->value.len)
-                    {
-                        RMOD_ERROR("Value of \"mtbf\" was given as \"%.*s\" in the element \"block\", which is not allowed (only a single positive float can be given)", child->value.len, child->value.begin);
-                        res = RMOD_RESULT_BAD_XML;
-                        goto failed;
-                    }
-                    if (mtbf_v < 0.0f)
-                    {
-                        RMOD_ERROR("Value of \"mtbf\" was given as \"%g\" in the element \"block\", which is must be positive", mtbf_v);
-                        res = RMOD_RESULT_BAD_XML;
-                        goto failed;
-                    }
-                    found_mtbf = true;
-                }
-                else if (COMPARE_STRING_SEGMENT_TO_LITERAL(mtbr, &child->name))
-                {
-                    //  Reliability of the block
-                    if (found_mtbr)
-                    {
-                        RMOD_WARN("Duplicate \"mtbr\" element was found in the element in \"block\" and will be ignored");
-                        continue;
-                    }
-                    if (child->value.len == 0)
-                    {
-                        RMOD_ERROR("Element \"mtbr\" in the element \"block\" was empty");
-                        res = RMOD_RESULT_BAD_XML;
-                        goto failed;
-                    }
-                    char* end_pos;
-                    mtbr_v = strtof(child->value.begin, &end_pos);
-                    if (end_pos != child->value.begin + child->value.len)
-                    {
-                        RMOD_ERROR("Value of \"mtbr\" was given as \"%.*s\" in the element \"block\", which is not allowed (only a single positive float can be given)", child->value.len, child->value.begin);
-                        res = RMOD_RESULT_BAD_XML;
-                        goto failed;
-                    }
-                    if (mtbr_v < 0.0f)
-                    {
-                        RMOD_ERROR("Value of \"mtbr\" was given as \"%g\" in the element \"block\", which is must be positive", mtbr_v);
-                        res = RMOD_RESULT_BAD_XML;
-                        goto failed;
-                    }
-                    found_mtbr = true;
-                }
-                else if (COMPARE_STRING_SEGMENT_TO_LITERAL(effect, &child->name))
-                {
-                    //  Effect of the block
-                    if (found_effect)
-                    {
-                        RMOD_WARN("Duplicate \"effect\" element was found in the element in \"block\" and will be ignored");
-                        continue;
-                    }
-                    if (child->value.len == 0)
-                    {
-                        RMOD_ERROR("Element \"effect\" in the element \"block\" was empty");
-                        res = RMOD_RESULT_BAD_XML;
-                        goto failed;
-                    }
-                    char* end_pos;
-                    effect_v = strtof(child->value.begin, &end_pos);
-                    if (end_pos != child->value.begin + child->value.len)
-                    {
-                        RMOD_ERROR("Value of \"effect\" was given as \"%.*s\" in the element \"block\", which is not allowed (only a single float in range (0, 1] can be given)", child->value.len, child->value.begin);
-                        res = RMOD_RESULT_BAD_XML;
-                        goto failed;
-                    }
-                    if (effect_v == 0.0f)
-                    {
-                        RMOD_ERROR("Value of \"effect\" was given as \"%g\" in the element \"block\", which is not allowed to be zero", effect_v);
-                        res = RMOD_RESULT_BAD_XML;
-                        goto failed;
-                    }
-                    found_effect = true;
-                }
-                else if (COMPARE_STRING_SEGMENT_TO_LITERAL(failure, &child->name))
-                {
-                    //  Failure type of the block
-                    if (found_failure)
-                    {
-                        RMOD_WARN("Duplicate \"failure\" element was found in the element in \"block\" and will be ignored");
-                        continue;
-                    }
-                    if (COMPARE_CASE_STRING_SEGMENT_TO_LITERAL(normal, &child->value))
-                    {
-                        failure_type_v = RMOD_FAILURE_TYPE_ACCEPTABLE;
-                    }
-                    else if (COMPARE_CASE_STRING_SEGMENT_TO_LITERAL(critical, &child->value))
-                    {
-                        failure_type_v = RMOD_FAILURE_TYPE_CRITICAL;
-                    }
-                    else if (COMPARE_CASE_STRING_SEGMENT_TO_LITERAL(fatal, &child->value))
-                    {
-                        failure_type_v = RMOD_FAILURE_TYPE_FATAL;
-                    }
-                    else
-                    {
-                        RMOD_ERROR("Value of \"failure\" element was given as \"%.*s\", which is not a valid value", child->value.len, child->value.begin);
-                        res = RMOD_RESULT_BAD_XML;
-                        goto failed;
-                    }
-                    found_failure = true;
-                }
-                else if (COMPARE_STRING_SEGMENT_TO_LITERAL(cost, &child->name))
-                {
-                    //  Failure type of the block
-                    if (found_cost)
-                    {
-                        RMOD_WARN("Duplicate \"cost\" element was found in the element in \"block\" and will be ignored");
-                        continue;
-                    }
-                    if (child->value.len == 0)
-                    {
-                        RMOD_ERROR("Element \"cost\" in the element \"block\" was empty");
-                        res = RMOD_RESULT_BAD_XML;
-                        goto failed;
-                    }
-                    char* end_pos;
-                    cost_v = strtof(child->value.begin, &end_pos);
-                    if (end_pos != child->value.begin + child->value.len)
-                    {
-                        RMOD_ERROR("Value of \"cost\" was given as \"%.*s\" in the element \"block\", which is not allowed (only a single float can be given)", child->value.len, child->value.begin);
-                        res = RMOD_RESULT_BAD_XML;
-                        goto failed;
-                    }
-                    found_cost = true;
-                }
-                else
-                {
-                    RMOD_WARN("Unknown element \"%.*s\" was found in the element \"block\" and will be ignored", e->name.len, e->name.begin);
-                }
-            }
-
-            if (!found_name)
-            {
-                RMOD_ERROR("Element \"block\" did not include element \"name\"");
-            }
-            if (!found_mtbf)
+//  Starts one of chain's elements, which contains:
+//      - attribute "etype": "block" for a type of block and "chain" for type of chain
+//      - element "label": unique identifier of the element within the chain
+//      - optional element(s) "parent": identifies a parent of the block, can have many
+//      - optional element(s) "child": identifies a child of the block, can have many
+static rmod_result begin_chain_element(type_converter* const this, const rmod_xml_element* const child)
+{
+    RMOD_ENTER_FUNCTION;
+    rmod_result res;
+    bool found_etype = false;
+    rmod_element_type_value type_v = RMOD_ELEMENT_TYPE_NONE;
+    //  Process attributes
+    for (u32 k = 0; k < child->attrib_count; ++k)
+    {
+        const string_segment* a_name = child->attribute_names + k;
+        const string_segment* a_valu = child->attribute_values + k;
+        if (COMPARE_STRING_SEGMENT_TO_LITERAL(etype, a_name))
+        {
+            //  element's type can either be "block" or "chain"
+            if (found_etype)
             {
-                RMOD_ERROR("Element \"block\" did not include element \"mtbf\"");
+                RMOD_WARN("Duplicate \"etype\" attribute was found in the element in \"element\" and will be ignored");
+                continue;
             }
-            if (!found_mtbr)
+            if (a_valu->len == 0)
             {
-                RMOD_ERROR("Element \"block\" did not include element \"mtbr\"");
+                RMOD_ERROR("Attribute \"etype\" in the element \"element\" was empty");
+                res = RMOD_RESULT_BAD_XML;
+                goto failed;
             }
-            if (!found_effect)
+
+            if (COMPARE_STRING_SEGMENT_TO_LITERAL(block, a_valu))
             {
-                RMOD_ERROR("Element \"block\" did not include element \"effect\"");
+                type_v = RMOD_ELEMENT_TYPE_BLOCK;
             }
-            if (!found_failure)
+            else if (COMPARE_STRING_SEGMENT_TO_LITERAL(chain, a_valu))
             {
-                RMOD_ERROR("Element \"block\" did not include element \"failure\"");
+                type_v = RMOD_ELEMENT_TYPE_CHAIN;
             }
-            if (!found_cost)
+            else
             {
-                RMOD_ERROR("Element \"block\" did not include element \"cost\"");
+                RMOD_ERROR("Attribute \"etype\" may only have values of \"block\" or \"chain\", but had the value of \"%.*s\"", a_valu->len, a_valu->begin);
+                res = RMOD_RESULT_BAD_XML;
+                goto failed;
             }
 
-            if (!found_name || !found_mtbf || !found_effect || !found_failure || !found_cost || !found_mtbr)
+            found_etype = true;
+        }
+        else
+        {
+            RMOD_WARN("Unknown attribute \"%.*s\" was found in the element \"element\" and will be ignored", a_name->len, a_name->begin);
+        }
+
+    }
+    if (!found_etype)
+    {
+        RMOD_ERROR("Element \"element\" did not specify it's type with an attribute \"etype\"");
+        res = RMOD_RESULT_BAD_XML;
+        goto failed;
+    }
+    //  Get intermediate element
+    if (this->part_count == this->part_capacity)
+    {
+        const u64 new_capacity = this->part_capacity ? 2 * this->part_capacity : 64;
+        intermediate_element* const new_ptr = region_jrealloc(this->info, this->element_buffer, sizeof*new_ptr * this->part_capacity, sizeof*new_ptr * new_capacity);
+        if (!new_ptr)
+        {
+            RMOD_ERROR("Failed region_jrealloc(%p, %p, %zu)", this->info, this->element_buffer, sizeof*new_ptr * new_capacity);
+            res = RMOD_RESULT_NOMEM;
+            goto failed;
+        }
+        memset(new_ptr + this->part_count, 0, sizeof*new_ptr * (new_capacity - this->part_capacity));
+        this->element_buffer = new_ptr;
+        this->part_capacity = new_capacity;
+    }
+    intermediate_element* const element = this->element_buffer + (this->part_count++);
+    memset(element, 0, sizeof(*element));
+    element->type_value = type_v;
+    this->chain.in_element = true;
+    this->chain.found_type = false;
+    this->chain.found_label = false;
+
+    RMOD_LEAVE_FUNCTION;
+    return RMOD_RESULT_SUCCESS;
+failed:
+    RMOD_LEAVE_FUNCTION;
+    return res;
+}
+
+static rmod_result add_relation(
+        region_jallocator* const allocator, u32* const p_count, u32* const p_capacity, string_segment** const p_names,
+        const string_segment* const name)
+{
+    RMOD_ENTER_FUNCTION;
+    if (*p_count == *p_capacity)
+    {
+        //  Most elements have only a few relations
+        const u64 new_capacity = *p_capacity ? 2 * *p_capacity : 4;
+        string_segment* const new_ptr = region_jrealloc(allocator, *p_names, sizeof*new_ptr * *p_capacity, sizeof*new_ptr * new_capacity);
+        if (!new_ptr)
+        {
+            RMOD_ERROR("Failed region_jrealloc(%p, %p, %zu)", allocator, *p_names, sizeof*new_ptr * new_capacity);
+            RMOD_LEAVE_FUNCTION;
+            return RMOD_RESULT_NOMEM;
+        }
+        memset(new_ptr + *p_count, 0, sizeof*new_ptr * (new_capacity - *p_capacity));
+        *p_names = new_ptr;
+        *p_capacity = new_capacity;
+    }
+    (*p_names)[(*p_count)++] = *name;
+    RMOD_LEAVE_FUNCTION;
+    return RMOD_RESULT_SUCCESS;
+}
+
+//  Converts a child of chain's element "element"
+static rmod_result convert_element_component(type_converter* const this, const rmod_xml_element* const component)
+{
+    RMOD_ENTER_FUNCTION;
+    rmod_result res;
+    chain_definition* const chain = &this->chain;
+    intermediate_element* const element = this->element_buffer + (this->part_count - 1);
+    if (COMPARE_STRING_SEGMENT_TO_LITERAL(type, &component->name))
+    {
+        //  Element's type
+        if (chain->found_type)
+        {
+            RMOD_WARN("Duplicate \"type\" element was found in the element in \"element\" and will be ignored");
+            goto end;
+        }
+        if (component->value.len == 0)
+        {
+            RMOD_ERROR("Element \"type\" in the element \"element\" was empty");
+            res = RMOD_RESULT_BAD_XML;
+            goto failed;
+        }
+        element->type_name = component->value;
+        chain->found_type = true;
+    }
+    else if (COMPARE_STRING_SEGMENT_TO_LITERAL(label, &component->name))
+    {
+        //  Last element in the chain
+        if (chain->found_label)
+        {
+            RMOD_WARN("Duplicate \"label\" element was found in the element in \"element\" and will be ignored");
+            goto end;
+        }
+        //  Process attributes
+        for (u32 l = 0; l < component->attrib_count; ++l)
+        {
+            const string_segment* a_name = component->attribute_names + l;
+            RMOD_WARN("Unknown attribute \"%.*s\" was found in the element \"label\" and will be ignored", a_name->len, a_name->begin);
+        }
+        if (component->value.len == 0)
+        {
+            RMOD_ERROR("Element \"label\" in the element \"element\" was empty");
+            res = RMOD_RESULT_BAD_XML;
+            goto failed;
+        }
+
+        element->label = component->value;
+        chain->found_label = true;
+    }
+    else if (COMPARE_STRING_SEGMENT_TO_LITERAL(parent, &component->name))
+    {
+        //  A parent of the block
+
+        //  Process attributes
+        for (u32 l = 0; l < component->attrib_count; ++l)
+        {
+            const string_segment* a_name = component->attribute_names + l;
+            RMOD_WARN("Unknown attribute \"%.*s\" was found in the element \"parent\" and will be ignored", a_name->len, a_name->begin);
+        }
+        if (component->value.len == 0)
+        {
+            RMOD_ERROR("Element \"parent\" in the element \"element\" was empty");
+            res = RMOD_RESULT_BAD_XML;
+            goto failed;
+        }
+        if ((res = add_relation(this->scratch, &element->parent_count, &element->parent_capacity, &element->parent_names, &component->value)) != RMOD_RESULT_SUCCESS)
+        {
+            goto failed;
+        }
+    }
+    else if (COMPARE_STRING_SEGMENT_TO_LITERAL(child, &component->name))
+    {
+        //  A child of the block
+
+        //  Process attributes
+        for (u32 l = 0; l < component->attrib_count; ++l)
+        {
+            const string_segment* a_name = component->attribute_names + l;
+            RMOD_WARN("Unknown attribute \"%.*s\" was found in the element \"child\" and will be ignored", a_name->len, a_name->begin);
+        }
+        if (component->value.len == 0)
+        {
+            RMOD_ERROR("Element \"child\" in the element \"element\" was empty");
+            res = RMOD_RESULT_BAD_XML;
+            goto failed;
+        }
+        if ((res = add_relation(this->scratch, &element->child_count, &element->child_capacity, &element->child_names, &component->value)) != RMOD_RESULT_SUCCESS)
+        {
+            goto failed;
+        }
+    }
+    else
+    {
+        RMOD_WARN("Unknown element \"%.*s\" was found in the element \"element\" and will be ignored", component->name.len, component->name.begin);
+    }
+
+end:
+    RMOD_LEAVE_FUNCTION;
+    return RMOD_RESULT_SUCCESS;
+failed:
+    RMOD_LEAVE_FUNCTION;
+    return res;
+}
+
+//  Converts a child of the element "chain" once it is complete
+static rmod_result convert_chain_property(type_converter* const this, const rmod_xml_element* const child)
+{
+    RMOD_ENTER_FUNCTION;
+    rmod_result res;
+    chain_definition* const chain = &this->chain;
+    if (COMPARE_STRING_SEGMENT_TO_LITERAL(name, &child->name))
+    {
+        //  Name of the chain
+        if (chain->found_name)
+        {
+            RMOD_WARN("Duplicate \"name\" element was found in the element in \"chain\" and will be ignored");
+            goto end;
+        }
+        //  Process attributes
+        for (u32 k = 0; k < child->attrib_count; ++k)
+        {
+            const string_segment* a_name = child->attribute_names + k;
+            RMOD_WARN("Unknown attribute \"%.*s\" was found in the element \"name\" and will be ignored", a_name->len, a_name->begin);
+        }
+        if (child->value.len == 0)
+        {
+            RMOD_ERROR("Element \"name\" in the element \"chain\" was empty");
+            res = RMOD_RESULT_BAD_XML;
+            goto failed;
+        }
+        chain->name = child->value;
+        chain->found_name = true;
+    }
+    else if (COMPARE_STRING_SEGMENT_TO_LITERAL(first, &child->name))
+    {
+        //  First element in the chain
+        if (chain->found_first)
+        {
+            RMOD_WARN("Duplicate \"first\" element was found in the element in \"chain\" and will be ignored");
+            goto end;
+        }
+        //  Process attributes
+        for (u32 k = 0; k < child->attrib_count; ++k)
+        {
+            const string_segment* a_name = child->attribute_names + k;
+            RMOD_WARN("Unknown attribute \"%.*s\" was found in the element \"first\" and will be ignored", a_name->len, a_name->begin);
+        }
+        if (child->value.len == 0)
+        {
+            RMOD_ERROR("Element \"first\" in the element \"chain\" was empty");
+            res = RMOD_RESULT_BAD_XML;
+            goto failed;
+        }
+        chain->first = child->value;
+        chain->found_first = true;
+    }
+    else if (COMPARE_STRING_SEGMENT_TO_LITERAL(last, &child->name))
+    {
+        //  Last element in the chain
+        if (chain->found_last)
+        {
+            RMOD_WARN("Duplicate \"last\" element was found in the element in \"chain\" and will be ignored");
+            goto end;
+        }
+        //  Process attributes
+        for (u32 k = 0; k < child->attrib_count; ++k)
+        {
+            const string_segment* a_name = child->attribute_names + k;
+            RMOD_WARN("Unknown attribute \"%.*s\" was found in the element \"last\" and will be ignored", a_name->len, a_name->begin);
+        }
+        if (child->value.len == 0)
+        {
+            RMOD_ERROR("Element \"last\" in the element \"chain\" was empty");
+            res = RMOD_RESULT_BAD_XML;
+            goto failed;
+        }
+        chain->last = child->value;
+        chain->found_last = true;
+    }
+    else if (COMPARE_STRING_SEGMENT_TO_LITERAL(element, &child->name))
+    {
+        //  All children of the element were converted
+        chain->in_element = false;
+        if (!chain->found_label)
+        {
+            RMOD_ERROR("Element \"element\" did not contain element \"label\"");
+        }
+        if (!chain->found_type)
+        {
+            RMOD_ERROR("Element \"element\" did not contain element \"type\"");
+        }
+
+        if (!chain->found_type || !chain->found_label)
+        {
+            res = RMOD_RESULT_BAD_XML;
+            goto failed;
+        }
+    }
+    else
+    {
+        RMOD_WARN("Unknown element \"%.*s\" was found in the element \"chain\" and will be ignored", child->name.len, child->name.begin);
+    }
+
+end:
+    RMOD_LEAVE_FUNCTION;
+    return RMOD_RESULT_SUCCESS;
+failed:
+    RMOD_LEAVE_FUNCTION;
+    return res;
+}
+
+static void release_intermediate_elements(type_converter* const this)
+{
+    region_jallocator_reset(this->scratch);
+    this->part_count = 0;
+}
+
+//  Converts intermediate elements of the chain into its final form and adds it
+static rmod_result finish_chain(type_converter* const this)
+{
+    RMOD_ENTER_FUNCTION;
+    rmod_result res;
+    const chain_definition* const chain = &this->chain;
+    const string_segment* const name_ptr = &chain->name;
+    const u32 part_count = this->part_count;
+    const intermediate_element* const element_buffer = this->element_buffer;
+    //  Labels of elements of the chain
+    rmod_string_table label_table = {0};
+    rmod_chain_element* chain_elements = NULL;
+    element_type_name* element_types = NULL;
+    if (!chain->found_name)
+    {
+        RMOD_ERROR("There was not element \"name\" in element \"chain\"");
+    }
+    if (!chain->found_first)
+    {
+        RMOD_ERROR("There was not element \"first\" in element \"chain\"");
+    }
+    if (!chain->found_last)
+    {
+        RMOD_ERROR("There was not element \"last\" in element \"chain\"");
+    }
+    if (part_count == 0)
+    {
+        RMOD_ERROR("There was not element \"element\" in element \"chain\"");
+    }
+
+    if (!chain->found_name || !chain->found_first || !chain->found_last || part_count == 0)
+    {
+        res = RMOD_RESULT_BAD_XML;
+        goto failed;
+    }
+    const u32 chain_element_count = part_count;
+    chain_elements = region_jalloc(this->allocator, sizeof*chain_elements * part_count);
+    if (!chain_elements)
+    {
+        RMOD_ERROR("Failed region_jalloc(%p, %zu)", this->allocator, sizeof*chain_elements * part_count);
+        res = RMOD_RESULT_NOMEM;
+        goto failed;
+    }
+    memset(chain_elements, 0, sizeof*chain_elements * part_count);
+    element_types = region_jalloc(this->info, sizeof*element_types * part_count);
+    if (!element_types)
+    {
+        RMOD_ERROR("Failed region_jalloc(%p, %zu)", this->info, sizeof*element_types * part_count);
+        res = RMOD_RESULT_NOMEM;
+        goto failed;
+    }
+
+    //  Make sure each part has a unique label, so that they can be looked up by it
+    if ((res = rmod_string_table_create_in_region(this->scratch, part_count, &label_table)) != RMOD_RESULT_SUCCESS)
+    {
+        RMOD_ERROR("Failed creating table of labels, reason: %s", rmod_result_str(res));
+        goto failed;
+    }
+    for (u32 j = 0; j < part_count; ++j)
+    {
+        u32 existing_id;
+        if ((res = rmod_string_table_insert(&label_table, &element_buffer[j].label, j, &existing_id)) != RMOD_RESULT_SUCCESS)
+        {
+            goto failed;
+        }
+        if (existing_id != j)
+        {
+            RMOD_ERROR("Label \"%.*s\" appears twice in chain \"%.*s\"", element_buffer[j].label.len, element_buffer[j].label.begin, name_ptr->len, name_ptr->begin);
+            res = RMOD_RESULT_BAD_XML;
+            goto failed;
+        }
+    }
+    u32 first_v, last_v;
+    if (!rmod_string_table_find(&label_table, &chain->first, &first_v))
+    {
+        RMOD_ERROR("First element of chain \"%.*s\" with label \"%.*s\" was not found", name_ptr->len, name_ptr->begin, chain->first.len, chain->first.begin);
+        res = RMOD_RESULT_BAD_XML;
+        goto failed;
+    }
+    if (!rmod_string_table_find(&label_table, &chain->last, &last_v))
+    {
+        RMOD_ERROR("Last element of chain \"%.*s\" with label \"%.*s\" was not found", name_ptr->len, name_ptr->begin, chain->last.len, chain->last.begin);
+        res = RMOD_RESULT_BAD_XML;
+        goto failed;
+    }
+
+    //  Now begin conversion
+    for (u32 j = 0; j < part_count; ++j)
+    {
+        rmod_chain_element* const out = chain_elements + j;
+        const intermediate_element* const this_part = element_buffer + j;
+
+        //  Process parents
+        if (this_part->parent_count)
+        {
+            ptrdiff_t* const parents = region_jalloc(this->allocator, sizeof*parents * this_part->parent_count);
+            if (!parents)
             {
-                RMOD_ERROR("Element \"block\" was not complete");
-                res = RMOD_RESULT_BAD_XML;
+                RMOD_ERROR("Failed region_jalloc(%p, %zu)", this->allocator, sizeof*parents * this_part->parent_count);
+                res = RMOD_RESULT_NOMEM;
                 goto failed;
             }
-            //  Check that name is not yet taken
-            for (u32 j = 0; j < type_count; ++j)
+            out->parents = parents;
+            out->parent_count = this_part->parent_count;
+            //  Match parents
+            for (u32 k = 0; k < this_part->parent_count; ++k)
             {
-                if (compare_string_segments(&types[j].header.type_name, &name_v))
+                const string_segment* parent_name = this_part->parent_names + k;
+                u32 l;
+                if (rmod_string_table_find(&label_table, parent_name, &l))
                 {
-                    RMOD_ERROR("Block/chain type \"%.*s\" was already defined", name_v.len, name_v.begin);
-                    goto failed;
+                    parents[k] = l;
                 }
-            }
-            //  Block can now be put in the type array
-            if (type_count == type_capacity)
-            {
-                const u32 new_capacity = type_capacity + 32;
-                rmod_element_type* const new_ptr = jrealloc(types, sizeof(*new_ptr) * new_capacity);
-                if (!new_ptr)
+                else
                 {
-                    RMOD_ERROR("Failed jrealloc(%p, %zu)", types, sizeof(*new_ptr) * new_capacity);
-                    res = RMOD_RESULT_NOMEM;
+                    RMOD_ERROR("Element with label \"%.*s\" had a parent \"%.*s\", which was not found", this_part->label.len, this_part->label.begin, parent_name->len, parent_name->begin);
+                    res = RMOD_RESULT_BAD_XML;
                     goto failed;
                 }
-                memset(new_ptr + type_count, 0, sizeof(*new_ptr) * (new_capacity - type_capacity));
-                types = new_ptr;
-                type_capacity = new_capacity;
             }
-            types[type_count++] = (rmod_element_type)
-                    {
-                    .block =
-                        {
-                        .header = { .type_value = RMOD_ELEMENT_TYPE_BLOCK, .type_name = name_v },
-                        .effect = effect_v,
-                        .failure_type = failure_type_v,
-                        .mtbf = mtbf_v,
-                        .mtbr = mtbr_v,
-                        .cost = cost_v,
-                        }
-                    };
         }
-        else if (COMPARE_STRING_SEGMENT_TO_LITERAL(chain, &e->name))
+        else if (j != first_v)
         {
-            assert(part_count == 0);
-            //  This is a chain type definition
-            bool found_name = false, found_first = false, found_last = false;
-            const string_segment* name_ptr = NULL;
-            const string_segment* str_first = NULL;
-            const string_segment* str_last = NULL;
-            memset(element_buffer, 0xCC, sizeof(*element_buffer) * part_capacity);
-            u32 first_v = -1, last_v = -1;
-            //  Process attributes
-            for (u32 k = 0; k < e->attrib_count; ++k)
-            {
-                const string_segment* a_name = e->attribute_names + k;
-                const string_segment* a_valu = e->attribute_values + k;
-                {
-                    RMOD_WARN("Unknown attribute \"%.*s\" was found in the element \"chain\" and will be ignored", a_name->len, a_name->begin);
-                }
+            RMOD_ERROR("Element with label \"%.*s\" specified no parents, but was not the beginning of the chain", this_part->label.len, this_part->label.begin);
+            res = RMOD_RESULT_BAD_XML;
+            goto failed;
+        }
 
+        //  Process children
+        if (this_part->child_count)
+        {
+            ptrdiff_t* const children = region_jalloc(this->allocator, sizeof*children * this_part->child_count);
+            if (!children)
+            {
+                RMOD_ERROR("Failed region_jalloc(%p, %zu)", this->allocator, sizeof*children * this_part->child_count);
+                res = RMOD_RESULT_NOMEM;
+                goto failed;
             }
-            //  Process the children
-            for (u32 j = 0; j < e->child_count; ++j)
+            out->children = children;
+            out->child_count = this_part->child_count;
+            //  Match children
+            for (u32 k = 0; k < this_part->child_count; ++k)
             {
-                const rmod_xml_element* child = e->children + j;
-                if (COMPARE_STRING_SEGMENT_TO_LITERAL(name, &child->name))
-                {
-                    //  Name of the chain
-                    if (found_name)
-                    {
-                        RMOD_WARN("Duplicate \"name\" element was found in the element in \"chain\" and will be ignored");
-                        continue;
-                    }
-                    //  Process attributes
-                    for (u32 k = 0; k < child->attrib_count; ++k)
-                    {
-                        const string_segment* a_name = child->attribute_names + k;
-                        const string_segment* a_valu = child->attribute_values + k;
-                        {
-                            RMOD_WARN("Unknown attribute \"%.*s\" was found in the element \"name\" and will be ignored", a_name->len, a_name->begin);
-                        }
-
-                    }
-                    if (child->value.len == 0)
-                    {
-                        RMOD_ERROR("Element \"name\" in the element \"chain\" was empty");
-                        res = RMOD_RESULT_BAD_XML;
-                        goto failed;
-                    }
-                    name_ptr = &child->value;
-                    found_name = true;
-                }
-                else if (COMPARE_STRING_SEGMENT_TO_LITERAL(first, &child->name))
-                {
-                    //  Name of the chain
-                    if (found_first)
-                    {
-                        RMOD_WARN("Duplicate \"first\" element was found in the element in \"chain\" and will be ignored");
-                        continue;
-                    }
-                    //  Process attributes
-                    for (u32 k = 0; k < child->attrib_count; ++k)
-                    {
-                        const string_segment* a_name = child->attribute_names + k;
-                        const string_segment* a_valu = child->attribute_values + k;
-                        {
-                            RMOD_WARN("Unknown attribute \"%.*s\" was found in the element \"element\" and will be ignored", a_name->len, a_name->begin);
-                        }
-
-                    }
-                    if (child->value.len == 0)
-                    {
-                        RMOD_ERROR("Element \"first\" in the element \"chain\" was empty");
-                        res = RMOD_RESULT_BAD_XML;
-                        goto failed;
-                    }
-                    str_first = &child->value;
-                    found_first = true;
-                }
-                else if (COMPARE_STRING_SEGMENT_TO_LITERAL(last, &child->name))
-                {
-                    //  Last element in the chain
-                    if (found_last)
-                    {
-                        RMOD_WARN("Duplicate \"first\" element was found in the element in \"chain\" and will be ignored");
-                        continue;
-                    }
-                    //  Process attributes
-                    for (u32 k = 0; k < child->attrib_count; ++k)
-                    {
-                        const string_segment* a_name = child->attribute_names + k;
-                        const string_segment* a_valu = child->attribute_values + k;
-                        {
-                            RMOD_WARN("Unknown attribute \"%.*s\" was found in the element \"element\" and will be ignored", a_name->len, a_name->begin);
-                        }
-
-                    }
-                    if (child->value.len == 0)
-                    {
-                        RMOD_ERROR("Element \"last\" in the element \"chain\" was empty");
-                        res = RMOD_RESULT_BAD_XML;
-                        goto failed;
-                    }
-                    str_last = &child->value;
-                    found_last = true;
-                }
-                else if (COMPARE_STRING_SEGMENT_TO_LITERAL(element, &child->name))
+                const string_segment* child_name = this_part->child_names + k;
+                u32 l;
+                if (rmod_string_table_find(&label_table, child_name, &l))
                 {
-                    //  One of chain's elements, contains:
-                    //      - attribute "etype": "block" for a type of block and "chain" for type of chain
-                    //      - element "label": unique identifier of the element within the chain
-                    //      - optional element(s) "parent": identifies a parent of the block, can have many
-                    //      - optional element(s) "child": identifies a child of the block, can have many
-                    bool found_type = false, found_label = false, found_etype = false;
-                    element_type_id type_id = -1;
-                    const string_segment* label_v;
-                    rmod_element_type_value type_v;
-                    //  Process attributes
-                    for (u32 k = 0; k < child->attrib_count; ++k)
-                    {
-                        const string_segment* a_name = child->attribute_names + k;
-                        const string_segment* a_valu = child->attribute_values + k;
-                        if (COMPARE_STRING_SEGMENT_TO_LITERAL(etype, a_name))
-                        {
-                            //  element's type can either be "block" or "chain"
-                            if (found_etype)
-                            {
-                                RMOD_WARN("Duplicate \"etype\" attribute was found in the element in \"element\" and will be ignored");
-                                continue;
-                            }
-                            if (a_valu->len == 0)
-                            {
-                                RMOD_ERROR("Attribute \"etype\" in the element \"element\" was empty");
-                                res = RMOD_RESULT_BAD_XML;
-                                goto failed;
-                            }
-
-                            if (COMPARE_STRING_SEGMENT_TO_LITERAL(block, a_valu))
-                            {
-                                type_v = RMOD_ELEMENT_TYPE_BLOCK;
-                            }
-                            else if (COMPARE_STRING_SEGMENT_TO_LITERAL(chain, a_valu))
-                            {
-                                type_v = RMOD_ELEMENT_TYPE_CHAIN;
-                            }
-                            else
-                            {
-                                RMOD_ERROR("Attribute \"etype\" may only have values of \"block\" or \"chain\", but had the value of \"%.*s\"", a_valu->len, a_valu->begin);
-                                res = RMOD_RESULT_BAD_XML;
-                                goto failed;
-                            }
-
-                            found_etype = true;
-                        }
-                        else
-                        {
-                            RMOD_WARN("Unknown attribute \"%.*s\" was found in the element \"element\" and will be ignored", a_name->len, a_name->begin);
-                        }
-
-                    }
-                    if (!found_etype)
-                    {
-                        RMOD_ERROR("Element \"element\" did not specify it's type with an attribute \"etype\"");
-                        res = RMOD_RESULT_BAD_XML;
-                        goto failed;
-                    }
-                    //  Get intermediate element
-                    if (part_count == part_capacity)
-                    {
-                        const u64 new_capacity = part_capacity + 64;
-                        intermediate_element* const new_ptr = jrealloc(element_buffer, sizeof*new_ptr * new_capacity);
-                        if (!new_ptr)
-                        {
-                            RMOD_ERROR("Failed jrealloc(%p, %zu)", element_buffer, sizeof*new_ptr * new_capacity);
-                            res = RMOD_RESULT_NOMEM;
-                            goto failed;
-                        }
-                        memset(new_ptr + part_count, 0, sizeof*new_ptr * (new_capacity - part_capacity));
-                        element_buffer = new_ptr;
-                        part_capacity = new_capacity;
-                    }
-
-                    intermediate_element* const this = element_buffer + (part_count++);
-                    memset(this, 0, sizeof(*this));
-                    //  process children of "element"
-                    for (u32 k = 0; k < child->child_count; ++k)
-                    {
-                        const rmod_xml_element* component = child->children + k;
-                        if (COMPARE_STRING_SEGMENT_TO_LITERAL(type, &component->name))
-                        {
-                            //  Element's type
-                            if (found_type)
-                            {
-                                RMOD_WARN("Duplicate \"type\" element was found in the element in \"element\" and will be ignored");
-                                continue;
-                            }
-                            if (component->value.len == 0)
-                            {
-                                RMOD_ERROR("Element \"type\" in the element \"element\" was empty");
-                                res = RMOD_RESULT_BAD_XML;
-                                goto failed;
-                            }
-
-                            for (u32 l = 0; l < type_count && !found_type; ++l)
-                            {
-                                const rmod_element_type* type = types + l;
-                                if (type->header.type_value != type_v)
-                                {
-                                    continue;
-                                }
-                                switch (type->header.type_value)
-                                {
-                                case RMOD_ELEMENT_TYPE_BLOCK:
-                                    if (compare_string_segments(&type->header.type_name, &component->value))
-                                    {
-                                        type_id = l;
-                                        found_type = true;
-                                    }
-                                    break;
-                                case RMOD_ELEMENT_TYPE_CHAIN:
-                                    if (compare_string_segments(&type->header.type_name, &component->value))
-                                    {
-                                        type_id = l;
-                                        found_type = true;
-                                    }
-                                    break;
-                                default:
-                                    RMOD_ERROR("Invalid type enum value for type %s - %i", type->header.type_name, types->header);
-                                    res = RMOD_RESULT_BAD_XML;
-                                    goto failed;
-                                }
-                            }
-
-                            if (!found_type)
-                            {
-                                RMOD_ERROR("%s of type \"%.*s\" is not defined", type_v == RMOD_ELEMENT_TYPE_CHAIN ? "Chain" : "Block", component->value.len, component->value.begin);
-                                res = RMOD_RESULT_BAD_XML;
-                                goto failed;
-                            }
-                        }
-                        else if (COMPARE_STRING_SEGMENT_TO_LITERAL(label, &component->name))
-                        {
-                            //  Last element in the chain
-                            if (found_label)
-                            {
-                                RMOD_WARN("Duplicate \"label\" element was found in the element in \"element\" and will be ignored");
-                                continue;
-                            }
-                            //  Process attributes
-                            for (u32 l = 0; l < component->attrib_count; ++k)
-                            {
-                                const string_segment* a_name = component->attribute_names + k;
-                                const string_segment* a_valu = component->attribute_values + k;
-                                {
-                                    RMOD_WARN("Unknown attribute \"%.*s\" was found in the element \"label\" and will be ignored", a_name->len, a_name->begin);
-                                }
-                            }
-                            if (component->value.len == 0)
-                            {
-                                RMOD_ERROR("Element \"label\" in the element \"element\" was empty");
-                                res = RMOD_RESULT_BAD_XML;
-                                goto failed;
-                            }
-
-                            label_v = &component->value;
-                            found_label = true;
-                        }
-                        else if (COMPARE_STRING_SEGMENT_TO_LITERAL(parent, &component->name))
-                        {
-                            //  A parent of the block
-
-                            //  Process attributes
-                            for (u32 l = 0; l < component->attrib_count; ++k)
-                            {
-                                const string_segment* a_name = component->attribute_names + k;
-                                const string_segment* a_valu = component->attribute_values + k;
-                                {
-                                    RMOD_WARN("Unknown attribute \"%.*s\" was found in the element \"label\" and will be ignored", a_name->len, a_name->begin);
-                                }
-                            }
-                            if (component->value.len == 0)
-                            {
-                                RMOD_ERROR("Element \"parent\" in the element \"element\" was empty");
-                                res = RMOD_RESULT_BAD_XML;
-                                goto failed;
-                            }
-                            if (this->parent_count == this->parent_capacity)
-                            {
-                                const u64 new_capacity = this->parent_capacity + 64;
-                                const string_segment** const new_ptr = jrealloc(this->parent_names, sizeof*new_ptr * new_capacity);
-                                if (!new_ptr)
-                                {
-                                    RMOD_ERROR("Failed jrealloc(%p, %zu)", this->parent_names, sizeof*new_ptr * new_capacity);
-                                    res = RMOD_RESULT_NOMEM;
-                                    goto failed;
-                                }
-                                memset(new_ptr + this->parent_count, 0, sizeof*new_ptr * (new_capacity - this->parent_capacity));
-                                this->parent_names = new_ptr;
-                                this->parent_capacity = new_capacity;
-                            }
-                            this->parent_names[this->parent_count++] = &component->value;
-                        }
-                        else if (COMPARE_STRING_SEGMENT_TO_LITERAL(child, &component->name))
-                        {
-                            //  A child of the block
-
-                            //  Process attributes
-                            for (u32 l = 0; l < component->attrib_count; ++k)
-                            {
-                                const string_segment* a_name = component->attribute_names + k;
-                                const string_segment* a_valu = component->attribute_values + k;
-                                {
-                                    RMOD_WARN("Unknown attribute \"%.*s\" was found in the element \"label\" and will be ignored", a_name->len, a_name->begin);
-                                }
-                            }
-                            if (component->value.len == 0)
-                            {
-                                RMOD_ERROR("Element \"parent\" in the element \"element\" was empty");
-                                res = RMOD_RESULT_BAD_XML;
-                                goto failed;
-                            }
-                            if (this->child_count == this->child_capacity)
-                            {
-                                const u64 new_capacity = this->child_capacity + 64;
-                                const string_segment** const new_ptr = jrealloc(this->child_names, sizeof*new_ptr * new_capacity);
-                                if (!new_ptr)
-                                {
-                                    RMOD_ERROR("Failed jrealloc(%p, %zu)", this->child_names, sizeof*new_ptr * new_capacity);
-                                    res = RMOD_RESULT_NOMEM;
-                                    goto failed;
-                                }
-                                memset(new_ptr + this->child_count, 0, sizeof*new_ptr * (new_capacity - this->child_capacity));
-                                this->child_names = new_ptr;
-                                this->child_capacity = new_capacity;
-                            }
-                            this->child_names[this->child_count++] = &component->value;
-                        }
-                        else
-                        {
-                            RMOD_WARN("Unknown element \"%.*s\" was found in the element \"element\" and will be ignored", e->name.len, e->name.begin);
-                        }
-                    }
-                    if (!found_label)
-                    {
-                        RMOD_ERROR("Element \"element\" did not contain element \"label\"");
-                    }
-                    if (!found_type)
-                    {
-                        RMOD_ERROR("Element \"element\" did not contain element \"type\"");
-                    }
-
-                    if (!found_type || !found_label)
-                    {
-                        res = RMOD_RESULT_BAD_XML;
-                        goto failed;
-                    }
-                    this->label = label_v;
-                    assert(type_id != -1);
-                    this->type_id = type_id;
+                    children[k] = l;
                 }
                 else
                 {
-                    RMOD_WARN("Unknown element \"%.*s\" was found in the element \"chain\" and will be ignored", e->name.len, e->name.begin);
+                    RMOD_ERROR("Element with label \"%.*s\" had a child \"%.*s\", which was not found", this_part->label.len, this_part->label.begin, child_name->len, child_name->begin);
+                    res = RMOD_RESULT_BAD_XML;
+                    goto failed;
                 }
             }
-            //  Now convert intermediate elements into proper form
-            //  Make sure there's enough space for all of them
+        }
+        else if (j != last_v)
+        {
+            RMOD_ERROR("Element with label \"%.*s\" specified no children, but was not the end of the chain", this_part->label.len, this_part->label.begin);
+            res = RMOD_RESULT_BAD_XML;
+            goto failed;
+        }
 
-            for (u32 j = 0; j < type_count; ++j)
+        out->label = this_part->label;
+        out->id = j;
+        element_types[j] = (element_type_name){.name = this_part->type_name, .type_value = this_part->type_value};
+    }
+    //  Ensure that there is correspondence between children and parents
+    for (u32 j = 0; j < chain_element_count; ++j)
+    {
+        const rmod_chain_element* element = chain_elements + j;
+        //  Check children
+        for (u32 k = 0; k < element->child_count; ++k)
+        {
+            bool was_found = false;
+            const rmod_chain_element* child_element = chain_elements + element->children[k];
+            for (u32 l = 0; l < child_element->parent_count; ++l)
             {
-                if (compare_string_segments(&types[j].header.type_name, name_ptr))
+                if (child_element->parents[l] == j)
                 {
-                    RMOD_ERROR("Block/chain type \"%.*s\" was already defined", name_ptr->len, name_ptr->begin);
-                    goto failed;
+                    was_found = true;
+                    break;
                 }
             }
-            const u32 chain_element_count = part_count;
-            rmod_chain_element* const chain_elements = jalloc(sizeof*chain_elements * part_count);
-            if (!chain_elements)
-            {
-                RMOD_ERROR("Failed jalloc(%zu)", sizeof*chain_elements * part_count);
-                res = RMOD_RESULT_NOMEM;
-                goto failed;
-            }
-            //  First make sure each part has a unique name
-            if ((res = confirm_unique_labels(element_buffer, part_count)))
+            if (!was_found)
             {
-                RMOD_ERROR("Not all elements in charin \"%.*s\" have unique labels", name_ptr->len, name_ptr->begin);
+                RMOD_ERROR("Element with label \"%.*s\" is not specified as parent of one of its children with label \"%.*s\"", element->label.len, element->label.begin, child_element->label.len, child_element->label.begin);
+                res = RMOD_RESULT_BAD_XML;
                 goto failed;
             }
-
-            if (!found_name)
-            {
-                RMOD_ERROR("There was not element \"name\" in element \"chain\"");
-            }
-            if (!found_first)
-            {
-                RMOD_ERROR("There was not element \"first\" in element \"chain\"");
-            }
-            if (!found_last)
-            {
-                RMOD_ERROR("There was not element \"last\" in element \"chain\"");
-            }
-            if (part_count == 0)
+        }
+        //  Check parents
+        for (u32 k = 0; k < element->parent_count; ++k)
+        {
+            bool was_found = false;
+            const rmod_chain_element* parent_element = chain_elements + element->parents[k];
+            for (u32 l = 0; l < parent_element->child_count; ++l)
             {
-                RMOD_ERROR("There was not element \"element\" in element \"chain\"");
+                if (parent_element->children[l] == j)
+                {
+                    was_found = true;
+                    break;
+                }
             }
-
-            if (!found_name || !found_first || !found_last || part_count == 0)
+            if (!was_found)
             {
+                RMOD_ERROR("Element with label \"%.*s\" is not specified as child of one of its parents with label \"%.*s\"", element->label.len, element->label.begin, parent_element->label.len, parent_element->label.begin);
                 res = RMOD_RESULT_BAD_XML;
                 goto failed;
             }
+        }
+    }
+    //  Ensure the chain is non-cyclical
+    if ((res = check_flow(this->scratch, name_ptr, chain_elements, chain_element_count, first_v, last_v)) != RMOD_RESULT_SUCCESS)
+    {
+        goto failed;
+    }
+
+    //  Convert block relation (parent & child) into relative offsets. This allows for easier merging of chains
+    u32 name_byte_count = 0;
+    for (u32 j = 0; j < chain_element_count; ++j)
+    {
+        const rmod_chain_element* element = chain_elements + j;
+        for (u32 k = 0; k < element->child_count; ++k)
+        {
+            element->children[k] -= j;
+        }
+        for (u32 k = 0; k < element->parent_count; ++k)
+        {
+            element->parents[k] -= j;
+        }
+        name_byte_count += element->label.len;
+    }
 
-            //  Now begin conversion
-            for (u32 j = 0; j < part_count; ++j)
+    //  Chain was now parsed insert it into the type array
+    const model_type type =
             {
-                rmod_chain_element* const out = chain_elements + j;
-                const intermediate_element* const this = element_buffer + j;
-                //  Check if it matches the first or last
-                if (first_v == -1)
+            .type.chain =
                 {
-                    if (compare_string_segments(str_first, this->label))
-                    {
-                        found_first = true;
-                        first_v = j;
-                    }
-                }
-                if (last_v == -1)
-                {
-                    if (compare_string_segments(str_last, this->label))
-                    {
-                        found_last = true;
-                        last_v = j;
-                    }
-                }
+                .header = { .type_value = RMOD_ELEMENT_TYPE_CHAIN, .type_name = *name_ptr },
+                .chain_elements = chain_elements,
+                .element_count = chain_element_count,
+                .i_first = first_v,
+                .i_last = last_v,
+                .compiled = false,
+                .name_buffer = NULL,
+                .name_bytes_total = name_byte_count,
+                },
+            .element_types = element_types,
+            };
+    if ((res = add_type(this, &type)) != RMOD_RESULT_SUCCESS)
+    {
+        goto failed;
+    }
+    rmod_string_table_destroy(&label_table);
+    release_intermediate_elements(this);
+    RMOD_LEAVE_FUNCTION;
+    return RMOD_RESULT_SUCCESS;
 
-                //  Process parents
-                if (this->parent_count)
-                {
-                    ptrdiff_t* const parents = jalloc(sizeof*parents * this->parent_count);
-                    if (!parents)
-                    {
-                        RMOD_ERROR("Failed jalloc(%zu)", sizeof*parents * this->parent_count);
-                        jfree(chain_elements);
-                        res = RMOD_RESULT_NOMEM;
-                        goto failed;
-                    }
-                    //  Match parents
-                    for (u32 k = 0; k < this->parent_count; ++k)
-                    {
-                        const string_segment* parent_name = this->parent_names[k];
-                        u32 l;
-                        for (l = 0; l < part_count; ++l)
-                        {
-                            if (compare_string_segments(parent_name, element_buffer[l].label))
-                            {
-                                parents[k] = l;
-                                break;
-                            }
-                        }
-                        if (l == part_count)
-                        {
-                            RMOD_ERROR("Element with label \"%.*s\" had a parent \"%.*s\", which was not found", this->label->len, this->label->begin, parent_name->len, parent_name->begin);
-                            res = RMOD_RESULT_BAD_XML;
-                            jfree(chain_elements);
-                            goto failed;
-                        }
-                    }
-                    out->parents = parents;
-                    out->parent_count = this->parent_count;
-                }
-                else
-                {
-                    if (j != first_v)
-                    {
-                        RMOD_ERROR("Element with label \"%.*s\" specified no parents, but was not the beginning of the chain", this->label->len, this->label->begin);
-                        res = RMOD_RESULT_BAD_XML;
-                        jfree(chain_elements);
-                        goto failed;
-                    }
-                    out->parent_count = 0;
-                    out->parents = NULL;
-                }
+failed:
+    rmod_string_table_destroy(&label_table);
+    release_intermediate_elements(this);
+    RMOD_LEAVE_FUNCTION;
+    return res;
+}
 
-                //  Process children
-                if (this->child_count)
-                {
-                    ptrdiff_t* const children = jalloc(sizeof*children * this->child_count);
-                    if (!children)
-                    {
-                        RMOD_ERROR("Failed jalloc(%zu)", sizeof*children * this->child_count);
-                        jfree(chain_elements);
-                        res = RMOD_RESULT_NOMEM;
-                        goto failed;
-                    }
-                    //  Match parents
-                    for (u32 k = 0; k < this->child_count; ++k)
-                    {
-                        const string_segment* child_name = this->child_names[k];
-                        u32 l;
-                        for (l = 0; l < part_count; ++l)
-                        {
-                            if (compare_string_segments(child_name, element_buffer[l].label))
-                            {
-                                children[k] = l;
-                                break;
-                            }
-                        }
-                        if (l == part_count)
-                        {
-                            RMOD_ERROR("Element with label \"%.*s\" had a child \"%.*s\", which was not found", this->label->len, this->label->begin, child_name->len, child_name->begin);
-                            res = RMOD_RESULT_BAD_XML;
-                            jfree(chain_elements);
-                            goto failed;
-                        }
-                    }
-                    out->children = children;
-                    out->child_count = this->child_count;
-                }
-                else
-                {
-                    if (j != last_v)
-                    {
-                        RMOD_ERROR("Element with label \"%.*s\" specified no children, but was not the end of the chain", this->label->len, this->label->begin);
-                        jfree(chain_elements);
-                        res = RMOD_RESULT_BAD_XML;
-                        goto failed;
-                    }
-                    out->child_count = 0;
-                    out->children = NULL;
-                }
+//  Include tag: value is the name of the file, relative to the directory of the including file unless it is absolute.
+//  Only its real path is found here, the file itself is loaded together with the other files included by the same wave
+static rmod_result convert_include(type_converter* const this, const string_segment* const value)
+{
+    RMOD_ENTER_FUNCTION;
+    rmod_result res;
+    model_file* const file = this->file;
+    if (value->len == 0)
+    {
+        RMOD_ERROR("Element \"include\" was empty");
+        res = RMOD_RESULT_BAD_XML;
+        goto end;
+    }
+    //  Directory of the including file is the part of its real path up to the last separator
+    const char* separator = strrchr(file->path, '/');
+#ifdef _WIN32
+    const char* const backslash = strrchr(file->path, '\\');
+    if (backslash > separator)
+    {
+        separator = backslash;
+    }
+#endif
+    const u64 dir_len = value->begin[0] == '/' || !separator ? 0 : separator - file->path + 1;
+    char* const name_buffer = region_jalloc(this->info, dir_len + value->len + 1);
+    if (!name_buffer)
+    {
+        RMOD_ERROR("Failed region_jalloc(%p, %zu)", this->info, dir_len + value->len + 1);
+        res = RMOD_RESULT_NOMEM;
+        goto end;
+    }
+    memcpy(name_buffer, file->path, dir_len);
+    memcpy(name_buffer + dir_len, value->begin, value->len);
+    name_buffer[dir_len + value->len] = 0;
+
+    char* const buffer = region_jalloc(this->info, PATH_MAX);
+    if (!buffer)
+    {
+        RMOD_ERROR("Failed region_jalloc(%p, %zu)", this->info, (size_t)PATH_MAX);
+        res = RMOD_RESULT_NOMEM;
+        goto end;
+    }
+#ifndef _WIN32
+    if (!realpath(name_buffer, buffer))
+#else
+    if (!GetFullPathNameA(name_buffer, PATH_MAX, buffer, NULL))
+#endif
+    {
+        RMOD_ERROR("Could not find real path of file \"%s\" included by \"%s\", reason: %s", name_buffer, file->path, RMOD_ERRNO_MESSAGE);
+        res = RMOD_RESULT_BAD_PATH;
+        goto end;
+    }
+
+    if (file->include_count == file->include_capacity)
+    {
+        const u32 new_capacity = file->include_capacity ? 2 * file->include_capacity : 4;
+        model_include* const new_ptr = region_jrealloc(this->info, file->includes, sizeof(*new_ptr) * file->include_capacity, sizeof(*new_ptr) * new_capacity);
+        if (!new_ptr)
+        {
+            RMOD_ERROR("Failed region_jrealloc(%p, %p, %zu)", this->info, file->includes, sizeof(*new_ptr) * new_capacity);
+            res = RMOD_RESULT_NOMEM;
+            goto end;
+        }
+        file->includes = new_ptr;
+        file->include_capacity = new_capacity;
+    }
+    file->includes[file->include_count++] = (model_include){.position = file->type_count, .path = buffer};
+    file->structure_hash = hash_bytes(file->structure_hash, &file->type_count, sizeof(file->type_count));
+    file->structure_hash = hash_bytes(file->structure_hash, buffer, strlen(buffer) + 1);
+    res = RMOD_RESULT_SUCCESS;
+
+end:
+    RMOD_LEAVE_FUNCTION;
+    return res;
+}
+
+static rmod_result converter_begin_element(void* param, u32 depth, const rmod_xml_element* e)
+{
+    RMOD_ENTER_FUNCTION;
+    type_converter* const this = param;
+    rmod_result res = RMOD_RESULT_SUCCESS;
+    switch (depth)
+    {
+    case 0:
+        if (!COMPARE_STRING_SEGMENT_TO_LITERAL(rmod, &e->name))
+        {
+            RMOD_ERROR("xml's root tag was not \"rmod\" but was \"%.*s\"", e->name.len, e->name.begin);
+            res = RMOD_RESULT_BAD_XML;
+        }
+        break;
+    case 1:
+        //  Children of the root are "block", "chain", and "include" elements
+        if (COMPARE_STRING_SEGMENT_TO_LITERAL(block, &e->name))
+        {
+            //  This is a block type definition
+            this->definition = DEFINITION_BLOCK;
+            memset(&this->block, 0, sizeof(this->block));
+            for (u32 k = 0; k < e->attrib_count; ++k)
+            {
+                const string_segment* a_name = e->attribute_names + k;
+                RMOD_WARN("Unknown attribute \"%.*s\" was found in the element \"block\" and will be ignored", a_name->len, a_name->begin);
+            }
+        }
+        else if (COMPARE_STRING_SEGMENT_TO_LITERAL(chain, &e->name))
+        {
+            //  This is a chain type definition
+            assert(this->part_count == 0);
+            this->definition = DEFINITION_CHAIN;
+            memset(&this->chain, 0, sizeof(this->chain));
+            for (u32 k = 0; k < e->attrib_count; ++k)
+            {
+                const string_segment* a_name = e->attribute_names + k;
+                RMOD_WARN("Unknown attribute \"%.*s\" was found in the element \"chain\" and will be ignored", a_name->len, a_name->begin);
+            }
+        }
+        else if (COMPARE_STRING_SEGMENT_TO_LITERAL(include, &e->name))
+        {
+            this->definition = DEFINITION_INCLUDE;
+        }
+        else
+        {
+            RMOD_WARN("Unknown element \"%.*s\" was found in the root \"rmod\" and will be ignored", e->name.len, e->name.begin);
+            this->definition = DEFINITION_NONE;
+        }
+        break;
+    case 2:
+        if (this->definition == DEFINITION_CHAIN && COMPARE_STRING_SEGMENT_TO_LITERAL(element, &e->name))
+        {
+            res = begin_chain_element(this, e);
+        }
+        break;
+    default:
+        break;
+    }
+    RMOD_LEAVE_FUNCTION;
+    return res;
+}
+
+static rmod_result converter_end_element(void* param, u32 depth, const rmod_xml_element* e)
+{
+    RMOD_ENTER_FUNCTION;
+    type_converter* const this = param;
+    rmod_result res = RMOD_RESULT_SUCCESS;
+    switch (depth)
+    {
+    case 1:
+        switch (this->definition)
+        {
+        case DEFINITION_BLOCK:
+            res = finish_block(this);
+            break;
+        case DEFINITION_CHAIN:
+            res = finish_chain(this);
+            break;
+        case DEFINITION_INCLUDE:
+            res = convert_include(this, &e->value);
+            break;
+        default:
+            break;
+        }
+        this->definition = DEFINITION_NONE;
+        break;
+    case 2:
+        if (this->definition == DEFINITION_BLOCK)
+        {
+            res = convert_block_property(this, e);
+        }
+        else if (this->definition == DEFINITION_CHAIN)
+        {
+            res = convert_chain_property(this, e);
+        }
+        break;
+    case 3:
+        if (this->definition == DEFINITION_CHAIN && this->chain.in_element)
+        {
+            res = convert_element_component(this, e);
+        }
+        break;
+    default:
+        break;
+    }
+    RMOD_LEAVE_FUNCTION;
+    return res;
+}
 
-                out->label = *this->label;
-                out->type_id = this->type_id;
-                out->id = j;
-            }
-            //  Ensure that there is correspondence between children and parents
-            for (u32 j = 0; j < chain_element_count; ++j)
-            {
-                const rmod_chain_element* element = chain_elements + j;
-                //  Check children
-                for (u32 k = 0; k < element->child_count; ++k)
-                {
-                    bool was_found = false;
-                    const rmod_chain_element* child_element = chain_elements + element->children[k];
-                    for (u32 l = 0; l < child_element->parent_count; ++l)
-                    {
-                        if (child_element->parents[l] == j)
-                        {
-                            was_found = true;
-                            break;
-                        }
-                    }
-                    if (!was_found)
-                    {
-                        RMOD_ERROR("Element with label \"%.*s\" is not specified as parent of one of its children with label \"%.*s\"", element->label.len, element->label.begin, child_element->label.len, child_element->label.begin);
-                        res = RMOD_RESULT_BAD_XML;
-                        jfree(chain_elements);
-                        goto failed;
-                    }
-                }
-                //  Check parents
-                for (u32 k = 0; k < element->parent_count; ++k)
-                {
-                    bool was_found = false;
-                    const rmod_chain_element* parent_element = chain_elements + element->parents[k];
-                    for (u32 l = 0; l < parent_element->child_count; ++l)
-                    {
-                        if (parent_element->children[l] == j)
-                        {
-                            was_found = true;
-                            break;
-                        }
-                    }
-                    if (!was_found)
-                    {
-                        RMOD_ERROR("Element with label \"%.*s\" is not specified as child of one of its parents with label \"%.*s\"", element->label.len, element->label.begin, parent_element->label.len, parent_element->label.begin);
-                        res = RMOD_RESULT_BAD_XML;
-                        jfree(chain_elements);
-                        goto failed;
-                    }
-                }
-            }
-            //  Ensure the chain is non-cyclical
-            if ((res = check_flow(name_ptr, chain_elements, first_v, 0, chain_element_count)) != RMOD_RESULT_SUCCESS)
-            {
-                RMOD_ERROR("Cycle detected in chain");
-                jfree(chain_elements);
-                goto failed;
-            }
+//  Regions of each worker which loads model files, indexed by worker index
+typedef struct model_loader_struct model_loader;
+struct model_loader_struct
+{
+    model_file* files;                  //  Files of the current wave begin at index first
+    u32 first;
+    region_jallocator** outputs;        //  Memory of elements of chains, which is taken over by the program
+    region_jallocator** infos;          //  Memory of types and includes, which is released once files are merged
+    region_jallocator** scratches;
+};
 
-            //  Free the child and parent arrays
-            for (u32 j = 0; j < part_count; ++j)
+//  Converts own types of the mapped file, while the files it includes are only recorded
+static rmod_result convert_model_file(
+        model_file* const file, region_jallocator* const allocator, region_jallocator* const info,
+        region_jallocator* const scratch)
+{
+    RMOD_ENTER_FUNCTION;
+    type_converter converter =
             {
-                jfree(element_buffer[j].child_names);
-                jfree(element_buffer[j].parent_names);
-            }
-            part_count = 0;
-            
-            //  Convert block relation (parent & child) into relative offsets. This allows for easier merging of chains
-            u32 name_byte_count = 0;
-            for (u32 j = 0; j < chain_element_count; ++j)
+            .allocator = allocator,
+            .info = info,
+            .scratch = scratch,
+            .file = file,
+            .definition = DEFINITION_NONE,
+            };
+    const rmod_xml_handler handler =
             {
-                const rmod_chain_element* element = chain_elements + j;
-                for (u32 k = 0; k < element->child_count; ++k)
-                {
-                    element->children[k] -= j;
-                }
-                for (u32 k = 0; k < element->parent_count; ++k)
-                {
-                    element->parents[k] -= j;
-                }
-                name_byte_count += element->label.len;
-            }
-            
+            .begin_element = converter_begin_element,
+            .end_element = converter_end_element,
+            .param = &converter,
+            };
+    file->structure_hash = FNV_OFFSET;
+    const rmod_result res = rmod_parse_xml_events(info, &file->mem_file, &handler);
+    region_jallocator_reset(scratch);
+    if (res != RMOD_RESULT_SUCCESS)
+    {
+        RMOD_ERROR("Failed converting model file \"%s\"", file->path);
+    }
+    RMOD_LEAVE_FUNCTION;
+    return res;
+}
 
-            //  Chain was now parsed insert it into the type array
-            if (type_count == type_capacity)
-            {
-                const u32 new_capacity = type_capacity + 32;
-                rmod_element_type* const new_ptr = jrealloc(types, sizeof(*new_ptr) * new_capacity);
-                if (!new_ptr)
-                {
-                    RMOD_ERROR("Failed jrealloc(%p, %zu)", types, sizeof(*new_ptr) * new_capacity);
-                    jfree(chain_elements);
-                    res = RMOD_RESULT_NOMEM;
-                    goto failed;
-                }
-                memset(new_ptr + type_count, 0, sizeof(*new_ptr) * (new_capacity - type_capacity));
-                types = new_ptr;
-                type_capacity = new_capacity;
-            }
+//  Maps the file and converts its own types, while the files it includes are only recorded, so that they can be loaded
+//  by the next wave
+static rmod_result load_model_file(void* param, u32 worker_idx, u32 task_idx)
+{
+    RMOD_ENTER_FUNCTION;
+    const model_loader* const loader = param;
+    model_file* const file = loader->files + loader->first + task_idx;
+    rmod_result res = rmod_map_file_to_memory(file->path, &file->mem_file);
+    if (res != RMOD_RESULT_SUCCESS)
+    {
+        RMOD_ERROR("Could not map model file \"%s\" to memory", file->path);
+        RMOD_LEAVE_FUNCTION;
+        return res;
+    }
+    res = convert_model_file(file, loader->outputs[worker_idx], loader->infos[worker_idx], loader->scratches[worker_idx]);
+    RMOD_LEAVE_FUNCTION;
+    return res;
+}
+
+//  Merges types of loaded files into one array, in the order they would have if each include was replaced by the
+//  types of the included file
+typedef struct model_merger_struct model_merger;
+struct model_merger_struct
+{
+    const model_file* files;
+    bool* merged;                       //  Files which were merged already are not included again
+    u32 type_count;
+    rmod_element_type* types;
+    u32* type_files;                    //  File which defined each type
+};
 
+static rmod_result merge_file(model_merger* this, u32 file_index);
 
-            types[type_count++] = (rmod_element_type)
-                    {
-                            .chain =
-                                    {
-                                            .header = { .type_value = RMOD_ELEMENT_TYPE_CHAIN, .type_name = *name_ptr },
-                                            .chain_elements = chain_elements,
-                                            .element_count = chain_element_count,
-                                            .i_first = first_v,
-                                            .i_last = last_v,
-                                            .compiled = false,
-                                            .name_buffer = NULL,
-                                            .name_bytes_total = name_byte_count,
-                                    }
-                    };
+//  Adds types of the included file, unless it was already merged, and makes their names visible to the including file.
+//  Types defined earlier take precedence over included ones with the same name.
+static rmod_result merge_include(model_merger* const this, rmod_string_table* const type_table, const model_include* const include)
+{
+    RMOD_ENTER_FUNCTION;
+    rmod_result res;
+    if (this->merged[include->file_index])
+    {
+        RMOD_LEAVE_FUNCTION;
+        return RMOD_RESULT_SUCCESS;
+    }
+    const u32 first = this->type_count;
+    if ((res = merge_file(this, include->file_index)) != RMOD_RESULT_SUCCESS)
+    {
+        RMOD_ERROR("Failed converting included file \"%s\"", include->path);
+        RMOD_LEAVE_FUNCTION;
+        return res;
+    }
+    for (u32 k = first; k < this->type_count; ++k)
+    {
+        u32 existing_id;
+        if ((res = rmod_string_table_insert(type_table, &this->types[k].header.type_name, k, &existing_id)) != RMOD_RESULT_SUCCESS)
+        {
+            RMOD_LEAVE_FUNCTION;
+            return res;
         }
-        else if (COMPARE_STRING_SEGMENT_TO_LITERAL(include, &e->name))
+    }
+    RMOD_LEAVE_FUNCTION;
+    return RMOD_RESULT_SUCCESS;
+}
+
+//  Adds own types of the file and those of files it includes, then resolves types of elements of its chains. Names
+//  of types are unique, regardless of whether they are blocks or chains.
+static rmod_result merge_file(model_merger* const this, const u32 file_index)
+{
+    RMOD_ENTER_FUNCTION;
+    rmod_result res;
+    const model_file* const file = this->files + file_index;
+    this->merged[file_index] = true;
+    //  Names of types which the file can use, which are its own and those of files it included before them
+    rmod_string_table type_table;
+    if ((res = rmod_string_table_create(file->type_count + 16, &type_table)) != RMOD_RESULT_SUCCESS)
+    {
+        RMOD_ERROR("Failed creating table of type names, reason: %s", rmod_result_str(res));
+        RMOD_LEAVE_FUNCTION;
+        return res;
+    }
+    u32 i_include = 0;
+    for (u32 i = 0; i < file->type_count; ++i)
+    {
+        for (; i_include < file->include_count && file->includes[i_include].position == i; ++i_include)
         {
-            //  Include tag: value is the name of the file which has to be converted into full path
-            char* const name_buffer = lin_jalloc(G_LIN_JALLOCATOR, e->value.len + 1);
-            if (!name_buffer)
+            if ((res = merge_include(this, &type_table, file->includes + i_include)) != RMOD_RESULT_SUCCESS)
             {
-                RMOD_ERROR("Failed lin_jalloc(%p, %zu)", G_LIN_JALLOCATOR, e->value.len + 1);
-                res = RMOD_RESULT_NOMEM;
-                goto failed;
+                goto end;
             }
-            memcpy(name_buffer, e->value.begin, e->value.len);
-            name_buffer[e->value.len] = 0;
-
-            char* buffer = lin_jalloc(G_LIN_JALLOCATOR, PATH_MAX);
-            if (!buffer)
+        }
+        const model_type* const type = file->types + i;
+        rmod_element_type* const out = this->types + this->type_count;
+        *out = type->type;
+        if (out->header.type_value == RMOD_ELEMENT_TYPE_CHAIN)
+        {
+            for (u32 j = 0; j < out->chain.element_count; ++j)
             {
-                RMOD_ERROR("Failed lin_jalloc(%p, %zu)", G_LIN_JALLOCATOR, PATH_MAX);
-                res = RMOD_RESULT_NOMEM;
-                goto failed;
+                const element_type_name* const element_type = type->element_types + j;
+                u32 l;
+                if (!rmod_string_table_find(&type_table, &element_type->name, &l) || this->types[l].header.type_value != element_type->type_value)
+                {
+                    RMOD_ERROR("%s of type \"%.*s\" is not defined", element_type->type_value == RMOD_ELEMENT_TYPE_CHAIN ? "Chain" : "Block", element_type->name.len, element_type->name.begin);
+                    res = RMOD_RESULT_BAD_XML;
+                    goto end;
+                }
+                out->chain.chain_elements[j].type_id = l;
             }
-            char* working_dir = lin_jalloc(G_LIN_JALLOCATOR, PATH_MAX);
-            if (!working_dir)
+        }
+        //  Check that name is not yet taken
+        u32 existing_id;
+        if ((res = rmod_string_table_insert(&type_table, &out->header.type_name, this->type_count, &existing_id)) != RMOD_RESULT_SUCCESS)
+        {
+            goto end;
+        }
+        if (existing_id != this->type_count)
+        {
+            RMOD_ERROR("Block/chain type \"%.*s\" was already defined", out->header.type_name.len, out->header.type_name.begin);
+            res = RMOD_RESULT_BAD_XML;
+            goto end;
+        }
+        this->type_files[this->type_count] = file_index;
+        this->type_count += 1;
+    }
+    //  Includes after the last type of the file
+    for (; i_include < file->include_count; ++i_include)
+    {
+        if ((res = merge_include(this, &type_table, file->includes + i_include)) != RMOD_RESULT_SUCCESS)
+        {
+            goto end;
+        }
+    }
+    res = RMOD_RESULT_SUCCESS;
+
+end:
+    rmod_string_table_destroy(&type_table);
+    RMOD_LEAVE_FUNCTION;
+    return res;
+}
+
+rmod_result rmod_load_model_files(
+        region_jallocator* allocator, const char* file_name, u32 thread_count, u32* pn_files, rmod_memory_file** pp_files,
+        u64** pp_structure_hashes, u32* pn_types, rmod_element_type** pp_types, u32** pp_type_files)
+{
+    RMOD_ENTER_FUNCTION;
+    rmod_result res;
+    u32 file_count = 0;
+    u32 file_capacity = 16;
+    model_file* files = NULL;
+    //  Real paths of files which were found so far, mapped to their index
+    rmod_string_table registry = {0};
+    bool* merged = NULL;
+    char main_path[PATH_MAX];
+    if (thread_count == 0)
+    {
+        thread_count = 1;
+    }
+    //  Each worker has its own regions for output, information needed for merging, and the chain being converted
+    region_jallocator** const regions = jalloc(sizeof(*regions) * 3 * thread_count);
+    if (!regions)
+    {
+        RMOD_ERROR("Failed jalloc(%zu)", sizeof(*regions) * 3 * thread_count);
+        RMOD_LEAVE_FUNCTION;
+        return RMOD_RESULT_NOMEM;
+    }
+    memset(regions, 0, sizeof(*regions) * 3 * thread_count);
+    model_loader loader =
             {
-                RMOD_ERROR("Failed lin_jalloc(%p, %zu)", G_LIN_JALLOCATOR, PATH_MAX);
-                res = RMOD_RESULT_NOMEM;
-                goto failed;
-            }
+            .outputs = regions,
+            .infos = regions + thread_count,
+            .scratches = regions + 2 * thread_count,
+            };
+    for (u32 i = 0; i < thread_count; ++i)
+    {
+        loader.outputs[i] = region_jallocator_create(1 << 20);
+        loader.infos[i] = region_jallocator_create(1 << 16);
+        loader.scratches[i] = region_jallocator_create(1 << 16);
+        if (!loader.outputs[i] || !loader.infos[i] || !loader.scratches[i])
+        {
+            RMOD_ERROR("Failed creating region allocators for loading model files");
+            res = RMOD_RESULT_NOMEM;
+            goto end;
+        }
+    }
 
 #ifndef _WIN32
-            if (!realpath(name_buffer, buffer))
+    if (!realpath(file_name, main_path))
 #else
-            if (!GetFullPathName(name_buffer, MAX_PATH, buffer, NULL))
+    if (!GetFullPathNameA(file_name, PATH_MAX, main_path, NULL))
 #endif
-            {
-                RMOD_ERROR("Could not find real path of file \"%s\", reason: %s", name_buffer, RMOD_ERRNO_MESSAGE);
-                res = RMOD_RESULT_NOMEM;
-                goto failed;
-            }
-            u32 j;
-            for (j = 0; j < *p_file_count; ++j)
-            {
-                const rmod_memory_file* p_file = (*pp_files) + j;
-                if (strcmp(p_file->name, buffer) == 0)
-                {
-                    break;
-                }
-
-            }
+    {
+        RMOD_ERROR("Could not get the real path of file \"%s\", reason: %s", file_name, RMOD_ERRNO_MESSAGE);
+        res = RMOD_RESULT_BAD_PATH;
+        goto end;
+    }
+    files = jalloc(sizeof(*files) * file_capacity);
+    if (!files)
+    {
+        RMOD_ERROR("Failed jalloc(%zu)", sizeof(*files) * file_capacity);
+        res = RMOD_RESULT_NOMEM;
+        goto end;
+    }
+    if ((res = rmod_string_table_create(file_capacity, &registry)) != RMOD_RESULT_SUCCESS)
+    {
+        RMOD_ERROR("Failed creating table of model files, reason: %s", rmod_result_str(res));
+        goto end;
+    }
+    memset(files, 0, sizeof(*files));
+    files[0].path = main_path;
+    file_count = 1;
+    u32 main_index;
+    if ((res = rmod_string_table_insert(&registry, &(string_segment){.begin = main_path, .len = strlen(main_path)}, 0, &main_index)) != RMOD_RESULT_SUCCESS)
+    {
+        goto end;
+    }
 
-            if (j == *p_file_count)
+    //  Files are loaded in waves, each consisting of files first included by the files of the previous one
+    for (u32 first = 0; first < file_count;)
+    {
+        const u32 wave_end = file_count;
+        loader.files = files;
+        loader.first = first;
+        if ((res = rmod_parallel_run(thread_count, wave_end - first, load_model_file, &loader, "load")) != RMOD_RESULT_SUCCESS)
+        {
+            RMOD_ERROR("Failed loading model files, reason: %s", rmod_result_str(res));
+            goto end;
+        }
+        for (u32 i = first; i < wave_end; ++i)
+        {
+            for (u32 k = 0; k < files[i].include_count; ++k)
             {
-                if (!getcwd(working_dir, PATH_MAX))
-                {
-                    RMOD_ERROR("Failed getting the current working directory, reason: %s", RMOD_ERRNO_MESSAGE);
-                    res = RMOD_RESULT_BAD_PATH;
-                    goto failed;
-                }
-                //  Add new file to list and merge them
-                rmod_memory_file mem_file;
-                res = rmod_map_file_to_memory(buffer, &mem_file);
-                if (res != RMOD_RESULT_SUCCESS)
-                {
-                    RMOD_ERROR("Could not map included file \"%s\" to memory", buffer);
-                    goto failed;
-                }
-                rmod_xml_element included_root;
-                res = rmod_parse_xml(&mem_file, &included_root);
-                if (res != RMOD_RESULT_SUCCESS)
-                {
-                    rmod_unmap_file(&mem_file);
-                    RMOD_ERROR("Failed parsing included file \"%s\"", buffer);
-                    goto failed;
-                }
-
-                u32 n_new_types;
-                rmod_element_type* p_new_types = NULL;
-                char* new_wd = lin_jalloc(G_LIN_JALLOCATOR, PATH_MAX);
-                if (!new_wd)
-                {
-                    rmod_release_xml(&included_root);
-                    rmod_unmap_file(&mem_file);
-                    RMOD_ERROR("Failed lin_jalloc(%p, %zu)", G_LIN_JALLOCATOR, PATH_MAX);
-                    res = RMOD_RESULT_NOMEM;
-                    goto failed;
-                }
-                //  Literally the same size, so not checking this return value
-                strncpy(new_wd, buffer, PATH_MAX);
-                const int ret_1 = chdir(dirname(new_wd));
-                lin_jfree(G_LIN_JALLOCATOR, new_wd);
-                if (ret_1 < 0)
-                {
-                    RMOD_ERROR("could not change directory to location of \"%s\", reason: %s", new_wd, RMOD_ERRNO_MESSAGE);
-                    rmod_release_xml(&included_root);
-                    rmod_unmap_file(&mem_file);
-                    res = RMOD_RESULT_BAD_PATH;
-                    goto failed;
-                }
-
-                res = rmod_convert_xml(&included_root, p_file_count, p_file_capacity, pp_files, &n_new_types, &p_new_types);
-                rmod_release_xml(&included_root);
-                if (chdir(working_dir) < 0)
+                model_include* const include = files[i].includes + k;
+                u32 file_index;
+                if ((res = rmod_string_table_insert(&registry, &(string_segment){.begin = include->path, .len = strlen(include->path)}, file_count, &file_index)) != RMOD_RESULT_SUCCESS)
                 {
-                    jfree(p_new_types);
-                    RMOD_ERROR("Could not change directory back to location of previous working directory \"%s\"", working_dir, RMOD_ERRNO_MESSAGE);
-                    rmod_unmap_file(&mem_file);
-                    res = RMOD_RESULT_BAD_PATH;
-                    goto failed;
-                }
-                if (res != RMOD_RESULT_SUCCESS)
-                {
-                    rmod_unmap_file(&mem_file);
-                    RMOD_ERROR("Failed converting included file \"%s\"", buffer);
-                    goto failed;
+                    goto end;
                 }
-
-                //  Merge the files and types arrays
-                if (type_count + n_new_types >= type_capacity)
+                include->file_index = file_index;
+                if (file_index != file_count)
                 {
-                    const u64 new_capacity = type_capacity + type_count;
-                    rmod_element_type* const new_ptr = jrealloc(types, new_capacity * sizeof*types);
-                    if (!new_ptr)
-                    {
-                        jfree(p_new_types);
-                        rmod_unmap_file(&mem_file);
-                        RMOD_ERROR("Failed jrealloc(%p, %zu)", types, new_capacity * sizeof*types);
-                        res = RMOD_RESULT_NOMEM;
-                        goto failed;
-                    }
-                    memset(new_ptr + type_count, 0, sizeof(*new_ptr) * (new_capacity - type_count));
-                    type_capacity = new_capacity;
-                    types = new_ptr;
+                    continue;
                 }
-                if (*p_file_count >= *p_file_capacity)
+                if (file_count == file_capacity)
                 {
-                    const u64 new_capacity = *p_file_capacity + 8;
-                    rmod_memory_file* const new_ptr = jrealloc(*pp_files, new_capacity * sizeof(**pp_files));
+                    const u32 new_capacity = file_capacity * 2;
+                    model_file* const new_ptr = jrealloc(files, sizeof(*new_ptr) * new_capacity);
                     if (!new_ptr)
                     {
-                        jfree(p_new_types);
-                        rmod_unmap_file(&mem_file);
-                        RMOD_ERROR("Failed jrealloc(%p, %zu)", *pp_files, new_capacity * sizeof(**pp_files));
+                        RMOD_ERROR("Failed jrealloc(%p, %zu)", files, sizeof(*new_ptr) * new_capacity);
                         res = RMOD_RESULT_NOMEM;
-                        goto failed;
+                        goto end;
                     }
-                    memset(new_ptr + *p_file_count, 0, sizeof(*new_ptr) * (new_capacity - *p_file_count));
-                    *p_file_capacity = new_capacity;
-                    *pp_files = new_ptr;
+                    files = new_ptr;
+                    file_capacity = new_capacity;
                 }
+                memset(files + file_count, 0, sizeof(*files));
+                files[file_count++].path = include->path;
+            }
+        }
+        first = wave_end;
+    }
 
-                //  For all elements in new chains update their type ids, since they need to be shifted
-                for (u32 k = 0; k < n_new_types; ++k)
-                {
-                    const rmod_element_type* type = p_new_types + k;
-                    if (type->header.type_value == RMOD_ELEMENT_TYPE_BLOCK)
-                    {
-                        continue;
-                    }
-                    const rmod_chain* chain = &type->chain;
-                    for (u32 l = 0; l < chain->element_count; ++l)
-                    {
-                        rmod_chain_element* const element = chain->chain_elements + l;
-                        element->type_id += type_count;
-                    }
-                }
+    //  Each file is merged exactly once, since all of them are included by the main file or files it includes
+    u32 type_count = 0;
+    for (u32 i = 0; i < file_count; ++i)
+    {
+        type_count += files[i].type_count;
+    }
+    merged = jalloc(sizeof(*merged) * file_count);
+    if (!merged)
+    {
+        RMOD_ERROR("Failed jalloc(%zu)", sizeof(*merged) * file_count);
+        res = RMOD_RESULT_NOMEM;
+        goto end;
+    }
+    memset(merged, 0, sizeof(*merged) * file_count);
+    rmod_element_type* const types = region_jalloc(allocator, sizeof(*types) * type_count);
+    u32* const type_files = region_jalloc(allocator, sizeof(*type_files) * type_count);
+    rmod_memory_file* const mem_files = region_jalloc(allocator, sizeof(*mem_files) * file_count);
+    u64* const structure_hashes = region_jalloc(allocator, sizeof(*structure_hashes) * file_count);
+    if (!types || !type_files || !mem_files || !structure_hashes)
+    {
+        RMOD_ERROR("Failed region_jalloc(%p, %zu)", allocator, (sizeof(*types) + sizeof(*type_files)) * type_count + (sizeof(*mem_files) + sizeof(*structure_hashes)) * file_count);
+        res = RMOD_RESULT_NOMEM;
+        goto end;
+    }
+    model_merger merger =
+            {
+            .files = files,
+            .merged = merged,
+            .type_count = 0,
+            .types = types,
+            .type_files = type_files,
+            };
+    if ((res = merge_file(&merger, 0)) != RMOD_RESULT_SUCCESS)
+    {
+        goto end;
+    }
+    assert(merger.type_count == type_count);
+    for (u32 i = 0; i < file_count; ++i)
+    {
+        mem_files[i] = files[i].mem_file;
+        structure_hashes[i] = files[i].structure_hash;
+    }
+    //  Elements of chains are now owned by the program
+    for (u32 i = 0; i < thread_count; ++i)
+    {
+        region_jallocator_absorb(allocator, loader.outputs[i]);
+        loader.outputs[i] = NULL;
+    }
 
-                memcpy(types + type_count, p_new_types, sizeof(*types) * n_new_types);
-                type_count += n_new_types;
-                jfree(p_new_types);
+    *pn_files = file_count;
+    *pp_files = mem_files;
+    *pp_structure_hashes = structure_hashes;
+    *pn_types = type_count;
+    *pp_types = types;
+    *pp_type_files = type_files;
 
-                (*pp_files)[*p_file_count] = mem_file;
-                *p_file_count += 1;
+end:
+    if (res != RMOD_RESULT_SUCCESS)
+    {
+        for (u32 i = 0; i < file_count; ++i)
+        {
+            if (files[i].mem_file.ptr)
+            {
+                rmod_unmap_file(&files[i].mem_file);
             }
-
-            lin_jfree(G_LIN_JALLOCATOR, working_dir);
-            lin_jfree(G_LIN_JALLOCATOR, buffer);
-            lin_jfree(G_LIN_JALLOCATOR, name_buffer);
         }
-        else
+    }
+    jfree(merged);
+    if (registry.capacity)
+    {
+        rmod_string_table_destroy(&registry);
+    }
+    jfree(files);
+    for (u32 i = 0; i < 3 * thread_count; ++i)
+    {
+        if (regions[i])
         {
-            RMOD_WARN("Unknown element \"%.*s\" was found in the root \"rmod\" and will be ignored", e->name.len, e->name.begin);
+            region_jallocator_destroy(regions[i]);
         }
     }
-
-    *pn_types = type_count;
-    *pp_types = types;
-    jfree(element_buffer);
+    jfree(regions);
     RMOD_LEAVE_FUNCTION;
-    return RMOD_RESULT_SUCCESS;
+    return res;
+}
 
-failed:
-    lin_jalloc_set_current(G_LIN_JALLOCATOR, base);
-    for (u32 i = 0; i < part_count; ++i)
+
+rmod_result rmod_convert_model_file(
+        region_jallocator* allocator, const rmod_memory_file* mem_file, u64* p_structure_hash, u32* pn_types,
+        rmod_element_type** pp_types)
+{
+    RMOD_ENTER_FUNCTION;
+    rmod_result res;
+    model_file file = {.path = mem_file->name, .mem_file = *mem_file};
+    region_jallocator* const scratch = region_jallocator_create(1 << 16);
+    if (!scratch)
     {
-        jfree(element_buffer[i].child_names);
-        jfree(element_buffer[i].parent_names);
+        RMOD_ERROR("Failed creating region allocator for the chain which is being converted");
+        RMOD_LEAVE_FUNCTION;
+        return RMOD_RESULT_NOMEM;
     }
-    jfree(element_buffer);
-    for (u32 i = 0; i < type_count; ++i)
+    if ((res = convert_model_file(&file, allocator, allocator, scratch)) != RMOD_RESULT_SUCCESS)
     {
-        if (types[i].header.type_value == RMOD_ELEMENT_TYPE_CHAIN)
-        {
-            rmod_chain* const this = &types[i].chain;
-            for (u32 j = 0; j < this->element_count; ++j)
-            {
-                jfree(this->chain_elements[j].parents);
-                jfree(this->chain_elements[j].children);
-            }
-            jfree(this->chain_elements);
-            jfree(this->name_buffer);
-        }
+        goto end;
+    }
+    rmod_element_type* const types = region_jalloc(allocator, sizeof(*types) * file.type_count);
+    if (!types)
+    {
+        RMOD_ERROR("Failed region_jalloc(%p, %zu)", allocator, sizeof(*types) * file.type_count);
+        res = RMOD_RESULT_NOMEM;
+        goto end;
+    }
+    for (u32 i = 0; i < file.type_count; ++i)
+    {
+        types[i] = file.types[i].type;
     }
-    jfree(types);
+    *p_structure_hash = file.structure_hash;
+    *pn_types = file.type_count;
+    *pp_types = types;
+
+end:
+    region_jallocator_destroy(scratch);
     RMOD_LEAVE_FUNCTION;
     return res;
 }
@@ -1549,33 +2197,3 @@ failure:
     RMOD_LEAVE_FUNCTION;
     return res;
 }
-
-rmod_result rmod_destroy_types(u32 n_types, rmod_element_type* types)
-{
-    RMOD_ENTER_FUNCTION;
-    for (u32 i = 0; i < n_types; ++i)
-    {
-        switch (types[i].header.type_value)
-        {
-        case RMOD_ELEMENT_TYPE_CHAIN:
-        {
-            rmod_chain* const this = &types[i].chain;
-            for (u32 j = 0; j < this->element_count; ++j)
-            {
-                jfree(this->chain_elements[j].parents);
-                jfree(this->chain_elements[j].children);
-            }
-            jfree(this->chain_elements);
-            jfree(this->name_buffer);
-        }
-            break;
-        case RMOD_ELEMENT_TYPE_BLOCK:break;
-        default:RMOD_WARN("Unknown type encountered for type \"%.*s\"", types->header.type_name.len, types->header.type_name.begin);
-            break;
-        }
-    }
-    jfree(types);
-    RMOD_LEAVE_FUNCTION;
-    return RMOD_RESULT_SUCCESS;
-}
-
@@ -37,6 +37,43 @@ struct rmod_element_type_header_struct
     string_segment type_name;
 };
 
+//  Parameters of a block which can be given as a range of values instead of a single one
+typedef enum rmod_block_parameter_enum rmod_block_parameter;
+enum rmod_block_parameter_enum
+{
+    RMOD_BLOCK_PARAMETER_MTBF,
+    RMOD_BLOCK_PARAMETER_MTBR,
+    RMOD_BLOCK_PARAMETER_EFFECT,
+    RMOD_BLOCK_PARAMETER_COST,
+    RMOD_BLOCK_PARAMETER_COUNT,
+};
+
+//  Returns the name of the element which gives the parameter
+const char* rmod_block_parameter_to_str(rmod_block_parameter value);
+
+typedef enum rmod_distribution_type_enum rmod_distribution_type;
+enum rmod_distribution_type_enum
+{
+    RMOD_DISTRIBUTION_NONE,         //  Value is known exactly
+    RMOD_DISTRIBUTION_UNIFORM,
+    RMOD_DISTRIBUTION_LOG_UNIFORM,  //  Logarithm of the value is uniformly distributed
+    RMOD_DISTRIBUTION_TRIANGULAR,   //  Mode is the value of the parameter
+    RMOD_DISTRIBUTION_COUNT,
+};
+
+//  Returns the value of the attribute "distribution" which selects the distribution
+const char* rmod_distribution_type_to_str(rmod_distribution_type value);
+
+//  Distribution of the value of a parameter which is not known exactly, given by attributes "distribution", "min", and
+//  "max" of its element
+typedef struct rmod_parameter_distribution_struct rmod_parameter_distribution;
+struct rmod_parameter_distribution_struct
+{
+    rmod_distribution_type type;
+    f32 min;
+    f32 max;
+};
+
 typedef struct rmod_block_struct rmod_block;
 struct rmod_block_struct
 {
@@ -46,6 +83,7 @@ struct rmod_block_struct
     f32 effect;
     f32 cost;
     rmod_failure_type failure_type;
+    rmod_parameter_distribution uncertainty[RMOD_BLOCK_PARAMETER_COUNT];
 };
 
 
@@ -85,10 +123,20 @@ union rmod_element_type_union
 };
 
 
-rmod_result rmod_convert_xml(const rmod_xml_element* root, u32* p_file_count, u32* p_file_capacity, rmod_memory_file** pp_files, u32* pn_types, rmod_element_type** pp_types);
+//  Loads the model file and all files it includes, which are found relative to the directory of the file including
+//  them. Files are loaded in waves of those first included by the previous wave, each of which is mapped and converted
+//  on up to thread_count threads. Their types are then merged in the same order as if each include was replaced by
+//  the types of the included file, with files which were already included being skipped. For each file the hash of its
+//  structure is given, which is the same as rmod_convert_model_file gives, and for each type the index of the file
+//  which defined it. All arrays and chain elements are taken from the allocator, so they are released with it.
+rmod_result rmod_load_model_files(region_jallocator* allocator, const char* file_name, u32 thread_count, u32* pn_files, rmod_memory_file** pp_files, u64** pp_structure_hashes, u32* pn_types, rmod_element_type** pp_types, u32** pp_type_files);
 
-rmod_result rmod_serialize_types(linear_jallocator* allocator, u32 type_count, const rmod_element_type* types, char** p_out);
+//  Converts only the types defined by the file itself, without loading files it includes, so that it can be compared
+//  to the file which was loaded before. Types of elements of chains are not resolved. Hash of the structure covers
+//  everything in the file except values of parameters of blocks, so two versions of the file with the same hash only
+//  differ in those. Memory is taken from the allocator.
+rmod_result rmod_convert_model_file(region_jallocator* allocator, const rmod_memory_file* mem_file, u64* p_structure_hash, u32* pn_types, rmod_element_type** pp_types);
 
-rmod_result rmod_destroy_types(u32 n_types, rmod_element_type* types);
+rmod_result rmod_serialize_types(linear_jallocator* allocator, u32 type_count, const rmod_element_type* types, char** p_out);
 
 #endif //RMOD_GRAPH_PARSING_H
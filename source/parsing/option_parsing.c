@@ -3,6 +3,7 @@
 //
 #include "option_parsing.h"
 #include <inttypes.h>
+#include <ctype.h>
 
 
 rmod_result convert_value(const string_segment v, const rmod_config_converter* const converter)
@@ -90,6 +91,81 @@ rmod_result convert_value(const string_segment v, const rmod_config_converter* c
     }
         break;
 
+    case RMOD_CFG_VALUE_FLAGS:
+    {
+        const rmod_config_converter_flags* this = &converter->c_flags;
+        //  Comma separated list of flag names
+        u32 flags = 0;
+        const char* begin = v.begin;
+        const char* const end = v.begin + v.len;
+        while (begin < end)
+        {
+            const char* next = memchr(begin, ',', end - begin);
+            if (!next)
+            {
+                next = end;
+            }
+            u32 i;
+            for (i = 0; i < this->n_flags; ++i)
+            {
+                if (strlen(this->flag_names[i]) == (size_t)(next - begin) && strncmp(this->flag_names[i], begin, next - begin) == 0)
+                {
+                    flags |= (1 << i);
+                    break;
+                }
+            }
+            if (i == this->n_flags)
+            {
+                RMOD_ERROR("Failed conversion to flags due to unknown flag \"%.*s\"", (int)(next - begin), begin);
+                goto failed;
+            }
+            begin = next + 1;
+        }
+        *this->p_out = flags;
+    }
+        break;
+
+    case RMOD_CFG_VALUE_REAL_LIST:
+    {
+        const rmod_config_converter_real_list* this = &converter->c_real_list;
+        //  Values separated by commas or whitespace
+        u32 count = 0;
+        const char* begin = v.begin;
+        const char* const end = v.begin + v.len;
+        for (;;)
+        {
+            while (begin < end && (*begin == ',' || isspace((unsigned char)*begin)))
+            {
+                begin += 1;
+            }
+            if (begin == end)
+            {
+                break;
+            }
+            char* end_p = NULL;
+            const double_t val = strtod(begin, &end_p);
+            if (end_p == begin || end_p > end)
+            {
+                RMOD_ERROR("Failed conversion to list of doubles due to invalid value in \"%.*s\"", v.len, v.begin);
+                goto failed;
+            }
+            if (val < this->v_min || val > this->v_max)
+            {
+                RMOD_ERROR("Converted value %e was outside of allowed range [%e, %e]", val, this->v_min, this->v_max);
+                goto failed;
+            }
+            if (count == this->capacity)
+            {
+                RMOD_ERROR("List \"%.*s\" has more than %u values", v.len, v.begin, this->capacity);
+                goto failed;
+            }
+            this->p_out[count++] = val;
+            begin = end_p;
+        }
+        *this->p_count = count;
+    }
+        break;
+
     default:
     RMOD_ERROR("Config element converter has invalid type member");
         RMOD_LEAVE_FUNCTION;
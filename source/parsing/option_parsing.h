@@ -15,6 +15,8 @@ enum rmod_config_value_type_enum
     RMOD_CFG_VALUE_STR,
     RMOD_CFG_VALUE_REAL,
     RMOD_CFG_VALUE_CUSTOM,
+    RMOD_CFG_VALUE_FLAGS,
+    RMOD_CFG_VALUE_REAL_LIST,
 };
 
 typedef struct rmod_config_converter_uint_struct rmod_config_converter_uint;
@@ -60,6 +62,26 @@ struct rmod_config_converter_custom_struct
     void* p_out;
 };
 
+typedef struct rmod_config_converter_flags_struct rmod_config_converter_flags;
+struct rmod_config_converter_flags_struct
+{
+    rmod_config_value_type type;
+    u32 n_flags;
+    const char* const* flag_names;  //  Name of the flag i, which sets the bit (1 << i)
+    u32* p_out;
+};
+
+typedef struct rmod_config_converter_real_list_struct rmod_config_converter_real_list;
+struct rmod_config_converter_real_list_struct
+{
+    rmod_config_value_type type;
+    double_t v_min;
+    double_t v_max;
+    u32 capacity;                   //  Largest number of values which fit into p_out
+    u32* p_count;
+    double_t* p_out;
+};
+
 typedef union rmod_config_converter_union rmod_config_converter;
 union rmod_config_converter_union
 {
@@ -69,6 +91,8 @@ union rmod_config_converter_union
     rmod_config_converter_str c_str;
     rmod_config_converter_real c_real;
     rmod_config_converter_custom c_custom;
+    rmod_config_converter_flags c_flags;
+    rmod_config_converter_real_list c_real_list;
 };
 
 
@@ -0,0 +1,266 @@
+//
+// Created by jan on 19.10.2026.
+//
+#include "parsing_base.h"
+#include <stdio.h>
+#include <inttypes.h>
+#include "parse_benchmark_baseline.c"
+
+//  Measures speed of parsing xml and numbers. Parsing is measured on the file given as the first argument, or on a
+//  generated model if none is given, with the parser which used strchr and strstr as the baseline. Build with
+//  RMOD_PARSING_USE_SIMD defined to measure the vector scanner.
+
+#define ASSERT(x) if ((x) == false) {fprintf(stderr, "Failed assertion: \"" #x "\"\n"); __builtin_trap(); exit(EXIT_FAILURE);} (void)0
+#define N_BLOCKS 2000
+#define N_CHAINS 200
+#define N_CHAIN_ELEMENTS 500
+#define N_RUNS 20
+#define PAGE_SIZE 4096
+
+typedef struct benchmark_counts_struct benchmark_counts;
+struct benchmark_counts_struct
+{
+    u64 elements;
+    u64 attributes;
+    u64 value_bytes;
+    u32 number_count;
+    u32 number_capacity;
+    string_segment* numbers;        //  Values of mtbf, mtbr, effect, and cost elements
+};
+
+static rmod_result count_begin_element(void* param, u32 depth, const rmod_xml_element* e)
+{
+    (void)depth;
+    benchmark_counts* const this = param;
+    this->elements += 1;
+    this->attributes += e->attrib_count;
+    return RMOD_RESULT_SUCCESS;
+}
+
+static rmod_result count_end_element(void* param, u32 depth, const rmod_xml_element* e)
+{
+    benchmark_counts* const this = param;
+    this->value_bytes += e->value.len;
+    if (depth == 2 && this->numbers &&
+        (COMPARE_STRING_SEGMENT_TO_LITERAL(mtbf, &e->name) || COMPARE_STRING_SEGMENT_TO_LITERAL(mtbr, &e->name) ||
+         COMPARE_STRING_SEGMENT_TO_LITERAL(effect, &e->name) || COMPARE_STRING_SEGMENT_TO_LITERAL(cost, &e->name)))
+    {
+        if (this->number_count == this->number_capacity)
+        {
+            const u32 new_capacity = this->number_capacity + 1024;
+            string_segment* const new_ptr = jrealloc(this->numbers, sizeof(*new_ptr) * new_capacity);
+            ASSERT(new_ptr);
+            this->numbers = new_ptr;
+            this->number_capacity = new_capacity;
+        }
+        this->numbers[this->number_count++] = e->value;
+    }
+    return RMOD_RESULT_SUCCESS;
+}
+
+//  Writes a model with many block types and long chains, which is zero padded up to the end of the last page, same as
+//  a mapped file would be
+static void generate_model(rmod_memory_file* p_file)
+{
+    u64 capacity = 1 << 20;
+    u64 size = 0;
+    char* buffer = jalloc(capacity);
+    ASSERT(buffer);
+#define APPEND(...) for (;;) {\
+    const int written = snprintf(buffer + size, capacity - size, __VA_ARGS__);\
+    ASSERT(written >= 0);\
+    if ((u64)written < capacity - size) {size += written; break;}\
+    capacity *= 2;\
+    buffer = jrealloc(buffer, capacity);\
+    ASSERT(buffer);\
+    } (void)0
+    APPEND("<?xml version=\"1.0\" encoding=\"utf-8\"?>\n<rmod>\n");
+    for (u32 i = 0; i < N_BLOCKS; ++i)
+    {
+        APPEND("    <!-- Block type number %u -->\n"
+               "    <block>\n"
+               "        <name>block_type_%u</name>\n"
+               "        <mtbf min=\"%g\" max=\"%g\">%g</mtbf>\n"
+               "        <mtbr>%.3f</mtbr>\n"
+               "        <effect>%.4f</effect>\n"
+               "        <cost>%.2e</cost>\n"
+               "    </block>\n",
+               i, i, 500.0 + i, 2000.0 + i, 1000.0 + 0.25 * i, 12.0 + 0.001 * i, 1.0 / (1 + i % 7), 1500.0 * (i + 1));
+    }
+    for (u32 i = 0; i < N_CHAINS; ++i)
+    {
+        APPEND("    <chain>\n"
+               "        <name>chain_%u</name>\n"
+               "        <first>e0</first>\n"
+               "        <last>e%u</last>\n", i, N_CHAIN_ELEMENTS - 1);
+        for (u32 j = 0; j < N_CHAIN_ELEMENTS; ++j)
+        {
+            APPEND("        <element etype=\"block\">\n"
+                   "            <type>block_type_%u</type>\n"
+                   "            <label>e%u</label>\n", (i + j) % N_BLOCKS, j);
+            if (j)
+            {
+                APPEND("            <parent>e%u</parent>\n", j - 1);
+            }
+            if (j + 1 != N_CHAIN_ELEMENTS)
+            {
+                APPEND("            <child>e%u</child>\n", j + 1);
+            }
+            APPEND("        </element>\n");
+        }
+        APPEND("    </chain>\n");
+    }
+    APPEND("</rmod>\n");
+#undef APPEND
+    //  Contents are copied to page aligned memory, so that the scanner sees them the same way as a mapped file
+    const u64 file_size = (size + PAGE_SIZE) & ~(u64)(PAGE_SIZE - 1);
+    char* const ptr = aligned_alloc(PAGE_SIZE, file_size);
+    ASSERT(ptr);
+    memcpy(ptr, buffer, size);
+    memset(ptr + size, 0, file_size - size);
+    jfree(buffer);
+    *p_file = (rmod_memory_file){.ptr = ptr, .file_size = file_size};
+    snprintf(p_file->name, sizeof(p_file->name), "generated model");
+}
+
+static f64 seconds_since(const struct timespec* ts_begin)
+{
+    struct timespec ts_end;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts_end);
+    return (f64)(ts_end.tv_sec - ts_begin->tv_sec) + ((f64)(ts_end.tv_nsec - ts_begin->tv_nsec) * 1e-9);
+}
+
+int main(int argc, char* argv[])
+{
+#ifdef _WIN32
+#error NOT IMPLEMENTED
+#endif
+    G_JALLOCATOR = jallocator_create((1 << 20), (1 << 19), 1);
+    ASSERT(G_JALLOCATOR);
+    rmod_error_init_thread("benchmark", RMOD_ERROR_LEVEL_WARN, 32, 32);
+
+    rmod_memory_file file;
+    const bool generated = argc < 2;
+    if (generated)
+    {
+        generate_model(&file);
+    }
+    else
+    {
+        ASSERT(rmod_map_file_to_memory(argv[1], &file) == RMOD_RESULT_SUCCESS);
+    }
+#ifdef RMOD_PARSING_USE_SIMD
+    printf("Scanner: vector\n");
+#else
+    printf("Scanner: scalar\n");
+#endif
+    //  Fastest run is reported, since it is the least disturbed by anything else running at the same time
+    struct timespec ts_begin;
+
+    //  Building the tree with the baseline parser
+    f64 duration_baseline = INFINITY;
+    for (u32 i = 0; i < N_RUNS; ++i)
+    {
+        rmod_xml_element root;
+        clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts_begin);
+        ASSERT(baseline_parse_xml(&file, &root) == RMOD_RESULT_SUCCESS);
+        const f64 run_duration = seconds_since(&ts_begin);
+        if (run_duration < duration_baseline)
+        {
+            duration_baseline = run_duration;
+        }
+        baseline_release_xml(&root);
+    }
+
+    //  Building the tree with the current parser
+    region_jallocator* const parser_allocator = region_jallocator_create(1 << 16);
+    ASSERT(parser_allocator);
+    f64 duration_tree = INFINITY;
+    for (u32 i = 0; i < N_RUNS; ++i)
+    {
+        rmod_xml_element root;
+        region_jallocator_reset(parser_allocator);
+        clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts_begin);
+        ASSERT(rmod_parse_xml(parser_allocator, &file, &root) == RMOD_RESULT_SUCCESS);
+        const f64 run_duration = seconds_since(&ts_begin);
+        if (run_duration < duration_tree)
+        {
+            duration_tree = run_duration;
+        }
+    }
+
+    //  Scanning without building the tree
+    benchmark_counts counts = {0};
+    const rmod_xml_handler handler =
+            {
+            .begin_element = count_begin_element,
+            .end_element = count_end_element,
+            .param = &counts,
+            };
+    f64 duration = INFINITY;
+    for (u32 i = 0; i < N_RUNS; ++i)
+    {
+        counts.elements = 0;
+        counts.attributes = 0;
+        counts.value_bytes = 0;
+        region_jallocator_reset(parser_allocator);
+        clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts_begin);
+        ASSERT(rmod_parse_xml_events(parser_allocator, &file, &handler) == RMOD_RESULT_SUCCESS);
+        const f64 run_duration = seconds_since(&ts_begin);
+        if (run_duration < duration)
+        {
+            duration = run_duration;
+        }
+    }
+    printf("Scanned %s: %g MB, %"PRIu64" elements, %"PRIu64" attributes, %"PRIu64" bytes of values\n",
+           file.name, (f64)file.file_size / 1e6, counts.elements, counts.attributes, counts.value_bytes);
+    printf("Speed of building the tree was %g MB/s with the baseline parser and %g MB/s with rmod_parse_xml\n",
+           (f64)file.file_size / (duration_baseline * 1e6), (f64)file.file_size / (duration_tree * 1e6));
+    printf("Speed of rmod_parse_xml_events was %g MB/s\n", (f64)file.file_size / (duration * 1e6));
+
+    //  Parsing numbers, which are collected in one more pass
+    counts.numbers = jalloc(sizeof(*counts.numbers));
+    ASSERT(counts.numbers);
+    counts.number_capacity = 1;
+    ASSERT(rmod_parse_xml_events(parser_allocator, &file, &handler) == RMOD_RESULT_SUCCESS);
+    f64 sum_strtof = 0.0, sum_fast = 0.0;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts_begin);
+    for (u32 i = 0; i < N_RUNS; ++i)
+    {
+        for (u32 j = 0; j < counts.number_count; ++j)
+        {
+            //  Value of an element is followed by the '<' of its end tag, so strtof stops there
+            sum_strtof += strtof(counts.numbers[j].begin, NULL);
+        }
+    }
+    const f64 duration_strtof = seconds_since(&ts_begin);
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts_begin);
+    for (u32 i = 0; i < N_RUNS; ++i)
+    {
+        for (u32 j = 0; j < counts.number_count; ++j)
+        {
+            f32 v;
+            ASSERT(parse_string_segment_to_f32(counts.numbers + j, &v));
+            sum_fast += v;
+        }
+    }
+    const f64 duration_fast = seconds_since(&ts_begin);
+    ASSERT(sum_fast == sum_strtof);
+    printf("Parsed %u numbers: strtof with speed of %g values per ms, parse_string_segment_to_f32 with speed of %g values per ms\n",
+           counts.number_count, (f64)counts.number_count * N_RUNS / (duration_strtof * 1e3),
+           (f64)counts.number_count * N_RUNS / (duration_fast * 1e3));
+
+    jfree(counts.numbers);
+    region_jallocator_destroy(parser_allocator);
+    if (generated)
+    {
+        free(file.ptr);
+    }
+    else
+    {
+        rmod_unmap_file(&file);
+    }
+    rmod_error_cleanup_thread();
+    jallocator_destroy(G_JALLOCATOR);
+    return 0;
+}
@@ -6,6 +6,24 @@
 #include <stdbool.h>
 #include <libgen.h>
 #include <unistd.h>
+#include <locale.h>
+#include <float.h>
+
+//  Long pieces of text can be scanned with AVX2 when the compiler targets it (such as with -march=native), otherwise with
+//  SSE2, which every x86-64 processor has, by defining RMOD_PARSING_USE_SIMD. Names, values, and indentation in model
+//  files are mostly shorter than a vector, so on models measured with xml_benchmark it was slower than checking one
+//  character at a time, which is why that is the default.
+#ifdef RMOD_PARSING_USE_SIMD
+#if defined(__AVX2__)
+#define RMOD_PARSING_SIMD
+#define RMOD_PARSING_AVX2
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#define RMOD_PARSING_SIMD
+#define RMOD_PARSING_SSE2
+#include <emmintrin.h>
+#endif
+#endif
 
 
 static const char WHITESPACE[] = {
@@ -183,6 +201,227 @@ static u32 count_new_lines(u32 length, const char* str)
     return c;
 }
 
+//  Names are almost always ASCII, so these are checked without decoding them first
+static inline bool is_ascii_name_char(const c8 c)
+{
+    return IS_IN_RANGE(c, 'a', 'z') || IS_IN_RANGE(c, 'A', 'Z') || IS_IN_RANGE(c, '0', '9') || c == '_' || c == ':' ||
+           c == '-' || c == '.';
+}
+
+//  Most pieces of text between markup are short, and checking them one character at a time is faster than loading them
+//  into vector registers, since the branches are predicted well. Vector instructions are only used for the text which
+//  remains after this many characters, such as comments, long values, or deep indentation.
+#define SCALAR_PREFIX 16
+
+//  Chunks are only loaded when they are entirely before the end of the file, the rest is checked one character at a
+//  time. Each mask has bit i set when byte i of the chunk matches, and CHUNK_MASK has a bit set for every byte.
+#ifdef RMOD_PARSING_AVX2
+#define CHUNK_SIZE 32
+#define CHUNK_MASK 0xFFFFFFFFu
+typedef __m256i chunk_t;
+#define LOAD_CHUNK(ptr) _mm256_loadu_si256((const __m256i*)(ptr))
+#define SET_CHUNK(c) _mm256_set1_epi8((char)(c))
+#define CMPEQ_CHUNK(a, b) _mm256_cmpeq_epi8((a), (b))
+#define CMPGT_CHUNK(a, b) _mm256_cmpgt_epi8((a), (b))
+#define OR_CHUNK(a, b) _mm256_or_si256((a), (b))
+#define AND_CHUNK(a, b) _mm256_and_si256((a), (b))
+#define ANDNOT_CHUNK(a, b) _mm256_andnot_si256((a), (b))
+#define MOVEMASK_CHUNK(a) (u32)_mm256_movemask_epi8((a))
+#elif defined(RMOD_PARSING_SSE2)
+#define CHUNK_SIZE 16
+#define CHUNK_MASK 0xFFFFu
+typedef __m128i chunk_t;
+#define LOAD_CHUNK(ptr) _mm_loadu_si128((const __m128i*)(ptr))
+#define SET_CHUNK(c) _mm_set1_epi8((char)(c))
+#define CMPEQ_CHUNK(a, b) _mm_cmpeq_epi8((a), (b))
+#define CMPGT_CHUNK(a, b) _mm_cmpgt_epi8((a), (b))
+#define OR_CHUNK(a, b) _mm_or_si128((a), (b))
+#define AND_CHUNK(a, b) _mm_and_si128((a), (b))
+#define ANDNOT_CHUNK(a, b) _mm_andnot_si128((a), (b))
+#define MOVEMASK_CHUNK(a) (u32)_mm_movemask_epi8((a))
+#endif
+
+#ifdef RMOD_PARSING_SIMD
+//  Characters which are c or zero
+static inline u32 char_mask(const chunk_t chunk, const char c)
+{
+    return MOVEMASK_CHUNK(OR_CHUNK(CMPEQ_CHUNK(chunk, SET_CHUNK(c)), CMPEQ_CHUNK(chunk, SET_CHUNK(0))));
+}
+
+static inline u32 whitespace_mask(const chunk_t chunk)
+{
+    return MOVEMASK_CHUNK(OR_CHUNK(
+            OR_CHUNK(CMPEQ_CHUNK(chunk, SET_CHUNK(WHITESPACE[0])), CMPEQ_CHUNK(chunk, SET_CHUNK(WHITESPACE[1]))),
+            OR_CHUNK(CMPEQ_CHUNK(chunk, SET_CHUNK(WHITESPACE[2])), CMPEQ_CHUNK(chunk, SET_CHUNK(WHITESPACE[3])))));
+}
+
+//  Characters in range [low, high], both of which must be ASCII, so that the signed comparison works
+static inline chunk_t in_range(const chunk_t chunk, const char low, const char high)
+{
+    return AND_CHUNK(CMPGT_CHUNK(chunk, SET_CHUNK(low - 1)), CMPGT_CHUNK(SET_CHUNK(high + 1), chunk));
+}
+
+static inline u32 ascii_name_mask(const chunk_t chunk)
+{
+    //  Setting 0x20 makes upper case letters lower case, without making anything else a letter, and the range from '-'
+    //  to ':' has '.', digits, and ':', but also '/'
+    const chunk_t letters = in_range(OR_CHUNK(chunk, SET_CHUNK(0x20)), 'a', 'z');
+    const chunk_t punctuation_and_digits = ANDNOT_CHUNK(CMPEQ_CHUNK(chunk, SET_CHUNK('/')), in_range(chunk, '-', ':'));
+    return MOVEMASK_CHUNK(OR_CHUNK(OR_CHUNK(letters, punctuation_and_digits), CMPEQ_CHUNK(chunk, SET_CHUNK('_'))));
+}
+
+//  Parts of searches which continue past the first SCALAR_PREFIX characters. These are kept out of line, so that the
+//  short searches do not pay for setting up the vector registers.
+__attribute__((noinline)) static const char* find_char_simd(const char* pos, const char* const end, const char c)
+{
+    for (; end - pos >= CHUNK_SIZE; pos += CHUNK_SIZE)
+    {
+        const u32 mask = char_mask(LOAD_CHUNK(pos), c);
+        if (mask)
+        {
+            pos += __builtin_ctz(mask);
+            return *pos == c ? pos : NULL;
+        }
+    }
+    for (; pos < end; ++pos)
+    {
+        if (*pos == c)
+        {
+            return pos;
+        }
+        if (!*pos)
+        {
+            return NULL;
+        }
+    }
+    return NULL;
+}
+
+__attribute__((noinline)) static const char* skip_whitespace_simd(const char* pos, const char* const end)
+{
+    for (; end - pos >= CHUNK_SIZE; pos += CHUNK_SIZE)
+    {
+        const u32 mask = ~whitespace_mask(LOAD_CHUNK(pos)) & CHUNK_MASK;
+        if (mask)
+        {
+            return pos + __builtin_ctz(mask);
+        }
+    }
+    while (pos < end && is_whitespace(*pos))
+    {
+        pos += 1;
+    }
+    return pos;
+}
+
+__attribute__((noinline)) static const char* skip_ascii_name_chars_simd(const char* pos, const char* const end)
+{
+    for (; end - pos >= CHUNK_SIZE; pos += CHUNK_SIZE)
+    {
+        const u32 mask = ~ascii_name_mask(LOAD_CHUNK(pos)) & CHUNK_MASK;
+        if (mask)
+        {
+            return pos + __builtin_ctz(mask);
+        }
+    }
+    while (pos < end && is_ascii_name_char(*pos))
+    {
+        pos += 1;
+    }
+    return pos;
+}
+#endif
+
+//  Finds the first c in [pos, end), same as strchr would, stopping at the first zero byte. Returns NULL if c is not found
+static inline const char* find_char(const char* pos, const char* const end, const char c)
+{
+#ifdef RMOD_PARSING_SIMD
+    const char* const limit = end - pos > SCALAR_PREFIX ? pos + SCALAR_PREFIX : end;
+#else
+    const char* const limit = end;
+#endif
+    for (; pos < limit; ++pos)
+    {
+        if (*pos == c)
+        {
+            return pos;
+        }
+        if (!*pos)
+        {
+            return NULL;
+        }
+    }
+#ifdef RMOD_PARSING_SIMD
+    if (pos != end)
+    {
+        return find_char_simd(pos, end, c);
+    }
+#endif
+    return NULL;
+}
+
+//  Returns the first character in [pos, end) which is not whitespace, or end if there is none
+static inline const char* skip_whitespace(const char* pos, const char* const end)
+{
+#ifdef RMOD_PARSING_SIMD
+    const char* const limit = end - pos > SCALAR_PREFIX ? pos + SCALAR_PREFIX : end;
+#else
+    const char* const limit = end;
+#endif
+    for (; pos < limit; ++pos)
+    {
+        if (!is_whitespace(*pos))
+        {
+            return pos;
+        }
+    }
+#ifdef RMOD_PARSING_SIMD
+    if (pos != end)
+    {
+        return skip_whitespace_simd(pos, end);
+    }
+#endif
+    return end;
+}
+
+//  Returns the first character in [pos, end) which is not an ASCII character allowed in names, or end if there is none
+static inline const char* skip_ascii_name_chars(const char* pos, const char* const end)
+{
+#ifdef RMOD_PARSING_SIMD
+    const char* const limit = end - pos > SCALAR_PREFIX ? pos + SCALAR_PREFIX : end;
+#else
+    const char* const limit = end;
+#endif
+    for (; pos < limit; ++pos)
+    {
+        if (!is_ascii_name_char(*pos))
+        {
+            return pos;
+        }
+    }
+#ifdef RMOD_PARSING_SIMD
+    if (pos != end)
+    {
+        return skip_ascii_name_chars_simd(pos, end);
+    }
+#endif
+    return end;
+}
+
+//  Finds the "-->" which ends the comment, or returns NULL if the comment is not concluded
+static const char* find_comment_end(const char* pos, const char* const end)
+{
+    while ((pos = find_char(pos, end, '-')))
+    {
+        if (end - pos >= 3 && pos[1] == '-' && pos[2] == '>')
+        {
+            return pos;
+        }
+        pos += 1;
+    }
+    return NULL;
+}
+
 static bool parse_name_from_string(const u64 max_len, const char* const str, string_segment* out)
 {
     const char* ptr = str;
@@ -196,14 +435,20 @@ static bool parse_name_from_string(const u64 max_len, const char* const str, str
     {
         return false;
     }
-    do
+    ptr = skip_ascii_name_chars(ptr + c_len, str + max_len);
+    //  Only characters which are not ASCII need to be decoded
+    for (;;)
     {
-        ptr += c_len;
         if (!parse_utf8_to_utf32(max_len - (ptr - str), (const u8*)ptr, &c_len, &c))
         {
             return false;
         }
-    } while (is_name_char(c));
+        if (!is_name_char(c))
+        {
+            break;
+        }
+        ptr += c_len;
+    }
 
     out->begin = str;
     out->len = ptr - str;
@@ -211,22 +456,6 @@ static bool parse_name_from_string(const u64 max_len, const char* const str, str
     return true;
 }
 
-rmod_result rmod_release_xml(rmod_xml_element* root)
-{
-    RMOD_ENTER_FUNCTION;
-    jfree(root->attribute_values);
-    jfree(root->attribute_names);
-    for (u32 i = 0; i < root->child_count; ++i)
-    {
-        rmod_release_xml(root->children + i);
-    }
-    jfree(root->children);
-    memset(root, 0, sizeof*root);
-    RMOD_LEAVE_FUNCTION;
-    return RMOD_RESULT_WAS_NULL;
-}
-
-
 static void print_xml_element_to_file(const rmod_xml_element * e, const u32 depth, FILE* const file)
 {
     RMOD_ENTER_FUNCTION;
@@ -292,12 +521,29 @@ rmod_result rmod_serialize_xml(rmod_xml_element* root, FILE* f_out)
     return RMOD_RESULT_SUCCESS;
 }
 
-rmod_result rmod_parse_xml(const rmod_memory_file* mem_file, rmod_xml_element* p_root)
+//  Element which is open while the file is scanned, with its attributes stored in the shared attribute arrays
+typedef struct xml_frame_struct xml_frame;
+struct xml_frame_struct
+{
+    string_segment name;
+    u32 attrib_offset;
+    u32 attrib_count;
+};
+
+rmod_result rmod_parse_xml_events(region_jallocator* allocator, const rmod_memory_file* mem_file, const rmod_xml_handler* handler)
 {
     RMOD_ENTER_FUNCTION;
     const char* const xml = mem_file->ptr;
     const u64 len = mem_file->file_size;
-    rmod_result res;
+    const char* const end = xml + len;
+    rmod_result res = RMOD_RESULT_BAD_XML;
+    u32 stack_depth = 32;
+    u32 stack_pos = 0;
+    xml_frame* frames = NULL;
+    u32 attrib_capacity = 32;
+    u32 attrib_count = 0;
+    string_segment* attribute_names = NULL;
+    string_segment* attribute_values = NULL;
     const char* pos;
     //  Parse the xml prologue (if present)
     if ((pos = strstr(xml, "<?xml")))
@@ -318,7 +564,7 @@ rmod_result rmod_parse_xml(const rmod_memory_file* mem_file, rmod_xml_element* p
     c32 c;
     do
     {
-        pos = strchr(pos, '<');
+        pos = find_char(pos, end, '<');
         if (!pos)
         {
             RMOD_ERROR("No root element was found");
@@ -334,60 +580,69 @@ rmod_result rmod_parse_xml(const rmod_memory_file* mem_file, rmod_xml_element* p
     } while(!is_name_start_char(c));
 
     //  We have now arrived at the root element
-    rmod_xml_element root = {};
+    string_segment root_name;
     //  Find the end of root's name
-    if (!parse_name_from_string(len - (pos - xml), pos, &root.name))
+    if (!parse_name_from_string(len - (pos - xml), pos, &root_name))
     {
         RMOD_ERROR("Could not parse the name of the root tag");
         goto failed;
     }
-    if (!(pos = strchr(pos, '>')))
+    if (!(pos = find_char(pos, end, '>')))
     {
         RMOD_ERROR("Root element's start tag was not concluded");
         goto failed;
     }
-    if (pos != root.name.begin + root.name.len)
+    if (pos != root_name.begin + root_name.len)
     {
         RMOD_ERROR("Root tag should be only \"<rmod>\"");
         goto failed;
     }
     pos += 1;
 
-
-    u32 stack_depth = 32;
-    u32 stack_pos = 0;
-    rmod_xml_element** current_stack = jalloc(stack_depth * sizeof(*current_stack));
-    if (!current_stack)
+    //  Memory used only depends on how deeply elements are nested and how many attributes they have, not on the size
+    //  of the file
+    frames = region_jalloc(allocator, stack_depth * sizeof(*frames));
+    if (!frames)
     {
-        RMOD_ERROR("Failed jalloc (%zu)", stack_depth * sizeof(*current_stack));
+        RMOD_ERROR("Failed region_jalloc(%p, %zu)", allocator, stack_depth * sizeof(*frames));
         res = RMOD_RESULT_NOMEM;
         goto failed;
     }
-    memset(current_stack, 0, stack_depth * sizeof(*current_stack));
-    rmod_xml_element* current = &root;
-    current_stack[0] = current;
+    attribute_names = region_jalloc(allocator, attrib_capacity * sizeof(*attribute_names));
+    if (!attribute_names)
+    {
+        RMOD_ERROR("Failed region_jalloc(%p, %zu)", allocator, attrib_capacity * sizeof(*attribute_names));
+        res = RMOD_RESULT_NOMEM;
+        goto failed;
+    }
+    attribute_values = region_jalloc(allocator, attrib_capacity * sizeof(*attribute_values));
+    if (!attribute_values)
+    {
+        RMOD_ERROR("Failed region_jalloc(%p, %zu)", allocator, attrib_capacity * sizeof(*attribute_values));
+        res = RMOD_RESULT_NOMEM;
+        goto failed;
+    }
+    frames[0] = (xml_frame){.name = root_name, .attrib_offset = 0, .attrib_count = 0};
+    rmod_xml_element event = {.name = root_name};
+    if ((res = handler->begin_element(handler->param, 0, &event)) != RMOD_RESULT_SUCCESS)
+    {
+        goto failed;
+    }
+    res = RMOD_RESULT_BAD_XML;
     //  Perform descent down the element tree
     for (;;)
     {
         //  Skip any whitespace
-        while (is_whitespace(*pos))
-        {
-            pos += 1;
-        }
-        current = current_stack[stack_pos];
-        const char* new_pos = strchr(pos, '<');
+        pos = skip_whitespace(pos, end);
+        const xml_frame* const current = frames + stack_pos;
+        const char* new_pos = find_char(pos, end, '<');
         if (!new_pos)
         {
             RMOD_ERROR("Tag \"%.*s\" on line %u is unclosed", current->name.len, current->name.begin,
                        count_new_lines(current->name.begin - xml, xml));
-            goto free_fail;
+            goto failed;
         }
 
-        //  Skip any whitespace
-        while (is_whitespace(*pos))
-        {
-            pos += 1;
-        }
         //  We have some text before the next '<'
         string_segment val = {.begin = pos, .len = new_pos - pos};
         //  Trim space after the end of text
@@ -395,7 +650,6 @@ rmod_result rmod_parse_xml(const rmod_memory_file* mem_file, rmod_xml_element* p
         {
             val.len -= 1;
         }
-        current->value = val;
 
         pos = new_pos + 1;
         if (*pos == '/')
@@ -405,16 +659,31 @@ rmod_result rmod_parse_xml(const rmod_memory_file* mem_file, rmod_xml_element* p
             {
                 RMOD_ERROR("Tag \"%.*s\" on line %u was not properly closed", current->name.len, current->name.begin,
                            count_new_lines(current->name.begin - xml, xml));
-                goto free_fail;
+                goto failed;
             }
             pos += 1 + current->name.len;
             if (*pos != '>')
             {
                 RMOD_ERROR("Tag \"%.*s\" on line %u was not properly closed", current->name.len, current->name.begin,
                            count_new_lines(current->name.begin - xml, xml));
-                goto free_fail;
+                goto failed;
             }
             pos += 1;
+            //  Text right before the end tag is the value of the element
+            event = (rmod_xml_element)
+                    {
+                    .name = current->name,
+                    .attrib_count = current->attrib_count,
+                    .attribute_names = attribute_names + current->attrib_offset,
+                    .attribute_values = attribute_values + current->attrib_offset,
+                    .value = val,
+                    };
+            if ((res = handler->end_element(handler->param, stack_pos, &event)) != RMOD_RESULT_SUCCESS)
+            {
+                goto failed;
+            }
+            res = RMOD_RESULT_BAD_XML;
+            attrib_count = current->attrib_offset;
             if (stack_pos)
             {
                 stack_pos -= 1;
@@ -428,11 +697,11 @@ rmod_result rmod_parse_xml(const rmod_memory_file* mem_file, rmod_xml_element* p
         {
             //  This is a comment
             pos += 3;
-            new_pos = strstr(pos, "-->");
+            new_pos = find_comment_end(pos, end);
             if (!new_pos)
             {
                 RMOD_ERROR("Comment on line %u was not concluded", count_new_lines(pos - xml, xml));
-                goto free_fail;
+                goto failed;
             }
             pos = new_pos + 3;
         }
@@ -443,31 +712,12 @@ rmod_result rmod_parse_xml(const rmod_memory_file* mem_file, rmod_xml_element* p
             if (!parse_name_from_string(len - (pos - xml), pos, &name))
             {
                 RMOD_ERROR("Failed parsing tag name on line %u", count_new_lines(pos - xml, xml));
-                goto free_fail;
+                goto failed;
             }
             pos += name.len;
-            //  Add the child
-            if (current->child_count == current->child_capacity)
-            {
-                const u64 new_capacity = current->child_capacity + 32;
-                rmod_xml_element* const new_ptr = jrealloc(current->children, sizeof(*current->children) * new_capacity);
-                if (!new_ptr)
-                {
-                    RMOD_ERROR("Failed jrealloc(%p, %zu)", current->children, sizeof(*current->children) * new_capacity);
-                    goto free_fail;
-                }
-                memset(new_ptr + current->child_count, 0, sizeof(*new_ptr) * (new_capacity - current->child_capacity));
-                current->child_capacity = new_capacity;
-                current->children = new_ptr;
-            }
-            rmod_xml_element* new_child = current->children + (current->child_count++);
-            new_child->name = name;
+            const u32 attrib_offset = attrib_count;
 
-
-            while (is_whitespace(*pos))
-            {
-                pos += 1;
-            }
+            pos = skip_whitespace(pos, end);
             while (*pos != '>')
             {
                 //  There are attributes to add
@@ -476,37 +726,31 @@ rmod_result rmod_parse_xml(const rmod_memory_file* mem_file, rmod_xml_element* p
                 {
                     RMOD_ERROR("Failed parsing attribute name for block %.*s on line %u", name.len, name.begin,
                                count_new_lines(pos - xml, xml));
-                    goto free_fail;
+                    goto failed;
                 }
                 //  Next is the '=', which could be surrounded by whitespace
                 pos += attrib_name.len;
-                while (is_whitespace(*pos))
-                {
-                    pos += 1;
-                }
+                pos = skip_whitespace(pos, end);
                 if (*pos != '=')
                 {
                     RMOD_ERROR("Failed parsing attribute %.*s for block %.*s on line %u: attribute name and value must be separated by '='", attrib_name.len, attrib_name.begin, name.len, name.begin,
                                count_new_lines(pos - xml, xml));
-                    goto free_fail;
+                    goto failed;
                 }
                 pos += 1;
-                while (is_whitespace(*pos))
-                {
-                    pos += 1;
-                }
+                pos = skip_whitespace(pos, end);
                 if (*pos != '\'' && *pos != '\"')
                 {
                     RMOD_ERROR("Failed parsing attribute %.*s for block %.*s on line %u: attribute value must be quoted", attrib_name.len, attrib_name.begin, name.len, name.begin,
                                count_new_lines(pos - xml, xml));
-                    goto free_fail;
+                    goto failed;
                 }
-                new_pos = strchr(pos + 1, *pos);
+                new_pos = find_char(pos + 1, end, *pos);
                 if (!new_pos)
                 {
                     RMOD_ERROR("Failed parsing attribute %.*s for block %.*s on line %u: attribute value quotes are not closed", attrib_name.len, attrib_name.begin, name.len, name.begin,
                                count_new_lines(pos - xml, xml));
-                    goto free_fail;
+                    goto failed;
                 }
                 attrib_val.begin = pos + 1;
                 attrib_val.len = new_pos - pos - 1;
@@ -515,88 +759,217 @@ rmod_result rmod_parse_xml(const rmod_memory_file* mem_file, rmod_xml_element* p
                 {
                     RMOD_ERROR("Failed parsing attribute %.*s for block %.*s on line %u: attributes should be separated by whitespace", attrib_name.len, attrib_name.begin, name.len, name.begin,
                                count_new_lines(pos - xml, xml));
-                    goto free_fail;
+                    goto failed;
                 }
-                if (new_child->attrib_count == new_child->attrib_capacity)
+                if (attrib_count == attrib_capacity)
                 {
-                    const u32 new_capacity = new_child->attrib_capacity + 8;
-                    string_segment* const new_ptr1 = jrealloc(new_child->attribute_names, sizeof(*new_ptr1) * new_capacity);
+                    const u32 new_capacity = attrib_capacity + 32;
+                    string_segment* const new_ptr1 = region_jrealloc(allocator, attribute_names, sizeof(*new_ptr1) * attrib_capacity, sizeof(*new_ptr1) * new_capacity);
                     if (!new_ptr1)
                     {
-                        RMOD_ERROR("Failed calling jrealloc(%p, %zu)", new_child->attribute_names, sizeof(*new_ptr1) * new_capacity);
-                        goto free_fail;
+                        RMOD_ERROR("Failed region_jrealloc(%p, %p, %zu)", allocator, attribute_names, sizeof(*new_ptr1) * new_capacity);
+                        res = RMOD_RESULT_NOMEM;
+                        goto failed;
                     }
-                    memset(new_ptr1 + new_child->attrib_count, 0, sizeof(*new_ptr1) * (new_capacity - new_child->attrib_capacity));
-                    new_child->attribute_names = new_ptr1;
-
-                    string_segment* const new_ptr2 = jrealloc(new_child->attribute_values, sizeof(*new_ptr2) * new_capacity);
+                    attribute_names = new_ptr1;
+                    string_segment* const new_ptr2 = region_jrealloc(allocator, attribute_values, sizeof(*new_ptr2) * attrib_capacity, sizeof(*new_ptr2) * new_capacity);
                     if (!new_ptr2)
                     {
-                        RMOD_ERROR("Failed calling jrealloc(%p, %zu)", new_child->attribute_values, sizeof(*new_ptr2) * new_capacity);
-                        goto free_fail;
+                        RMOD_ERROR("Failed region_jrealloc(%p, %p, %zu)", allocator, attribute_values, sizeof(*new_ptr2) * new_capacity);
+                        res = RMOD_RESULT_NOMEM;
+                        goto failed;
                     }
-                    memset(new_ptr2 + new_child->attrib_count, 0, sizeof(*new_ptr2) * (new_capacity - new_child->attrib_capacity));
-                    new_child->attribute_values = new_ptr2;
-
-                    new_child->attrib_capacity = new_capacity;
+                    attribute_values = new_ptr2;
+                    attrib_capacity = new_capacity;
                 }
-                new_child->attribute_names[new_child->attrib_count] = attrib_name;
-                new_child->attribute_values[new_child->attrib_count] = attrib_val;
-                new_child->attrib_count += 1;
+                attribute_names[attrib_count] = attrib_name;
+                attribute_values[attrib_count] = attrib_val;
+                attrib_count += 1;
 
-                while (is_whitespace(*pos))
-                {
-                    pos += 1;
-                }
+                pos = skip_whitespace(pos, end);
             }
             pos += 1;
 
 
             //  Push the stack
-            if (stack_pos == stack_depth)
+            if (stack_pos + 1 == stack_depth)
             {
                 const u64 new_depth = stack_depth + 32;
-                rmod_xml_element** const new_ptr = jrealloc(current_stack, sizeof(*current_stack) * new_depth);
+                xml_frame* const new_ptr = region_jrealloc(allocator, frames, sizeof(*frames) * stack_depth, sizeof(*frames) * new_depth);
                 if (!new_ptr)
                 {
-                    RMOD_ERROR("Failed jrealloc(%p, %zu)", current_stack, sizeof(*current_stack) * new_depth);
-                    goto free_fail;
+                    RMOD_ERROR("Failed region_jrealloc(%p, %p, %zu)", allocator, frames, sizeof(*frames) * new_depth);
+                    res = RMOD_RESULT_NOMEM;
+                    goto failed;
                 }
-                memset(new_ptr + stack_pos, 0, sizeof(*new_ptr) * (new_depth - stack_depth));
                 stack_depth = new_depth;
-                current_stack = new_ptr;
+                frames = new_ptr;
             }
-            current_stack[++stack_pos] = new_child;
-            if (current->child_count == 1)
-            {
-                assert(current->depth == 0);
-                current->depth = 1;
-                //  First child increases the depth of the tree
-                for (u32 i = 0; i < stack_pos - 1; ++i)
-                {
-                    //  If a child now has an equal depth as parent, parent should have a greater depth
-                    if (current_stack[stack_pos - 1 - i]->depth == current_stack[stack_pos - i - 2]->depth)
+            stack_pos += 1;
+            frames[stack_pos] = (xml_frame){.name = name, .attrib_offset = attrib_offset, .attrib_count = attrib_count - attrib_offset};
+            event = (rmod_xml_element)
                     {
-                        current_stack[stack_pos - 2 - i]->depth += 1;
-                    }
-                }
+                    .name = name,
+                    .attrib_count = attrib_count - attrib_offset,
+                    .attribute_names = attribute_names + attrib_offset,
+                    .attribute_values = attribute_values + attrib_offset,
+                    };
+            if ((res = handler->begin_element(handler->param, stack_pos, &event)) != RMOD_RESULT_SUCCESS)
+            {
+                goto failed;
             }
+            res = RMOD_RESULT_BAD_XML;
         }
     }
 
     done:
     assert(stack_pos == 0);
-    jfree(current_stack);
-    *p_root = root;
+    res = RMOD_RESULT_SUCCESS;
+    failed:
+    RMOD_LEAVE_FUNCTION;
+    return res;
+}
+
+//  Builds the tree of elements from events of the parser, with children and attributes taken from the allocator
+typedef struct xml_tree_builder_struct xml_tree_builder;
+struct xml_tree_builder_struct
+{
+    region_jallocator* allocator;
+    rmod_xml_element root;
+    u32 stack_depth;
+    rmod_xml_element** stack;           //  Element which is open at each depth
+};
+
+static rmod_result tree_begin_element(void* param, u32 depth, const rmod_xml_element* e)
+{
+    RMOD_ENTER_FUNCTION;
+    xml_tree_builder* const this = param;
+    if (depth == this->stack_depth)
+    {
+        const u32 new_depth = this->stack_depth + 32;
+        rmod_xml_element** const new_ptr = jrealloc(this->stack, sizeof(*new_ptr) * new_depth);
+        if (!new_ptr)
+        {
+            RMOD_ERROR("Failed jrealloc(%p, %zu)", this->stack, sizeof(*new_ptr) * new_depth);
+            RMOD_LEAVE_FUNCTION;
+            return RMOD_RESULT_NOMEM;
+        }
+        this->stack = new_ptr;
+        this->stack_depth = new_depth;
+    }
+    if (depth == 0)
+    {
+        this->root.name = e->name;
+        this->stack[0] = &this->root;
+        RMOD_LEAVE_FUNCTION;
+        return RMOD_RESULT_SUCCESS;
+    }
+    //  Add the child
+    rmod_xml_element* const current = this->stack[depth - 1];
+    if (current->child_count == current->child_capacity)
+    {
+        //  Capacity is doubled, since children of the element's own children are allocated in between, so the array can
+        //  rarely be grown in place and each copy is left in the allocator
+        const u64 new_capacity = current->child_capacity ? 2 * current->child_capacity : 8;
+        rmod_xml_element* const new_ptr = region_jrealloc(this->allocator, current->children, sizeof(*current->children) * current->child_capacity, sizeof(*current->children) * new_capacity);
+        if (!new_ptr)
+        {
+            RMOD_ERROR("Failed region_jrealloc(%p, %p, %zu)", this->allocator, current->children, sizeof(*current->children) * new_capacity);
+            RMOD_LEAVE_FUNCTION;
+            return RMOD_RESULT_NOMEM;
+        }
+        memset(new_ptr + current->child_count, 0, sizeof(*new_ptr) * (new_capacity - current->child_capacity));
+        current->child_capacity = new_capacity;
+        current->children = new_ptr;
+    }
+    rmod_xml_element* const new_child = current->children + (current->child_count++);
+    new_child->name = e->name;
+    if (e->attrib_count)
+    {
+        //  Attributes are all known, so no extra capacity is needed
+        const u32 new_capacity = e->attrib_count;
+        new_child->attribute_names = region_jalloc(this->allocator, sizeof(*new_child->attribute_names) * new_capacity);
+        if (!new_child->attribute_names)
+        {
+            RMOD_ERROR("Failed region_jalloc(%p, %zu)", this->allocator, sizeof(*new_child->attribute_names) * new_capacity);
+            RMOD_LEAVE_FUNCTION;
+            return RMOD_RESULT_NOMEM;
+        }
+        new_child->attribute_values = region_jalloc(this->allocator, sizeof(*new_child->attribute_values) * new_capacity);
+        if (!new_child->attribute_values)
+        {
+            RMOD_ERROR("Failed region_jalloc(%p, %zu)", this->allocator, sizeof(*new_child->attribute_values) * new_capacity);
+            RMOD_LEAVE_FUNCTION;
+            return RMOD_RESULT_NOMEM;
+        }
+        memcpy(new_child->attribute_names, e->attribute_names, sizeof(*e->attribute_names) * e->attrib_count);
+        memcpy(new_child->attribute_values, e->attribute_values, sizeof(*e->attribute_values) * e->attrib_count);
+        new_child->attrib_count = e->attrib_count;
+        new_child->attrib_capacity = new_capacity;
+    }
+    this->stack[depth] = new_child;
     RMOD_LEAVE_FUNCTION;
     return RMOD_RESULT_SUCCESS;
+}
 
-    free_fail:
-    rmod_release_xml(&root);
-    jfree(current_stack);
-    failed:
+static rmod_result tree_end_element(void* param, u32 depth, const rmod_xml_element* e)
+{
+    xml_tree_builder* const this = param;
+    rmod_xml_element* const current = this->stack[depth];
+    current->value = e->value;
+    //  Depth of an element is the number of levels of elements below it
+    if (depth && this->stack[depth - 1]->depth < current->depth + 1)
+    {
+        this->stack[depth - 1]->depth = current->depth + 1;
+    }
+    return RMOD_RESULT_SUCCESS;
+}
+
+rmod_result rmod_parse_xml(region_jallocator* allocator, const rmod_memory_file* mem_file, rmod_xml_element* p_root)
+{
+    RMOD_ENTER_FUNCTION;
+    xml_tree_builder builder = {.allocator = allocator, .stack_depth = 0, .stack = NULL};
+    const rmod_xml_handler handler =
+            {
+            .begin_element = tree_begin_element,
+            .end_element = tree_end_element,
+            .param = &builder,
+            };
+    const rmod_result res = rmod_parse_xml_events(allocator, mem_file, &handler);
+    jfree(builder.stack);
+    if (res != RMOD_RESULT_SUCCESS)
+    {
+        RMOD_LEAVE_FUNCTION;
+        return res;
+    }
+    *p_root = builder.root;
     RMOD_LEAVE_FUNCTION;
-    return RMOD_RESULT_BAD_XML;
+    return RMOD_RESULT_SUCCESS;
+}
+
+static rmod_result walk_xml(const rmod_xml_element* e, const u32 depth, const rmod_xml_handler* handler)
+{
+    rmod_result res;
+    if ((res = handler->begin_element(handler->param, depth, e)) != RMOD_RESULT_SUCCESS)
+    {
+        return res;
+    }
+    for (u32 i = 0; i < e->child_count; ++i)
+    {
+        if ((res = walk_xml(e->children + i, depth + 1, handler)) != RMOD_RESULT_SUCCESS)
+        {
+            return res;
+        }
+    }
+    return handler->end_element(handler->param, depth, e);
+}
+
+rmod_result rmod_walk_xml(const rmod_xml_element* root, const rmod_xml_handler* handler)
+{
+    RMOD_ENTER_FUNCTION;
+    const rmod_result res = walk_xml(root, 0, handler);
+    RMOD_LEAVE_FUNCTION;
+    return res;
 }
 
 bool compare_string_segments(const string_segment* s1, const string_segment* s2)
@@ -619,3 +992,168 @@ bool compare_string_segment(u64 len, const char* str, const string_segment* segm
         return false;
     return memcmp(str, segment->begin, len) == 0;
 }
+
+//  Powers of ten which are represented exactly by a double
+static const f64 EXACT_POWERS_OF_TEN[] =
+        {
+        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+        };
+#define MAX_EXACT_POWER_OF_TEN ((i32)(sizeof(EXACT_POWERS_OF_TEN) / sizeof(*EXACT_POWERS_OF_TEN)) - 1)
+
+//  Parses the number with strtof in the "C" locale. Locale is only changed for the calling thread, since numbers are
+//  parsed by worker threads, and localeconv or setlocale would race with them.
+static bool parse_f32_with_strtof(const string_segment* const segment, f32* const p_out)
+{
+    char buffer[128];
+    char* str = buffer;
+    if (segment->len >= sizeof(buffer))
+    {
+        //  Numbers are parsed by worker threads, which can not use jalloc
+        str = malloc(segment->len + 1);
+        if (!str)
+        {
+            RMOD_ERROR("Failed malloc(%zu)", (size_t)segment->len + 1);
+            return false;
+        }
+    }
+    memcpy(str, segment->begin, segment->len);
+    str[segment->len] = 0;
+    bool valid = false;
+    const locale_t c_locale = newlocale(LC_NUMERIC_MASK, "C", (locale_t)0);
+    if (c_locale == (locale_t)0)
+    {
+        RMOD_ERROR("Failed newlocale(LC_NUMERIC_MASK, \"C\", 0)");
+    }
+    else
+    {
+        const locale_t old_locale = uselocale(c_locale);
+        char* end_pos;
+        *p_out = strtof(str, &end_pos);
+        valid = end_pos == str + segment->len;
+        uselocale(old_locale);
+        freelocale(c_locale);
+    }
+    if (str != buffer)
+    {
+        free(str);
+    }
+    return valid;
+}
+
+bool parse_string_segment_to_f32(const string_segment* segment, f32* p_out)
+{
+    const char* pos = segment->begin;
+    const char* const end = pos + segment->len;
+    while (pos < end && is_whitespace(*pos))
+    {
+        pos += 1;
+    }
+    bool negative = false;
+    if (pos < end && (*pos == '-' || *pos == '+'))
+    {
+        negative = *pos == '-';
+        pos += 1;
+    }
+    //  Up to 19 significant digits fit into the mantissa
+    u64 mantissa = 0;
+    u32 significant_digits = 0;
+    i32 exponent = 0;
+    bool found_digits = false;
+    for (; pos < end && IS_IN_RANGE(*pos, '0', '9'); ++pos)
+    {
+        const u32 digit = *pos - '0';
+        found_digits = true;
+        if (mantissa || digit)
+        {
+            if (significant_digits == 19)
+            {
+                goto slow;
+            }
+            mantissa = mantissa * 10 + digit;
+            significant_digits += 1;
+        }
+    }
+    if (pos < end && *pos == '.')
+    {
+        for (pos += 1; pos < end && IS_IN_RANGE(*pos, '0', '9'); ++pos)
+        {
+            const u32 digit = *pos - '0';
+            found_digits = true;
+            if (mantissa || digit)
+            {
+                if (significant_digits == 19)
+                {
+                    goto slow;
+                }
+                mantissa = mantissa * 10 + digit;
+                significant_digits += 1;
+            }
+            exponent -= 1;
+        }
+    }
+    if (!found_digits)
+    {
+        //  Could still be "inf" or "nan", or a hexadecimal number
+        goto slow;
+    }
+    if (pos < end && (*pos == 'e' || *pos == 'E'))
+    {
+        pos += 1;
+        bool negative_exponent = false;
+        if (pos < end && (*pos == '-' || *pos == '+'))
+        {
+            negative_exponent = *pos == '-';
+            pos += 1;
+        }
+        if (pos == end || !IS_IN_RANGE(*pos, '0', '9'))
+        {
+            goto slow;
+        }
+        i32 exponent_value = 0;
+        for (; pos < end && IS_IN_RANGE(*pos, '0', '9'); ++pos)
+        {
+            if (exponent_value < 10000)
+            {
+                exponent_value = exponent_value * 10 + (*pos - '0');
+            }
+        }
+        exponent += negative_exponent ? -exponent_value : exponent_value;
+    }
+    if (pos != end)
+    {
+        goto slow;
+    }
+    if (mantissa == 0)
+    {
+        *p_out = negative ? -0.0f : 0.0f;
+        return true;
+    }
+    //  When both the mantissa and the power of ten are exact doubles, their product or quotient is correctly rounded
+    if (mantissa > (1ull << 53) || exponent < -MAX_EXACT_POWER_OF_TEN || exponent > MAX_EXACT_POWER_OF_TEN)
+    {
+        goto slow;
+    }
+    f64 v = (f64)mantissa;
+    v = exponent < 0 ? v / EXACT_POWERS_OF_TEN[-exponent] : v * EXACT_POWERS_OF_TEN[exponent];
+    if (v < FLT_MIN || v > FLT_MAX)
+    {
+        //  Would be rounded to a denormal, zero, or infinity
+        goto slow;
+    }
+    //  Rounding the double to a float is the same as rounding the exact value to a float, unless the double falls exactly
+    //  half-way between two floats, in which case the exact value could have been on either side of it
+    u64 bits;
+    static_assert(sizeof(bits) == sizeof(v));
+    memcpy(&bits, &v, sizeof(bits));
+    const u64 float_rounded_bits = (1ull << (DBL_MANT_DIG - FLT_MANT_DIG)) - 1;
+    if ((bits & float_rounded_bits) == (float_rounded_bits + 1) >> 1)
+    {
+        goto slow;
+    }
+    *p_out = negative ? -(f32)v : (f32)v;
+    return true;
+
+slow:
+    return parse_f32_with_strtof(segment, p_out);
+}
@@ -28,12 +28,37 @@ struct rmod_xml_element_struct
     string_segment value;
 };
 
-rmod_result rmod_release_xml(rmod_xml_element* root);
+//  Callbacks which receive elements of an xml file as they are parsed. Element passed to them is only valid during the
+//  call and has no children, but its name, attributes, and value point into the file. Depth of the root element is 0.
+typedef struct rmod_xml_handler_struct rmod_xml_handler;
+struct rmod_xml_handler_struct
+{
+    //  Called after the start tag of the element, before any of its children, so its value is still empty
+    rmod_result (*begin_element)(void* param, u32 depth, const rmod_xml_element* e);
+    //  Called after the end tag of the element, with its value being the text right before the end tag
+    rmod_result (*end_element)(void* param, u32 depth, const rmod_xml_element* e);
+    void* param;
+};
+
+//  Parses the file without building the tree of elements, so memory it uses only depends on how deeply elements are
+//  nested. Parsing stops at the first callback which does not return RMOD_RESULT_SUCCESS and its result is returned.
+//  Memory is taken from the allocator, so that files can be parsed by threads which can not use jalloc.
+rmod_result rmod_parse_xml_events(region_jallocator* allocator, const rmod_memory_file* mem_file, const rmod_xml_handler* handler);
 
-rmod_result rmod_parse_xml(const rmod_memory_file* mem_file, rmod_xml_element* p_root);
+//  Builds the tree of elements of the file. Children and attributes of elements are taken from the allocator, so the
+//  whole tree is released with it.
+rmod_result rmod_parse_xml(region_jallocator* allocator, const rmod_memory_file* mem_file, rmod_xml_element* p_root);
+
+//  Calls the handler for each element of the tree in the same order as rmod_parse_xml_events would for its file
+rmod_result rmod_walk_xml(const rmod_xml_element* root, const rmod_xml_handler* handler);
 
 rmod_result rmod_serialize_xml(rmod_xml_element* root, FILE* f_out);
 
+//  Parses the whole segment as a number the same way strtof does in the "C" locale, so the result does not depend on the
+//  current locale. Most numbers are converted directly, only the ones which could be rounded differently are left to
+//  strtof. Returns false if the segment is not a single number.
+bool parse_string_segment_to_f32(const string_segment* segment, f32* p_out);
+
 bool compare_string_segment(u64 len, const char* str, const string_segment* segment);
 bool compare_case_string_segment(u64 len, const char* str, const string_segment* segment);
 bool compare_string_segments(const string_segment* s1, const string_segment* s2);
@@ -0,0 +1,264 @@
+//
+// Created by jan on 19.10.2026.
+//
+
+//  Scanners are static, so the file is included to test them. Built once as it is and once with RMOD_PARSING_USE_SIMD
+//  defined, where both builds must give the results of checking one character at a time, so they are the same.
+#include "parsing_base.c"
+
+//  Checks scanning of text against checking one character at a time, and parsing numbers against strtof in the "C"
+//  locale, both in it and in a locale which uses ',' as the decimal point
+
+#define ASSERT(x) if ((x) == false) {fprintf(stderr, "Failed assertion: \"" #x "\"\n"); __builtin_trap(); exit(EXIT_FAILURE);} (void)0
+//  Longest text which is scanned, which covers two chunks of either size after the scalar prefix
+#define SCAN_MAX_LENGTH 80
+//  Largest offset of the beginning of the text from the start of the buffer, so that it starts at every alignment
+#define SCAN_MAX_OFFSET 32
+#define N_RANDOM_NUMBERS 200000
+#define NUMBER_MAX_LENGTH 64
+
+static const char* reference_find_char(const char* pos, const char* const end, const char c)
+{
+    for (; pos < end; ++pos)
+    {
+        if (*pos == c)
+        {
+            return pos;
+        }
+        if (!*pos)
+        {
+            return NULL;
+        }
+    }
+    return NULL;
+}
+
+static const char* reference_skip_whitespace(const char* pos, const char* const end)
+{
+    while (pos < end && is_whitespace(*pos))
+    {
+        pos += 1;
+    }
+    return pos;
+}
+
+static const char* reference_skip_ascii_name_chars(const char* pos, const char* const end)
+{
+    while (pos < end && is_ascii_name_char(*pos))
+    {
+        pos += 1;
+    }
+    return pos;
+}
+
+//  Fills [begin, end) by repeating the filler
+static void fill_text(char* const begin, const char* const end, const char* const filler)
+{
+    const u64 filler_length = strlen(filler);
+    for (char* p = begin; p < end; ++p)
+    {
+        *p = filler[(p - begin) % filler_length];
+    }
+}
+
+//  Text is checked with the stopper at each position, and then without it. Every value of the stopper is tried around
+//  the ends of the scalar prefix and of the chunks, other positions only with a few.
+static void check_stoppers(char* const begin, char* const end, const char* const filler, const bool all_alignments)
+{
+    const u32 length = (u32)(end - begin);
+    fill_text(begin, end, filler);
+    for (u32 i = 0; i <= length; ++i)
+    {
+        const bool all_values = all_alignments && (i == 0 || i + 1 == length || (i % 16) <= 1 || (i % 16) == 15);
+        for (u32 v = 0; v < 256; ++v)
+        {
+            if (i == length ? v != 0 : !all_values && v != '>' && v != 'x' && v != 0)
+            {
+                continue;
+            }
+            const char old = i < length ? begin[i] : 0;
+            if (i < length)
+            {
+                begin[i] = (char)v;
+            }
+            ASSERT(skip_whitespace(begin, end) == reference_skip_whitespace(begin, end));
+            ASSERT(skip_ascii_name_chars(begin, end) == reference_skip_ascii_name_chars(begin, end));
+            ASSERT(find_char(begin, end, '>') == reference_find_char(begin, end, '>'));
+            ASSERT(find_char(begin, end, (char)0xE2) == reference_find_char(begin, end, (char)0xE2));
+            if (i < length)
+            {
+                begin[i] = old;
+            }
+        }
+    }
+}
+
+static void check_scanners(void)
+{
+    for (u32 length = 0; length <= SCAN_MAX_LENGTH; ++length)
+    {
+        for (u32 offset = 0; offset <= SCAN_MAX_OFFSET; ++offset)
+        {
+            //  Buffer ends right where the text does, so that reading past it is caught by the address sanitizer
+            char* const buffer = malloc(offset + length ? offset + length : 1);
+            ASSERT(buffer);
+            memset(buffer, '>', offset);
+            char* const begin = buffer + offset;
+            char* const end = begin + length;
+            const bool all_alignments = offset == 0 || offset == 1 || offset == 15 || offset == SCAN_MAX_OFFSET;
+            check_stoppers(begin, end, " \t\r\n", all_alignments);
+            check_stoppers(begin, end, "aZz_09:-.Az", all_alignments);
+            check_stoppers(begin, end, "abc \t\"'<=/-", all_alignments);
+            //  Zero byte before the character which is looked for ends the search
+            for (u32 i = 0; i + 1 < length; ++i)
+            {
+                fill_text(begin, end, "abc \t\"'<=/-");
+                begin[i] = 0;
+                end[-1] = '>';
+                ASSERT(find_char(begin, end, '>') == NULL);
+                ASSERT(reference_find_char(begin, end, '>') == NULL);
+            }
+            free(buffer);
+        }
+    }
+}
+
+typedef struct number_case_struct number_case;
+struct number_case_struct
+{
+    char text[NUMBER_MAX_LENGTH];
+    bool valid;
+    f32 value;
+};
+
+//  Parses the number with strtof in the current locale, which must be "C", the same way parse_string_segment_to_f32 is
+//  specified to
+static void reference_number(number_case* const c)
+{
+    char* end_pos;
+    c->value = strtof(c->text, &end_pos);
+    c->valid = end_pos == c->text + strlen(c->text);
+}
+
+//  Number is followed by a digit in memory, which must not be taken as a part of it
+static void check_number(const number_case* const c)
+{
+    char buffer[NUMBER_MAX_LENGTH + 1];
+    const u32 length = (u32)strlen(c->text);
+    memcpy(buffer, c->text, length);
+    buffer[length] = '7';
+    const string_segment segment = {.begin = buffer, .len = length};
+    f32 value;
+    const bool valid = parse_string_segment_to_f32(&segment, &value);
+    if (valid != c->valid || (valid && !(memcmp(&value, &c->value, sizeof(value)) == 0 || (isnan(value) && isnan(c->value)))))
+    {
+        fprintf(stderr, "Number \"%s\" was parsed as %s %.9g instead of %s %.9g\n", c->text, valid ? "valid" : "invalid",
+                (f64)value, c->valid ? "valid" : "invalid", (f64)c->value);
+        ASSERT(false);
+    }
+}
+
+static const char* const NUMBERS[] =
+        {
+        "0", "-0", "+0", "0.0", "00012", "1", "+1", "-1.5", "0.1", "3.14159", "13.2", ".5", "5.", "-.25", "  42",
+        "1e10", "1E-5", "+2.5e+3", "2.5e-0", "6.02214076e23", "1.602176634e-19",
+        //  Exactly half-way between two floats, which are rounded to the even one
+        "16777217", "16777219", "-16777217", "33554434", "33554438", "1.000000059604644775390625",
+        "1.000000178813934326171875", "0.500000029802322387695312", "0.5000000298023223876953125",
+        "1.00000005960464477539063", "1.00000005960464477539062",
+        //  Mantissas which just fit and which do not fit into the fast path
+        "1234567890123456789", "12345678901234567890", "9999999999999999999", "99999999999999999999",
+        "9007199254740993", "9007199254740992", "0.0000012345678901234567890", "1234567890123456789e-10",
+        "0.1234567890123456789", "00000000000000000000000001.5",
+        //  Limits of the range and past them
+        "3.4028235e38", "3.40282357e38", "3.4028236e38", "1e38", "1e39", "-1e39", "1.17549435e-38", "1e-38",
+        "1e-40", "1.4e-45", "1e-46", "1e-50", "1e400", "1e-400", "1e22", "1e23", "1e-22", "1e-23",
+        "1e99999999999", "1e-99999999999", "0e99999999999", "0.000000000000000000000000000001e30",
+        //  Left to strtof
+        "inf", "-inf", "+INF", "infinity", "nan", "-nan", "NaN", "0x1p3", "0x1.8p1", "0X10", "-0x.8",
+        //  Not numbers
+        " ", "+", "-", ".", "+.", "e5", "1e", "1e+", "1e-", "1.2.3", "1,5", "1 ", "1 2", "abc", "--1", "+-1", "0x",
+        "1e5.5", "1f", "nan(", "in",
+        };
+
+static void check_numbers(void)
+{
+    const u32 fixed_count = sizeof(NUMBERS) / sizeof(*NUMBERS);
+    number_case* const cases = malloc(sizeof(*cases) * (fixed_count + N_RANDOM_NUMBERS));
+    ASSERT(cases);
+    for (u32 i = 0; i < fixed_count; ++i)
+    {
+        ASSERT(strlen(NUMBERS[i]) < NUMBER_MAX_LENGTH);
+        strcpy(cases[i].text, NUMBERS[i]);
+    }
+    //  Decimals with up to 21 digits and exponents around the range of floats, so both paths are taken
+    u64 state = 0x853c49e6748fea9b;
+    for (u32 i = fixed_count; i < fixed_count + N_RANDOM_NUMBERS; ++i)
+    {
+        char* p = cases[i].text;
+        state = state * 6364136223846793005 + 1442695040888963407;
+        const u32 digit_count = 1 + (u32)((state >> 33) % 21);
+        const u32 point = (u32)((state >> 43) % (digit_count + 1));
+        const i32 exponent = (i32)((state >> 51) % 90) - 50;
+        if ((state >> 60) & 1)
+        {
+            *p++ = '-';
+        }
+        for (u32 j = 0; j < digit_count; ++j)
+        {
+            if (j == point)
+            {
+                *p++ = '.';
+            }
+            state = state * 6364136223846793005 + 1442695040888963407;
+            *p++ = (char)('0' + (state >> 33) % 10);
+        }
+        sprintf(p, "e%d", exponent);
+    }
+
+    for (u32 i = 0; i < fixed_count + N_RANDOM_NUMBERS; ++i)
+    {
+        reference_number(cases + i);
+        check_number(cases + i);
+    }
+    //  Results must not depend on the locale, even when strtof would take ',' as the decimal point and not '.'
+    const char* const comma_locales[] = {"de_DE.UTF-8", "de_DE.utf8", "de_DE", "fr_FR.UTF-8", "fr_FR.utf8", "cs_CZ.UTF-8", "cs_CZ.utf8"};
+    bool found_locale = false;
+    for (u32 i = 0; i < sizeof(comma_locales) / sizeof(*comma_locales) && !found_locale; ++i)
+    {
+        found_locale = setlocale(LC_NUMERIC, comma_locales[i]) && *localeconv()->decimal_point == ',';
+    }
+    if (found_locale)
+    {
+        for (u32 i = 0; i < fixed_count + N_RANDOM_NUMBERS; ++i)
+        {
+            check_number(cases + i);
+        }
+        setlocale(LC_NUMERIC, "C");
+    }
+    else
+    {
+        setlocale(LC_NUMERIC, "C");
+        printf("No locale with ',' as the decimal point is installed, so numbers were only checked in the \"C\" locale\n");
+    }
+    free(cases);
+}
+
+int main()
+{
+    G_JALLOCATOR = jallocator_create((1 << 20), (1 << 19), 1);
+    ASSERT(G_JALLOCATOR);
+    rmod_error_init_thread("parsing test", RMOD_ERROR_LEVEL_NONE, 32, 32);
+
+    check_scanners();
+    check_numbers();
+#ifdef RMOD_PARSING_SIMD
+    printf("Vector scanners (chunks of %u bytes) and number parsing matched the references\n", CHUNK_SIZE);
+#else
+    printf("Scalar scanners and number parsing matched the references\n");
+#endif
+
+    rmod_error_cleanup_thread();
+    jallocator_destroy(G_JALLOCATOR);
+    return 0;
+}
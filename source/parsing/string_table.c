@@ -0,0 +1,175 @@
+//
+// Created by jan on 19.10.2026.
+//
+#include "string_table.h"
+
+//  Table grows once more than this fraction of slots is used
+#define RMOD_STRING_TABLE_MAX_LOAD 0.5
+
+//  FNV-1a, with 0 reserved for empty slots
+static u64 hash_segment(const string_segment* key)
+{
+    u64 hash = 0xcbf29ce484222325;
+    for (u32 i = 0; i < key->len; ++i)
+    {
+        hash ^= (unsigned char)key->begin[i];
+        hash *= 0x100000001b3;
+    }
+    return hash ? hash : 1;
+}
+
+static rmod_result allocate_slots(const u32 capacity, rmod_string_table* table)
+{
+    RMOD_ENTER_FUNCTION;
+    const u64 size = (sizeof(*table->hashes) + sizeof(*table->keys) + sizeof(*table->values)) * capacity;
+    u64* hashes;
+    string_segment* keys;
+    u32* values;
+    if (table->allocator)
+    {
+        //  All slots are in one allocation
+        hashes = region_jalloc(table->allocator, size);
+        if (!hashes)
+        {
+            RMOD_ERROR("Failed region_jalloc(%p, %zu)", table->allocator, (size_t)size);
+            RMOD_LEAVE_FUNCTION;
+            return RMOD_RESULT_NOMEM;
+        }
+        keys = (string_segment*)(hashes + capacity);
+        values = (u32*)(keys + capacity);
+    }
+    else
+    {
+        hashes = jalloc(sizeof(*hashes) * capacity);
+        if (!hashes)
+        {
+            RMOD_ERROR("Failed jalloc(%zu)", sizeof(*hashes) * capacity);
+            RMOD_LEAVE_FUNCTION;
+            return RMOD_RESULT_NOMEM;
+        }
+        keys = jalloc(sizeof(*keys) * capacity);
+        if (!keys)
+        {
+            jfree(hashes);
+            RMOD_ERROR("Failed jalloc(%zu)", sizeof(*keys) * capacity);
+            RMOD_LEAVE_FUNCTION;
+            return RMOD_RESULT_NOMEM;
+        }
+        values = jalloc(sizeof(*values) * capacity);
+        if (!values)
+        {
+            jfree(keys);
+            jfree(hashes);
+            RMOD_ERROR("Failed jalloc(%zu)", sizeof(*values) * capacity);
+            RMOD_LEAVE_FUNCTION;
+            return RMOD_RESULT_NOMEM;
+        }
+    }
+    memset(hashes, 0, sizeof(*hashes) * capacity);
+    table->capacity = capacity;
+    table->hashes = hashes;
+    table->keys = keys;
+    table->values = values;
+    RMOD_LEAVE_FUNCTION;
+    return RMOD_RESULT_SUCCESS;
+}
+
+//  Index of the slot which holds the key, or of the empty slot where it would be inserted
+static u32 find_slot(const rmod_string_table* table, const string_segment* key, const u64 hash)
+{
+    const u32 mask = table->capacity - 1;
+    u32 i = (u32)hash & mask;
+    while (table->hashes[i] && (table->hashes[i] != hash || !compare_string_segments(table->keys + i, key)))
+    {
+        i = (i + 1) & mask;
+    }
+    return i;
+}
+
+rmod_result rmod_string_table_create_in_region(region_jallocator* allocator, u32 expected_count, rmod_string_table* p_out)
+{
+    RMOD_ENTER_FUNCTION;
+    u32 capacity = 16;
+    while ((f64)expected_count > RMOD_STRING_TABLE_MAX_LOAD * (f64)capacity)
+    {
+        capacity <<= 1;
+    }
+    rmod_string_table table = {.allocator = allocator, .count = 0};
+    const rmod_result res = allocate_slots(capacity, &table);
+    if (res == RMOD_RESULT_SUCCESS)
+    {
+        *p_out = table;
+    }
+    RMOD_LEAVE_FUNCTION;
+    return res;
+}
+
+rmod_result rmod_string_table_create(u32 expected_count, rmod_string_table* p_out)
+{
+    return rmod_string_table_create_in_region(NULL, expected_count, p_out);
+}
+
+void rmod_string_table_destroy(rmod_string_table* table)
+{
+    if (!table->allocator)
+    {
+        jfree(table->values);
+        jfree(table->keys);
+        jfree(table->hashes);
+    }
+    memset(table, 0, sizeof(*table));
+}
+
+rmod_result rmod_string_table_insert(rmod_string_table* table, const string_segment* key, u32 value, u32* p_value)
+{
+    RMOD_ENTER_FUNCTION;
+    const u64 hash = hash_segment(key);
+    u32 i = find_slot(table, key, hash);
+    if (table->hashes[i])
+    {
+        *p_value = table->values[i];
+        RMOD_LEAVE_FUNCTION;
+        return RMOD_RESULT_SUCCESS;
+    }
+    if ((f64)(table->count + 1) > RMOD_STRING_TABLE_MAX_LOAD * (f64)table->capacity)
+    {
+        rmod_string_table old = *table;
+        const rmod_result res = allocate_slots(old.capacity << 1, table);
+        if (res != RMOD_RESULT_SUCCESS)
+        {
+            RMOD_LEAVE_FUNCTION;
+            return res;
+        }
+        for (u32 j = 0; j < old.capacity; ++j)
+        {
+            if (!old.hashes[j])
+            {
+                continue;
+            }
+            const u32 k = find_slot(table, old.keys + j, old.hashes[j]);
+            table->hashes[k] = old.hashes[j];
+            table->keys[k] = old.keys[j];
+            table->values[k] = old.values[j];
+        }
+        rmod_string_table_destroy(&old);
+        i = find_slot(table, key, hash);
+    }
+    table->hashes[i] = hash;
+    table->keys[i] = *key;
+    table->values[i] = value;
+    table->count += 1;
+    *p_value = value;
+    RMOD_LEAVE_FUNCTION;
+    return RMOD_RESULT_SUCCESS;
+}
+
+bool rmod_string_table_find(const rmod_string_table* table, const string_segment* key, u32* p_value)
+{
+    const u32 i = find_slot(table, key, hash_segment(key));
+    if (!table->hashes[i])
+    {
+        return false;
+    }
+    *p_value = table->values[i];
+    return true;
+}
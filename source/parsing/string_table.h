@@ -0,0 +1,38 @@
+//
+// Created by jan on 19.10.2026.
+//
+
+#ifndef RMOD_STRING_TABLE_H
+#define RMOD_STRING_TABLE_H
+#include "parsing_base.h"
+
+//  Hash table which maps strings to indices, using open addressing with linear probing. Keys are not copied, so the
+//  memory they point to must outlive the table.
+typedef struct rmod_string_table_struct rmod_string_table;
+struct rmod_string_table_struct
+{
+    region_jallocator* allocator;       //  Memory of the slots when not NULL, otherwise they are allocated by jalloc
+    u32 capacity;                       //  Always a power of two
+    u32 count;
+    u64* hashes;                        //  Hash of each slot's key, 0 for empty slots
+    string_segment* keys;
+    u32* values;
+};
+
+//  Creates a table large enough to hold expected_count keys without having to grow. Memory is allocated by jalloc.
+rmod_result rmod_string_table_create(u32 expected_count, rmod_string_table* p_out);
+
+//  Creates the table with its memory taken from the allocator, so that it can be used by threads which can not use
+//  jalloc. Slots are released together with the allocator, when the table grows old ones are left in it.
+rmod_result rmod_string_table_create_in_region(region_jallocator* allocator, u32 expected_count, rmod_string_table* p_out);
+
+void rmod_string_table_destroy(rmod_string_table* table);
+
+//  Inserts the key with the given value, unless the key is already in the table. Value stored for the key is written to
+//  p_value either way, so the key was a duplicate if it differs from the value given.
+rmod_result rmod_string_table_insert(rmod_string_table* table, const string_segment* key, u32 value, u32* p_value);
+
+//  Finds the value stored for the key, returns false if it is not in the table
+bool rmod_string_table_find(const rmod_string_table* table, const string_segment* key, u32* p_value);
+
+#endif //RMOD_STRING_TABLE_H
@@ -0,0 +1,85 @@
+//
+// Created by jan on 19.10.2026.
+//
+#include "string_table.h"
+
+//  Checks that duplicates keep the value they were first inserted with, that the table keeps all keys when it grows,
+//  and that keys are compared by their length, not by a terminating NUL
+
+#define ASSERT(x) if ((x) == false) {fprintf(stderr, "Failed assertion: \"" #x "\"\n"); __builtin_trap(); exit(EXIT_FAILURE);} (void)0
+#define N_KEYS 5000
+#define KEY_LENGTH 8
+
+static void check_table(rmod_string_table* table)
+{
+    //  Keys are parts of one buffer which has no NUL characters, so none of them are terminated
+    static char buffer[N_KEYS * KEY_LENGTH];
+    for (u32 i = 0; i < N_KEYS; ++i)
+    {
+        for (u32 j = 0; j < KEY_LENGTH; ++j)
+        {
+            buffer[i * KEY_LENGTH + j] = (char)('a' + ((i >> (2 * j)) & 3) + 4 * (j & 1));
+        }
+    }
+    const u32 initial_capacity = table->capacity;
+    u32 value;
+    for (u32 i = 0; i < N_KEYS; ++i)
+    {
+        const string_segment key = {.begin = buffer + i * KEY_LENGTH, .len = KEY_LENGTH};
+        ASSERT(rmod_string_table_insert(table, &key, i, &value) == RMOD_RESULT_SUCCESS);
+        ASSERT(value == i);
+    }
+    ASSERT(table->count == N_KEYS);
+    ASSERT(table->capacity > initial_capacity);
+    ASSERT((table->capacity & (table->capacity - 1)) == 0);
+    for (u32 i = 0; i < N_KEYS; ++i)
+    {
+        const string_segment key = {.begin = buffer + i * KEY_LENGTH, .len = KEY_LENGTH};
+        ASSERT(rmod_string_table_find(table, &key, &value));
+        ASSERT(value == i);
+    }
+
+    //  Inserting a key again, from a different place in memory, gives the value it already had
+    char copy[KEY_LENGTH];
+    memcpy(copy, buffer + 123 * KEY_LENGTH, KEY_LENGTH);
+    const string_segment duplicate = {.begin = copy, .len = KEY_LENGTH};
+    ASSERT(rmod_string_table_insert(table, &duplicate, N_KEYS, &value) == RMOD_RESULT_SUCCESS);
+    ASSERT(value == 123);
+    ASSERT(table->count == N_KEYS);
+
+    //  Prefixes of keys are different keys, even though they are followed by the same characters in memory
+    const string_segment prefix = {.begin = buffer + 7 * KEY_LENGTH, .len = KEY_LENGTH - 1};
+    ASSERT(!rmod_string_table_find(table, &prefix, &value));
+    ASSERT(rmod_string_table_insert(table, &prefix, N_KEYS, &value) == RMOD_RESULT_SUCCESS);
+    ASSERT(value == N_KEYS);
+    ASSERT(rmod_string_table_find(table, &prefix, &value) && value == N_KEYS);
+    const string_segment whole = {.begin = buffer + 7 * KEY_LENGTH, .len = KEY_LENGTH};
+    ASSERT(rmod_string_table_find(table, &whole, &value) && value == 7);
+    const string_segment empty = {.begin = buffer, .len = 0};
+    ASSERT(!rmod_string_table_find(table, &empty, &value));
+    ASSERT(table->count == N_KEYS + 1);
+}
+
+int main()
+{
+    G_JALLOCATOR = jallocator_create((1 << 20), (1 << 19), 1);
+    ASSERT(G_JALLOCATOR);
+    rmod_error_init_thread("string table test", RMOD_ERROR_LEVEL_NONE, 32, 32);
+
+    rmod_string_table table;
+    ASSERT(rmod_string_table_create(1, &table) == RMOD_RESULT_SUCCESS);
+    check_table(&table);
+    rmod_string_table_destroy(&table);
+
+    region_jallocator* const allocator = region_jallocator_create(1 << 12);
+    ASSERT(allocator);
+    ASSERT(rmod_string_table_create_in_region(allocator, 1, &table) == RMOD_RESULT_SUCCESS);
+    check_table(&table);
+    rmod_string_table_destroy(&table);
+    region_jallocator_destroy(allocator);
+    printf("String table kept all keys\n");
+
+    rmod_error_cleanup_thread();
+    jallocator_destroy(G_JALLOCATOR);
+    return 0;
+}
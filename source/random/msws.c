@@ -18,6 +18,25 @@ void rmod_msws_init(rmod_msws_state* rng, u64 x0, u64 x1, u64 w0, u64 w1)
     rng->has_remaining = false;
 }
 
+//  SplitMix64 step, which spreads nearby keys over the whole state space
+static uint_fast64_t splitmix64(uint_fast64_t* state)
+{
+    uint_fast64_t z = (*state += 0x9e3779b97f4a7c15);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+    return z ^ (z >> 31);
+}
+
+void rmod_msws_init_keyed(rmod_msws_state* rng, u64 seed, u64 key)
+{
+    uint_fast64_t state = seed ^ (key * 0xd1342543de82ef95);
+    const uint_fast64_t x0 = splitmix64(&state);
+    const uint_fast64_t x1 = splitmix64(&state);
+    const uint_fast64_t w0 = splitmix64(&state);
+    const uint_fast64_t w1 = splitmix64(&state);
+    rmod_msws_init(rng, x0, x1, w0, w1);
+}
+
 uint_fast64_t rmod_msws_rng(rmod_msws_state* rng)
 {
     uint_fast64_t tmp;
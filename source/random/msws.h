@@ -26,6 +26,10 @@ extern _Atomic u64 MSWS_TIMES_CALLED;
 
 void rmod_msws_init(rmod_msws_state* rng, u64 x0, u64 x1, u64 w0, u64 w1);
 
+//  Initializes the generator to the stream identified by the key, so that the same seed and key always give the same
+//  sequence, no matter which thread uses it or in what order the streams are used
+void rmod_msws_init_keyed(rmod_msws_state* rng, u64 seed, u64 key);
+
 uint_fast64_t rmod_msws_rng(rmod_msws_state* rng);
 
 double rmod_msws_rngf(rmod_msws_state* rng);
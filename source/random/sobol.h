@@ -0,0 +1,28 @@
+//
+// Created by jan on 19.10.2026.
+//
+
+//  Based on:
+//  Joe, S., Kuo, F. Y., "Constructing Sobol sequences with better two-dimensional projections", 2008,
+//  https://doi.org/10.1137/070709359
+//  Burley, B., "Practical Hash-based Owen Scrambling", 2020, Journal of Computer Graphics Techniques 9(4)
+
+#ifndef RMOD_SOBOL_H
+#define RMOD_SOBOL_H
+#include <stdint.h>
+#include "../common/common.h"
+
+//  Number of dimensions for which direction numbers are available
+#define RMOD_SOBOL_MAX_DIMENSIONS 16
+
+//  Writes the first dimension_count coordinates of the point with the given index of the Sobol sequence, each of them
+//  scrambled by nested uniform (Owen) scrambling keyed by the seed and the dimension. Points with different seeds are
+//  independent randomizations of the same sequence, so the mean of each is an unbiased estimate. Coordinates are in
+//  the open interval (0, 1).
+void rmod_sobol_point(u32 index, u32 dimension_count, u64 seed, f64* p_out);
+
+//  Writes the first dimension_count coordinates of the point with the given index of the Sobol sequence without any
+//  scrambling, as fractions of 2^32. Points are in the order of their index, not in the Gray code order.
+void rmod_sobol_point_unscrambled(u32 index, u32 dimension_count, uint32_t* p_out);
+
+#endif //RMOD_SOBOL_H
@@ -0,0 +1,131 @@
+//
+// Created by jan on 19.10.2026.
+//
+#include "sobol.h"
+
+//  Checks unscrambled points against the reference sequence, and that scrambled points keep its stratification
+
+#define ASSERT(x) if ((x) == false) {fprintf(stderr, "Failed assertion: \"" #x "\"\n"); __builtin_trap(); exit(EXIT_FAILURE);} (void)0
+#define MAX_LEVEL 12
+#define N_SEEDS 8
+
+//  First points of the first four dimensions, as given by the generator of Joe and Kuo (in Gray code order)
+static const f64 REFERENCE_POINTS[][4] =
+        {
+        {0.0, 0.0, 0.0, 0.0},
+        {0.5, 0.5, 0.5, 0.5},
+        {0.75, 0.25, 0.25, 0.25},
+        {0.25, 0.75, 0.75, 0.75},
+        {0.375, 0.375, 0.625, 0.875},
+        {0.875, 0.875, 0.125, 0.375},
+        {0.625, 0.125, 0.875, 0.625},
+        {0.125, 0.625, 0.375, 0.125},
+        {0.1875, 0.3125, 0.9375, 0.4375},
+        {0.6875, 0.8125, 0.4375, 0.9375},
+        };
+
+static u32 reverse_index(u32 x, const u32 bits)
+{
+    u32 r = 0;
+    for (u32 i = 0; i < bits; ++i, x >>= 1)
+    {
+        r = (r << 1) | (x & 1);
+    }
+    return r;
+}
+
+static void check_unscrambled(void)
+{
+    uint32_t x[RMOD_SOBOL_MAX_DIMENSIONS];
+    for (u32 i = 0; i < sizeof(REFERENCE_POINTS) / sizeof(*REFERENCE_POINTS); ++i)
+    {
+        rmod_sobol_point_unscrambled(i ^ (i >> 1), 4, x);
+        for (u32 j = 0; j < 4; ++j)
+        {
+            ASSERT((f64)x[j] / 4294967296.0 == REFERENCE_POINTS[i][j]);
+        }
+    }
+    //  First dimension is the van der Corput sequence
+    for (u32 i = 0; i < (1 << 16); ++i)
+    {
+        rmod_sobol_point_unscrambled(i, 1, x);
+        ASSERT(x[0] == reverse_index(i, 32));
+    }
+}
+
+//  Each of the first 2^k points must be in a different interval of length 2^-k in each dimension, and in a different
+//  elementary interval of area 2^-k of the first two dimensions
+static void check_stratified(const bool scrambled, const u64 seed)
+{
+    static u8 occupied[1 << MAX_LEVEL];
+    static u32 cells[RMOD_SOBOL_MAX_DIMENSIONS][1 << MAX_LEVEL];
+    for (u32 i = 0; i < (1 << MAX_LEVEL); ++i)
+    {
+        if (scrambled)
+        {
+            f64 v[RMOD_SOBOL_MAX_DIMENSIONS];
+            rmod_sobol_point(i, RMOD_SOBOL_MAX_DIMENSIONS, seed, v);
+            for (u32 j = 0; j < RMOD_SOBOL_MAX_DIMENSIONS; ++j)
+            {
+                ASSERT(v[j] > 0.0 && v[j] < 1.0);
+                cells[j][i] = (u32)(v[j] * (1 << MAX_LEVEL));
+            }
+        }
+        else
+        {
+            uint32_t x[RMOD_SOBOL_MAX_DIMENSIONS];
+            rmod_sobol_point_unscrambled(i, RMOD_SOBOL_MAX_DIMENSIONS, x);
+            for (u32 j = 0; j < RMOD_SOBOL_MAX_DIMENSIONS; ++j)
+            {
+                cells[j][i] = x[j] >> (32 - MAX_LEVEL);
+            }
+        }
+    }
+
+    for (u32 k = 0; k <= MAX_LEVEL; ++k)
+    {
+        const u32 n = 1 << k;
+        for (u32 j = 0; j < RMOD_SOBOL_MAX_DIMENSIONS; ++j)
+        {
+            memset(occupied, 0, n);
+            for (u32 i = 0; i < n; ++i)
+            {
+                const u32 cell = cells[j][i] >> (MAX_LEVEL - k);
+                ASSERT(!occupied[cell]);
+                occupied[cell] = 1;
+            }
+        }
+        for (u32 a = 0; a <= k; ++a)
+        {
+            memset(occupied, 0, n);
+            for (u32 i = 0; i < n; ++i)
+            {
+                const u32 cell = ((cells[0][i] >> (MAX_LEVEL - a)) << (k - a)) | (cells[1][i] >> (MAX_LEVEL - (k - a)));
+                ASSERT(!occupied[cell]);
+                occupied[cell] = 1;
+            }
+        }
+    }
+}
+
+int main()
+{
+    G_JALLOCATOR = jallocator_create((1 << 10), (1 << 9), 1);
+    ASSERT(G_JALLOCATOR);
+
+    check_unscrambled();
+    check_stratified(false, 0);
+    for (u32 i = 0; i < N_SEEDS; ++i)
+    {
+        check_stratified(true, 0x5eed + 0x9e3779b97f4a7c15 * i);
+    }
+    //  Randomizations with different seeds must differ
+    f64 a[RMOD_SOBOL_MAX_DIMENSIONS], b[RMOD_SOBOL_MAX_DIMENSIONS];
+    rmod_sobol_point(1, RMOD_SOBOL_MAX_DIMENSIONS, 1, a);
+    rmod_sobol_point(1, RMOD_SOBOL_MAX_DIMENSIONS, 2, b);
+    ASSERT(memcmp(a, b, sizeof(a)) != 0);
+    printf("Sobol points matched the reference and stayed stratified\n");
+
+    jallocator_destroy(G_JALLOCATOR);
+    return 0;
+}
@@ -3,615 +3,749 @@
 //
 
 #include "compile.h"
+#include "../common/parallel.h"
+#include <inttypes.h>
 
-typedef struct chain_dependency_info_struct chain_dependency_info;
-struct chain_dependency_info_struct
+//  Size of memory reserved by each worker for chains it compiles
+#define RMOD_COMPILE_ARENA_SIZE ((u64)1 << 28)
+
+//  Chain compiled by a worker, with all of its memory in the worker's arena
+typedef struct compiled_chain_struct compiled_chain;
+struct compiled_chain_struct
 {
-    u32 index;
-    u32 dependency_count;
-    u32* dependency_list;
+    u32 element_count;
+    rmod_chain_element* elements;
+    char* name_buffer;                  //  Labels of inlined elements, NULL when there were none
+    u64 name_bytes;                     //  Bytes used in the name buffer
+    u32 name_bytes_total;               //  Bytes taken by labels of all elements
 };
 
-static rmod_result copy_element(const rmod_chain_element* const this, rmod_chain_element* const dest)
+typedef struct compile_context_struct compile_context;
+struct compile_context_struct
 {
-    RMOD_ENTER_FUNCTION;
-    ptrdiff_t* new_parents, *new_children;
-    if (this->parent_count)
-    {
-        new_parents = jalloc(this->parent_count * sizeof(*new_parents));
-        if (!new_parents)
-        {
-            RMOD_ERROR("Failed jalloc(%zu)",this->parent_count * sizeof(*new_parents));
-            RMOD_LEAVE_FUNCTION;
-            return RMOD_RESULT_NOMEM;
-        }
-    }
-    else
-    {
-        new_parents = NULL;
-    }
-    if (this->child_count)
-    {
-        new_children = jalloc(this->child_count * sizeof(*new_children));
-        if (!new_children)
-        {
-            jfree(new_parents);
-            RMOD_ERROR("Failed jalloc(%zu)", this->parent_count * sizeof(*new_children));
-            RMOD_LEAVE_FUNCTION;
-            return RMOD_RESULT_NOMEM;
-        }
-    }
-    else
-    {
-        new_children = NULL;
-    }
-    static_assert(sizeof(*dest) == sizeof(*this));
-    memcpy(dest, this, sizeof(*this));
-    dest->parents = new_parents;
-    if (this->parent_count)
+    const rmod_element_type* p_types;
+    rmod_chain* const* level_chains;    //  Chains on the level currently being compiled
+    compiled_chain* results;            //  Result for each chain of the level
+    linear_jallocator** arenas;         //  Memory of each worker
+};
+
+//  Copies the array into the arena, giving NULL for empty arrays
+static rmod_result copy_to_arena(linear_jallocator* const arena, const u32 count, const ptrdiff_t* const src, ptrdiff_t** const p_out)
+{
+    if (!count)
     {
-        memcpy(new_parents, this->parents, this->parent_count * sizeof(*new_parents));
+        *p_out = NULL;
+        return RMOD_RESULT_SUCCESS;
     }
-    dest->children = new_children;
-    if (this->child_count)
+    ptrdiff_t* const dst = lin_jalloc(arena, sizeof(*dst) * count);
+    if (!dst)
     {
-        memcpy(new_children, this->children, this->child_count * sizeof(*new_children));
+        RMOD_ERROR("Failed lin_jalloc(%p, %zu)", arena, sizeof(*dst) * count);
+        return RMOD_RESULT_NOMEM;
     }
-    RMOD_LEAVE_FUNCTION;
+    memcpy(dst, src, sizeof(*dst) * count);
+    *p_out = dst;
     return RMOD_RESULT_SUCCESS;
 }
 
-static inline void chain_to_absolute_relations(rmod_chain* const chain)
+//  Sorts elements of the chain topologically, giving the order in which the old algorithm would take them out: it made
+//  passes over the elements in their original order and took out each one whose parents were already taken out. An
+//  element is therefore taken out in the first pass after the last of its parents which comes after it, or in the same
+//  pass as the last of its parents which comes before it. Passes are found with Kahn's algorithm, then elements are
+//  sorted by pass and original position with a counting sort. On return order[i] is the original position of the i-th
+//  element and position[j] is where the j-th element was moved to.
+static rmod_result sort_chain_elements(linear_jallocator* const arena, const rmod_chain* const chain, u32* const order, u32* const position)
 {
-    for (u32 i = 0; i < chain->element_count; ++i)
+    RMOD_ENTER_FUNCTION;
+    const u32 n = chain->element_count;
+    const rmod_chain_element* const elements = chain->chain_elements;
+    //  order is used as the queue of Kahn's algorithm and position as the pass of each element
+    u32* const remaining = lin_jalloc(arena, sizeof(*remaining) * (n + 1));
+    if (!remaining)
     {
-        rmod_chain_element* const this = chain->chain_elements + i;
-        for (u32 j = 0; j < this->parent_count; ++j)
-        {
-            this->parents[j] += i;
-        }
-        for (u32 j = 0; j < this->child_count; ++j)
+        RMOD_ERROR("Failed lin_jalloc(%p, %zu)", arena, sizeof(*remaining) * (n + 1));
+        RMOD_LEAVE_FUNCTION;
+        return RMOD_RESULT_NOMEM;
+    }
+    u32* const queue = order;
+    u32* const pass = position;
+    u32 queue_end = 0;
+    for (u32 i = 0; i < n; ++i)
+    {
+        remaining[i] = elements[i].parent_count;
+        pass[i] = 0;
+        if (remaining[i] == 0)
         {
-            this->children[j] += i;
+            queue[queue_end++] = i;
         }
     }
-}
-
-static inline void chain_to_relative_relations(rmod_chain* const chain)
-{
-    for (u32 i = 0; i < chain->element_count; ++i)
+    u32 pass_count = 1;
+    for (u32 queue_begin = 0; queue_begin < queue_end; ++queue_begin)
     {
-        rmod_chain_element* const this = chain->chain_elements + i;
-        for (u32 j = 0; j < this->parent_count; ++j)
+        const u32 i = queue[queue_begin];
+        const rmod_chain_element* const e = elements + i;
+        for (u32 j = 0; j < e->child_count; ++j)
         {
-            this->parents[j] -= i;
+            const u32 child = (u32)(i + e->children[j]);
+            const u32 child_pass = pass[i] + (i > child);
+            if (child_pass > pass[child])
+            {
+                pass[child] = child_pass;
+            }
+            if (--remaining[child] == 0)
+            {
+                queue[queue_end++] = child;
+            }
         }
-        for (u32 j = 0; j < this->child_count; ++j)
+        if (pass[i] + 1 > pass_count)
         {
-            this->children[j] -= i;
+            pass_count = pass[i] + 1;
         }
     }
-}
-
-rmod_result rmod_compile_graph(
-        u32 n_types, rmod_element_type* p_types, const char* chain_name, const char* module_name,
-        rmod_graph* p_out)
-{
-    RMOD_ENTER_FUNCTION;
-    rmod_result res = RMOD_RESULT_SUCCESS;
-    void* const base_lin_alloc = lin_jalloc_get_current(G_LIN_JALLOCATOR);
+    if (queue_end != n)
+    {
+        RMOD_ERROR("Cyclical flow for chain \"%.*s\" was found", chain->header.type_name.len, chain->header.type_name.begin);
+        lin_jfree(arena, remaining);
+        RMOD_LEAVE_FUNCTION;
+        return RMOD_RESULT_CYCLICAL_CHAIN;
+    }
 
-    //  Search for proper chain
-    u32 chain_count = 0;
-    const rmod_chain* target_chain = NULL;
-    for (u32 i = 0; i < n_types; ++i)
+    //  Counting sort by pass, which keeps elements of the same pass in their original order
+    memset(remaining, 0, sizeof(*remaining) * (pass_count + 1));
+    for (u32 i = 0; i < n; ++i)
     {
-        const bool is_chain = p_types[i].header.type_value == RMOD_ELEMENT_TYPE_CHAIN;
-        if (is_chain && strlen(chain_name) == p_types[i].header.type_name.len && strncmp(chain_name, p_types[i].header.type_name.begin, p_types[i].header.type_name.len) == 0)
-        {
-            assert(!target_chain);
-            target_chain = &p_types[i].chain;
-        }
-        chain_count += is_chain;
+        remaining[pass[i] + 1] += 1;
     }
-    if (!target_chain)
+    for (u32 i = 0; i < pass_count; ++i)
     {
-        RMOD_ERROR("Could not find chain named \"%s\"", chain_name);
-        res = RMOD_RESULT_BAD_CHAIN_NAME;
-        goto failed;
+        remaining[i + 1] += remaining[i];
     }
-    if (n_types == chain_count)
+    for (u32 i = 0; i < n; ++i)
     {
-        RMOD_ERROR("All types passed were chains. HOW IN GOD'S NAME DO YOU EXPECT TO BUILD A RELIABILITY BLOCK DIAGRAM WITH NO BLOCKS!?");
-        res = RMOD_RESULT_STUPIDITY;
-        goto failed;
+        order[remaining[pass[i]]++] = i;
+    }
+    for (u32 i = 0; i < n; ++i)
+    {
+        position[order[i]] = i;
     }
 
-    //  Build chain hierarchy and ensure there are no cycles
-    u32* chain_index_array = lin_jalloc(G_LIN_JALLOCATOR, sizeof(*chain_index_array) * chain_count);
-    if (!chain_index_array)
+    lin_jfree(arena, remaining);
+    RMOD_LEAVE_FUNCTION;
+    return RMOD_RESULT_SUCCESS;
+}
+
+//  Sorts elements of the chain topologically and replaces each element which is a chain with elements of that chain,
+//  which must already be compiled. Size of the result is known in advance, so each element is written to its final
+//  place in a single pass. Parents of the replaced element become parents of the first element of the sub-chain, and
+//  its children become children of the last one. The chain itself is not modified and the result is allocated from the
+//  arena, so chains which do not depend on each other can be compiled at the same time.
+static rmod_result compile_chain(
+        linear_jallocator* const arena, const rmod_element_type* const p_types, const rmod_chain* const chain,
+        compiled_chain* const p_out)
+{
+    RMOD_ENTER_FUNCTION;
+    rmod_result res;
+    void* const base = lin_jalloc_get_current(arena);
+    const u32 n = chain->element_count;
+    const rmod_chain_element* const elements = chain->chain_elements;
+
+    u32* const order = lin_jalloc(arena, sizeof(*order) * n);
+    u32* const position = lin_jalloc(arena, sizeof(*position) * n);
+    //  Position of the first element each element is replaced with in the compiled chain
+    u32* const offsets = lin_jalloc(arena, sizeof(*offsets) * (n + 1));
+    //  Relations of each element in the sorted order, which are converted into relative offsets in place
+    ptrdiff_t** const parents = lin_jalloc(arena, sizeof(*parents) * n);
+    ptrdiff_t** const children = lin_jalloc(arena, sizeof(*children) * n);
+    if (!order || !position || !offsets || !parents || !children)
     {
-        RMOD_ERROR("Failed lin_jalloc(%p, %zu)", G_LIN_JALLOCATOR, sizeof* chain_index_array * chain_count);
+        RMOD_ERROR("Failed lin_jalloc(%p, %zu)", arena, sizeof(*order) * (3 * n + 1) + sizeof(*parents) * 2 * n);
         res = RMOD_RESULT_NOMEM;
         goto failed;
     }
-    u32* build_order_array = lin_jalloc(G_LIN_JALLOCATOR, sizeof(*build_order_array) * chain_count);
-    if (!build_order_array)
+    if ((res = sort_chain_elements(arena, chain, order, position)) != RMOD_RESULT_SUCCESS)
     {
-        RMOD_ERROR("Failed lin_jalloc(%p, %zu)", G_LIN_JALLOCATOR, sizeof(*build_order_array) * chain_count);
-        res = RMOD_RESULT_NOMEM;
         goto failed;
     }
-    u32 needed_count = 1;
 
-    //  Find the proper build order
+    //  Children refer to positions in the sorted order, and parents are generated from them, so that they are given in
+    //  the sorted order as well
+    for (u32 i = 0; i < n; ++i)
     {
-        chain_dependency_info* dependency_info_list = lin_jalloc(
-                G_LIN_JALLOCATOR, sizeof *dependency_info_list * chain_count);
-        if (!dependency_info_list)
+        const rmod_chain_element* const e = elements + order[i];
+        if ((res = copy_to_arena(arena, e->child_count, e->children, children + i)) != RMOD_RESULT_SUCCESS
+            || (res = copy_to_arena(arena, e->parent_count, e->parents, parents + i)) != RMOD_RESULT_SUCCESS)
         {
-            RMOD_ERROR("Failed lin_jalloc(%p, %zu)", G_LIN_JALLOCATOR, sizeof *dependency_info_list * chain_count);
-            res = RMOD_RESULT_NOMEM;
             goto failed;
         }
-        u32* joined_dependency_array = lin_jalloc(
-                G_LIN_JALLOCATOR, sizeof *joined_dependency_array * chain_count * chain_count);
-        if (!joined_dependency_array)
+        for (u32 j = 0; j < e->child_count; ++j)
         {
-            RMOD_ERROR("Failed lin_jalloc(%p, %zu)", G_LIN_JALLOCATOR,
-                       sizeof *joined_dependency_array * chain_count * chain_count);
-            res = RMOD_RESULT_NOMEM;
-            goto failed;
+            children[i][j] = position[order[i] + children[i][j]];
         }
-        u32 chain_idx = -1;
-        //  Count the numer of chains present and what is the order of the target chain
-        for (u32 i = 0, j = 0; i < n_types && j < chain_count; ++i)
+        offsets[i] = 0;
+    }
+    for (u32 i = 0; i < n; ++i)
+    {
+        const rmod_chain_element* const e = elements + order[i];
+        for (u32 j = 0; j < e->child_count; ++j)
         {
-            //  Is this type a chain
-            if (p_types[i].header.type_value != RMOD_ELEMENT_TYPE_CHAIN)
-            {
-                continue;
-            }
-            if (&p_types[i].chain == target_chain)
-            {
-                chain_idx = j;
-            }
-            chain_index_array[j++] = i;
+            const u32 child = (u32)children[i][j];
+            assert(offsets[child] < elements[order[child]].parent_count);
+            parents[child][offsets[child]++] = i;
         }
-        assert(chain_idx != -1);
+    }
 
-        //  For each chain, loop through all elements and identify which of them are chains,
-        //  then add them to the list of chain dependencies for that chain (check that there
-        //  are no duplicates).
-        for (u32 i = 0, j = 0; i < n_types && j < chain_count; ++i)
+    //  Find where each element will be placed and how much space their new labels take up
+    u64 name_bytes = 0;
+    u32 name_bytes_total = 0;
+    bool has_chains = false;
+    offsets[0] = 0;
+    for (u32 i = 0; i < n; ++i)
+    {
+        const rmod_chain_element* const e = elements + order[i];
+        const rmod_element_type* const type = p_types + e->type_id;
+        switch (type->header.type_value)
         {
-            //  Is this type a chain
-            if (p_types[i].header.type_value != RMOD_ELEMENT_TYPE_CHAIN)
-            {
-                continue;
-            }
-            chain_dependency_info* const info = dependency_info_list + j;
-            info->index = j;
-            info->dependency_count = 0;
-            info->dependency_list = joined_dependency_array + chain_count * j;
-
-            const rmod_chain* this = &p_types[i].chain;
-            //  Go over elements to discover which ones are chains
-            for (u32 k = 0; k < this->element_count; ++k)
+        case RMOD_ELEMENT_TYPE_BLOCK:
+            offsets[i + 1] = offsets[i] + 1;
+            name_bytes_total += e->label.len;
+            break;
+        case RMOD_ELEMENT_TYPE_CHAIN:
+            if (!type->chain.compiled)
             {
-                const rmod_chain_element* element = this->chain_elements + k;
-                const rmod_element_type* element_type = p_types + element->type_id;
-                //  Is the element's type chain?
-                if (element_type->header.type_value != RMOD_ELEMENT_TYPE_CHAIN)
-                {
-                    continue;
-                }
-                //  Translate the position in type array in position in chain array
-                u32 l, pos;
-                for (pos = 0; pos < chain_count; ++pos)
-                {
-                    if (chain_index_array[pos] == element->type_id)
-                    {
-                        break;
-                    }
-                }
-                assert(pos < chain_count);
-                //  Check for duplicate dependency
-                for (l = 0; l < info->dependency_count; ++l)
-                {
-                    if (info->dependency_list[l] == pos)
-                    {
-                        //  Already in there
-                        break;
-                    }
-                }
-                if (l == info->dependency_count)
-                {
-                    info->dependency_list[info->dependency_count++] = pos;
-                }
-                assert(info->dependency_count <= chain_count);
+                RMOD_ERROR("Chain \"%.*s\" was not compiled as dependency for chain \"%.*s\"", type->header.type_name.len, type->header.type_name.begin, chain->header.type_name.len, chain->header.type_name.begin);
+                res = RMOD_RESULT_STUPIDITY;
+                goto failed;
             }
-
-            j += 1;
+            offsets[i + 1] = offsets[i] + type->chain.element_count;
+            name_bytes += type->chain.name_bytes_total + type->chain.element_count * (e->label.len + 2);
+            has_chains = true;
+            break;
+        default:
+            RMOD_ERROR("Element type \"%.*s\" had invalid type", type->header.type_name.len, type->header.type_name.begin);
+            res = RMOD_RESULT_BAD_XML;
+            goto failed;
         }
+    }
+    const u32 total_element_count = offsets[n];
 
-        //  Extract the dependencies needed by the target chain
-        chain_dependency_info* const needed_dependencies = lin_jalloc(G_LIN_JALLOCATOR, sizeof(*needed_dependencies) * chain_count);
-        if (!needed_dependencies)
+    rmod_chain_element* const out = lin_jalloc(arena, sizeof(*out) * total_element_count);
+    if (!out)
+    {
+        RMOD_ERROR("Failed lin_jalloc(%p, %zu)", arena, sizeof(*out) * total_element_count);
+        res = RMOD_RESULT_NOMEM;
+        goto failed;
+    }
+    char* name_buffer = NULL;
+    if (has_chains)
+    {
+        //  One extra byte for the terminator written by snprintf
+        name_buffer = lin_jalloc(arena, name_bytes + 1);
+        if (!name_buffer)
         {
-            RMOD_ERROR("Failed lin_jalloc(%p, %zu)", G_LIN_JALLOCATOR, sizeof(*needed_dependencies) * chain_count);
+            RMOD_ERROR("Failed lin_jalloc(%p, %zu)", arena, name_bytes + 1);
             res = RMOD_RESULT_NOMEM;
             goto failed;
         }
-        u32* const queue = lin_jalloc(G_LIN_JALLOCATOR, sizeof*queue * chain_count);
-        if (!queue)
+    }
+
+    //  Write elements into their places, converting relations into relative offsets
+    u64 name_pos = 0;
+    for (u32 i = 0; i < n; ++i)
+    {
+        const rmod_chain_element* const e = elements + order[i];
+        const rmod_element_type* const type = p_types + e->type_id;
+        const u32 begin = offsets[i];
+        const u32 end = offsets[i + 1] - 1;
+        //  Parents connect to the last element which their element was replaced by and children to the first
+        for (u32 j = 0; j < e->parent_count; ++j)
+        {
+            parents[i][j] = (ptrdiff_t)offsets[parents[i][j] + 1] - 1 - begin;
+        }
+        for (u32 j = 0; j < e->child_count; ++j)
         {
-            RMOD_ERROR("Failed lin_jalloc(%p, %zu)", G_LIN_JALLOCATOR, sizeof(*queue) * chain_count);
-            res = RMOD_RESULT_NOMEM;
-            goto failed;
+            children[i][j] = (ptrdiff_t)offsets[children[i][j]] - end;
         }
-        u32 queue_count = 0;
-
-
-        needed_dependencies[0] = dependency_info_list[chain_idx];
-        for (u32 i = 0; i < needed_count; ++i)
+        if (type->header.type_value == RMOD_ELEMENT_TYPE_BLOCK)
         {
-            assert(i < chain_count);
-            //  For each chain in the needed array check whether all of its dependencies are already
-            //  in the array and add them if not
-            for (u32 j = 0; j < needed_dependencies[i].dependency_count; ++j)
-            {
-                const u32 dependency = needed_dependencies[i].dependency_list[j];
-                u32 k;
-                for (k = 0; k < needed_count; ++k)
-                {
-                    if (dependency == needed_dependencies[k].index)
+            out[begin] = (rmod_chain_element)
                     {
-                        break;
-                    }
-                }
-                if (k == needed_count)
-                {
-                    needed_dependencies[k] = dependency_info_list[dependency];
-                    needed_count += 1;
-                }
-            }
+                    .type_id = e->type_id,
+                    .id = begin,
+                    .label = e->label,
+                    .parent_count = e->parent_count,
+                    .parents = parents[i],
+                    .child_count = e->child_count,
+                    .children = children[i],
+                    };
+            continue;
         }
 
-        //  Now all the actually needed dependencies reside in the needed_dependencies array with the length of
-        //  needed_count. Next step is performing a topological sort of the array.
-        u32 left_to_sort = needed_count;
-        u32 sorted_count = 0;
-        while (left_to_sort)
+        const rmod_chain* const sub_chain = &type->chain;
+        for (u32 j = 0; j < sub_chain->element_count; ++j)
         {
-            //  Extract the nodes with no dependencies
-            for (u32 i = 0; i < left_to_sort; ++i)
+            const rmod_chain_element* const sub_element = sub_chain->chain_elements + j;
+            rmod_chain_element* const dst = out + begin + j;
+            *dst = *sub_element;
+            if ((res = copy_to_arena(arena, sub_element->parent_count, sub_element->parents, &dst->parents)) != RMOD_RESULT_SUCCESS
+                || (res = copy_to_arena(arena, sub_element->child_count, sub_element->children, &dst->children)) != RMOD_RESULT_SUCCESS)
             {
-                if (needed_dependencies[i].dependency_count == 0)
-                {
-                    //  Take it out of the array and move it into the queue
-                    u32 idx = needed_dependencies[i].index;
-                    queue[queue_count++] = idx;
-                    memmove(needed_dependencies + i, needed_dependencies + i + 1, sizeof(*needed_dependencies) * (left_to_sort - 1 - i));
-                    memset(needed_dependencies + left_to_sort - 1, 0, sizeof(*needed_dependencies));
-                    left_to_sort -= 1;
-                    i -= 1;
-
-                    //  Remove dependence on this from the other chains
-                    for (u32 j = 0; j < left_to_sort; ++j)
-                    {
-                        for (u32 k = 0; k < needed_dependencies[j].dependency_count; ++k)
-                        {
-                            if (needed_dependencies[j].dependency_list[k] == idx)
-                            {
-                                memmove(needed_dependencies[j].dependency_list + k, needed_dependencies[j].dependency_list + k + 1, sizeof(*needed_dependencies[j].dependency_list) * (needed_dependencies[j].dependency_count - 1 - k));
-                                needed_dependencies[j].dependency_count -= 1;
-                                break;
-                            }
-                        }
-                    }
-                }
-            }
-
-            //  Remove the extracted values and push them in the sorted array
-
-            //      If queue is empty, there is at least one cycle in the chain dependencies
-            if (queue_count == 0)
-            {
-                RMOD_ERROR("Cyclical dependencies for chain \"%s\" were found", chain_name);
-                res = RMOD_RESULT_CYCLICAL_CHAIN_DEPENDENCY;
                 goto failed;
             }
+            const int new_name_len = snprintf(name_buffer + name_pos, name_bytes + 1 - name_pos, "%.*s::%.*s", (int)e->label.len, e->label.begin, (int)sub_element->label.len, sub_element->label.begin);
+            assert(new_name_len == (int)(2 + e->label.len + sub_element->label.len));
+            dst->label.begin = name_buffer + name_pos;
+            dst->label.len = new_name_len;
+            dst->id = begin + j;
+            name_pos += new_name_len;
+        }
+        assert(out[begin].parent_count == 0 && out[begin].parents == NULL);
+        out[begin].parent_count = e->parent_count;
+        out[begin].parents = parents[i];
+        assert(out[end].child_count == 0 && out[end].children == NULL);
+        out[end].child_count = e->child_count;
+        out[end].children = children[i];
+    }
+    assert(name_pos <= name_bytes);
 
-            for (u32 i = 0; i < queue_count; ++i)
+    *p_out = (compiled_chain)
             {
-                build_order_array[sorted_count++] = queue[i];
-            }
-            queue_count = 0;
-
-            assert(sorted_count + left_to_sort == needed_count);
-        }
+            .element_count = total_element_count,
+            .elements = out,
+            .name_buffer = name_buffer,
+            .name_bytes = name_pos,
+            .name_bytes_total = name_bytes_total + name_pos,
+            };
+    RMOD_LEAVE_FUNCTION;
+    return RMOD_RESULT_SUCCESS;
 
+failed:
+    lin_jalloc_set_current(arena, base);
+    RMOD_LEAVE_FUNCTION;
+    return res;
+}
 
-        lin_jfree(G_LIN_JALLOCATOR, queue);
-        lin_jfree(G_LIN_JALLOCATOR, needed_dependencies);
-        lin_jfree(G_LIN_JALLOCATOR, joined_dependency_array);
-        lin_jfree(G_LIN_JALLOCATOR, dependency_info_list);
+static rmod_result compile_chain_task(void* param, u32 worker_idx, u32 task_idx)
+{
+    RMOD_ENTER_FUNCTION;
+    const compile_context* const ctx = param;
+    const rmod_chain* const chain = ctx->level_chains[task_idx];
+    RMOD_INFO("Building chain \"%.*s\"", chain->header.type_name.len, chain->header.type_name.begin);
+    const rmod_result res = compile_chain(ctx->arenas[worker_idx], ctx->p_types, chain, ctx->results + task_idx);
+    if (res != RMOD_RESULT_SUCCESS)
+    {
+        RMOD_ERROR("Failed building chain \"%.*s\", reason: %s", chain->header.type_name.len, chain->header.type_name.begin, rmod_result_str(res));
     }
+    RMOD_LEAVE_FUNCTION;
+    return res;
+}
 
-    //  chain_index_array has the indices of the chains within the p_types
-    //  build_order_array has the order in which the chains have to be built (0 corresponding to the first element in chain_index_array)
+//  Moves the chain compiled by a worker out of its arena and into the chain, replacing its old elements. New elements
+//  are taken from the allocator which holds the types, so the old ones are simply left in it.
+static rmod_result merge_compiled_chain(
+        region_jallocator* const allocator, const compiled_chain* const compiled, rmod_chain* const chain)
+{
+    RMOD_ENTER_FUNCTION;
+    const u32 count = compiled->element_count;
+    rmod_chain_element* const elements = region_jalloc(allocator, sizeof(*elements) * count);
+    if (!elements)
+    {
+        RMOD_ERROR("Failed region_jalloc(%p, %zu)", allocator, sizeof(*elements) * count);
+        RMOD_LEAVE_FUNCTION;
+        return RMOD_RESULT_NOMEM;
+    }
+    memcpy(elements, compiled->elements, sizeof(*elements) * count);
+    char* name_buffer = NULL;
+    if (compiled->name_buffer)
+    {
+        assert(!chain->name_buffer);
+        name_buffer = region_jalloc(allocator, compiled->name_bytes ? compiled->name_bytes : 1);
+        if (!name_buffer)
+        {
+            RMOD_ERROR("Failed region_jalloc(%p, %zu)", allocator, compiled->name_bytes ? compiled->name_bytes : 1);
+            RMOD_LEAVE_FUNCTION;
+            return RMOD_RESULT_NOMEM;
+        }
+        memcpy(name_buffer, compiled->name_buffer, compiled->name_bytes);
+    }
+    for (u32 i = 0; i < count; ++i)
+    {
+        rmod_chain_element* const e = elements + i;
+        const rmod_chain_element* const src = compiled->elements + i;
+        if (compiled->name_buffer && e->label.begin >= compiled->name_buffer && e->label.begin < compiled->name_buffer + compiled->name_bytes)
+        {
+            e->label.begin = name_buffer + (e->label.begin - compiled->name_buffer);
+        }
+        e->parents = src->parent_count ? region_jalloc(allocator, sizeof(*e->parents) * src->parent_count) : NULL;
+        e->children = src->child_count ? region_jalloc(allocator, sizeof(*e->children) * src->child_count) : NULL;
+        if ((src->parent_count && !e->parents) || (src->child_count && !e->children))
+        {
+            RMOD_ERROR("Failed region_jalloc(%p, %zu)", allocator, sizeof(*e->parents) * (src->parent_count + src->child_count));
+            RMOD_LEAVE_FUNCTION;
+            return RMOD_RESULT_NOMEM;
+        }
+        if (src->parent_count)
+        {
+            memcpy(e->parents, src->parents, sizeof(*e->parents) * src->parent_count);
+        }
+        if (src->child_count)
+        {
+            memcpy(e->children, src->children, sizeof(*e->children) * src->child_count);
+        }
+    }
 
+    chain->chain_elements = elements;
+    chain->element_count = count;
+    if (name_buffer)
+    {
+        chain->name_buffer = name_buffer;
+    }
+    chain->name_bytes_total = compiled->name_bytes_total;
+    chain->i_first = 0;
+    chain->i_last = count - 1;
+    chain->compiled = true;
+    RMOD_LEAVE_FUNCTION;
+    return RMOD_RESULT_SUCCESS;
+}
 
-    //  Compile chains based on their topological ordering (nice fancy words)
-    u32 built_count = 0;
-    for (u32 i = 0; i < needed_count; ++i, ++built_count)
+//  Compiles the needed chains, given in the order in which they can be built. Chains are split into levels, so that
+//  each chain only contains chains from lower levels, then chains of each level are compiled in parallel, each worker
+//  using its own arena. Once a level is done, its chains are merged back into the types by the calling thread, since
+//  the global allocators can not be used by the workers.
+static rmod_result compile_needed_chains(
+        region_jallocator* const allocator, rmod_element_type* const p_types, const u32 needed_count, const u32* const needed_array,
+        const u32* const build_order_array, const u32* const needed_position, const u32 thread_count)
+{
+    RMOD_ENTER_FUNCTION;
+    rmod_result res;
+    void* const base = lin_jalloc_get_current(G_LIN_JALLOCATOR);
+    linear_jallocator** const arenas = lin_jalloc(G_LIN_JALLOCATOR, sizeof(*arenas) * thread_count);
+    if (!arenas)
+    {
+        RMOD_ERROR("Failed lin_jalloc(%p, %zu)", G_LIN_JALLOCATOR, sizeof(*arenas) * thread_count);
+        res = RMOD_RESULT_NOMEM;
+        goto end;
+    }
+    memset(arenas, 0, sizeof(*arenas) * thread_count);
+    void** const arena_bases = lin_jalloc(G_LIN_JALLOCATOR, sizeof(*arena_bases) * thread_count);
+    if (!arena_bases)
+    {
+        RMOD_ERROR("Failed lin_jalloc(%p, %zu)", G_LIN_JALLOCATOR, sizeof(*arena_bases) * thread_count);
+        res = RMOD_RESULT_NOMEM;
+        goto end;
+    }
+    for (u32 i = 0; i < thread_count; ++i)
     {
-        const u32 chain_to_build_index = build_order_array[i];
-        rmod_chain* const chain = &p_types[chain_index_array[chain_to_build_index]].chain;
-        if (chain->compiled)
+        arenas[i] = lin_jallocator_create(RMOD_COMPILE_ARENA_SIZE);
+        if (!arenas[i])
         {
-            //  No compilation needed
-            continue;
+            RMOD_ERROR("Failed creating linear allocator of size %"PRIu64" for worker %u", (u64)RMOD_COMPILE_ARENA_SIZE, i);
+            res = RMOD_RESULT_NOMEM;
+            goto end;
         }
-        assert(chain->header.type_value == RMOD_ELEMENT_TYPE_CHAIN);
-        RMOD_INFO("Building chain \"%.*s\"", chain->header.type_name.len, chain->header.type_name.begin);
-
-        //  Building a chain means substituting all of its elements for blocks this requires all of its dependencies to
-        //  also be built already
+        arena_bases[i] = lin_jalloc_get_current(arenas[i]);
+    }
+    u32* const level = lin_jalloc(G_LIN_JALLOCATOR, sizeof(*level) * needed_count);
+    u32* const level_offsets = lin_jalloc(G_LIN_JALLOCATOR, sizeof(*level_offsets) * (needed_count + 1));
+    rmod_chain** const level_chains = lin_jalloc(G_LIN_JALLOCATOR, sizeof(*level_chains) * needed_count);
+    compiled_chain* const results = lin_jalloc(G_LIN_JALLOCATOR, sizeof(*results) * needed_count);
+    if (!level || !level_offsets || !level_chains || !results)
+    {
+        RMOD_ERROR("Failed lin_jalloc(%p, %zu)", G_LIN_JALLOCATOR, (sizeof(*level) + sizeof(*level_offsets) + sizeof(*level_chains) + sizeof(*results)) * needed_count + sizeof(*level_offsets));
+        res = RMOD_RESULT_NOMEM;
+        goto end;
+    }
 
-        u32 total_element_count = 0;
-        u32 extra_name_bytes = 0;
+    //  Dependencies come before the chains which contain them, so levels can be found in a single pass
+    u32 level_count = 0;
+    for (u32 i = 0; i < needed_count; ++i)
+    {
+        const u32 idx = build_order_array[i];
+        const rmod_chain* const chain = &p_types[needed_array[idx]].chain;
+        u32 l = 0;
         for (u32 j = 0; j < chain->element_count; ++j)
         {
-            const rmod_chain_element* element = chain->chain_elements + j;
-            const rmod_element_type* element_type = p_types + element->type_id;
-            switch (element_type->header.type_value)
+            const element_type_id type_id = chain->chain_elements[j].type_id;
+            if (p_types[type_id].header.type_value == RMOD_ELEMENT_TYPE_CHAIN && level[needed_position[type_id]] + 1 > l)
             {
-            case RMOD_ELEMENT_TYPE_BLOCK:
-                total_element_count += 1;
-                break;
-            case RMOD_ELEMENT_TYPE_CHAIN:
-                total_element_count += element_type->chain.element_count;
-                extra_name_bytes += element_type->chain.name_bytes_total + element_type->chain.element_count * (element->label.len + 3);
-                break;
-            default:RMOD_ERROR("Element type \"%.*s\" had invalid type", element_type->header.type_name.len, element_type->header.type_name.begin);
-            res = RMOD_RESULT_BAD_XML;
-            goto failed;
+                l = level[needed_position[type_id]] + 1;
             }
         }
-
-        if (total_element_count != chain->element_count)
+        level[idx] = l;
+        if (l + 1 > level_count)
         {
+            level_count = l + 1;
+        }
+    }
+    memset(level_offsets, 0, sizeof(*level_offsets) * (level_count + 1));
+    for (u32 i = 0; i < needed_count; ++i)
+    {
+        level_offsets[level[i] + 1] += 1;
+    }
+    for (u32 i = 0; i < level_count; ++i)
+    {
+        level_offsets[i + 1] += level_offsets[i];
+    }
+    for (u32 i = 0; i < needed_count; ++i)
+    {
+        const u32 idx = build_order_array[i];
+        level_chains[level_offsets[level[idx]]++] = &p_types[needed_array[idx]].chain;
+    }
+    //  Offsets were moved one level forward while sorting
+    for (u32 i = level_count; i > 0; --i)
+    {
+        level_offsets[i] = level_offsets[i - 1];
+    }
+    level_offsets[0] = 0;
 
-            rmod_chain_element* new_element_array = jrealloc(chain->chain_elements, total_element_count * sizeof*new_element_array);
-            if (!new_element_array)
+    compile_context ctx =
             {
-                RMOD_ERROR("Failed jrealloc(%p, %zu)", chain->chain_elements, total_element_count * sizeof*new_element_array);
-                res = RMOD_RESULT_NOMEM;
-                goto failed;
-            }
-            memset(new_element_array + chain->element_count, 0, (total_element_count - chain->element_count) * sizeof*new_element_array);
-            chain->chain_elements = new_element_array;
-            assert(!chain->name_buffer);
-            char* name_buffer = jrealloc(chain->name_buffer, extra_name_bytes);
-            if (!name_buffer)
+            .p_types = p_types,
+            .arenas = arenas,
+            };
+    for (u32 i = 0; i < level_count; ++i)
+    {
+        //  Chains which were already compiled for another target are skipped
+        u32 count = 0;
+        for (u32 j = level_offsets[i]; j < level_offsets[i + 1]; ++j)
+        {
+            if (!level_chains[j]->compiled)
             {
-                RMOD_ERROR("Failed jrealloc(%p, %zu)", chain->name_buffer, extra_name_bytes);
-                res = RMOD_RESULT_NOMEM;
-                goto failed;
+                level_chains[level_offsets[i] + count++] = level_chains[j];
             }
-            chain->name_buffer = name_buffer;
         }
-        u32 name_pos = 0;
-
-        //  Now performa a topological sort of the elements
-        rmod_chain_element* const sorted_array = lin_jalloc(G_LIN_JALLOCATOR, total_element_count * sizeof(*sorted_array));
-        if (!sorted_array)
+        ctx.level_chains = level_chains + level_offsets[i];
+        ctx.results = results + level_offsets[i];
+        res = rmod_parallel_run(thread_count, count, compile_chain_task, &ctx, "compile");
+        if (res != RMOD_RESULT_SUCCESS)
         {
-            RMOD_ERROR("Failed lin_jalloc(%p, %g)", G_LIN_JALLOCATOR, total_element_count * sizeof(*sorted_array));
-            res = RMOD_RESULT_NOMEM;
-            goto failed;
+            RMOD_ERROR("Failed compiling chains of level %u, reason: %s", i, rmod_result_str(res));
+            goto end;
         }
-        u32 left_to_sort = chain->element_count;
-
-        //  Convert parent-child relations to be absolute rather than relative
-        chain_to_absolute_relations(chain);
-        while (left_to_sort)
+        for (u32 j = 0; j < count; ++j)
         {
-            u32 found = 0;
-            //  Extract the nodes with no dependencies
-            for (u32 j = 0; j < left_to_sort; ++j)
+            if ((res = merge_compiled_chain(allocator, ctx.results + j, level_chains[level_offsets[i] + j])) != RMOD_RESULT_SUCCESS)
             {
-                if (chain->chain_elements[j].parent_count == 0)
-                {
-                    found += 1;
-                    //  Take it out of the array and move it into the queue
-                    const rmod_chain_element e = chain->chain_elements[j];
-                    sorted_array[(chain->element_count - left_to_sort)] = e;
-                    memmove(chain->chain_elements + j, chain->chain_elements + j + 1, sizeof(*chain->chain_elements) * (left_to_sort - 1 - j));
-                    memset(chain->chain_elements + left_to_sort - 1, 0, sizeof(*chain->chain_elements));
-                    left_to_sort -= 1;
-                    j -= 1;
-
-                    //  Remove dependence on this from the other chains
-                    for (u32 k = 0; k < left_to_sort; ++k)
-                    {
-                        for (u32 l = 0; l < chain->chain_elements[k].parent_count; ++l)
-                        {
-                            if (chain->chain_elements[k].parents[l] == e.id)
-                            {
-                                memmove(chain->chain_elements[k].parents + l, chain->chain_elements[k].parents + l + 1, sizeof(*chain->chain_elements[k].parents) * (chain->chain_elements[k].parent_count - 1 - l));
-                                chain->chain_elements[k].parent_count -= 1;
-                                break;
-                            }
-                        }
-                    }
-                }
+                goto end;
             }
+        }
+        for (u32 j = 0; j < thread_count; ++j)
+        {
+            lin_jalloc_set_current(arenas[j], arena_bases[j]);
+        }
+    }
 
-            //  Remove the extracted values and push them in the sorted array
-
-            //      If queue is empty, there is at least one cycle in the chain dependencies
-            if (found == 0)
-            {
-                RMOD_ERROR_CRIT("Cyclical flow for chain \"%.*s\" were found", chain->header.type_name.len, chain->header.type_name.begin);
-                //  Not really necessary, since this function calls exit
-                exit(EXIT_FAILURE);
-            }
+    res = RMOD_RESULT_SUCCESS;
+end:
+    for (u32 i = 0; arenas && i < thread_count; ++i)
+    {
+        if (arenas[i])
+        {
+            lin_jallocator_destroy(arenas[i]);
         }
+    }
+    lin_jalloc_set_current(G_LIN_JALLOCATOR, base);
+    RMOD_LEAVE_FUNCTION;
+    return res;
+}
 
-        //  Update chain first and last indices
-        chain->i_first = 0;
-        chain->i_last = chain->element_count - 1;
+//  Parameters of the node type are the same as of its block type, except that the failure rate is given instead of mtbf
+static void set_node_type_parameters(rmod_graph_node_type* const type, const rmod_block* const block_type)
+{
+    type->failure_type = block_type->failure_type;
+    type->failure_rate = (block_type->mtbf == 0.0) ? 0 : 1.0f / block_type->mtbf;
+    type->repair_time = block_type->mtbr;
+    type->effect = block_type->effect;
+    type->cost = block_type->cost;
+    memcpy(type->uncertainty, block_type->uncertainty, sizeof(block_type->uncertainty));
+}
 
-        memmove(chain->chain_elements, sorted_array, sizeof(*sorted_array) * chain->element_count);
-        lin_jfree(G_LIN_JALLOCATOR, sorted_array);
-        //  Adjust child references
-        u32* const ordering_array = lin_jalloc(G_LIN_JALLOCATOR, sizeof(*ordering_array) * chain->element_count);
-        assert(ordering_array);
-        //  Allocation will succeed because a bigger chunk of memory was just given back
-        for (u32 j = 0; j < chain->element_count; ++j)
+rmod_result rmod_compile_graph(
+        region_jallocator* allocator, u32 n_types, rmod_element_type* p_types, const char* chain_name, const char* module_name, u32 thread_count,
+        rmod_graph* p_out)
+{
+    RMOD_ENTER_FUNCTION;
+    rmod_result res = RMOD_RESULT_SUCCESS;
+    void* const base_lin_alloc = lin_jalloc_get_current(G_LIN_JALLOCATOR);
+
+    //  Search for proper chain
+    u32 chain_count = 0;
+    const rmod_chain* target_chain = NULL;
+    u32 target_index = 0;
+    for (u32 i = 0; i < n_types; ++i)
+    {
+        const bool is_chain = p_types[i].header.type_value == RMOD_ELEMENT_TYPE_CHAIN;
+        if (is_chain && strlen(chain_name) == p_types[i].header.type_name.len && strncmp(chain_name, p_types[i].header.type_name.begin, p_types[i].header.type_name.len) == 0)
         {
-            ordering_array[j] = chain->chain_elements[j].id;
+            assert(!target_chain);
+            target_chain = &p_types[i].chain;
+            target_index = i;
         }
-        for (u32 j = 0; j < chain->element_count; ++j)
+        chain_count += is_chain;
+    }
+    if (!target_chain)
+    {
+        RMOD_ERROR("Could not find chain named \"%s\"", chain_name);
+        res = RMOD_RESULT_BAD_CHAIN_NAME;
+        goto failed;
+    }
+    if (n_types == chain_count)
+    {
+        RMOD_ERROR("All types passed were chains. HOW IN GOD'S NAME DO YOU EXPECT TO BUILD A RELIABILITY BLOCK DIAGRAM WITH NO BLOCKS!?");
+        res = RMOD_RESULT_STUPIDITY;
+        goto failed;
+    }
+
+    //  Find the chains which the target depends on and the order in which they have to be built, so that every chain is
+    //  built after all chains it contains. Dependencies are found with a breadth-first search from the target, then
+    //  they are sorted topologically with Kahn's algorithm. Each element which is a chain counts as one dependency, so
+    //  that counts of remaining dependencies can be decremented once per element.
+    u32* const needed_array = lin_jalloc(G_LIN_JALLOCATOR, sizeof(*needed_array) * n_types);
+    if (!needed_array)
+    {
+        RMOD_ERROR("Failed lin_jalloc(%p, %zu)", G_LIN_JALLOCATOR, sizeof(*needed_array) * n_types);
+        res = RMOD_RESULT_NOMEM;
+        goto failed;
+    }
+    //  Position of each type in the needed array, or -1 if it is not needed
+    u32* const needed_position = lin_jalloc(G_LIN_JALLOCATOR, sizeof(*needed_position) * n_types);
+    if (!needed_position)
+    {
+        RMOD_ERROR("Failed lin_jalloc(%p, %zu)", G_LIN_JALLOCATOR, sizeof(*needed_position) * n_types);
+        res = RMOD_RESULT_NOMEM;
+        goto failed;
+    }
+    memset(needed_position, 0xFF, sizeof(*needed_position) * n_types);
+    u32 needed_count = 0;
+    u32 dependency_count = 0;
+    needed_array[needed_count] = target_index;
+    needed_position[target_index] = needed_count;
+    needed_count += 1;
+    for (u32 i = 0; i < needed_count; ++i)
+    {
+        const rmod_chain* const this = &p_types[needed_array[i]].chain;
+        for (u32 j = 0; j < this->element_count; ++j)
         {
-            rmod_chain_element* const this = chain->chain_elements + j;
-            for (u32 k = 0; k < this->child_count; ++k)
+            const element_type_id type_id = this->chain_elements[j].type_id;
+            if (p_types[type_id].header.type_value != RMOD_ELEMENT_TYPE_CHAIN)
             {
-                for (u32 l = 0; l < chain->element_count; ++l)
-                {
-                    if (ordering_array[l] == this->children[k])
-                    {
-                        this->children[k] = l;
-                        break;
-                    }
-                }
+                continue;
+            }
+            dependency_count += 1;
+            if (needed_position[type_id] == (u32)-1)
+            {
+                needed_position[type_id] = needed_count;
+                needed_array[needed_count++] = type_id;
             }
-            this->id = j;
         }
+    }
 
-
-        lin_jfree(G_LIN_JALLOCATOR, ordering_array);
-
-
-        //  Re-generate child relations by using child references
-        for (u32 j = 0; j < chain->element_count; ++j)
+    //  Chains which depend on each chain, stored contiguously: dependents of chain i are at
+    //  [dependent_offsets[i], dependent_offsets[i + 1])
+    u32* const dependent_offsets = lin_jalloc(G_LIN_JALLOCATOR, sizeof(*dependent_offsets) * (needed_count + 1));
+    if (!dependent_offsets)
+    {
+        RMOD_ERROR("Failed lin_jalloc(%p, %zu)", G_LIN_JALLOCATOR, sizeof(*dependent_offsets) * (needed_count + 1));
+        res = RMOD_RESULT_NOMEM;
+        goto failed;
+    }
+    u32* const dependents = lin_jalloc(G_LIN_JALLOCATOR, sizeof(*dependents) * (dependency_count + 1));
+    if (!dependents)
+    {
+        RMOD_ERROR("Failed lin_jalloc(%p, %zu)", G_LIN_JALLOCATOR, sizeof(*dependents) * (dependency_count + 1));
+        res = RMOD_RESULT_NOMEM;
+        goto failed;
+    }
+    //  Number of dependencies of each chain which were not built yet
+    u32* const remaining = lin_jalloc(G_LIN_JALLOCATOR, sizeof(*remaining) * needed_count);
+    if (!remaining)
+    {
+        RMOD_ERROR("Failed lin_jalloc(%p, %zu)", G_LIN_JALLOCATOR, sizeof(*remaining) * needed_count);
+        res = RMOD_RESULT_NOMEM;
+        goto failed;
+    }
+    u32* const build_order_array = lin_jalloc(G_LIN_JALLOCATOR, sizeof(*build_order_array) * needed_count);
+    if (!build_order_array)
+    {
+        RMOD_ERROR("Failed lin_jalloc(%p, %zu)", G_LIN_JALLOCATOR, sizeof(*build_order_array) * needed_count);
+        res = RMOD_RESULT_NOMEM;
+        goto failed;
+    }
+    memset(dependent_offsets, 0, sizeof(*dependent_offsets) * (needed_count + 1));
+    memset(remaining, 0, sizeof(*remaining) * needed_count);
+    for (u32 i = 0; i < needed_count; ++i)
+    {
+        const rmod_chain* const this = &p_types[needed_array[i]].chain;
+        for (u32 j = 0; j < this->element_count; ++j)
         {
-            rmod_chain_element* const this = chain->chain_elements + j;
-            for (u32 k = 0; k < this->child_count; ++k)
+            const element_type_id type_id = this->chain_elements[j].type_id;
+            if (p_types[type_id].header.type_value == RMOD_ELEMENT_TYPE_CHAIN)
             {
-                rmod_chain_element* child = chain->chain_elements + this->children[k];
-                child->parents[child->parent_count++] = j;
+                dependent_offsets[needed_position[type_id] + 1] += 1;
+                remaining[i] += 1;
             }
         }
+    }
+    for (u32 i = 0; i < needed_count; ++i)
+    {
+        dependent_offsets[i + 1] += dependent_offsets[i];
+    }
+    for (u32 i = 0; i < needed_count; ++i)
+    {
+        const rmod_chain* const this = &p_types[needed_array[i]].chain;
+        for (u32 j = 0; j < this->element_count; ++j)
+        {
+            const element_type_id type_id = this->chain_elements[j].type_id;
+            if (p_types[type_id].header.type_value == RMOD_ELEMENT_TYPE_CHAIN)
+            {
+                dependents[dependent_offsets[needed_position[type_id]]++] = i;
+            }
+        }
+    }
+    //  Filling moved each offset to the beginning of the next chain's dependents
+    for (u32 i = needed_count; i > 0; --i)
+    {
+        dependent_offsets[i] = dependent_offsets[i - 1];
+    }
+    dependent_offsets[0] = 0;
 
-        //  Reset the chain to use relative offsets
-        chain_to_relative_relations(chain);
-
-        if (total_element_count != chain->element_count)
+    u32 sorted_count = 0;
+    for (u32 i = 0; i < needed_count; ++i)
+    {
+        if (remaining[i] == 0)
+        {
+            build_order_array[sorted_count++] = i;
+        }
+    }
+    for (u32 i = 0; i < sorted_count; ++i)
+    {
+        const u32 built = build_order_array[i];
+        for (u32 j = dependent_offsets[built]; j < dependent_offsets[built + 1]; ++j)
         {
-            //  Lastly go through the element list and substitute all the chains. Since all elements contain relative ordering,
-            //  this substitution should not need any reordering. Space for all new elements was already reserved before
-            for (u32 j = 0; j < chain->element_count; ++j)
+            if (--remaining[dependents[j]] == 0)
             {
-                const rmod_chain_element* element = chain->chain_elements + j;
-                const rmod_element_type* type = p_types + element->type_id;
-                //  Not a chain, so skip
-                if (type->header.type_value != RMOD_ELEMENT_TYPE_CHAIN)
-                {
-                    continue;
-                }
-                const rmod_chain* sub_chain = &type->chain;
-                if (!sub_chain->compiled)
-                {
-                    RMOD_ERROR("Chain \"%.*s\" was not compiled as dependency for chain \"%.*s\"", sub_chain->header.type_name.len, sub_chain->header.type_name.begin, chain->header.type_name.len, chain->header.type_name.begin);
-                    res = RMOD_RESULT_STUPIDITY;
-                    goto failed;
-                }
-                const u32 sub_elements = sub_chain->element_count;
-                //  Save element which will be replaced
-                const rmod_chain_element e_replaced = chain->chain_elements[j];
-                //  Create a copy of elements that will be inserted
-                rmod_chain_element* const element_copy = lin_jalloc(G_LIN_JALLOCATOR, sub_elements * sizeof(*element_copy));
-                if (!element_copy)
-                {
-                    RMOD_ERROR("Failed lin_jalloc(%p, %zu)", G_LIN_JALLOCATOR, sub_elements * sizeof(*element_copy));
-                    res = RMOD_RESULT_NOMEM;
-                    goto failed;
-                }
-                for (u32 k = 0; k < sub_elements; ++k)
-                {
-                    if ((res = copy_element(sub_chain->chain_elements + k, element_copy + k)))
-                    {
-                        RMOD_ERROR("Failed copying element");
-                        for (u32 l = 0; l < k; ++l)
-                        {
-                            jfree(element_copy[l].parents);
-                            jfree(element_copy[l].children);
-                        }
-                        goto failed;
-                    }
-                    const size_t new_name_len = snprintf(chain->name_buffer + name_pos, extra_name_bytes - name_pos, "%.*s::%.*s",e_replaced.label.len, e_replaced.label.begin, sub_chain->chain_elements[k].label.len, sub_chain->chain_elements[k].label.begin);
-                    assert(new_name_len == 2 + e_replaced.label.len + sub_chain->chain_elements[k].label.len);
-                    element_copy[k].label.begin = chain->name_buffer + name_pos;
-                    name_pos += new_name_len;
-                    element_copy[k].label.len = new_name_len;
-                }
-
-                //  Correct all parent-child relations of the elements proceeding and following this one
-                for (u32 k = 0; k < j; ++k)
-                {
-                    rmod_chain_element* e = chain->chain_elements + k;
-                    for (u32 l = 0; l < e->child_count; ++l)
-                    {
-                        if (e->children[l] + k > j)
-                        {
-                            e->children[l] += sub_elements - 1;
-                        }
-                    }
-                }
-                for (u32 k = j + 1; k < chain->element_count; ++k)
-                {
-                    rmod_chain_element* e = chain->chain_elements + k;
-                    for (u32 l = 0; l < e->parent_count; ++l)
-                    {
-                        if (e->parents[l] + k < j)
-                        {
-                            e->parents[l] -= sub_elements - 1;
-                        }
-                    }
-                }
-                //  Move other elements out of the way
-                memmove(chain->chain_elements + j + sub_elements, chain->chain_elements + j + 1, sizeof(*chain->chain_elements) * (chain->element_count - j - 1));
-                assert(element_copy[0].parent_count == 0);
-                element_copy[0].parent_count = e_replaced.parent_count;
-                assert(element_copy[0].parents == NULL);
-                element_copy[0].parents = e_replaced.parents;
-                assert(element_copy[sub_elements - 1].child_count == 0);
-                element_copy[sub_elements - 1].child_count = e_replaced.child_count;
-                assert(element_copy[sub_elements - 1].children == NULL);
-                element_copy[sub_elements - 1].children = e_replaced.children;
-                //  Copy the memory from the copy_array now that there's space for them
-                memcpy(chain->chain_elements + j, element_copy, sizeof(*element_copy) * sub_elements);
-                lin_jfree(G_LIN_JALLOCATOR, element_copy);
-                chain->element_count += sub_elements - 1;
-                j += sub_elements - 1;
-
-                //  Move loop index forward
+                build_order_array[sorted_count++] = dependents[j];
             }
-            chain->name_bytes_total = name_pos;
         }
+    }
+    if (sorted_count != needed_count)
+    {
+        RMOD_ERROR("Cyclical dependencies for chain \"%s\" were found", chain_name);
+        res = RMOD_RESULT_CYCLICAL_CHAIN_DEPENDENCY;
+        goto failed;
+    }
 
-        assert(chain->element_count == total_element_count);
-        chain->i_first = 0;
-        chain->i_last = chain->element_count - 1;
-        chain->compiled = true;
+    //  Compile chains based on their topological ordering (nice fancy words)
+    if ((res = compile_needed_chains(allocator, p_types, needed_count, needed_array, build_order_array, needed_position, thread_count)) != RMOD_RESULT_SUCCESS)
+    {
+        goto failed;
     }
 
     lin_jfree(G_LIN_JALLOCATOR, build_order_array);
-    lin_jfree(G_LIN_JALLOCATOR, chain_index_array);
+    lin_jfree(G_LIN_JALLOCATOR, remaining);
+    lin_jfree(G_LIN_JALLOCATOR, dependents);
+    lin_jfree(G_LIN_JALLOCATOR, dependent_offsets);
+    lin_jfree(G_LIN_JALLOCATOR, needed_position);
+    lin_jfree(G_LIN_JALLOCATOR, needed_array);
 
     //  Chain compilation is complete. Now the target is compiled.
     assert(target_chain->compiled);
@@ -670,11 +804,7 @@ rmod_result rmod_compile_graph(
             memcpy(name_buffer, block_type->header.type_name.begin, block_type->header.type_name.len);
             name_buffer[block_type->header.type_name.len] = 0;
             type_array[unique_types].name = name_buffer;
-            type_array[unique_types].failure_type = block_type->failure_type;
-            type_array[unique_types].failure_rate = (block_type->mtbf == 0.0) ? 0 : 1.0f / block_type->mtbf;
-            type_array[unique_types].repair_time = block_type->mtbr;
-            type_array[unique_types].effect = block_type->effect;
-            type_array[unique_types].cost = block_type->cost;
+            set_node_type_parameters(type_array + unique_types, block_type);
             unique_types += 1;
             assert(unique_types <= n_types - chain_count);
         }
@@ -731,12 +861,21 @@ rmod_result rmod_compile_graph(
     }
 
     this.type_count = unique_types;
-    this.type_list = jrealloc(type_array, unique_types * sizeof(*type_array));
-    if (!this.type_list)
+    rmod_graph_node_type* const new_type_array = jrealloc(type_array, unique_types * sizeof(*type_array));
+    if (!new_type_array)
     {
         RMOD_WARN("Failed jrealloc(%p, %zu), but not critical since array was bigger than needed", type_array, unique_types * sizeof(*type_array));
         this.type_list = type_array;
     }
+    else
+    {
+        this.type_list = new_type_array;
+    }
+    //  Graph is not reduced, so each node is its own component
+    this.component_count = this.node_count;
+    this.member_offsets = NULL;
+    this.member_list = NULL;
+    this.member_types = NULL;
 
     *p_out = this;
 
@@ -803,9 +942,29 @@ rmod_result rmod_destroy_graph(rmod_graph* graph)
     }
     jfree(graph->type_list);
 
+    jfree(graph->member_types);
+    jfree(graph->member_list);
+    jfree(graph->member_offsets);
+
     jfree(graph->graph_type);
     jfree(graph->module_name);
 
     RMOD_LEAVE_FUNCTION;
     return RMOD_RESULT_SUCCESS;
 }
+
+rmod_result rmod_graph_update_block(rmod_graph* graph, const rmod_block* block)
+{
+    RMOD_ENTER_FUNCTION;
+    for (u32 i = 0; i < graph->type_count; ++i)
+    {
+        rmod_graph_node_type* const type = graph->type_list + i;
+        if (strlen((const char*)type->name) == block->header.type_name.len && strncmp((const char*)type->name, block->header.type_name.begin, block->header.type_name.len) == 0)
+        {
+            set_node_type_parameters(type, block);
+            break;
+        }
+    }
+    RMOD_LEAVE_FUNCTION;
+    return RMOD_RESULT_SUCCESS;
+}
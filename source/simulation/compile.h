@@ -26,6 +26,7 @@ struct rmod_graph_node_type_struct
     f32 effect;
     f32 cost;
     rmod_failure_type failure_type;
+    rmod_parameter_distribution uncertainty[RMOD_BLOCK_PARAMETER_COUNT];   //  Ranges of parameters of the block
 };
 
 typedef struct rmod_graph_struct rmod_graph;
@@ -43,11 +44,24 @@ struct rmod_graph_struct
     //  Type information
     uint_fast32_t type_count;               //  Number of node types
     rmod_graph_node_type* type_list;        //  Array of node types
+
+    //  Reduction information (only for reduced graphs, otherwise member arrays are NULL)
+    uint_fast32_t component_count;          //  Number of nodes in the graph which was reduced
+    u32* member_offsets;                    //  Members of node i are at [member_offsets[i], member_offsets[i + 1])
+    rmod_graph_node_id* member_list;        //  Node of the original graph which each member was
+    rmod_graph_type_id* member_types;       //  Type of each member in this graph's type list
 };
 
 
-rmod_result rmod_compile_graph(u32 n_types, rmod_element_type* p_types, const char* chain_name, const char* module_name, rmod_graph* p_out);
+//  Compiles the chain with the given name, and all chains it depends on, into a graph. Chains which do not depend on
+//  each other are compiled using up to thread_count threads. Compiled chains replace the elements of their types, with the
+//  memory for them taken from the allocator which holds the types.
+rmod_result rmod_compile_graph(region_jallocator* allocator, u32 n_types, rmod_element_type* p_types, const char* chain_name, const char* module_name, u32 thread_count, rmod_graph* p_out);
 
 rmod_result rmod_destroy_graph(rmod_graph* graph);
 
+//  Sets parameters of the graph's node type with the same name as the block to those of the block, so that a block
+//  type which was changed does not require the graph to be compiled again. Nothing is done if the graph has no such type.
+rmod_result rmod_graph_update_block(rmod_graph* graph, const rmod_block* block);
+
 #endif //RMOD_COMPILE_H
@@ -0,0 +1,671 @@
+//
+// Created by jan on 19.10.2026.
+//
+
+#include "graph_cache.h"
+#include <stdio.h>
+#include <inttypes.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <errno.h>
+
+#define RMOD_GRAPH_CACHE_MAGIC "RMODGRC"
+#define RMOD_GRAPH_CACHE_VERSION 1
+//  Written as a number, so that files written on a machine with different byte order are rejected
+#define RMOD_GRAPH_CACHE_BYTE_ORDER 0x01020304u
+
+#define FNV_OFFSET 0xcbf29ce484222325
+#define FNV_PRIME 0x100000001b3
+
+//  All sections are found by their offset from the beginning of the file. Relations come right after the header and
+//  the files, so that they are aligned to 8 bytes, and everything after them only needs alignment to 4 bytes.
+typedef struct cache_header_struct cache_header;
+struct cache_header_struct
+{
+    char magic[8];
+    u32 version;
+    u32 byte_order;
+    u64 key;                            //  Hash of contents of all input files and of the name of the chain
+    u32 file_count;
+    u32 type_count;                     //  Number of block types, which are followed by a record for the chain
+    u32 element_count;
+    u32 relation_count;
+    u32 name_bytes_total;
+    u32 padding;
+    u64 files_offset;
+    u64 relations_offset;
+    u64 types_offset;
+    u64 elements_offset;
+    u64 strings_offset;
+    u64 strings_size;
+};
+
+typedef struct cache_string_struct cache_string;
+struct cache_string_struct
+{
+    u32 offset;                         //  Offset from the beginning of the string section
+    u32 length;
+};
+
+typedef struct cache_file_struct cache_file;
+struct cache_file_struct
+{
+    u64 hash;                           //  Hash of contents of the file when the entry was made
+    cache_string path;
+};
+
+typedef struct cache_distribution_struct cache_distribution;
+struct cache_distribution_struct
+{
+    u32 type;
+    f32 min;
+    f32 max;
+};
+
+typedef struct cache_type_struct cache_type;
+struct cache_type_struct
+{
+    cache_string name;
+    u32 failure_type;
+    f32 mtbf;
+    f32 mtbr;
+    f32 effect;
+    f32 cost;
+    cache_distribution uncertainty[RMOD_BLOCK_PARAMETER_COUNT];
+};
+
+typedef struct cache_element_struct cache_element;
+struct cache_element_struct
+{
+    u32 type_id;
+    cache_string label;
+    u32 parent_count;
+    u32 child_count;
+    u32 relations;                      //  Index of the first relation, parents are followed by children
+};
+
+static_assert(sizeof(cache_header) == 96);
+static_assert(sizeof(cache_file) == 16);
+static_assert(sizeof(cache_type) == 76);
+static_assert(sizeof(cache_element) == 24);
+
+static u64 hash_bytes(u64 hash, const void* const ptr, const u64 size)
+{
+    const unsigned char* const bytes = ptr;
+    for (u64 i = 0; i < size; ++i)
+    {
+        hash ^= bytes[i];
+        hash *= FNV_PRIME;
+    }
+    return hash;
+}
+
+//  Finds the hash of the contents of the file. When it does not exist, *p_found is cleared instead.
+static rmod_result hash_file(const char* const path, u64* const p_hash, bool* const p_found)
+{
+    RMOD_ENTER_FUNCTION;
+    struct stat st;
+    if (stat(path, &st) < 0)
+    {
+        *p_found = false;
+        RMOD_LEAVE_FUNCTION;
+        return RMOD_RESULT_SUCCESS;
+    }
+    u64 hash = FNV_OFFSET;
+    if (st.st_size > 0)
+    {
+        rmod_memory_file file;
+        const rmod_result res = rmod_map_file_to_memory(path, &file);
+        if (res != RMOD_RESULT_SUCCESS)
+        {
+            RMOD_ERROR("Failed mapping file \"%s\" to memory, reason: %s", path, rmod_result_str(res));
+            RMOD_LEAVE_FUNCTION;
+            return res;
+        }
+        //  Mapping is larger than the file, so only the part which is in the file is hashed
+        hash = hash_bytes(hash, file.ptr, (u64)st.st_size);
+        rmod_unmap_file(&file);
+    }
+    *p_hash = hash;
+    *p_found = true;
+    RMOD_LEAVE_FUNCTION;
+    return RMOD_RESULT_SUCCESS;
+}
+
+//  Path of the cache entry, which depends on the path and contents of the main file and on the name of the chain. The
+//  path is included since included files are found relative to the main file.
+static rmod_result cache_entry_path(const char* const cache_dir, const char* const file_name, const char* const chain_name, char* const path)
+{
+    RMOD_ENTER_FUNCTION;
+    char real_name[PATH_MAX];
+    if (!realpath(file_name, real_name))
+    {
+        RMOD_ERROR("Could not find full path of file \"%s\", reason: %s", file_name, RMOD_ERRNO_MESSAGE);
+        RMOD_LEAVE_FUNCTION;
+        return RMOD_RESULT_BAD_PATH;
+    }
+    u64 content_hash;
+    bool found;
+    const rmod_result res = hash_file(real_name, &content_hash, &found);
+    if (res != RMOD_RESULT_SUCCESS)
+    {
+        RMOD_LEAVE_FUNCTION;
+        return res;
+    }
+    if (!found)
+    {
+        RMOD_ERROR("File \"%s\" was not found", real_name);
+        RMOD_LEAVE_FUNCTION;
+        return RMOD_RESULT_BAD_PATH;
+    }
+    u64 hash = hash_bytes(FNV_OFFSET, real_name, strlen(real_name) + 1);
+    hash = hash_bytes(hash, &content_hash, sizeof(content_hash));
+    hash = hash_bytes(hash, chain_name, strlen(chain_name) + 1);
+    if (snprintf(path, PATH_MAX, "%s/%016"PRIx64".rmodc", cache_dir, hash) >= PATH_MAX)
+    {
+        RMOD_ERROR("Path of cache entry in directory \"%s\" is too long", cache_dir);
+        RMOD_LEAVE_FUNCTION;
+        return RMOD_RESULT_BAD_PATH;
+    }
+    RMOD_LEAVE_FUNCTION;
+    return RMOD_RESULT_SUCCESS;
+}
+
+static bool section_fits(const u64 file_size, const u64 offset, const u64 count, const u64 element_size)
+{
+    return offset <= file_size && count <= (file_size - offset) / element_size;
+}
+
+static bool string_fits(const cache_header* const header, const cache_string* const str)
+{
+    return (u64)str->offset + str->length <= header->strings_size;
+}
+
+//  Checks that all sections, strings and relations of the entry are within the file, so that it can be used safely
+static bool check_entry(const void* const base, const u64 file_size)
+{
+    const cache_header* const header = base;
+    if (file_size < sizeof(*header)
+        || memcmp(header->magic, RMOD_GRAPH_CACHE_MAGIC, sizeof(header->magic)) != 0
+        || header->version != RMOD_GRAPH_CACHE_VERSION
+        || header->byte_order != RMOD_GRAPH_CACHE_BYTE_ORDER
+        || header->element_count == 0
+        || !section_fits(file_size, header->files_offset, header->file_count, sizeof(cache_file))
+        || !section_fits(file_size, header->relations_offset, header->relation_count, sizeof(i64))
+        || !section_fits(file_size, header->types_offset, (u64)header->type_count + 1, sizeof(cache_type))
+        || !section_fits(file_size, header->elements_offset, header->element_count, sizeof(cache_element))
+        || !section_fits(file_size, header->strings_offset, header->strings_size, 1)
+        || header->files_offset % _Alignof(cache_file) || header->relations_offset % _Alignof(i64)
+        || header->types_offset % _Alignof(cache_type) || header->elements_offset % _Alignof(cache_element))
+    {
+        return false;
+    }
+    const char* const bytes = base;
+    const cache_file* const files = (const cache_file*)(bytes + header->files_offset);
+    for (u32 i = 0; i < header->file_count; ++i)
+    {
+        if (!string_fits(header, &files[i].path) || files[i].path.length >= PATH_MAX)
+        {
+            return false;
+        }
+    }
+    const cache_type* const types = (const cache_type*)(bytes + header->types_offset);
+    for (u32 i = 0; i < header->type_count + 1; ++i)
+    {
+        if (!string_fits(header, &types[i].name) || types[i].failure_type >= RMOD_FAILURE_TYPE_COUNT)
+        {
+            return false;
+        }
+        for (u32 j = 0; j < RMOD_BLOCK_PARAMETER_COUNT; ++j)
+        {
+            if (types[i].uncertainty[j].type >= RMOD_DISTRIBUTION_COUNT)
+            {
+                return false;
+            }
+        }
+    }
+    const cache_element* const elements = (const cache_element*)(bytes + header->elements_offset);
+    const i64* const relations = (const i64*)(bytes + header->relations_offset);
+    for (u32 i = 0; i < header->element_count; ++i)
+    {
+        const cache_element* const e = elements + i;
+        if (e->type_id >= header->type_count || !string_fits(header, &e->label)
+            || (u64)e->relations + e->parent_count + e->child_count > header->relation_count)
+        {
+            return false;
+        }
+        for (u32 j = 0; j < e->parent_count + e->child_count; ++j)
+        {
+            const i64 target = (i64)i + relations[e->relations + j];
+            if (target < 0 || target >= header->element_count)
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+//  Checks that contents of all files which the entry was built from are still the same
+static rmod_result entry_is_current(const void* const base, const char* const chain_name, bool* const p_current)
+{
+    RMOD_ENTER_FUNCTION;
+    const cache_header* const header = base;
+    const char* const bytes = base;
+    const cache_file* const files = (const cache_file*)(bytes + header->files_offset);
+    const char* const strings = bytes + header->strings_offset;
+    u64 key = FNV_OFFSET;
+    *p_current = false;
+    for (u32 i = 0; i < header->file_count; ++i)
+    {
+        char path[PATH_MAX];
+        memcpy(path, strings + files[i].path.offset, files[i].path.length);
+        path[files[i].path.length] = 0;
+        u64 hash;
+        bool found;
+        const rmod_result res = hash_file(path, &hash, &found);
+        if (res != RMOD_RESULT_SUCCESS)
+        {
+            RMOD_LEAVE_FUNCTION;
+            return res;
+        }
+        if (!found || hash != files[i].hash)
+        {
+            RMOD_INFO("File \"%s\" changed since the cache entry was made", path);
+            RMOD_LEAVE_FUNCTION;
+            return RMOD_RESULT_SUCCESS;
+        }
+        key = hash_bytes(key, &hash, sizeof(hash));
+    }
+    key = hash_bytes(key, chain_name, strlen(chain_name) + 1);
+    *p_current = key == header->key;
+    RMOD_LEAVE_FUNCTION;
+    return RMOD_RESULT_SUCCESS;
+}
+
+rmod_result rmod_graph_cache_load(
+        const char* cache_dir, const char* file_name, const char* chain_name, rmod_program* p_program, bool* p_hit)
+{
+    RMOD_ENTER_FUNCTION;
+    rmod_result res;
+    region_jallocator* allocator = NULL;
+    rmod_memory_file* mem_file = NULL;
+    *p_hit = false;
+
+    char path[PATH_MAX];
+    if ((res = cache_entry_path(cache_dir, file_name, chain_name, path)) != RMOD_RESULT_SUCCESS)
+    {
+        RMOD_LEAVE_FUNCTION;
+        return res;
+    }
+    struct stat st;
+    if (stat(path, &st) < 0)
+    {
+        RMOD_LEAVE_FUNCTION;
+        return RMOD_RESULT_SUCCESS;
+    }
+    allocator = region_jallocator_create(RMOD_PROGRAM_REGION_SIZE);
+    if (!allocator)
+    {
+        RMOD_ERROR("Failed creating region allocator of size %"PRIu64" for the program", RMOD_PROGRAM_REGION_SIZE);
+        RMOD_LEAVE_FUNCTION;
+        return RMOD_RESULT_NOMEM;
+    }
+    mem_file = region_jalloc(allocator, sizeof(*mem_file));
+    if (!mem_file)
+    {
+        RMOD_ERROR("Failed region_jalloc(%p, %zu)", allocator, sizeof(*mem_file));
+        region_jallocator_destroy(allocator);
+        RMOD_LEAVE_FUNCTION;
+        return RMOD_RESULT_NOMEM;
+    }
+    if ((res = rmod_map_file_to_memory(path, mem_file)) != RMOD_RESULT_SUCCESS)
+    {
+        RMOD_ERROR("Failed mapping cache entry \"%s\" to memory, reason: %s", path, rmod_result_str(res));
+        region_jallocator_destroy(allocator);
+        RMOD_LEAVE_FUNCTION;
+        return res;
+    }
+    const char* const bytes = mem_file->ptr;
+    const cache_header* const header = mem_file->ptr;
+    if (!check_entry(mem_file->ptr, (u64)st.st_size))
+    {
+        RMOD_WARN("Cache entry \"%s\" is not valid and will be replaced", path);
+        res = RMOD_RESULT_SUCCESS;
+        goto failed;
+    }
+    bool current;
+    if ((res = entry_is_current(mem_file->ptr, chain_name, &current)) != RMOD_RESULT_SUCCESS || !current)
+    {
+        goto failed;
+    }
+
+    const char* const strings = bytes + header->strings_offset;
+    const cache_type* const cached_types = (const cache_type*)(bytes + header->types_offset);
+    const cache_element* const cached_elements = (const cache_element*)(bytes + header->elements_offset);
+    const i64* const relations = (const i64*)(bytes + header->relations_offset);
+    const u32 n_types = header->type_count + 1;
+    const u32 n_elements = header->element_count;
+    rmod_element_type* const types = region_jalloc(allocator, sizeof(*types) * n_types);
+    if (!types)
+    {
+        RMOD_ERROR("Failed region_jalloc(%p, %zu)", allocator, sizeof(*types) * n_types);
+        res = RMOD_RESULT_NOMEM;
+        goto failed;
+    }
+    memset(types, 0, sizeof(*types) * n_types);
+    for (u32 i = 0; i < header->type_count; ++i)
+    {
+        const cache_type* const t = cached_types + i;
+        rmod_block* const block = &types[i].block;
+        *block = (rmod_block)
+                {
+                .header = {.type_value = RMOD_ELEMENT_TYPE_BLOCK, .type_name = {.begin = strings + t->name.offset, .len = t->name.length}},
+                .mtbf = t->mtbf,
+                .mtbr = t->mtbr,
+                .effect = t->effect,
+                .cost = t->cost,
+                .failure_type = t->failure_type,
+                };
+        for (u32 j = 0; j < RMOD_BLOCK_PARAMETER_COUNT; ++j)
+        {
+            block->uncertainty[j] = (rmod_parameter_distribution){.type = t->uncertainty[j].type, .min = t->uncertainty[j].min, .max = t->uncertainty[j].max};
+        }
+    }
+
+    rmod_chain_element* const chain_elements = region_jalloc(allocator, sizeof(*chain_elements) * n_elements);
+    if (!chain_elements)
+    {
+        RMOD_ERROR("Failed region_jalloc(%p, %zu)", allocator, sizeof(*chain_elements) * n_elements);
+        res = RMOD_RESULT_NOMEM;
+        goto failed;
+    }
+    for (u32 converted = 0; converted < n_elements; ++converted)
+    {
+        const cache_element* const e = cached_elements + converted;
+        rmod_chain_element* const out = chain_elements + converted;
+        *out = (rmod_chain_element)
+                {
+                .type_id = e->type_id,
+                .id = converted,
+                .label = {.begin = strings + e->label.offset, .len = e->label.length},
+                .parent_count = e->parent_count,
+                .parents = e->parent_count ? region_jalloc(allocator, sizeof(*out->parents) * e->parent_count) : NULL,
+                .child_count = e->child_count,
+                .children = e->child_count ? region_jalloc(allocator, sizeof(*out->children) * e->child_count) : NULL,
+                };
+        if ((e->parent_count && !out->parents) || (e->child_count && !out->children))
+        {
+            RMOD_ERROR("Failed region_jalloc(%p, %zu)", allocator, sizeof(*out->parents) * (e->parent_count + e->child_count));
+            res = RMOD_RESULT_NOMEM;
+            goto failed;
+        }
+        for (u32 j = 0; j < e->parent_count; ++j)
+        {
+            out->parents[j] = (ptrdiff_t)relations[e->relations + j];
+        }
+        for (u32 j = 0; j < e->child_count; ++j)
+        {
+            out->children[j] = (ptrdiff_t)relations[e->relations + e->parent_count + j];
+        }
+    }
+    types[n_types - 1].chain = (rmod_chain)
+            {
+            .header = {.type_value = RMOD_ELEMENT_TYPE_CHAIN, .type_name = {.begin = strings + cached_types[header->type_count].name.offset, .len = cached_types[header->type_count].name.length}},
+            .element_count = n_elements,
+            .chain_elements = chain_elements,
+            .i_first = 0,
+            .i_last = n_elements - 1,
+            .name_buffer = NULL,
+            .name_bytes_total = header->name_bytes_total,
+            .compiled = true,
+            };
+    *p_program = (rmod_program)
+            {
+            .allocator = allocator,
+            .n_types = n_types,
+            .p_types = types,
+            .n_files = 1,
+            .mem_files = mem_file,
+            };
+    *p_hit = true;
+    RMOD_LEAVE_FUNCTION;
+    return RMOD_RESULT_SUCCESS;
+
+failed:
+    rmod_unmap_file(mem_file);
+    region_jallocator_destroy(allocator);
+    RMOD_LEAVE_FUNCTION;
+    return res;
+}
+
+static cache_string add_string(char* const strings, u32* const p_size, const char* const str, const u32 len)
+{
+    const cache_string out = {.offset = *p_size, .length = len};
+    memcpy(strings + *p_size, str, len);
+    *p_size += len;
+    return out;
+}
+
+rmod_result rmod_graph_cache_store(
+        const char* cache_dir, const char* file_name, const char* chain_name, const rmod_program* program)
+{
+    RMOD_ENTER_FUNCTION;
+    rmod_result res;
+    void* const base_lin_alloc = lin_jalloc_get_current(G_LIN_JALLOCATOR);
+    char* image = NULL;
+
+    const rmod_chain* chain = NULL;
+    for (u32 i = 0; i < program->n_types; ++i)
+    {
+        const rmod_element_type* const type = program->p_types + i;
+        if (type->header.type_value == RMOD_ELEMENT_TYPE_CHAIN && type->header.type_name.len == strlen(chain_name)
+            && strncmp(type->header.type_name.begin, chain_name, type->header.type_name.len) == 0)
+        {
+            chain = &type->chain;
+            break;
+        }
+    }
+    if (!chain || !chain->compiled)
+    {
+        RMOD_ERROR("Chain \"%s\" was not compiled, so it can not be cached", chain_name);
+        res = RMOD_RESULT_BAD_CHAIN_NAME;
+        goto failed;
+    }
+
+    //  Only block types which are used by the chain are stored, so they get new ids
+    u32* const new_ids = lin_jalloc(G_LIN_JALLOCATOR, sizeof(*new_ids) * program->n_types);
+    if (!new_ids)
+    {
+        RMOD_ERROR("Failed lin_jalloc(%p, %zu)", G_LIN_JALLOCATOR, sizeof(*new_ids) * program->n_types);
+        res = RMOD_RESULT_NOMEM;
+        goto failed;
+    }
+    u32* const used_types = lin_jalloc(G_LIN_JALLOCATOR, sizeof(*used_types) * program->n_types);
+    if (!used_types)
+    {
+        RMOD_ERROR("Failed lin_jalloc(%p, %zu)", G_LIN_JALLOCATOR, sizeof(*used_types) * program->n_types);
+        res = RMOD_RESULT_NOMEM;
+        goto failed;
+    }
+    u64* const file_hashes = lin_jalloc(G_LIN_JALLOCATOR, sizeof(*file_hashes) * (program->n_files + 1));
+    if (!file_hashes)
+    {
+        RMOD_ERROR("Failed lin_jalloc(%p, %zu)", G_LIN_JALLOCATOR, sizeof(*file_hashes) * (program->n_files + 1));
+        res = RMOD_RESULT_NOMEM;
+        goto failed;
+    }
+    memset(new_ids, 0xFF, sizeof(*new_ids) * program->n_types);
+    u32 type_count = 0;
+    u64 string_bytes = strlen(chain_name);
+    u64 relation_count = 0;
+    for (u32 i = 0; i < chain->element_count; ++i)
+    {
+        const rmod_chain_element* const e = chain->chain_elements + i;
+        assert(program->p_types[e->type_id].header.type_value == RMOD_ELEMENT_TYPE_BLOCK);
+        if (new_ids[e->type_id] == (u32)-1)
+        {
+            new_ids[e->type_id] = type_count;
+            used_types[type_count++] = e->type_id;
+            string_bytes += program->p_types[e->type_id].header.type_name.len;
+        }
+        string_bytes += e->label.len;
+        relation_count += (u64)e->parent_count + e->child_count;
+    }
+    //  Key depends on contents of every file which was read, so a change in any of them makes the entry out of date
+    u64 key = FNV_OFFSET;
+    for (u32 i = 0; i < program->n_files; ++i)
+    {
+        bool found;
+        if ((res = hash_file(program->mem_files[i].name, file_hashes + i, &found)) != RMOD_RESULT_SUCCESS)
+        {
+            goto failed;
+        }
+        if (!found)
+        {
+            RMOD_ERROR("File \"%s\" was removed after being parsed", program->mem_files[i].name);
+            res = RMOD_RESULT_BAD_PATH;
+            goto failed;
+        }
+        key = hash_bytes(key, file_hashes + i, sizeof(*file_hashes));
+        string_bytes += strlen(program->mem_files[i].name);
+    }
+    key = hash_bytes(key, chain_name, strlen(chain_name) + 1);
+    if (string_bytes > UINT32_MAX || relation_count > UINT32_MAX)
+    {
+        RMOD_ERROR("Chain \"%s\" is too large to be cached", chain_name);
+        res = RMOD_RESULT_BAD_VALUE;
+        goto failed;
+    }
+
+    cache_header header =
+            {
+            .magic = RMOD_GRAPH_CACHE_MAGIC,
+            .version = RMOD_GRAPH_CACHE_VERSION,
+            .byte_order = RMOD_GRAPH_CACHE_BYTE_ORDER,
+            .key = key,
+            .file_count = program->n_files,
+            .type_count = type_count,
+            .element_count = chain->element_count,
+            .relation_count = (u32)relation_count,
+            .name_bytes_total = chain->name_bytes_total,
+            };
+    header.files_offset = sizeof(header);
+    header.relations_offset = header.files_offset + sizeof(cache_file) * header.file_count;
+    header.types_offset = header.relations_offset + sizeof(i64) * header.relation_count;
+    header.elements_offset = header.types_offset + sizeof(cache_type) * (header.type_count + 1);
+    header.strings_offset = header.elements_offset + sizeof(cache_element) * header.element_count;
+    header.strings_size = string_bytes;
+    const u64 image_size = header.strings_offset + header.strings_size;
+    image = jalloc(image_size);
+    if (!image)
+    {
+        RMOD_ERROR("Failed jalloc(%zu)", (size_t)image_size);
+        res = RMOD_RESULT_NOMEM;
+        goto failed;
+    }
+    memset(image, 0, image_size);
+    memcpy(image, &header, sizeof(header));
+    cache_file* const files = (cache_file*)(image + header.files_offset);
+    i64* const relations = (i64*)(image + header.relations_offset);
+    cache_type* const types = (cache_type*)(image + header.types_offset);
+    cache_element* const elements = (cache_element*)(image + header.elements_offset);
+    char* const strings = image + header.strings_offset;
+    u32 string_size = 0;
+    for (u32 i = 0; i < header.file_count; ++i)
+    {
+        const char* const name = program->mem_files[i].name;
+        files[i] = (cache_file){.hash = file_hashes[i], .path = add_string(strings, &string_size, name, strlen(name))};
+    }
+    for (u32 i = 0; i < type_count; ++i)
+    {
+        const rmod_block* const block = &program->p_types[used_types[i]].block;
+        cache_type* const t = types + i;
+        *t = (cache_type)
+                {
+                .name = add_string(strings, &string_size, block->header.type_name.begin, block->header.type_name.len),
+                .failure_type = block->failure_type,
+                .mtbf = block->mtbf,
+                .mtbr = block->mtbr,
+                .effect = block->effect,
+                .cost = block->cost,
+                };
+        for (u32 j = 0; j < RMOD_BLOCK_PARAMETER_COUNT; ++j)
+        {
+            t->uncertainty[j] = (cache_distribution){.type = block->uncertainty[j].type, .min = block->uncertainty[j].min, .max = block->uncertainty[j].max};
+        }
+    }
+    types[type_count] = (cache_type){.name = add_string(strings, &string_size, chain_name, strlen(chain_name))};
+    u32 relation_index = 0;
+    for (u32 i = 0; i < chain->element_count; ++i)
+    {
+        const rmod_chain_element* const e = chain->chain_elements + i;
+        elements[i] = (cache_element)
+                {
+                .type_id = new_ids[e->type_id],
+                .label = add_string(strings, &string_size, e->label.begin, e->label.len),
+                .parent_count = e->parent_count,
+                .child_count = e->child_count,
+                .relations = relation_index,
+                };
+        for (u32 j = 0; j < e->parent_count; ++j)
+        {
+            relations[relation_index++] = (i64)e->parents[j];
+        }
+        for (u32 j = 0; j < e->child_count; ++j)
+        {
+            relations[relation_index++] = (i64)e->children[j];
+        }
+    }
+    assert(string_size == string_bytes);
+    assert(relation_index == relation_count);
+
+    char path[PATH_MAX];
+    char tmp_path[PATH_MAX];
+    if ((res = cache_entry_path(cache_dir, file_name, chain_name, path)) != RMOD_RESULT_SUCCESS)
+    {
+        goto failed;
+    }
+    if (snprintf(tmp_path, sizeof(tmp_path), "%s.%ld.tmp", path, (long)getpid()) >= (int)sizeof(tmp_path))
+    {
+        RMOD_ERROR("Path of cache entry in directory \"%s\" is too long", cache_dir);
+        res = RMOD_RESULT_BAD_PATH;
+        goto failed;
+    }
+    if (mkdir(cache_dir, 0755) < 0 && errno != EEXIST)
+    {
+        RMOD_ERROR("Could not create cache directory \"%s\", reason: %s", cache_dir, RMOD_ERRNO_MESSAGE);
+        res = RMOD_RESULT_BAD_PATH;
+        goto failed;
+    }
+    //  Entry is written to a temporary file first, so that other processes never see a partially written one
+    FILE* const file = fopen(tmp_path, "wb");
+    if (!file)
+    {
+        RMOD_ERROR("Could not open file \"%s\", reason: %s", tmp_path, RMOD_ERRNO_MESSAGE);
+        res = RMOD_RESULT_BAD_PATH;
+        goto failed;
+    }
+    const bool written = fwrite(image, 1, image_size, file) == image_size;
+    if (fclose(file) != 0 || !written)
+    {
+        RMOD_ERROR("Failed writing cache entry \"%s\", reason: %s", tmp_path, RMOD_ERRNO_MESSAGE);
+        remove(tmp_path);
+        res = RMOD_RESULT_BAD_PATH;
+        goto failed;
+    }
+    if (rename(tmp_path, path) < 0)
+    {
+        RMOD_ERROR("Could not rename \"%s\" to \"%s\", reason: %s", tmp_path, path, RMOD_ERRNO_MESSAGE);
+        remove(tmp_path);
+        res = RMOD_RESULT_BAD_PATH;
+        goto failed;
+    }
+    res = RMOD_RESULT_SUCCESS;
+
+failed:
+    jfree(image);
+    lin_jalloc_set_current(G_LIN_JALLOCATOR, base_lin_alloc);
+    RMOD_LEAVE_FUNCTION;
+    return res;
+}
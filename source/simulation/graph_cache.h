@@ -0,0 +1,24 @@
+//
+// Created by jan on 19.10.2026.
+//
+
+#ifndef RMOD_GRAPH_CACHE_H
+#define RMOD_GRAPH_CACHE_H
+#include "program.h"
+
+//  Cache of compiled chains. Each entry holds the compiled chain and the block types it uses, in a binary file which
+//  only contains offsets, so it can be used directly after being mapped to memory. Entries are found by hash of the
+//  contents of the main file and the name of the chain, and are only used if contents of all files which were read to
+//  build them, including the included ones, still match.
+
+//  Looks for the chain of the file in the cache directory. When it is found, *p_hit is set and the program contains
+//  the compiled chain and its block types, with names and labels pointing into the mapped cache file, so that it can
+//  be compiled into a graph without parsing anything. When it is not found or is out of date, *p_hit is cleared.
+rmod_result rmod_graph_cache_load(
+        const char* cache_dir, const char* file_name, const char* chain_name, rmod_program* p_program, bool* p_hit);
+
+//  Stores the chain of the program, which must already be compiled, in the cache directory
+rmod_result rmod_graph_cache_store(
+        const char* cache_dir, const char* file_name, const char* chain_name, const rmod_program* program);
+
+#endif //RMOD_GRAPH_CACHE_H
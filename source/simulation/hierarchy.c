@@ -0,0 +1,632 @@
+//
+// Created by jan on 19.10.2026.
+//
+
+#include "hierarchy.h"
+#include "../analysis/exact.h"
+
+//  Number of Simpson's rule panels after which the step used to integrate reliability is doubled
+#define RMOD_HIERARCHY_PANELS_PER_STEP 32
+//  Maximum number of Simpson's rule panels used to integrate reliability
+#define RMOD_HIERARCHY_MAX_PANELS 2048
+//  Reliability below which the rest of the integral is neglected
+#define RMOD_HIERARCHY_RELIABILITY_CUTOFF 1e-9
+
+static c8* copy_type_name(const c8* name)
+{
+    const u64 len = strlen((const char*)name);
+    c8* const copy = jalloc(len + 1);
+    if (!copy)
+    {
+        RMOD_ERROR("Failed jalloc(%zu)", len + 1);
+        return NULL;
+    }
+    memcpy(copy, name, len + 1);
+    return copy;
+}
+
+//  Length of the part of the label before the first "::", or zero if the node was not inlined from a sub-chain
+static u32 instance_prefix_length(const string_segment* label)
+{
+    for (u32 i = 0; i + 1 < label->len; ++i)
+    {
+        if (label->begin[i] == ':' && label->begin[i + 1] == ':')
+        {
+            return i;
+        }
+    }
+    return 0;
+}
+
+static bool has_instance_prefix(const string_segment* label, const c8* prefix, u32 prefix_len)
+{
+    return label->len > prefix_len + 2 && memcmp(label->begin, prefix, prefix_len) == 0
+           && label->begin[prefix_len] == ':' && label->begin[prefix_len + 1] == ':';
+}
+
+//  Nodes in [first, last] can only be replaced by a single node if flow enters them only through the first and leaves
+//  only through the last one
+static bool is_two_terminal(const rmod_graph* graph, u32 first, u32 last)
+{
+    for (u32 i = first; i <= last; ++i)
+    {
+        const rmod_graph_node* const node = graph->node_list + i;
+        if (i != first)
+        {
+            for (u32 j = 0; j < node->parent_count; ++j)
+            {
+                if (node->parents[j] < first || node->parents[j] > last)
+                {
+                    return false;
+                }
+            }
+        }
+        if (i != last)
+        {
+            for (u32 j = 0; j < node->child_count; ++j)
+            {
+                if (node->children[j] < first || node->children[j] > last)
+                {
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+//  Instances of the same sub-chain have the same types and the same edges relative to their first node
+static bool same_structure(const rmod_graph* graph, const rmod_surrogate_block* a, const rmod_surrogate_block* b)
+{
+    if (a->last - a->first != b->last - b->first)
+    {
+        return false;
+    }
+    for (u32 i = 0; i <= a->last - a->first; ++i)
+    {
+        const rmod_graph_node* const node_a = graph->node_list + a->first + i;
+        const rmod_graph_node* const node_b = graph->node_list + b->first + i;
+        if (node_a->type_id != node_b->type_id || node_a->parent_count != node_b->parent_count)
+        {
+            return false;
+        }
+        if (i == 0)
+        {
+            //  Parents of the first node are outside the instance
+            continue;
+        }
+        for (u32 j = 0; j < node_a->parent_count; ++j)
+        {
+            if (node_a->parents[j] - a->first != node_b->parents[j] - b->first)
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+//  Finds reliability of the sub-chain from its structure function and integrates it to get its mean time to failure,
+//  to which the rate of the surrogate is fitted
+static rmod_result characterize_block(const rmod_graph* graph, rmod_surrogate_block* block)
+{
+    RMOD_ENTER_FUNCTION;
+    rmod_result res;
+    void* const base = lin_jalloc_get_current(G_LIN_JALLOCATOR);
+    const u32 count = block->last - block->first + 1;
+    rmod_structure_function structure = {0};
+
+    //  Sub-graph of only the instance's nodes, which shares types with the whole graph
+    rmod_graph sub =
+            {
+            .module_name = graph->module_name,
+            .graph_type = graph->graph_type,
+            .parent = graph->parent,
+            .node_count = count,
+            .type_count = graph->type_count,
+            .type_list = graph->type_list,
+            .component_count = count,
+            };
+    rmod_graph_node* const nodes = lin_jalloc(G_LIN_JALLOCATOR, sizeof(*nodes) * count);
+    if (!nodes)
+    {
+        RMOD_ERROR("Failed lin_jalloc(%p, %zu)", G_LIN_JALLOCATOR, sizeof(*nodes) * count);
+        res = RMOD_RESULT_NOMEM;
+        goto end;
+    }
+    sub.node_list = nodes;
+    f64* const value = lin_jalloc(G_LIN_JALLOCATOR, sizeof(*value) * count);
+    if (!value)
+    {
+        RMOD_ERROR("Failed lin_jalloc(%p, %zu)", G_LIN_JALLOCATOR, sizeof(*value) * count);
+        res = RMOD_RESULT_NOMEM;
+        goto end;
+    }
+    f64 total_rate = 0.0;
+    block->degradable = false;
+    for (u32 i = 0; i < count; ++i)
+    {
+        const rmod_graph_node* const node = graph->node_list + block->first + i;
+        rmod_graph_node* const this = nodes + i;
+        this->type_id = node->type_id;
+        this->parent_count = i != 0 ? node->parent_count : 0;
+        this->child_count = i != count - 1 ? node->child_count : 0;
+        this->parents = NULL;
+        this->children = NULL;
+        if (this->parent_count)
+        {
+            this->parents = lin_jalloc(G_LIN_JALLOCATOR, sizeof(*this->parents) * this->parent_count);
+            if (!this->parents)
+            {
+                RMOD_ERROR("Failed lin_jalloc(%p, %zu)", G_LIN_JALLOCATOR, sizeof(*this->parents) * this->parent_count);
+                res = RMOD_RESULT_NOMEM;
+                goto end;
+            }
+        }
+        if (this->child_count)
+        {
+            this->children = lin_jalloc(G_LIN_JALLOCATOR, sizeof(*this->children) * this->child_count);
+            if (!this->children)
+            {
+                RMOD_ERROR("Failed lin_jalloc(%p, %zu)", G_LIN_JALLOCATOR, sizeof(*this->children) * this->child_count);
+                res = RMOD_RESULT_NOMEM;
+                goto end;
+            }
+        }
+        f64 input = this->parent_count ? 0.0 : 1.0;
+        for (u32 j = 0; j < this->parent_count; ++j)
+        {
+            this->parents[j] = node->parents[j] - block->first;
+            input += value[this->parents[j]];
+        }
+        for (u32 j = 0; j < this->child_count; ++j)
+        {
+            this->children[j] = node->children[j] - block->first;
+        }
+        //  Flow through a node with multiple parents only drops partially when one of them fails
+        block->degradable |= this->parent_count > 1;
+        const rmod_graph_node_type* const type = graph->type_list + node->type_id;
+        value[i] = type->effect * input;
+        total_rate += type->failure_rate;
+    }
+    block->effect = value[count - 1];
+
+    if (total_rate == 0.0)
+    {
+        block->mttf = INFINITY;
+        block->failure_rate = 0.0;
+        block->max_error = 0.0;
+        res = RMOD_RESULT_SUCCESS;
+        goto end;
+    }
+
+    if ((res = rmod_structure_function_build(&sub, &structure)) != RMOD_RESULT_SUCCESS)
+    {
+        RMOD_ERROR("Could not build structure function of nodes %u to %u, reason: %s", block->first, block->last, rmod_result_str(res));
+        goto end;
+    }
+    f64* const p_work = lin_jalloc(G_LIN_JALLOCATOR, sizeof(*p_work) * count);
+    if (!p_work)
+    {
+        RMOD_ERROR("Failed lin_jalloc(%p, %zu)", G_LIN_JALLOCATOR, sizeof(*p_work) * count);
+        res = RMOD_RESULT_NOMEM;
+        goto end;
+    }
+    f64* const bdd_work = lin_jalloc(G_LIN_JALLOCATOR, sizeof(*bdd_work) * structure.bdd.node_count);
+    if (!bdd_work)
+    {
+        RMOD_ERROR("Failed lin_jalloc(%p, %zu)", G_LIN_JALLOCATOR, sizeof(*bdd_work) * structure.bdd.node_count);
+        res = RMOD_RESULT_NOMEM;
+        goto end;
+    }
+    const u32 max_samples = 2 * RMOD_HIERARCHY_MAX_PANELS + 1;
+    f64* const sample_t = lin_jalloc(G_LIN_JALLOCATOR, sizeof(*sample_t) * max_samples);
+    f64* const sample_r = lin_jalloc(G_LIN_JALLOCATOR, sizeof(*sample_r) * max_samples);
+    if (!sample_t || !sample_r)
+    {
+        RMOD_ERROR("Failed lin_jalloc(%p, %zu)", G_LIN_JALLOCATOR, sizeof(*sample_r) * max_samples);
+        res = RMOD_RESULT_NOMEM;
+        goto end;
+    }
+
+    //  Reliability is integrated with Simpson's rule, with the step doubling as it goes, since redundant sub-chains
+    //  have long tails. The first step is based on how soon the first member fails.
+    f64 h = 1.0 / (16.0 * total_rate), t = 0.0, mttf = 0.0;
+    u32 sample_count = 0;
+    sample_t[sample_count] = 0.0;
+    sample_r[sample_count++] = 1.0;
+    for (u32 panel = 0; panel < RMOD_HIERARCHY_MAX_PANELS; ++panel)
+    {
+        if (panel && panel % RMOD_HIERARCHY_PANELS_PER_STEP == 0)
+        {
+            h *= 2.0;
+        }
+        for (u32 k = 1; k <= 2; ++k)
+        {
+            const f64 tk = t + h * (f64)k;
+            for (u32 i = 0; i < count; ++i)
+            {
+                p_work[i] = exp(-(f64)graph->type_list[nodes[i].type_id].failure_rate * tk);
+            }
+            sample_t[sample_count] = tk;
+            sample_r[sample_count++] = rmod_bdd_probability(&structure.bdd, structure.root, p_work, bdd_work);
+        }
+        mttf += h / 3.0 * (sample_r[sample_count - 3] + 4.0 * sample_r[sample_count - 2] + sample_r[sample_count - 1]);
+        t += 2.0 * h;
+        if (sample_r[sample_count - 1] < RMOD_HIERARCHY_RELIABILITY_CUTOFF)
+        {
+            break;
+        }
+    }
+    if (sample_r[sample_count - 1] >= RMOD_HIERARCHY_RELIABILITY_CUTOFF)
+    {
+        RMOD_WARN("Reliability of nodes %u to %u was still %g at the end of integration, so their mean time to failure is underestimated", block->first, block->last, sample_r[sample_count - 1]);
+    }
+
+    block->mttf = mttf;
+    block->failure_rate = 1.0 / mttf;
+    block->max_error = 0.0;
+    for (u32 i = 0; i < sample_count; ++i)
+    {
+        const f64 error = fabs(sample_r[i] - exp(-block->failure_rate * sample_t[i]));
+        if (error > block->max_error)
+        {
+            block->max_error = error;
+        }
+    }
+    res = RMOD_RESULT_SUCCESS;
+
+end:
+    rmod_structure_function_destroy(&structure);
+    lin_jalloc_set_current(G_LIN_JALLOCATOR, base);
+    RMOD_LEAVE_FUNCTION;
+    return res;
+}
+
+rmod_result rmod_build_surrogate_graph(
+        const rmod_graph* graph, f64 interval, rmod_surrogate_report* p_report, rmod_graph* p_out)
+{
+    RMOD_ENTER_FUNCTION;
+    rmod_result res;
+#ifndef _WIN32
+    struct timespec t_begin;
+    int time_res = clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &t_begin);
+    assert(time_res >= 0);
+#else
+    LARGE_INTEGER t_begin;
+    QueryPerformanceCounter(&t_begin);
+#endif
+    void* const base = lin_jalloc_get_current(G_LIN_JALLOCATOR);
+    const u32 node_count = graph->node_count;
+    rmod_surrogate_report report = {.interval = interval};
+    //  Zeroed, so that destroying it releases only what was allocated so far
+    rmod_graph this;
+    memset(&this, 0, sizeof(this));
+    this.parent = graph->parent;
+    this.component_count = node_count;
+    if (graph->member_offsets)
+    {
+        RMOD_ERROR("Graph [%s - %s] was already reduced", graph->module_name, graph->graph_type);
+        res = RMOD_RESULT_BAD_VALUE;
+        goto failed;
+    }
+
+    //  Find instances of sub-chains. Compiling the graph inlines each instance as a contiguous range of nodes, labeled
+    //  with the label of the instance followed by "::".
+    report.blocks = jalloc(sizeof(*report.blocks) * (node_count / 2 + 1));
+    if (!report.blocks)
+    {
+        RMOD_ERROR("Failed jalloc(%zu)", sizeof(*report.blocks) * (node_count / 2 + 1));
+        res = RMOD_RESULT_NOMEM;
+        goto failed;
+    }
+    const rmod_chain_element* const elements = graph->parent->chain_elements;
+    for (u32 i = 0; i < node_count;)
+    {
+        const u32 prefix_len = instance_prefix_length(&elements[i].label);
+        u32 last = i;
+        if (prefix_len)
+        {
+            while (last + 1 < node_count && has_instance_prefix(&elements[last + 1].label, (const c8*)elements[i].label.begin, prefix_len))
+            {
+                last += 1;
+            }
+        }
+        if (last > i && is_two_terminal(graph, i, last))
+        {
+            report.blocks[report.block_count] = (rmod_surrogate_block){.first = i, .last = last, .prototype = report.block_count};
+            report.block_count += 1;
+        }
+        else if (last > i)
+        {
+            RMOD_WARN("Sub-chain \"%.*s\" (nodes %u to %u) has edges to nodes outside of it other than through its first and last node, so it is not replaced", prefix_len, elements[i].label.begin, i, last);
+        }
+        i = last + 1;
+    }
+
+    //  Characterize each distinct sub-chain once and reuse it for all other instances of it
+    for (u32 i = 0; i < report.block_count; ++i)
+    {
+        rmod_surrogate_block* const block = report.blocks + i;
+        for (u32 j = 0; j < i; ++j)
+        {
+            const rmod_surrogate_block* const other = report.blocks + j;
+            if (other->prototype == j && same_structure(graph, other, block))
+            {
+                block->prototype = j;
+                block->mttf = other->mttf;
+                block->failure_rate = other->failure_rate;
+                block->effect = other->effect;
+                block->max_error = other->max_error;
+                block->degradable = other->degradable;
+                break;
+            }
+        }
+        if (block->prototype != i)
+        {
+            continue;
+        }
+        if ((res = characterize_block(graph, block)) != RMOD_RESULT_SUCCESS)
+        {
+            RMOD_ERROR("Could not characterize sub-chain at nodes %u to %u, reason: %s", block->first, block->last, rmod_result_str(res));
+            goto failed;
+        }
+        report.characterized_count += 1;
+    }
+
+    //  Node of the surrogate graph which each node of the original graph is in. Nodes are ordered by their first
+    //  member, which keeps them sorted topologically, since edges only enter an instance at its first node and leave
+    //  it at its last.
+    u32* const group_of = lin_jalloc(G_LIN_JALLOCATOR, sizeof(*group_of) * node_count);
+    if (!group_of)
+    {
+        RMOD_ERROR("Failed lin_jalloc(%p, %zu)", G_LIN_JALLOCATOR, sizeof(*group_of) * node_count);
+        res = RMOD_RESULT_NOMEM;
+        goto failed;
+    }
+    //  Block which each node of the surrogate graph stands for, or -1 if it is a node of the original graph
+    u32* const block_of = lin_jalloc(G_LIN_JALLOCATOR, sizeof(*block_of) * node_count);
+    if (!block_of)
+    {
+        RMOD_ERROR("Failed lin_jalloc(%p, %zu)", G_LIN_JALLOCATOR, sizeof(*block_of) * node_count);
+        res = RMOD_RESULT_NOMEM;
+        goto failed;
+    }
+    this.member_list = jalloc(sizeof(*this.member_list) * node_count);
+    if (!this.member_list)
+    {
+        RMOD_ERROR("Failed jalloc(%zu)", sizeof(*this.member_list) * node_count);
+        res = RMOD_RESULT_NOMEM;
+        goto failed;
+    }
+    this.member_types = jalloc(sizeof(*this.member_types) * node_count);
+    if (!this.member_types)
+    {
+        RMOD_ERROR("Failed jalloc(%zu)", sizeof(*this.member_types) * node_count);
+        res = RMOD_RESULT_NOMEM;
+        goto failed;
+    }
+    u32 covered = 0;
+    for (u32 i = 0; i < report.block_count; ++i)
+    {
+        covered += report.blocks[i].last - report.blocks[i].first;
+    }
+    const u32 surrogate_count = node_count - covered;
+    this.member_offsets = jalloc(sizeof(*this.member_offsets) * (surrogate_count + 1));
+    if (!this.member_offsets)
+    {
+        RMOD_ERROR("Failed jalloc(%zu)", sizeof(*this.member_offsets) * (surrogate_count + 1));
+        res = RMOD_RESULT_NOMEM;
+        goto failed;
+    }
+    {
+        u32 group = 0, block = 0;
+        for (u32 i = 0; i < node_count; ++i)
+        {
+            this.member_types[i] = graph->node_list[i].type_id;
+            this.member_list[i] = i;
+            if (block < report.block_count && report.blocks[block].first <= i)
+            {
+                if (report.blocks[block].first == i)
+                {
+                    this.member_offsets[group] = i;
+                    block_of[group++] = block;
+                }
+                group_of[i] = group - 1;
+                if (report.blocks[block].last == i)
+                {
+                    block += 1;
+                }
+                continue;
+            }
+            this.member_offsets[group] = i;
+            block_of[group] = -1;
+            group_of[i] = group++;
+        }
+        assert(group == surrogate_count);
+        this.member_offsets[group] = node_count;
+    }
+
+    //  Types of the original graph are kept for the members, with a new type added for each distinct sub-chain
+    this.type_list = jalloc(sizeof(*this.type_list) * (graph->type_count + report.characterized_count));
+    if (!this.type_list)
+    {
+        RMOD_ERROR("Failed jalloc(%zu)", sizeof(*this.type_list) * (graph->type_count + report.characterized_count));
+        res = RMOD_RESULT_NOMEM;
+        goto failed;
+    }
+    for (u32 i = 0; i < graph->type_count; ++i)
+    {
+        this.type_list[i] = graph->type_list[i];
+        if (!(this.type_list[i].name = copy_type_name(graph->type_list[i].name)))
+        {
+            res = RMOD_RESULT_NOMEM;
+            goto failed;
+        }
+        this.type_count += 1;
+    }
+    //  Type of each prototype block
+    u32* const block_type = lin_jalloc(G_LIN_JALLOCATOR, sizeof(*block_type) * (report.block_count + 1));
+    if (!block_type)
+    {
+        RMOD_ERROR("Failed lin_jalloc(%p, %zu)", G_LIN_JALLOCATOR, sizeof(*block_type) * (report.block_count + 1));
+        res = RMOD_RESULT_NOMEM;
+        goto failed;
+    }
+    for (u32 i = 0; i < report.block_count; ++i)
+    {
+        const rmod_surrogate_block* const block = report.blocks + i;
+        if (block->prototype != i)
+        {
+            block_type[i] = block_type[block->prototype];
+            continue;
+        }
+        //  Repair time and cost are averages weighted by how often each member fails, but only those of the failed
+        //  member are used by the simulation
+        rmod_graph_node_type surrogate =
+                {
+                .failure_rate = (f32)block->failure_rate,
+                .repair_time = 0.0f,
+                .effect = (f32)block->effect,
+                .cost = 0.0f,
+                .failure_type = RMOD_FAILURE_TYPE_NONE,
+                };
+        f32 total_rate = 0.0f;
+        for (u32 j = block->first; j <= block->last; ++j)
+        {
+            const rmod_graph_node_type* const type = graph->type_list + graph->node_list[j].type_id;
+            total_rate += type->failure_rate;
+            surrogate.repair_time += type->failure_rate * type->repair_time;
+            surrogate.cost += type->failure_rate * type->cost;
+            if (type->failure_type > surrogate.failure_type)
+            {
+                surrogate.failure_type = type->failure_type;
+            }
+        }
+        if (total_rate > 0.0f)
+        {
+            surrogate.repair_time /= total_rate;
+            surrogate.cost /= total_rate;
+        }
+        const string_segment* const label = &elements[block->first].label;
+        const u32 prefix_len = instance_prefix_length(label);
+        const int len_name = snprintf(NULL, 0, "%.*s::*", (int)prefix_len, label->begin);
+        surrogate.name = jalloc(len_name + 1);
+        if (!surrogate.name)
+        {
+            RMOD_ERROR("Failed jalloc(%zu)", (size_t)len_name + 1);
+            res = RMOD_RESULT_NOMEM;
+            goto failed;
+        }
+        snprintf((char*)surrogate.name, len_name + 1, "%.*s::*", (int)prefix_len, label->begin);
+        block_type[i] = this.type_count;
+        this.type_list[this.type_count++] = surrogate;
+    }
+
+    this.node_list = jalloc(sizeof(*this.node_list) * surrogate_count);
+    if (!this.node_list)
+    {
+        RMOD_ERROR("Failed jalloc(%zu)", sizeof(*this.node_list) * surrogate_count);
+        res = RMOD_RESULT_NOMEM;
+        goto failed;
+    }
+    memset(this.node_list, 0, sizeof(*this.node_list) * surrogate_count);
+    this.node_count = surrogate_count;
+    for (u32 i = 0; i < this.node_count; ++i)
+    {
+        rmod_graph_node* const node = this.node_list + i;
+        const rmod_graph_node* const first_node = graph->node_list + this.member_offsets[i];
+        const rmod_graph_node* const last_node = graph->node_list + this.member_offsets[i + 1] - 1;
+        node->type_id = block_of[i] != (u32)-1 ? block_type[block_of[i]] : first_node->type_id;
+
+        //  Edges into the instance go to its first member and out of it from its last member
+        if (first_node->parent_count)
+        {
+            node->parents = jalloc(sizeof(*node->parents) * first_node->parent_count);
+            if (!node->parents)
+            {
+                RMOD_ERROR("Failed jalloc(%zu)", sizeof(*node->parents) * first_node->parent_count);
+                res = RMOD_RESULT_NOMEM;
+                goto failed;
+            }
+            for (u32 j = 0; j < first_node->parent_count; ++j)
+            {
+                node->parents[j] = group_of[first_node->parents[j]];
+                assert(node->parents[j] < i);
+            }
+            node->parent_count = first_node->parent_count;
+        }
+        if (last_node->child_count)
+        {
+            node->children = jalloc(sizeof(*node->children) * last_node->child_count);
+            if (!node->children)
+            {
+                RMOD_ERROR("Failed jalloc(%zu)", sizeof(*node->children) * last_node->child_count);
+                res = RMOD_RESULT_NOMEM;
+                goto failed;
+            }
+            for (u32 j = 0; j < last_node->child_count; ++j)
+            {
+                node->children[j] = group_of[last_node->children[j]];
+                assert(node->children[j] > i);
+            }
+            node->child_count = last_node->child_count;
+        }
+    }
+
+    if (!(this.module_name = copy_type_name(graph->module_name)) || !(this.graph_type = copy_type_name(graph->graph_type)))
+    {
+        res = RMOD_RESULT_NOMEM;
+        goto failed;
+    }
+    lin_jalloc_set_current(G_LIN_JALLOCATOR, base);
+
+    //  Error of the approximation as a whole
+    rmod_exact_result flat = {0}, surrogate = {0};
+    if ((res = rmod_exact_analysis(graph, interval, &flat)) != RMOD_RESULT_SUCCESS
+        || (res = rmod_exact_analysis(&this, interval, &surrogate)) != RMOD_RESULT_SUCCESS)
+    {
+        RMOD_WARN("Could not perform exact analysis to estimate error of surrogate graph, reason: %s", rmod_result_str(res));
+    }
+    else
+    {
+        report.has_exact = true;
+        report.flat_mean_flow = flat.mean_flow;
+        report.flat_max_flow = flat.max_flow;
+        report.surrogate_mean_flow = surrogate.mean_flow;
+        report.surrogate_max_flow = surrogate.max_flow;
+    }
+    rmod_exact_result_release(&flat);
+    rmod_exact_result_release(&surrogate);
+
+#ifndef _WIN32
+    struct timespec t_end;
+    time_res = clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &t_end);
+    assert(time_res >= 0);
+    report.duration = (f32)(t_end.tv_sec - t_begin.tv_sec) + (f32)((f64)(t_end.tv_nsec - t_begin.tv_nsec) / 1e9);
+#else
+    LARGE_INTEGER t_end, freq;
+    QueryPerformanceCounter(&t_end);
+    QueryPerformanceFrequency(&freq);
+    report.duration = (f32)((f64)(t_end.QuadPart - t_begin.QuadPart) / (f64)freq.QuadPart);
+#endif
+
+    *p_report = report;
+    *p_out = this;
+    RMOD_LEAVE_FUNCTION;
+    return RMOD_RESULT_SUCCESS;
+
+failed:
+    rmod_surrogate_report_release(&report);
+    rmod_destroy_graph(&this);
+    lin_jalloc_set_current(G_LIN_JALLOCATOR, base);
+    RMOD_LEAVE_FUNCTION;
+    return res;
+}
+
+void rmod_surrogate_report_release(rmod_surrogate_report* report)
+{
+    jfree(report->blocks);
+    report->blocks = NULL;
+    report->block_count = 0;
+}
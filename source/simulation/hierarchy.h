@@ -0,0 +1,53 @@
+//
+// Created by jan on 19.10.2026.
+//
+
+#ifndef RMOD_HIERARCHY_H
+#define RMOD_HIERARCHY_H
+#include "../common/rmod.h"
+#include "compile.h"
+
+//  Sub-chain instance which was replaced by a surrogate node
+typedef struct rmod_surrogate_block_struct rmod_surrogate_block;
+struct rmod_surrogate_block_struct
+{
+    u32 first;                          //  First node of the original graph which the instance consists of
+    u32 last;                           //  Last node of the original graph which the instance consists of
+    u32 prototype;                      //  Index of the block which was characterized, equal to own index if this one was
+    f64 mttf;                           //  Mean time until flow through the sub-chain stops, when nothing is repaired
+    f64 failure_rate;                   //  Fitted failure rate of the surrogate
+    f64 effect;                         //  Ratio of flow out of and into the sub-chain when everything works
+    f64 max_error;                      //  Largest difference between its reliability and that of the surrogate
+    bool degradable;                    //  Sub-chain can lose part of its flow, which the surrogate can not
+};
+
+typedef struct rmod_surrogate_report_struct rmod_surrogate_report;
+struct rmod_surrogate_report_struct
+{
+    f32 duration;                       //  Processor time used to build the surrogate graph
+    u32 block_count;
+    u32 characterized_count;            //  Number of distinct sub-chains which had to be characterized
+    rmod_surrogate_block* blocks;
+
+    //  Error of the approximation, found by exact analysis of both graphs
+    bool has_exact;
+    f64 interval;
+    f64 flat_mean_flow;
+    f64 surrogate_mean_flow;
+    f64 flat_max_flow;
+    f64 surrogate_max_flow;
+};
+
+//  Replaces each instance of a sub-chain, which was inlined into the graph when it was compiled, with a single surrogate
+//  node, provided that flow only enters the instance through its first node and leaves it through its last. Each
+//  distinct sub-chain is characterized once, by finding its reliability from its structure function, and each of its
+//  instances then shares the same surrogate type. Its failure rate is fitted so that mean time to failure matches that
+//  of the sub-chain and its effect is the gain of the sub-chain when everything works. Which member failed is chosen
+//  with probability proportional to its failure rate, so results are still attributed to nodes of the original graph.
+//  Error introduced by the approximation is measured by comparing exact mean flow over the interval of both graphs.
+rmod_result rmod_build_surrogate_graph(
+        const rmod_graph* graph, f64 interval, rmod_surrogate_report* p_report, rmod_graph* p_out);
+
+void rmod_surrogate_report_release(rmod_surrogate_report* report);
+
+#endif //RMOD_HIERARCHY_H
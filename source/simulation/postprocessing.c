@@ -6,7 +6,49 @@
 #include <time.h>
 #include <inttypes.h>
 
-#define sstream_print(stream, fmt, ...) if (string_stream_add(sstream, fmt __VA_OPT__(,) __VA_ARGS__) == -1) {RMOD_ERROR("Failed message to string stream"); res = RMOD_RESULT_NOMEM; goto failed;} (void)0
+#define sstream_print(stream, fmt, ...) if (string_stream_add(sstream, fmt __VA_OPT__(,) __VA_ARGS__) == (size_t)-1) {RMOD_ERROR("Failed message to string stream"); res = RMOD_RESULT_NOMEM; goto failed;} (void)0
+
+static rmod_result print_distribution(string_stream* sstream, const char* name, const rmod_sim_distribution* distribution)
+{
+    rmod_result res;
+    sstream_print(sstream, "\t\t%s:", name);
+    for (u32 i = 0; i < RMOD_SIM_PERCENTILE_COUNT; ++i)
+    {
+        sstream_print(sstream, " P%g = %g%s", RMOD_SIM_PERCENTILES[i], distribution->percentiles[i], i + 1 < RMOD_SIM_PERCENTILE_COUNT ? "," : "");
+    }
+    sstream_print(sstream, " (range from %g to %g)\n", distribution->min, distribution->max);
+    return RMOD_RESULT_SUCCESS;
+failed:
+    return res;
+}
+
+//  Percentiles are found from histograms of 2048 equal buckets over the observed range, so they are accurate to 1/512 of it
+static rmod_result print_distributions(string_stream* sstream, const rmod_sim_result* results)
+{
+    rmod_result res;
+    if (!results->flow_distribution.count)
+    {
+        return RMOD_RESULT_SUCCESS;
+    }
+    sstream_print(sstream, "\n\tDistribution over replications:\n");
+    if ((res = print_distribution(sstream, "Mean flow", &results->flow_distribution)) != RMOD_RESULT_SUCCESS
+        || (res = print_distribution(sstream, "Maintenance visits", &results->visits_distribution)) != RMOD_RESULT_SUCCESS
+        || (res = print_distribution(sstream, "Costs", &results->cost_distribution)) != RMOD_RESULT_SUCCESS)
+    {
+        return res;
+    }
+    if (!results->fatal_time_distribution.count)
+    {
+        sstream_print(sstream, "\t\tNo replication had a fatal failure\n");
+        return RMOD_RESULT_SUCCESS;
+    }
+    sstream_print(sstream, "\t\tFatal failure happened in %"PRIu64" of %"PRIu64" replications (%.2f%%)\n",
+                  (uint64_t)results->fatal_time_distribution.count, (uint64_t)results->sim_count,
+                  100.0 * (f64)results->fatal_time_distribution.count / (f64)results->sim_count);
+    return print_distribution(sstream, "Time of fatal failure", &results->fatal_time_distribution);
+failed:
+    return res;
+}
 
 rmod_result rmod_postprocess_results(
         const rmod_sim_result* results, f64 sim_duration, f64 repair_limit, const rmod_graph* graph, u32 thread_count,
@@ -32,7 +74,7 @@ rmod_result rmod_postprocess_results(
     strftime(intermediate_buffer, 4096, "%x at %T", &now);
     sstream_print(sstream, "Results of simulation on %s:\n\tCalled with arguments:\n", intermediate_buffer);
     lin_jfree(G_LIN_JALLOCATOR, intermediate_buffer);
-    for (u32 i = 0; i < argc; ++i)
+    for (u32 i = 0; i < (u32)argc; ++i)
     {
         sstream_print(sstream, "\t\t[%u] - \"%s\"\n", i, argv[i]);
     }
@@ -61,6 +103,22 @@ rmod_result rmod_postprocess_results(
                            ((f64)total_allocated) / (1 << 10), ((f64)total_allocated) / (1 << 20),
                            ((f64)max_usage) / (1 << 10), ((f64)max_usage) / (1 << 20),
                   max_usage);
+    if (results->qmc_randomizations)
+    {
+        //  Errors are only meaningful for quasi-random replications, which are not independent of one another
+        sstream_print(sstream, "\n\tQuasi-random estimates (95%% confidence from %u randomizations):\n"
+                               "\t\tMean flow: %g +/- %g\n"
+                               "\t\tMean maintenance visits: %f +/- %f\n"
+                               "\t\tMean costs: %g +/- %g\n",
+                               results->qmc_randomizations,
+                               mean_flow, results->qmc_flow_error,
+                               (f64)results->total_maintenance_visits / results->sim_count, results->qmc_visits_error,
+                               results->total_costs / (f64)results->sim_count, results->qmc_cost_error);
+    }
+    if ((res = print_distributions(sstream, results)) != RMOD_RESULT_SUCCESS)
+    {
+        goto failed;
+    }
     sstream_print(sstream, "\n\tInput parameter overview:\n"
                            "\t\tSimulation duration: %g\n"
                            "\t\tSimulation repetitions: %"PRIu64"\n"
@@ -200,3 +258,644 @@ failed:
     RMOD_LEAVE_FUNCTION;
     return res;
 }
+
+rmod_result rmod_postprocess_exact_results(
+        const rmod_exact_result* exact, const rmod_sim_result* results, f64 sim_duration, const rmod_graph* graph,
+        string_stream* sstream)
+{
+    RMOD_ENTER_FUNCTION;
+    rmod_result res;
+    const rmod_chain* const chain = graph->parent;
+    sstream_print(sstream, "\n\tExact analysis (components repaired independently):\n"
+                           "\t\tProcessor time used: %f seconds\n"
+                           "\t\tDecision diagram size: %u nodes\n"
+                           "\t\tSteady state availability: %.6f\n"
+                           "\t\tAvailability at %g: %.6f\n"
+                           "\t\tMean availability over [0, %g]: %.6f\n"
+                           "\t\tMaximum flow: %g\n"
+                           "\t\tSteady state mean flow: %g (%.2f%% availability)\n"
+                           "\t\tMean flow over [0, %g]: %g (%.2f%% availability)\n",
+                  exact->duration,
+                  exact->bdd_size,
+                  exact->steady_availability,
+                  exact->interval, exact->point_availability,
+                  exact->interval, exact->mean_availability,
+                  exact->max_flow,
+                  exact->steady_flow, exact->max_flow != 0.0 ? exact->steady_flow / exact->max_flow * 100.0 : 0.0,
+                  exact->interval, exact->mean_flow, exact->max_flow != 0.0 ? exact->mean_flow / exact->max_flow * 100.0 : 0.0);
+
+    if (results && results->sim_count)
+    {
+        //  Simulation repairs everything at once once maintenance is needed, so the two will only agree when repairs
+        //  are rare compared to the simulated interval
+        const f64 sim_flow = results->total_flow / (sim_duration * (f64)results->sim_count);
+        const f64 sim_availability = results->max_flow != 0.0f ? sim_flow / results->max_flow : 0.0;
+        const f64 exact_availability = exact->max_flow != 0.0 ? exact->mean_flow / exact->max_flow : 0.0;
+        sstream_print(sstream, "\t\tComparison with simulation (not a validation, since simulation repairs failed components in maintenance visits, while here each is repaired independently):\n"
+                               "\t\t\tMaximum flow (simulated/exact): %g / %g\n"
+                               "\t\t\tMean flow (simulated/exact): %g / %g\n"
+                               "\t\t\tFlow availability (simulated/exact): %.4f%% / %.4f%%\n",
+                      (f64)results->max_flow, exact->max_flow,
+                      sim_flow, exact->mean_flow,
+                      sim_availability * 100.0, exact_availability * 100.0);
+    }
+
+    sstream_print(sstream, "\t\tComponent unavailability (steady state / at %g / mean over [0, %g]):\n", exact->interval, exact->interval);
+    for (u32 i = 0; i < exact->n_components; ++i)
+    {
+        const rmod_chain_element* const element = chain->chain_elements + i;
+        sstream_print(sstream, "\t\t\t\"%.*s\" (%s): %.6e / %.6e / %.6e\n",
+                      element->label.len, element->label.begin,
+                      graph->type_list[graph->node_list[i].type_id].name,
+                      exact->steady_unavailability[i], exact->point_unavailability[i], exact->mean_unavailability[i]);
+    }
+
+    if (exact->importance)
+    {
+        sstream_print(sstream, "\t\tComponent importance (relative to system unavailability of %.6e):\n"
+                               "\t\t\t%-32s %14s %14s %14s %14s\n",
+                      exact->importance_unavailability, "Component", "Birnbaum", "Fussell-Vesely", "RAW", "RRW");
+        for (u32 i = 0; i < exact->n_components; ++i)
+        {
+            const rmod_chain_element* const element = chain->chain_elements + i;
+            const rmod_importance* const importance = exact->importance + i;
+            sstream_print(sstream, "\t\t\t%-32.*s %14.6e %14.6e %14.6g %14.6g\n",
+                          element->label.len, element->label.begin,
+                          importance->birnbaum, importance->fussell_vesely, importance->risk_achievement, importance->risk_reduction);
+        }
+    }
+
+    RMOD_LEAVE_FUNCTION;
+    return RMOD_RESULT_SUCCESS;
+
+failed:
+    RMOD_LEAVE_FUNCTION;
+    return res;
+}
+
+rmod_result rmod_postprocess_cut_sets(
+        const rmod_cut_sets* cut_sets, const rmod_exact_result* exact, const rmod_graph* graph, string_stream* sstream)
+{
+    RMOD_ENTER_FUNCTION;
+    rmod_result res;
+    const rmod_chain* const chain = graph->parent;
+    //  Number of most likely cut sets which are listed
+#define TOP_CUT_SET_COUNT 20
+    //  Largest sum of probabilities of cut sets for which it is still reported as the rare event approximation
+#define RARE_EVENT_LIMIT 0.1
+    u32 order_counts[65] = {0};
+    u32 top[TOP_CUT_SET_COUNT];
+    f64 top_probability[TOP_CUT_SET_COUNT];
+    u32 top_count = 0;
+    f64 rare_event_unavailability = 0.0;
+    //  Product of probabilities that each cut set is not entirely down, which gives an upper bound on unavailability
+    f64 cut_sets_up = 1.0;
+    for (u32 i = 0; i < cut_sets->count; ++i)
+    {
+        order_counts[rmod_cut_set_order(cut_sets, i)] += 1;
+        if (!exact)
+        {
+            continue;
+        }
+        //  Probability of all components of the set being down at once
+        const u64* const set = cut_sets->sets + (u64)i * cut_sets->n_words;
+        f64 p = 1.0;
+        for (u32 j = 0; j < graph->node_count; ++j)
+        {
+            if (set[j / 64] & ((u64)1 << (j % 64)))
+            {
+                p *= exact->mean_unavailability[j];
+            }
+        }
+        rare_event_unavailability += p;
+        cut_sets_up *= 1.0 - p;
+        //  Insert into list of most likely ones
+        u32 pos = top_count < TOP_CUT_SET_COUNT ? top_count++ : TOP_CUT_SET_COUNT;
+        while (pos > 0 && top_probability[pos - 1] < p)
+        {
+            if (pos < TOP_CUT_SET_COUNT)
+            {
+                top[pos] = top[pos - 1];
+                top_probability[pos] = top_probability[pos - 1];
+            }
+            pos -= 1;
+        }
+        if (pos < TOP_CUT_SET_COUNT)
+        {
+            top[pos] = i;
+            top_probability[pos] = p;
+        }
+    }
+
+    sstream_print(sstream, "\n\tMinimal cut sets (up to order %u%s):\n"
+                           "\t\tProcessor time used: %f seconds\n"
+                           "\t\tTotal count: %u\n",
+                  cut_sets->max_order, cut_sets->truncated ? ", some were discarded" : "",
+                  cut_sets->duration,
+                  cut_sets->count);
+    for (u32 i = 1; i <= cut_sets->max_order; ++i)
+    {
+        if (order_counts[i])
+        {
+            sstream_print(sstream, "\t\tOrder %u: %u\n", i, order_counts[i]);
+        }
+    }
+    if (exact)
+    {
+        sstream_print(sstream, "\t\tMinimal cut set upper bound of mean unavailability: %.6e\n", 1.0 - cut_sets_up);
+        //  Sum of probabilities of cut sets is only close to unavailability when all of them are unlikely
+        if (rare_event_unavailability < RARE_EVENT_LIMIT)
+        {
+            sstream_print(sstream, "\t\tRare event approximation of mean unavailability: %.6e\n", rare_event_unavailability);
+        }
+        else
+        {
+            sstream_print(sstream, "\t\tRare event approximation of mean unavailability does not apply, since cut sets are not unlikely (sum of their probabilities is %.6e)\n", rare_event_unavailability);
+        }
+        sstream_print(sstream, "\t\tMost likely cut sets:\n");
+        for (u32 i = 0; i < top_count; ++i)
+        {
+            const u64* const set = cut_sets->sets + (u64)top[i] * cut_sets->n_words;
+            sstream_print(sstream, "\t\t\t%.6e: {", top_probability[i]);
+            bool first = true;
+            for (u32 j = 0; j < graph->node_count; ++j)
+            {
+                if (set[j / 64] & ((u64)1 << (j % 64)))
+                {
+                    const rmod_chain_element* const element = chain->chain_elements + j;
+                    sstream_print(sstream, "%s\"%.*s\"", first ? "" : ", ", element->label.len, element->label.begin);
+                    first = false;
+                }
+            }
+            sstream_print(sstream, "}\n");
+        }
+    }
+#undef RARE_EVENT_LIMIT
+#undef TOP_CUT_SET_COUNT
+
+    RMOD_LEAVE_FUNCTION;
+    return RMOD_RESULT_SUCCESS;
+
+failed:
+    RMOD_LEAVE_FUNCTION;
+    return res;
+}
+
+rmod_result rmod_postprocess_ctmc_results(
+        const rmod_ctmc_result* ctmc, const rmod_sim_result* results, f64 sim_duration, string_stream* sstream)
+{
+    RMOD_ENTER_FUNCTION;
+    rmod_result res;
+    sstream_print(sstream, "\n\tMarkov chain analysis (maintenance delay with %u Erlang phases, at most %u nodes down):\n"
+                           "\t\tProcessor time used: %f seconds\n"
+                           "\t\tStates: %u\n"
+                           "\t\tTransitions: %"PRIu64"\n"
+                           "\t\tUniformization steps: %"PRIu64"\n"
+                           "\t\tMaximum flow: %g\n"
+                           "\t\tFlow at %g: %g (%.2f%% availability)\n"
+                           "\t\tMean flow over [0, %g]: %g (%.2f%% availability)\n"
+                           "\t\tExpected maintenance visits: %f\n"
+                           "\t\tExpected costs: %f\n"
+                           "\t\tProbability of fatal failure: %.6e\n"
+                           "\t\tProbability of truncation: %.6e\n",
+                  ctmc->phase_count, ctmc->max_down,
+                  ctmc->duration,
+                  ctmc->state_count,
+                  (uint64_t)ctmc->transition_count,
+                  (uint64_t)ctmc->uniformization_steps,
+                  ctmc->max_flow,
+                  ctmc->interval, ctmc->point_flow, ctmc->max_flow != 0.0 ? ctmc->point_flow / ctmc->max_flow * 100.0 : 0.0,
+                  ctmc->interval, ctmc->mean_flow, ctmc->max_flow != 0.0 ? ctmc->mean_flow / ctmc->max_flow * 100.0 : 0.0,
+                  ctmc->expected_visits,
+                  ctmc->expected_cost,
+                  ctmc->fatal_probability,
+                  ctmc->truncated_probability);
+    if (isinf(ctmc->phase_change))
+    {
+        sstream_print(sstream, "\t\tNumber of phases was fixed, so results were not checked for convergence in it\n");
+    }
+    else
+    {
+        sstream_print(sstream, "\t\tResults changed by %.2e relative to their values when phases were doubled to %u (%s)\n",
+                      ctmc->phase_change, ctmc->phase_count, ctmc->phases_converged ? "converged" : "not converged, so results are off by the approximation of maintenance delay");
+    }
+    if (ctmc->has_steady_state)
+    {
+        sstream_print(sstream, "\t\tSteady state mean flow: %g (%.2f%% availability%s)\n"
+                               "\t\tSteady state maintenance visits per unit time: %.6e\n"
+                               "\t\tSteady state costs per unit time: %.6e\n",
+                      ctmc->steady_flow, ctmc->max_flow != 0.0 ? ctmc->steady_flow / ctmc->max_flow * 100.0 : 0.0,
+                      ctmc->steady_converged ? "" : ", not converged",
+                      ctmc->visit_rate,
+                      ctmc->cost_rate);
+    }
+    else
+    {
+        sstream_print(sstream, "\t\tNo steady state, since fatal failures or truncation absorb all probability\n");
+    }
+
+    if (results && results->sim_count)
+    {
+        const f64 sim_flow = results->total_flow / (sim_duration * (f64)results->sim_count);
+        const f64 sim_availability = results->max_flow != 0.0f ? sim_flow / results->max_flow : 0.0;
+        const f64 ctmc_availability = ctmc->max_flow != 0.0 ? ctmc->mean_flow / ctmc->max_flow : 0.0;
+        sstream_print(sstream, "\t\tComparison with simulation%s:\n"
+                               "\t\t\tFlow availability (simulated/Markov chain): %.4f%% / %.4f%% (difference of %+.4f%%)\n"
+                               "\t\t\tMaintenance visits (simulated/Markov chain): %f / %f\n"
+                               "\t\t\tCosts (simulated/Markov chain): %f / %f\n",
+                      ctmc->phases_converged ? "" : " (Markov chain results may still be off by the approximation of maintenance delay)",
+                      sim_availability * 100.0, ctmc_availability * 100.0, (sim_availability - ctmc_availability) * 100.0,
+                      (f64)results->total_maintenance_visits / (f64)results->sim_count, ctmc->expected_visits,
+                      (f64)results->total_costs / (f64)results->sim_count, ctmc->expected_cost);
+    }
+
+    RMOD_LEAVE_FUNCTION;
+    return RMOD_RESULT_SUCCESS;
+
+failed:
+    RMOD_LEAVE_FUNCTION;
+    return res;
+}
+
+rmod_result rmod_postprocess_surrogate_report(
+        const rmod_surrogate_report* report, const rmod_graph* graph, string_stream* sstream)
+{
+    RMOD_ENTER_FUNCTION;
+    rmod_result res;
+    sstream_print(sstream, "\n\tSurrogate sub-chains:\n"
+                           "\t\tProcessor time used: %f seconds\n"
+                           "\t\tSub-chains replaced: %u (%u distinct)\n",
+                  report->duration, report->block_count, report->characterized_count);
+    for (u32 i = 0; i < report->block_count; ++i)
+    {
+        const rmod_surrogate_block* const block = report->blocks + i;
+        if (block->prototype != i)
+        {
+            continue;
+        }
+        u32 instance_count = 0;
+        for (u32 j = i; j < report->block_count; ++j)
+        {
+            instance_count += report->blocks[j].prototype == i;
+        }
+        const string_segment* const label = &graph->parent->chain_elements[block->first].label;
+        u32 prefix_len = 0;
+        while (prefix_len + 1 < label->len && !(label->begin[prefix_len] == ':' && label->begin[prefix_len + 1] == ':'))
+        {
+            prefix_len += 1;
+        }
+        sstream_print(sstream, "\t\t%.*s (%u nodes, %u instances): MTTF %g, failure rate %g, effect %g, largest reliability error %.4e%s\n",
+                      (int)prefix_len, label->begin, block->last - block->first + 1, instance_count, block->mttf,
+                      block->failure_rate, block->effect, block->max_error,
+                      block->degradable ? ", partial loss of flow is not represented" : "");
+    }
+    if (report->has_exact)
+    {
+        const f64 flat_availability = report->flat_max_flow != 0.0 ? report->flat_mean_flow / report->flat_max_flow : 0.0;
+        const f64 surrogate_availability = report->surrogate_max_flow != 0.0 ? report->surrogate_mean_flow / report->surrogate_max_flow : 0.0;
+        sstream_print(sstream, "\t\tApproximation error (exact analysis with independent repairs over [0, %g]):\n"
+                               "\t\t\tMaximum flow (original/surrogate): %g / %g\n"
+                               "\t\t\tFlow availability (original/surrogate): %.4f%% / %.4f%% (difference of %+.4f%%)\n",
+                      report->interval,
+                      report->flat_max_flow, report->surrogate_max_flow,
+                      flat_availability * 100.0, surrogate_availability * 100.0, (surrogate_availability - flat_availability) * 100.0);
+    }
+    else
+    {
+        sstream_print(sstream, "\t\tApproximation error could not be estimated, since exact analysis failed\n");
+    }
+
+    RMOD_LEAVE_FUNCTION;
+    return RMOD_RESULT_SUCCESS;
+
+failed:
+    RMOD_LEAVE_FUNCTION;
+    return res;
+}
+
+rmod_result rmod_postprocess_sweep_results(
+        u32 point_count, const rmod_sweep_point* points, const rmod_sim_result* results,
+        const rmod_paired_difference* differences, const char* chain_name, string_stream* sstream)
+{
+    RMOD_ENTER_FUNCTION;
+    rmod_result res;
+    f64 total_duration = 0.0;
+    for (u32 i = 0; i < point_count; ++i)
+    {
+        total_duration += results[i].duration;
+    }
+    sstream_print(sstream, "\n\tParameter sweep of chain \"%s\":\n"
+                           "\t\tPoints: %u\n"
+                           "\t\tProcessor time used: %f seconds\n"
+                           "\t\t%6s %12s %12s %10s %8s %12s %14s %12s %12s %10s\n",
+                  chain_name, point_count, total_duration,
+                  "point", "sim_time", "repair_limit", "mtbf_scale", "reps", "mean flow", "availability %", "maintenance", "costs", "time [s]");
+    for (u32 i = 0; i < point_count; ++i)
+    {
+        const rmod_sweep_point* const point = points + i;
+        const rmod_sim_result* const result = results + i;
+        const f64 mean_flow = result->sim_count ? result->total_flow / ((f64)point->simulation_duration * (f64)result->sim_count) : 0.0;
+        sstream_print(sstream, "\t\t%6u %12g %12g %10g %8"PRIu64" %12g %14.4f %12g %12g %10.4f\n",
+                      i, point->simulation_duration, point->repair_limit, point->mtbf_scale, (uint64_t)result->sim_count,
+                      mean_flow, result->max_flow != 0.0f ? mean_flow / result->max_flow * 100.0 : 0.0,
+                      result->sim_count ? (f64)result->total_maintenance_visits / (f64)result->sim_count : 0.0,
+                      result->sim_count ? (f64)result->total_costs / (f64)result->sim_count : 0.0,
+                      result->duration);
+    }
+    if (differences && point_count > 1)
+    {
+        sstream_print(sstream, "\n\t\tDifferences from point 0 (common random numbers, 95%% confidence intervals):\n"
+                               "\t\t%6s %12s %12s %12s %12s %12s %12s %12s\n",
+                      "point", "mean flow", "+/-", "+/- indep.", "maintenance", "+/-", "costs", "+/-");
+        for (u32 i = 1; i < point_count; ++i)
+        {
+            const rmod_paired_difference* const d = differences + i;
+            sstream_print(sstream, "\t\t%6u %+12.5g %12.5g %12.5g %+12.5g %12.5g %+12.5g %12.5g\n",
+                          i, d->flow, d->flow_error, d->flow_error_independent, d->visits, d->visits_error, d->cost, d->cost_error);
+        }
+    }
+
+    RMOD_LEAVE_FUNCTION;
+    return RMOD_RESULT_SUCCESS;
+
+failed:
+    RMOD_LEAVE_FUNCTION;
+    return res;
+}
+
+rmod_result rmod_postprocess_sensitivity(const rmod_sim_result* results, const rmod_graph* graph, string_stream* sstream)
+{
+    RMOD_ENTER_FUNCTION;
+    rmod_result res;
+    sstream_print(sstream, "\n\tSensitivity to failure rates (likelihood ratio estimates from %"PRIu64" replications, 95%% confidence):\n",
+                  (uint64_t)results->sim_count);
+    const u32 type_count = results->n_types < graph->type_count ? results->n_types : (u32)graph->type_count;
+    for (u32 i = 0; i < type_count; ++i)
+    {
+        u32 node_count = 0;
+        for (u32 j = 0; j < graph->node_count; ++j)
+        {
+            node_count += graph->node_list[j].type_id == i;
+        }
+        if (!node_count)
+        {
+            continue;
+        }
+        const rmod_graph_node_type* const type = graph->type_list + i;
+        const rmod_sim_sensitivity* const sensitivity = results->sensitivity_per_type + i;
+        const f64 rate = type->failure_rate;
+        //  Mean time between failures is the inverse of the failure rate, so d/d(MTBF) = -rate^2 d/d(rate)
+        const f64 availability = results->max_flow != 0.0f ? sensitivity->flow / results->max_flow : 0.0;
+        sstream_print(sstream, "\t\tType \"%s\" (%u components, failure rate %g):\n"
+                               "\t\t\tDerivative of mean flow: %g +/- %g\n"
+                               "\t\t\tDerivative of costs: %g +/- %g\n"
+                               "\t\t\tDerivative of availability with respect to MTBF: %.4e %% per unit of time\n",
+                      type->name, node_count, rate,
+                      sensitivity->flow, sensitivity->flow_error,
+                      sensitivity->cost, sensitivity->cost_error,
+                      -rate * rate * availability * 100.0);
+    }
+
+    RMOD_LEAVE_FUNCTION;
+    return RMOD_RESULT_SUCCESS;
+
+failed:
+    RMOD_LEAVE_FUNCTION;
+    return res;
+}
+
+rmod_result rmod_postprocess_what_if(
+        u32 point_count, const rmod_sweep_point* points, const rmod_sim_result* results,
+        const rmod_paired_difference* differences, const rmod_graph* graph, string_stream* sstream)
+{
+    RMOD_ENTER_FUNCTION;
+    rmod_result res;
+    void* const base = lin_jalloc_get_current(G_LIN_JALLOCATOR);
+    const rmod_chain* const chain = graph->parent;
+    u32* const ranked = lin_jalloc(G_LIN_JALLOCATOR, sizeof(*ranked) * point_count);
+    if (!ranked)
+    {
+        RMOD_ERROR("Failed lin_jalloc(%p, %zu)", G_LIN_JALLOCATOR, sizeof(*ranked) * point_count);
+        res = RMOD_RESULT_NOMEM;
+        goto failed;
+    }
+    f64 total_duration = 0.0;
+    for (u32 i = 0; i < point_count; ++i)
+    {
+        total_duration += results[i].duration;
+    }
+    //  Availability is relative to the maximum flow of the unchanged graph, since removal may lower it
+    const f64 max_flow = results[0].max_flow;
+    const f64 base_flow = results[0].sim_count ? results[0].total_flow / ((f64)points[0].simulation_duration * (f64)results[0].sim_count) : 0.0;
+    sstream_print(sstream, "\n\tWhat-if study of single components (common random numbers, 95%% confidence intervals):\n"
+                           "\t\tVariants: %u\n"
+                           "\t\tProcessor time used: %f seconds\n"
+                           "\t\tAvailability of unchanged graph: %.4f%%\n",
+                  point_count - 1, total_duration, max_flow != 0.0 ? base_flow / max_flow * 100.0 : 0.0);
+
+    static const char* const titles[] =
+            {
+            [RMOD_SWEEP_CHANGE_PERFECT] = "Components made perfect, by gain of availability",
+            [RMOD_SWEEP_CHANGE_REMOVED] = "Components removed, by loss of availability",
+            };
+    for (rmod_sweep_change change = RMOD_SWEEP_CHANGE_PERFECT; change <= RMOD_SWEEP_CHANGE_REMOVED; ++change)
+    {
+        //  Insert variants into the ranking, largest change of flow first
+        u32 count = 0;
+        for (u32 i = 1; i < point_count; ++i)
+        {
+            if (points[i].change != change)
+            {
+                continue;
+            }
+            u32 pos = count++;
+            while (pos > 0 && fabs(differences[ranked[pos - 1]].flow) < fabs(differences[i].flow))
+            {
+                ranked[pos] = ranked[pos - 1];
+                pos -= 1;
+            }
+            ranked[pos] = i;
+        }
+        if (!count)
+        {
+            continue;
+        }
+        sstream_print(sstream, "\n\t\t%s:\n"
+                               "\t\t%6s %-32s %14s %12s %12s %12s %12s\n",
+                      titles[change], "rank", "component", "availability %", "+/-", "maintenance", "costs", "+/-");
+        for (u32 i = 0; i < count; ++i)
+        {
+            const rmod_sweep_point* const point = points + ranked[i];
+            const rmod_paired_difference* const d = differences + ranked[i];
+            const rmod_chain_element* const element = chain->chain_elements + point->component;
+            const bool below_limit = results[ranked[i]].max_flow < point->repair_limit;
+            sstream_print(sstream, "\t\t%6u %-32.*s %+14.4f %12.4f %+12.5g %+12.5g %12.5g%s\n",
+                          i + 1, element->label.len, element->label.begin,
+                          max_flow != 0.0 ? d->flow / max_flow * 100.0 : 0.0,
+                          max_flow != 0.0 ? d->flow_error / max_flow * 100.0 : 0.0,
+                          d->visits, d->cost, d->cost_error,
+                          below_limit ? " (below repair limit)" : "");
+        }
+    }
+
+    lin_jalloc_set_current(G_LIN_JALLOCATOR, base);
+    RMOD_LEAVE_FUNCTION;
+    return RMOD_RESULT_SUCCESS;
+
+failed:
+    lin_jalloc_set_current(G_LIN_JALLOCATOR, base);
+    RMOD_LEAVE_FUNCTION;
+    return res;
+}
+
+static rmod_result print_uncertainty_band(string_stream* sstream, const char* name, const rmod_uncertainty_band* band, const f64 scale)
+{
+    rmod_result res;
+    sstream_print(sstream, "\t\t%-16s %12.6g", name, band->mean * scale);
+    for (u32 i = 0; i < RMOD_UNCERTAINTY_PERCENTILE_COUNT; ++i)
+    {
+        sstream_print(sstream, " %12.6g", band->percentiles[i] * scale);
+    }
+    sstream_print(sstream, "\n");
+    return RMOD_RESULT_SUCCESS;
+failed:
+    return res;
+}
+
+rmod_result rmod_postprocess_uncertainty(
+        const rmod_uncertainty_result* uncertainty, const rmod_graph* graph, string_stream* sstream)
+{
+    RMOD_ENTER_FUNCTION;
+    rmod_result res;
+    sstream_print(sstream, "\n\tUncertainty of parameters (Latin hypercube):\n"
+                           "\t\tProcessor time used: %f seconds\n"
+                           "\t\tSamples: %u\n"
+                           "\t\tReplications per sample: %"PRIu64"\n"
+                           "\t\tUncertain parameters: %u\n",
+                  uncertainty->duration,
+                  uncertainty->sample_count,
+                  (uint64_t)uncertainty->replication_count,
+                  uncertainty->parameter_count);
+    for (u32 i = 0; i < graph->type_count; ++i)
+    {
+        const rmod_graph_node_type* const type = graph->type_list + i;
+        for (rmod_block_parameter j = 0; j < RMOD_BLOCK_PARAMETER_COUNT; ++j)
+        {
+            const rmod_parameter_distribution* const distribution = type->uncertainty + j;
+            if (distribution->type != RMOD_DISTRIBUTION_NONE)
+            {
+                sstream_print(sstream, "\t\t\t\"%s\" %s: %s on [%g, %g]\n", type->name, rmod_block_parameter_to_str(j),
+                              rmod_distribution_type_to_str(distribution->type), distribution->min, distribution->max);
+            }
+        }
+    }
+    sstream_print(sstream, "\t\t%-16s %12s", "result", "mean");
+    for (u32 i = 0; i < RMOD_UNCERTAINTY_PERCENTILE_COUNT; ++i)
+    {
+        sstream_print(sstream, "  %10g%%", RMOD_UNCERTAINTY_PERCENTILES[i]);
+    }
+    sstream_print(sstream, "\n");
+    if ((res = print_uncertainty_band(sstream, "availability %", &uncertainty->availability, 100.0)) != RMOD_RESULT_SUCCESS
+        || (res = print_uncertainty_band(sstream, "maintenance", &uncertainty->visits, 1.0)) != RMOD_RESULT_SUCCESS
+        || (res = print_uncertainty_band(sstream, "costs", &uncertainty->cost, 1.0)) != RMOD_RESULT_SUCCESS)
+    {
+        goto failed;
+    }
+
+    RMOD_LEAVE_FUNCTION;
+    return RMOD_RESULT_SUCCESS;
+
+failed:
+    RMOD_LEAVE_FUNCTION;
+    return res;
+}
+
+rmod_result rmod_postprocess_profile(const rmod_sim_result* results, f64 sim_duration, string_stream* sstream)
+{
+    RMOD_ENTER_FUNCTION;
+    rmod_result res;
+    const u32 bin_count = results->profile_bin_count;
+    const f64 width = sim_duration / (f64)bin_count;
+    const f64 max_flow = results->max_flow;
+    sstream_print(sstream, "\n\tFlow over time (%u bins of width %g):\n"
+                           "\t\t%-12s %-12s %-12s %-14s %-14s %-14s\n",
+                  bin_count, width, "From", "To", "Mean flow", "Availability", "Cumulative flow", "Cumulative availability");
+    f64 cumulative = 0.0;
+    u64 fatal_count = 0;
+    for (u32 i = 0; i < bin_count; ++i)
+    {
+        const f64 flow = results->profile[i].flow;
+        cumulative += flow;
+        fatal_count += results->profile[i].fatal_count;
+        const f64 cumulative_flow = cumulative / (f64)(i + 1);
+        sstream_print(sstream, "\t\t%-12g %-12g %-12g %-14.4f %-14g %-14.4f\n",
+                      width * (f64)i, width * (f64)(i + 1), flow,
+                      max_flow != 0.0 ? flow / max_flow * 100.0 : 0.0, cumulative_flow,
+                      max_flow != 0.0 ? cumulative_flow / max_flow * 100.0 : 0.0);
+    }
+
+    if (!fatal_count)
+    {
+        sstream_print(sstream, "\n\tReliability over time: no replication had a fatal failure, so R(%g) is at least %g (95%% confidence)\n",
+                      sim_duration, results->profile[bin_count - 1].reliability_lower);
+        RMOD_LEAVE_FUNCTION;
+        return RMOD_RESULT_SUCCESS;
+    }
+    sstream_print(sstream, "\n\tReliability over time (probability of no fatal failure until the end of each bin, 95%% confidence):\n"
+                           "\t\t%-12s %-14s %-12s %-12s %-12s\n",
+                  "Until", "Fatal failures", "R(t)", "Lower bound", "Upper bound");
+    for (u32 i = 0; i < bin_count; ++i)
+    {
+        const rmod_sim_profile_bin* const bin = results->profile + i;
+        sstream_print(sstream, "\t\t%-12g %-14"PRIu64" %-12.6f %-12.6f %-12.6f\n",
+                      width * (f64)(i + 1), (uint64_t)bin->fatal_count, bin->reliability, bin->reliability_lower, bin->reliability_upper);
+    }
+
+    RMOD_LEAVE_FUNCTION;
+    return RMOD_RESULT_SUCCESS;
+
+failed:
+    RMOD_LEAVE_FUNCTION;
+    return res;
+}
+
+rmod_result rmod_postprocess_horizons(
+        const rmod_sim_result* results, f64 sim_duration, const rmod_graph* graph, string_stream* sstream)
+{
+    RMOD_ENTER_FUNCTION;
+    rmod_result res;
+    const rmod_chain* const chain = graph->parent;
+    sstream_print(sstream, "\n\tResults at horizons (from the same %"PRIu64" replications):\n", (uint64_t)results->sim_count);
+    for (u32 i = 0; i <= results->horizon_count; ++i)
+    {
+        //  Last one is the end of the simulation
+        const bool is_end = i == results->horizon_count;
+        const f64 time = is_end ? sim_duration : results->horizons[i].time;
+        const f64 n = (f64)results->sim_count;
+        const f64 mean_flow = (is_end ? results->total_flow : results->horizons[i].total_flow) / (time * n);
+        const u64 visits = is_end ? results->total_maintenance_visits : results->horizons[i].total_maintenance_visits;
+        const f64 costs = is_end ? results->total_costs : results->horizons[i].total_costs;
+        const u64* const failures = is_end ? results->failures_per_component : results->horizons[i].failures_per_component;
+        const f64* const downtime = is_end ? results->downtime_per_component : results->horizons[i].downtime_per_component;
+        sstream_print(sstream, "\t\tHorizon %g:\n"
+                               "\t\t\tMean flow: %g (%.2f%% availability)\n"
+                               "\t\t\tMean maintenance visits: %f\n"
+                               "\t\t\tMean costs: %g\n"
+                               "\t\t\tAverage times failed and downtime of components:\n",
+                      time, mean_flow, results->max_flow != 0.0f ? mean_flow / results->max_flow * 100.0 : 0.0,
+                      (f64)visits / n, costs / n);
+        for (u32 j = 0; j < chain->element_count && j < results->n_components; ++j)
+        {
+            const rmod_chain_element* const element = chain->chain_elements + j;
+            sstream_print(sstream, "\t\t\t\t\"%.*s\": %f, %f\n",
+                          element->label.len, element->label.begin, (f64)failures[j] / n, downtime[j] / n);
+        }
+    }
+
+    RMOD_LEAVE_FUNCTION;
+    return RMOD_RESULT_SUCCESS;
+
+failed:
+    RMOD_LEAVE_FUNCTION;
+    return res;
+}
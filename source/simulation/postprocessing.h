@@ -9,9 +9,49 @@
 #include "../fmt/sstream.h"
 #include "compile.h"
 #include "program.h"
+#include "../analysis/exact.h"
+#include "../analysis/cut_sets.h"
+#include "../analysis/ctmc.h"
+#include "hierarchy.h"
+#include "uncertainty.h"
 
 rmod_result rmod_postprocess_results(
         const rmod_sim_result* results, f64 sim_duration, f64 repair_limit, const rmod_graph* graph, u32 thread_count,
         const rmod_program* program, int argc, const char* argv[], string_stream* sstream);
 
+rmod_result rmod_postprocess_exact_results(
+        const rmod_exact_result* exact, const rmod_sim_result* results, f64 sim_duration, const rmod_graph* graph,
+        string_stream* sstream);
+
+rmod_result rmod_postprocess_cut_sets(
+        const rmod_cut_sets* cut_sets, const rmod_exact_result* exact, const rmod_graph* graph, string_stream* sstream);
+
+rmod_result rmod_postprocess_ctmc_results(
+        const rmod_ctmc_result* ctmc, const rmod_sim_result* results, f64 sim_duration, string_stream* sstream);
+
+rmod_result rmod_postprocess_surrogate_report(
+        const rmod_surrogate_report* report, const rmod_graph* graph, string_stream* sstream);
+
+rmod_result rmod_postprocess_sweep_results(
+        u32 point_count, const rmod_sweep_point* points, const rmod_sim_result* results,
+        const rmod_paired_difference* differences, const char* chain_name, string_stream* sstream);
+
+rmod_result rmod_postprocess_sensitivity(const rmod_sim_result* results, const rmod_graph* graph, string_stream* sstream);
+
+//  Ranks variants of the sweep made by changing a single component by the change of mean flow from the first point
+rmod_result rmod_postprocess_what_if(
+        u32 point_count, const rmod_sweep_point* points, const rmod_sim_result* results,
+        const rmod_paired_difference* differences, const rmod_graph* graph, string_stream* sstream);
+
+rmod_result rmod_postprocess_uncertainty(
+        const rmod_uncertainty_result* uncertainty, const rmod_graph* graph, string_stream* sstream);
+
+//  Prints results up to each horizon, followed by those of the whole simulation for comparison
+rmod_result rmod_postprocess_horizons(
+        const rmod_sim_result* results, f64 sim_duration, const rmod_graph* graph, string_stream* sstream);
+
+//  Prints mean flow and availability in each bin of simulation time, along with their means from the start until its end,
+//  followed by reliability at the end of each bin
+rmod_result rmod_postprocess_profile(const rmod_sim_result* results, f64 sim_duration, string_stream* sstream);
+
 #endif //RMOD_POSTPROCESSING_H
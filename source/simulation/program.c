@@ -2,200 +2,158 @@
 // Created by jan on 31.5.2023.
 //
 
-#include <unistd.h>
-#include <libgen.h>
+#include <inttypes.h>
 #include "program.h"
 #include "../parsing/parsing_base.h"
 
-rmod_result rmod_program_create(const char* file_name, rmod_program* p_program)
+rmod_result rmod_program_create(const char* file_name, u32 thread_count, rmod_program* p_program)
 {
     RMOD_ENTER_FUNCTION;
-    rmod_result res = RMOD_RESULT_SUCCESS;
-#ifndef _WIN32
-    char name_path_buffer[PATH_MAX];
-    if (!realpath(file_name, name_path_buffer))
-    {
-        RMOD_ERROR("Could not get the real path of file \"%s\", reason: %s", file_name, RMOD_ERRNO_MESSAGE);
-        res = RMOD_RESULT_BAD_PATH;
-        goto end;
-    }
-    char prev_wd[PATH_MAX], new_wd[PATH_MAX];
-    if (!getcwd(prev_wd, PATH_MAX))
-    {
-        RMOD_ERROR("Failed getting the current working directory, reason: %s", RMOD_ERRNO_MESSAGE);
-        res = RMOD_RESULT_BAD_PATH;
-        goto end;
-    }
-    //  Literally same size
-    strncpy(new_wd, name_path_buffer, PATH_MAX);
-    if (chdir(dirname(new_wd)) < 0)
-    {
-        RMOD_ERROR("Could not change working directory to \"%s\", reason: %s", new_wd, RMOD_ERRNO_MESSAGE);
-        res = RMOD_RESULT_BAD_PATH;
-        goto end;
-    }
-#else
-    char name_path_buffer[PATH_MAX];
-    char* file_part;
-    if (!GetFullPathNameA(file_name, PATH_MAX, name_path_buffer, &file_part))
+    rmod_result res;
+    region_jallocator* const allocator = region_jallocator_create(RMOD_PROGRAM_REGION_SIZE);
+    if (!allocator)
     {
-        RMOD_ERROR("Could not get the real path of file \"%s\", reason: %s", file_name, RMOD_ERRNO_MESSAGE);
-        res = RMOD_RESULT_BAD_PATH;
+        RMOD_ERROR("Failed creating region allocator of size %"PRIu64" for the program", RMOD_PROGRAM_REGION_SIZE);
+        res = RMOD_RESULT_NOMEM;
         goto end;
     }
-    char prev_wd[PATH_MAX], new_wd[PATH_MAX];
-    if (!getcwd(prev_wd, PATH_MAX))
+
+    u32 n_files = 0;
+    rmod_memory_file* mem_files = NULL;
+    u64* file_structures = NULL;
+    u32 n_types = 0;
+    rmod_element_type* p_types = NULL;
+    u32* type_files = NULL;
+    res = rmod_load_model_files(allocator, file_name, thread_count, &n_files, &mem_files, &file_structures, &n_types, &p_types, &type_files);
+    if (res != RMOD_RESULT_SUCCESS)
     {
-        RMOD_ERROR("Failed getting the current working directory, reason: %s", RMOD_ERRNO_MESSAGE);
-        res = RMOD_RESULT_BAD_PATH;
+        RMOD_ERROR("Failed conversion of base xml to program");
+        region_jallocator_destroy(allocator);
         goto end;
     }
-    //  Literally same size
-    strncpy(new_wd, name_path_buffer, PATH_MAX);
-    if (chdir(dirname(new_wd)) < 0)
+
+    *p_program = (rmod_program) {
+            .allocator = allocator,
+            .p_types = p_types,
+            .n_types = n_types,
+            .mem_files = mem_files,
+            .n_files = n_files,
+            .type_files = type_files,
+            .file_structures = file_structures,
+    };
+
+end:
+    RMOD_LEAVE_FUNCTION;
+    return res;
+}
+
+rmod_result rmod_program_delete(rmod_program* program)
+{
+    RMOD_ENTER_FUNCTION;
+    for (u32 i = 0; i < program->n_files; ++i)
     {
-        RMOD_ERROR("Could not change working directory to \"%s\", reason: %s", new_wd, RMOD_ERRNO_MESSAGE);
-        res = RMOD_RESULT_BAD_PATH;
-        goto end;
+        rmod_unmap_file(program->mem_files + i);
     }
-#endif
+    region_jallocator_destroy(program->allocator);
+    memset(program, 0, sizeof(*program));
+
+    RMOD_LEAVE_FUNCTION;
+    return RMOD_RESULT_SUCCESS;
+}
 
-    u32 file_count = 1;
-    u32 file_capacity = 16;
-    rmod_memory_file* mem_file_array = jalloc(sizeof(*mem_file_array) * file_capacity);
-    if (!mem_file_array)
+rmod_result rmod_program_update_file(
+        rmod_program* program, u32 file_index, bool* p_same_structure, u32* p_changed_count, u32* changed_types)
+{
+    RMOD_ENTER_FUNCTION;
+    assert(file_index < program->n_files);
+    rmod_result res;
+    bool same_structure = false;
+    u32 changed_count = 0;
+    rmod_memory_file mem_file;
+    if ((res = rmod_map_file_to_memory(program->mem_files[file_index].name, &mem_file)) != RMOD_RESULT_SUCCESS)
     {
-        chdir(prev_wd);
-        RMOD_ERROR("Failed jalloc(%zu)", sizeof(*mem_file_array) * file_capacity);
-        res = RMOD_RESULT_NOMEM;
-        goto end;
+        RMOD_ERROR("Could not map model file \"%s\" to memory", program->mem_files[file_index].name);
+        RMOD_LEAVE_FUNCTION;
+        return res;
     }
-    res = rmod_map_file_to_memory(name_path_buffer, mem_file_array + 0);
-    if (res != RMOD_RESULT_SUCCESS)
+    region_jallocator* const allocator = region_jallocator_create(RMOD_PROGRAM_REGION_SIZE);
+    if (!allocator)
     {
-        jfree(mem_file_array);
-        chdir(prev_wd);
-        RMOD_ERROR("Failed mapping base file \"%s\" to memory, reason: %s", name_path_buffer, RMOD_ERRNO_MESSAGE);
+        RMOD_ERROR("Failed creating region allocator of size %"PRIu64" for the model file", RMOD_PROGRAM_REGION_SIZE);
+        res = RMOD_RESULT_NOMEM;
         goto end;
     }
-
-    rmod_xml_element file_root;
-    res = rmod_parse_xml(mem_file_array + 0, &file_root);
-    if (res != RMOD_RESULT_SUCCESS)
+    u64 structure_hash;
+    u32 n_types;
+    rmod_element_type* p_types;
+    if ((res = rmod_convert_model_file(allocator, &mem_file, &structure_hash, &n_types, &p_types)) != RMOD_RESULT_SUCCESS)
     {
-        rmod_unmap_file(mem_file_array + 0);
-        jfree(mem_file_array);
-        chdir(prev_wd);
-        RMOD_ERROR("Failed mapping base file \"%s\" to memory, reason: %s", name_path_buffer, RMOD_ERRNO_MESSAGE);
+        RMOD_ERROR("Failed converting model file \"%s\"", mem_file.name);
         goto end;
     }
-
-    u32 n_types = 0;
-    rmod_element_type* p_types = NULL;
-    res = rmod_convert_xml(&file_root, &file_count, &file_capacity, &mem_file_array, &n_types, &p_types);
-    chdir(prev_wd);
-    if (res != RMOD_RESULT_SUCCESS)
+    //  Without knowing which file defined each type the types can not be matched
+    if (!program->type_files || !program->file_structures || structure_hash != program->file_structures[file_index])
     {
-        for (u32 i = 0; i < file_count; ++i)
-        {
-            rmod_unmap_file(mem_file_array + i);
-        }
-        jfree(mem_file_array);
-        chdir(prev_wd);
-        RMOD_ERROR("Failed conversion of base xml to program");
         goto end;
     }
-
-    u32 chain_count = 0;
-    for (u32 i = 0; i < n_types; ++i)
+    u32 file_type_count = 0;
+    for (u32 i = 0; i < program->n_types; ++i)
     {
-        if (p_types[i].header.type_value == RMOD_ELEMENT_TYPE_CHAIN)
-        {
-            chain_count += 1;
-        }
+        file_type_count += program->type_files[i] == file_index;
     }
-
+    if (file_type_count != n_types)
     {
-        rmod_element_type* const new_ptr = jrealloc(p_types, n_types * sizeof(*p_types));
-        if (!new_ptr)
-        {
-            RMOD_WARN("Failed jrealloc(%p, %zu), but it's not critical because buffer was already large enough", p_types, n_types * sizeof(*p_types));
-        }
-        else
-        {
-            p_types = new_ptr;
-        }
+        goto end;
     }
+    same_structure = true;
+    u32 j = 0;
+    for (u32 i = 0; i < program->n_types; ++i)
     {
-        rmod_memory_file * const new_ptr = jrealloc(mem_file_array, file_count * sizeof(*mem_file_array));
-        if (!new_ptr)
+        if (program->type_files[i] != file_index)
         {
-            RMOD_WARN("Failed jrealloc(%p, %zu), but it's not critical because buffer was already large enough", mem_file_array, file_count * sizeof(*p_types));
+            continue;
         }
-        else
+        const rmod_element_type* const new_type = p_types + j++;
+        assert(new_type->header.type_value == program->p_types[i].header.type_value);
+        if (new_type->header.type_value != RMOD_ELEMENT_TYPE_BLOCK)
         {
-            mem_file_array = new_ptr;
+            continue;
         }
-    }
-
-    rmod_program return_value = (rmod_program) {
-            .p_types = p_types,
-            .n_types = n_types,
-            .mem_files = mem_file_array,
-            .n_files = file_count,
-            .xml_root = file_root,
-            .n_char_buffers = 0,
-            .p_char_buffers = NULL,
-    };
-
-    if (chain_count > 1)
-    {
-        char** const char_buffers = jalloc(sizeof(*char_buffers) * (chain_count - 1));
-        if (!char_buffers)
+        //  Names of types and labels keep pointing into the file as it was, so only the values are copied
+        rmod_block* const block = &program->p_types[i].block;
+        const rmod_block* const new_block = &new_type->block;
+        if (block->mtbf != new_block->mtbf || block->mtbr != new_block->mtbr || block->effect != new_block->effect ||
+            block->cost != new_block->cost || block->failure_type != new_block->failure_type ||
+            memcmp(block->uncertainty, new_block->uncertainty, sizeof(block->uncertainty)) != 0)
         {
-            RMOD_ERROR("Failed jalloc(%zu)", sizeof(*char_buffers) * (chain_count - 1));
-            res = RMOD_RESULT_NOMEM;
-            rmod_program_delete(&return_value);
-            goto end;
+            block->mtbf = new_block->mtbf;
+            block->mtbr = new_block->mtbr;
+            block->effect = new_block->effect;
+            block->cost = new_block->cost;
+            block->failure_type = new_block->failure_type;
+            memcpy(block->uncertainty, new_block->uncertainty, sizeof(block->uncertainty));
+            changed_types[changed_count++] = i;
         }
-        memset(char_buffers, 0, sizeof(*char_buffers) * (chain_count - 1));
-        return_value.p_char_buffers = char_buffers;
     }
-    *p_program = return_value;
 
 end:
-    RMOD_LEAVE_FUNCTION;
-    return res;
-}
-
-rmod_result rmod_program_delete(rmod_program* program)
-{
-    RMOD_ENTER_FUNCTION;
-    for (u32 i = 0; i < program->n_char_buffers; ++i)
-    {
-        jfree(program->p_char_buffers[i]);
-    }
-    jfree(program->p_char_buffers);
-    rmod_release_xml(&program->xml_root);
-    rmod_destroy_types(program->n_types, program->p_types);
-    for (u32 i = 0; i < program->n_files; ++i)
+    if (allocator)
     {
-        rmod_unmap_file(program->mem_files + i);
+        region_jallocator_destroy(allocator);
     }
-    memset(program->mem_files, 0, sizeof(*program->mem_files) * program->n_files);
-    jfree(program->mem_files);
-    memset(program, 0, sizeof(*program));
-
+    rmod_unmap_file(&mem_file);
+    *p_same_structure = same_structure;
+    *p_changed_count = changed_count;
     RMOD_LEAVE_FUNCTION;
-    return RMOD_RESULT_SUCCESS;
+    return res;
 }
 
 rmod_result
-rmod_compile(const rmod_program* program, rmod_graph* graph, const char* chain_name, const char* module_name)
+rmod_compile(const rmod_program* program, rmod_graph* graph, const char* chain_name, const char* module_name, u32 thread_count)
 {
     RMOD_ENTER_FUNCTION;
 
-    rmod_result res = rmod_compile_graph(program->n_types, program->p_types, chain_name, module_name, graph);
+    rmod_result res = rmod_compile_graph(program->allocator, program->n_types, program->p_types, chain_name, module_name, thread_count, graph);
 
     RMOD_LEAVE_FUNCTION;
     return res;
@@ -228,7 +186,7 @@ rmod_result rmod_serialize_program(const rmod_program* program, string_stream* s
                                           "        <!ELEMENT include (#PCDATA)>\n"
                                           "        ]>\n"
                                           "<rmod>\n");
-    if (ret_ss == -1)
+    if (ret_ss == (size_t)-1)
     {
         RMOD_ERROR("Failed adding serialized types to string stream");
         res = RMOD_RESULT_NOMEM;
@@ -246,7 +204,7 @@ rmod_result rmod_serialize_program(const rmod_program* program, string_stream* s
 
     ret_ss = string_stream_add_str(ss, serialized_types);
     lin_jfree(G_LIN_JALLOCATOR, serialized_types);
-    if (ret_ss == -1)
+    if (ret_ss == (size_t)-1)
     {
         RMOD_ERROR("Failed adding serialized types to string stream");
         res = RMOD_RESULT_NOMEM;
@@ -255,7 +213,7 @@ rmod_result rmod_serialize_program(const rmod_program* program, string_stream* s
 
     ret_ss = string_stream_add_str(ss,
                                    "</rmod>\n");
-    if (ret_ss == -1)
+    if (ret_ss == (size_t)-1)
     {
         RMOD_ERROR("Failed adding serialized types to string stream");
         res = RMOD_RESULT_NOMEM;
@@ -9,24 +9,36 @@
 #include "../parsing/parsing_base.h"
 #include "../fmt/sstream.h"
 
+//  Size of regions of the program's allocator, which is grown by this much at a time
+#define RMOD_PROGRAM_REGION_SIZE ((u64)1 << 20)
+
 typedef struct rmod_program_struct rmod_program;
 struct rmod_program_struct
 {
+    region_jallocator* allocator;       //  Memory of types, their chain elements, and the array of files
     u32 n_types;
     rmod_element_type* p_types;
     u32 n_files;
     rmod_memory_file* mem_files;
-    rmod_xml_element xml_root;
-    u32 n_char_buffers;
-    char** p_char_buffers;
+    u32* type_files;                    //  File which defined each type, NULL if not known
+    u64* file_structures;               //  Hash of structure of each file, NULL if not known
 };
 
-rmod_result rmod_program_create(const char* file_name, rmod_program* p_program);
+//  Loads the file and files it includes using up to thread_count threads. Paths of included files are relative to the
+//  file which includes them, so the working directory is not changed.
+rmod_result rmod_program_create(const char* file_name, u32 thread_count, rmod_program* p_program);
 
+//  Unmaps the program's files and releases all of its memory by destroying its allocator
 rmod_result rmod_program_delete(rmod_program* program);
 
+//  Converts the program's file again and, if only values of parameters of its blocks changed, copies the new values to
+//  the program's blocks, giving indices of the types which changed in changed_types, which must have room for all types
+//  of the program. Otherwise p_same_structure is set to false and the program is not changed, so it has to be created
+//  again. The file is mapped again only while it is converted.
+rmod_result rmod_program_update_file(rmod_program* program, u32 file_index, bool* p_same_structure, u32* p_changed_count, u32* changed_types);
+
 rmod_result
-rmod_compile(const rmod_program* program, rmod_graph* graph, const char* chain_name, const char* module_name);
+rmod_compile(const rmod_program* program, rmod_graph* graph, const char* chain_name, const char* module_name, u32 thread_count);
 
 rmod_result rmod_serialize_program(const rmod_program* program, string_stream* ss);
 
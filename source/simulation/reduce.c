@@ -0,0 +1,256 @@
+//
+// Created by jan on 19.10.2026.
+//
+
+#include "reduce.h"
+
+static c8* copy_type_name(const c8* name)
+{
+    const u64 len = strlen((const char*)name);
+    c8* const copy = jalloc(len + 1);
+    if (!copy)
+    {
+        RMOD_ERROR("Failed jalloc(%zu)", len + 1);
+        return NULL;
+    }
+    memcpy(copy, name, len + 1);
+    return copy;
+}
+
+rmod_result rmod_reduce_graph(const rmod_graph* graph, rmod_graph* p_out)
+{
+    RMOD_ENTER_FUNCTION;
+    rmod_result res;
+    void* const base = lin_jalloc_get_current(G_LIN_JALLOCATOR);
+    const u32 node_count = graph->node_count;
+    //  Zeroed, so that destroying it releases only what was allocated so far
+    rmod_graph this;
+    memset(&this, 0, sizeof(this));
+    this.parent = graph->parent;
+    this.component_count = node_count;
+    if (graph->member_offsets)
+    {
+        RMOD_ERROR("Graph [%s - %s] was already reduced", graph->module_name, graph->graph_type);
+        res = RMOD_RESULT_BAD_VALUE;
+        goto failed;
+    }
+
+    //  Macro-node which each node of the original graph is in
+    u32* const group_of = lin_jalloc(G_LIN_JALLOCATOR, sizeof(*group_of) * node_count);
+    if (!group_of)
+    {
+        RMOD_ERROR("Failed lin_jalloc(%p, %zu)", G_LIN_JALLOCATOR, sizeof(*group_of) * node_count);
+        res = RMOD_RESULT_NOMEM;
+        goto failed;
+    }
+    memset(group_of, 0xFF, sizeof(*group_of) * node_count);
+
+    this.member_list = jalloc(sizeof(*this.member_list) * node_count);
+    if (!this.member_list)
+    {
+        RMOD_ERROR("Failed jalloc(%zu)", sizeof(*this.member_list) * node_count);
+        res = RMOD_RESULT_NOMEM;
+        goto failed;
+    }
+    this.member_offsets = jalloc(sizeof(*this.member_offsets) * (node_count + 1));
+    if (!this.member_offsets)
+    {
+        RMOD_ERROR("Failed jalloc(%zu)", sizeof(*this.member_offsets) * (node_count + 1));
+        res = RMOD_RESULT_NOMEM;
+        goto failed;
+    }
+    this.member_types = jalloc(sizeof(*this.member_types) * node_count);
+    if (!this.member_types)
+    {
+        RMOD_ERROR("Failed jalloc(%zu)", sizeof(*this.member_types) * node_count);
+        res = RMOD_RESULT_NOMEM;
+        goto failed;
+    }
+
+    //  Find series strings. Since nodes are sorted topologically, the parent of a string's first node was already
+    //  visited, so each string is found starting from its first node. Macro-nodes are ordered by their first member,
+    //  which keeps them sorted topologically, since edges between them only go from the last member of one to the
+    //  first member of another.
+    u32 group_count = 0, member_count = 0;
+    for (u32 i = 0; i < node_count; ++i)
+    {
+        if (group_of[i] != (u32)-1)
+        {
+            continue;
+        }
+        this.member_offsets[group_count] = member_count;
+        u32 j = i;
+        for (;;)
+        {
+            const rmod_graph_node* const node = graph->node_list + j;
+            group_of[j] = group_count;
+            this.member_types[member_count] = node->type_id;
+            this.member_list[member_count++] = j;
+            if (node->child_count != 1 || graph->node_list[node->children[0]].parent_count != 1)
+            {
+                break;
+            }
+            j = node->children[0];
+        }
+        group_count += 1;
+    }
+    this.member_offsets[group_count] = member_count;
+    assert(member_count == node_count);
+    if (group_of[node_count - 1] != group_count - 1)
+    {
+        RMOD_ERROR("Graph [%s - %s] has nodes which do not lead to its last node, so it can not be reduced", graph->module_name, graph->graph_type);
+        res = RMOD_RESULT_BAD_VALUE;
+        goto failed;
+    }
+
+    //  Types of the original graph are kept for the members, with a new type added for each macro-node
+    u32 macro_count = 0;
+    for (u32 i = 0; i < group_count; ++i)
+    {
+        macro_count += (this.member_offsets[i + 1] - this.member_offsets[i]) > 1;
+    }
+    this.type_list = jalloc(sizeof(*this.type_list) * (graph->type_count + macro_count));
+    if (!this.type_list)
+    {
+        RMOD_ERROR("Failed jalloc(%zu)", sizeof(*this.type_list) * (graph->type_count + macro_count));
+        res = RMOD_RESULT_NOMEM;
+        goto failed;
+    }
+    for (u32 i = 0; i < graph->type_count; ++i)
+    {
+        this.type_list[i] = graph->type_list[i];
+        if (!(this.type_list[i].name = copy_type_name(graph->type_list[i].name)))
+        {
+            res = RMOD_RESULT_NOMEM;
+            goto failed;
+        }
+        this.type_count += 1;
+    }
+
+    this.node_list = jalloc(sizeof(*this.node_list) * group_count);
+    if (!this.node_list)
+    {
+        RMOD_ERROR("Failed jalloc(%zu)", sizeof(*this.node_list) * group_count);
+        res = RMOD_RESULT_NOMEM;
+        goto failed;
+    }
+    memset(this.node_list, 0, sizeof(*this.node_list) * group_count);
+    this.node_count = group_count;
+
+    for (u32 i = 0; i < group_count; ++i)
+    {
+        rmod_graph_node* const node = this.node_list + i;
+        const u32 first = this.member_offsets[i], last = this.member_offsets[i + 1] - 1;
+        const rmod_graph_node* const first_node = graph->node_list + this.member_list[first];
+        const rmod_graph_node* const last_node = graph->node_list + this.member_list[last];
+
+        //  Edges into the string go to its first member and out of it from its last member
+        if (first_node->parent_count)
+        {
+            node->parents = jalloc(sizeof(*node->parents) * first_node->parent_count);
+            if (!node->parents)
+            {
+                RMOD_ERROR("Failed jalloc(%zu)", sizeof(*node->parents) * first_node->parent_count);
+                res = RMOD_RESULT_NOMEM;
+                goto failed;
+            }
+            for (u32 j = 0; j < first_node->parent_count; ++j)
+            {
+                node->parents[j] = group_of[first_node->parents[j]];
+                assert(node->parents[j] < i);
+            }
+            node->parent_count = first_node->parent_count;
+        }
+        if (last_node->child_count)
+        {
+            node->children = jalloc(sizeof(*node->children) * last_node->child_count);
+            if (!node->children)
+            {
+                RMOD_ERROR("Failed jalloc(%zu)", sizeof(*node->children) * last_node->child_count);
+                res = RMOD_RESULT_NOMEM;
+                goto failed;
+            }
+            for (u32 j = 0; j < last_node->child_count; ++j)
+            {
+                node->children[j] = group_of[last_node->children[j]];
+                assert(node->children[j] > i);
+            }
+            node->child_count = last_node->child_count;
+        }
+
+        if (first == last)
+        {
+            node->type_id = first_node->type_id;
+            continue;
+        }
+
+        //  Macro-node fails when any of its members does and its flow passes through all of them. Repair time and
+        //  cost are averages weighted by how often each member fails, but only those of the failed member are used by
+        //  the simulation.
+        const rmod_graph_node_type* const first_type = graph->type_list + first_node->type_id;
+        rmod_graph_node_type macro =
+                {
+                .failure_rate = 0.0f,
+                .repair_time = 0.0f,
+                .effect = 1.0f,
+                .cost = 0.0f,
+                .failure_type = RMOD_FAILURE_TYPE_NONE,
+                };
+        for (u32 j = first; j <= last; ++j)
+        {
+            const rmod_graph_node_type* const type = graph->type_list + this.member_types[j];
+            macro.failure_rate += type->failure_rate;
+            macro.repair_time += type->failure_rate * type->repair_time;
+            macro.cost += type->failure_rate * type->cost;
+            macro.effect *= type->effect;
+            if (type->failure_type > macro.failure_type)
+            {
+                macro.failure_type = type->failure_type;
+            }
+        }
+        if (macro.failure_rate > 0.0f)
+        {
+            macro.repair_time /= macro.failure_rate;
+            macro.cost /= macro.failure_rate;
+        }
+        const int len_name = snprintf(NULL, 0, "%s+%u", first_type->name, last - first);
+        macro.name = jalloc(len_name + 1);
+        if (!macro.name)
+        {
+            RMOD_ERROR("Failed jalloc(%zu)", (size_t)len_name + 1);
+            res = RMOD_RESULT_NOMEM;
+            goto failed;
+        }
+        snprintf((char*)macro.name, len_name + 1, "%s+%u", first_type->name, last - first);
+        node->type_id = this.type_count;
+        this.type_list[this.type_count++] = macro;
+    }
+    assert(this.type_count == graph->type_count + macro_count);
+
+    u32* const new_offsets = jrealloc(this.member_offsets, sizeof(*this.member_offsets) * (group_count + 1));
+    if (!new_offsets)
+    {
+        RMOD_WARN("Failed jrealloc(%p, %zu), but not critical since array was bigger than needed", this.member_offsets, sizeof(*this.member_offsets) * (group_count + 1));
+    }
+    else
+    {
+        this.member_offsets = new_offsets;
+    }
+
+    if (!(this.module_name = copy_type_name(graph->module_name)) || !(this.graph_type = copy_type_name(graph->graph_type)))
+    {
+        res = RMOD_RESULT_NOMEM;
+        goto failed;
+    }
+
+    lin_jalloc_set_current(G_LIN_JALLOCATOR, base);
+    *p_out = this;
+    RMOD_LEAVE_FUNCTION;
+    return RMOD_RESULT_SUCCESS;
+
+failed:
+    rmod_destroy_graph(&this);
+    lin_jalloc_set_current(G_LIN_JALLOCATOR, base);
+    RMOD_LEAVE_FUNCTION;
+    return res;
+}
@@ -0,0 +1,19 @@
+//
+// Created by jan on 19.10.2026.
+//
+
+#ifndef RMOD_REDUCE_H
+#define RMOD_REDUCE_H
+#include "../common/rmod.h"
+#include "compile.h"
+
+//  Collapses each series string of the graph (nodes where each has a single child, which has no other parents) into a
+//  single macro-node, with the failure rate equal to the sum of failure rates of its members and the effect equal to
+//  their product. When a macro-node fails, which member failed is chosen with probability proportional to its failure
+//  rate, so repair time, cost, failure type, and failure counts are still those of the member. Members are kept in the
+//  member arrays of the reduced graph, so results can be attributed to nodes of the original graph.
+//  Parallel nodes are not merged, since a pair where only one failed can not be represented by a single node that is
+//  either working or down.
+rmod_result rmod_reduce_graph(const rmod_graph* graph, rmod_graph* p_out);
+
+#endif //RMOD_REDUCE_H
@@ -4,12 +4,166 @@
 
 #include "simulation_run.h"
 #include "../random/msws.h"
+#include "../random/sobol.h"
+#include "../common/histogram.h"
+#include "../common/parallel.h"
 #include <pthread.h>
 #include <stdio.h>
 
-static inline f32 find_next_failure(rmod_msws_state* rng, f32 failure_rate)
+//  Parameters of the simulation, which are shared between all workers
+typedef struct
+{
+    u32 node_count;
+    u32 component_count;
+    u32 reps_to_do;
+    f32 duration;
+    f32 repair_limit;
+    f32 full_fail_rate;
+    f32 full_throughput;
+    const f32* failure_rate;
+    const f32* effect;
+    const u32* parent_count;
+    const rmod_graph_node_id* const* parent_ids;
+    const u32* child_count;
+    const rmod_graph_node_id* const* child_ids;
+    //  Members of node i are at [member_offsets[i], member_offsets[i + 1]). Nodes of a graph which was not reduced
+    //  each have only themselves as a member.
+    const u32* member_offsets;
+    const f32* member_failure_rate;
+    const f32* member_repair_time;
+    const f32* member_cost;
+    const rmod_failure_type* member_failure_type;
+    const u32* member_component;        //  Index of the member's node in the original graph
+    //  Used to find derivatives of results with respect to failure rate of each type
+    u32 type_count;
+    const u32* member_type;             //  Type of each member
+    const f32* member_rate_share;       //  Derivative of failure rate of the member with respect to that of its type
+    const f64* member_inverse_rate;     //  Inverse of failure rate of the type of each member
+    //  Flow over time is accumulated into equal bins of simulation time
+    u32 profile_bin_count;              //  0 if flow over time is not needed
+    f64 profile_bin_width;
+    //  Results are also recorded when each of these times is crossed, in increasing order and before the duration
+    u32 horizon_count;
+    const f32* horizons;
+} simulation_parameters;
+
+//  Sums over replications used to find likelihood ratio estimates of derivatives with respect to a failure rate
+typedef struct sensitivity_sums_struct sensitivity_sums;
+struct sensitivity_sums_struct
+{
+    f64 score, score_sq;                    //  Sums of scores and their squares
+    f64 flow_score;                         //  Sum of products of mean flow and score
+    f64 flow_score_sq, flow_sq_score_sq;    //  Sums of squared scores multiplied by mean flow and its square
+    f64 cost_score;                         //  Sum of products of cost and score
+    f64 cost_score_sq, cost_sq_score_sq;    //  Sums of squared scores multiplied by cost and its square
+};
+
+//  Number of independent randomizations of the Sobol sequence, which replications are split between
+#define RMOD_QMC_RANDOMIZATIONS 16
+//  Quantile of Student's t distribution with RMOD_QMC_RANDOMIZATIONS - 1 degrees of freedom for the two-sided 95%
+//  confidence interval
+#define RMOD_QMC_T_QUANTILE 2.131449545559323
+//  Number of first random numbers of each replication taken from the Sobol sequence
+#define RMOD_QMC_DIMENSIONS 8
+//  Seed of scrambling of the Sobol sequence and of random number streams which are used after its numbers run out
+#define RMOD_QMC_SEED 0x50b01a5eed
+
+//  Sums over replications of a single randomization of the Sobol sequence
+typedef struct qmc_sums_struct qmc_sums;
+struct qmc_sums_struct
+{
+    u64 count;
+    f64 flow;
+    f64 visits;
+    f64 cost;
+};
+
+const f64 RMOD_SIM_PERCENTILES[RMOD_SIM_PERCENTILE_COUNT] = {5.0, 50.0, 95.0};
+
+//  Results of replications of which distributions are found
+enum
+{
+    DISTRIBUTION_FLOW,
+    DISTRIBUTION_COST,
+    DISTRIBUTION_VISITS,
+    DISTRIBUTION_FATAL_TIME,
+    DISTRIBUTION_COUNT,
+};
+
+//  Sums over replications of results up to a horizon
+typedef struct horizon_sums_struct horizon_sums;
+struct horizon_sums_struct
+{
+    f64 flow;
+    f64 cost;
+    u64 visits;
+    u64* fails_per_component;
+    f64* downtime_per_component;
+};
+
+//  State of a single simulation, each worker has its own
+typedef struct
+{
+    f32* value;
+    rmod_element_status* node_status;
+    f32* time_component_was_downed;
+    f32* repair_time;                   //  Repair time of the member which failed for each node
+    u32* failed_member;                 //  Member which failed for each node
+    u64* fails_per_component;
+    f64* downtime_per_component;
+    //  Derivative of log-likelihood of the current replication with respect to failure rate of each type, NULL if
+    //  derivatives are not needed
+    f64* score;
+    sensitivity_sums* sensitivity;      //  Sums over replications for each type
+    f64 flow_sum;                       //  Sum of mean flows of replications
+    f64 cost_sum;                       //  Sum of costs of replications
+    //  Quasi-random numbers of the current replication, which are used before those of the generator
+    u32 qmc_count;                      //  0 if quasi-random numbers are not used
+    u32 qmc_used;
+    f64 qmc_point[RMOD_SOBOL_MAX_DIMENSIONS];
+    u32 first_replication;              //  Index of the first replication simulated with this state
+    qmc_sums* qmc;                      //  Sums over replications of each randomization
+    f64* profile;                       //  Flow in each bin of time summed over replications, NULL if not needed
+    u64* fatal_per_bin;                 //  Number of replications which ended by a fatal failure in each bin
+    u32 next_horizon;                   //  First horizon which the current replication has not yet crossed
+    horizon_sums* horizon;              //  Sums for each horizon, NULL if there are none
+    f32 fatal_time;                     //  Time of the fatal failure of the last replication, or INFINITY
+    rmod_histogram* distributions;      //  Histogram of each result over replications, NULL if not needed
+} simulation_state;
+
+//  Quantile of the normal distribution for the two-sided 95% confidence interval
+#define RMOD_CONFIDENCE_Z 1.959963984540054
+
+//  Half-width of the confidence interval of the mean, given the sum and the sum of squares of n samples
+static f64 confidence_half_width(const f64 sum, const f64 sum_sq, const u64 n)
+{
+    if (n < 2)
+    {
+        return INFINITY;
+    }
+    const f64 mean = sum / (f64)n;
+    f64 variance = (sum_sq - mean * sum) / (f64)(n - 1);
+    if (variance < 0.0)
+    {
+        variance = 0.0;
+    }
+    return RMOD_CONFIDENCE_Z * sqrt(variance / (f64)n);
+}
+
+
+//  Returns the next quasi-random number of the replication, or one from the generator once they run out
+static inline f64 draw_uniform(simulation_state* const state, rmod_msws_state* const rng)
+{
+    if (state->qmc_used < state->qmc_count)
+    {
+        return state->qmc_point[state->qmc_used++];
+    }
+    return rmod_msws_rngf(rng);
+}
+
+static inline f32 find_next_failure(simulation_state* const state, rmod_msws_state* rng, f32 failure_rate)
 {
-    return -(f32)log(1.0 - rmod_msws_rngf(rng)) / (f32)failure_rate;
+    return -(f32)log(1.0 - draw_uniform(state, rng)) / (f32)failure_rate;
 }
 
 static f32 find_system_throughput(
@@ -93,7 +247,7 @@ static bool apply_failure(
     //  them running while the only part they depend on/provide for is not online
     //  Failure (may) be acceptable
 
-    u32 working_parents = 0;
+    bool any_working_parents = false;
     // Check for all nodes after the failed node if they should be switched off
     for (u32 i = fail_idx + 1; i < node_count; ++i)
     {
@@ -103,6 +257,7 @@ static bool apply_failure(
             continue;
         }
         //  Count how many of its parents are still working
+        u32 working_parents = 0;
         for (u32 j = 0; j < parent_count[i]; ++j)
         {
             working_parents += status[parent_array[i][j]] == RMOD_ELEMENT_STATUS_WORK;
@@ -112,13 +267,17 @@ static bool apply_failure(
             //  No more working parents, switch it off
             status[i] = RMOD_ELEMENT_STATUS_INACTIVE;
         }
+        else
+        {
+            any_working_parents = true;
+        }
     }
-    if (!working_parents)
+    if (!any_working_parents)
     {
         need_maintenance = true;
     }
 
-    u32 working_children = 0;
+    bool any_working_children = false;
     //  Check for all nodes before the failed node if they should be switched off
     for (u32 i = fail_idx; i > 0; --i)
     {
@@ -128,6 +287,7 @@ static bool apply_failure(
             continue;
         }
         //  Count how many of its children are still working
+        u32 working_children = 0;
         for (u32 j = 0; j < child_count[i - 1]; ++j)
         {
             working_children += status[child_array[i - 1][j]] == RMOD_ELEMENT_STATUS_WORK;
@@ -137,12 +297,14 @@ static bool apply_failure(
             //  No more working parents, switch it off
             status[i - 1] = RMOD_ELEMENT_STATUS_INACTIVE;
         }
+        else
+        {
+            any_working_children = true;
+        }
     }
-    if (!working_children)
+    if (!any_working_children)
     {
-        //  First node in the graph has no more working children
-        //  Literally should not happen
-        assert(need_maintenance);
+        //  No node before the failed one still provides for anything
         need_maintenance = true;
     }
     *p_throughput = find_system_throughput(p_sys_fail_rate, node_count, status, parent_count, parent_array, effect, value, failure_rate);
@@ -150,12 +312,12 @@ static bool apply_failure(
 }
 
 static u32 determine_failed_component(
-        rmod_msws_state* const rng, const f32 system_failure_rate, const u32 node_count,
+        simulation_state* const state, rmod_msws_state* const rng, const f32 system_failure_rate, const u32 node_count,
         const rmod_element_status* const node_status, const f32* const failure_rate)
 {
     u32 fail_idx = -1;
     f32 failed_so_far = 0.0f;
-    f32 fail_measure = (f32) rmod_msws_rngf(rng) * system_failure_rate;
+    f32 fail_measure = (f32) draw_uniform(state, rng) * system_failure_rate;
     for (u32 i = 0; i < node_count; ++i)
     {
         if (node_status[i] != RMOD_ELEMENT_STATUS_WORK)
@@ -170,19 +332,162 @@ static u32 determine_failed_component(
         }
     }
     assert(fail_idx < node_count);
-    assert(fail_idx != -1);
+    assert(fail_idx != (u32)-1);
     return fail_idx;
 }
 
-static inline f32 run_simulation(const f32 simulation_duration, rmod_msws_state* const rng, const f32 full_fail_rate, const f32 full_throughput, const u32 node_count, rmod_element_status* const node_status, const f32* const failure_rate, const rmod_failure_type* const failure_type, f32* const time_component_was_downed, u64* const fails_per_component, f64* const downtime_per_component, const u32* const parent_count, const rmod_graph_node_id* const* const parent_ids, const u32* const child_count, const rmod_graph_node_id* const* const child_ids, const f32* const effect, f32* const value, const f32 repair_limit, const f32* const repair_time, const f32* const cost, u32* const p_maintenance_count, f32* const p_total_cost)
+//  Marks the node as down and picks which of its members failed, with probability proportional to member failure rate
+static rmod_failure_type fail_node(
+        const simulation_parameters* const params, simulation_state* const state, rmod_msws_state* const rng,
+        const u32 fail_idx, const f32 time)
+{
+    u32 member = params->member_offsets[fail_idx];
+    const u32 member_end = params->member_offsets[fail_idx + 1];
+    if (member_end - member > 1)
+    {
+        f32 fail_measure = (f32) draw_uniform(state, rng) * params->failure_rate[fail_idx];
+        while (member + 1 < member_end && (fail_measure -= params->member_failure_rate[member]) > 0.0f)
+        {
+            member += 1;
+        }
+    }
+    assert(state->node_status[fail_idx] == RMOD_ELEMENT_STATUS_WORK);
+    assert(state->time_component_was_downed[fail_idx] == 0.0f);
+    state->node_status[fail_idx] = RMOD_ELEMENT_STATUS_DOWN;
+    state->time_component_was_downed[fail_idx] = time;
+    state->failed_member[fail_idx] = member;
+    state->repair_time[fail_idx] = params->member_repair_time[member];
+    state->fails_per_component[params->member_component[member]] += 1;
+    for (u32 i = state->next_horizon; i < params->horizon_count; ++i)
+    {
+        state->horizon[i].fails_per_component[params->member_component[member]] += 1;
+    }
+    if (state->score)
+    {
+        state->score[params->member_type[member]] += params->member_inverse_rate[member];
+    }
+    return params->member_failure_type[member];
+}
+
+//  Adds the contribution of an interval of length dt without failures to the score of each type. Survival of the
+//  interval has the log-likelihood of minus dt times the failure rate of all working members.
+static void add_score_exposure(const simulation_parameters* const params, const simulation_state* const state, const f32 dt)
+{
+    for (u32 i = 0; i < params->node_count; ++i)
+    {
+        if (state->node_status[i] != RMOD_ELEMENT_STATUS_WORK)
+        {
+            continue;
+        }
+        for (u32 j = params->member_offsets[i]; j < params->member_offsets[i + 1]; ++j)
+        {
+            state->score[params->member_type[j]] -= (f64)dt * (f64)params->member_rate_share[j];
+        }
+    }
+}
+
+//  Adds results of a finished replication to the sums of each type and clears its score for the next one
+static void add_replication_sensitivity(const simulation_parameters* const params, simulation_state* const state, const f64 flow, const f64 cost)
+{
+    for (u32 i = 0; i < params->type_count; ++i)
+    {
+        const f64 score = state->score[i];
+        sensitivity_sums* const sums = state->sensitivity + i;
+        sums->score += score;
+        sums->score_sq += score * score;
+        sums->flow_score += flow * score;
+        sums->flow_score_sq += flow * score * score;
+        sums->flow_sq_score_sq += flow * flow * score * score;
+        sums->cost_score += cost * score;
+        sums->cost_score_sq += cost * score * score;
+        sums->cost_sq_score_sq += cost * cost * score * score;
+        state->score[i] = 0.0;
+    }
+    state->flow_sum += flow;
+    state->cost_sum += cost;
+}
+
+//  Adds flow of the interval from begin to end, during which throughput is constant, to each bin it overlaps
+static void add_profile_flow(const simulation_parameters* const params, simulation_state* const state, const f32 begin, const f32 end, const f32 throughput)
+{
+    if (throughput == 0.0f)
+    {
+        return;
+    }
+    const f64 width = params->profile_bin_width;
+    f64 t = begin;
+    for (u32 bin = (u32)(t / width); bin < params->profile_bin_count && t < end; ++bin)
+    {
+        const f64 bin_end = width * (f64)(bin + 1);
+        if (bin_end <= t)
+        {
+            continue;
+        }
+        const f64 stop = bin_end < end ? bin_end : end;
+        state->profile[bin] += (f64)throughput * (stop - t);
+        t = stop;
+    }
+}
+
+//  Records results of the replication for each horizon crossed by the interval from begin to end, during which throughput
+//  is constant. Failures and downtime are instead added to each horizon not yet crossed when they happen, so only flow,
+//  costs, and visits have to be recorded here.
+static void cross_horizons(
+        const simulation_parameters* const params, simulation_state* const state, const f32 begin, const f32 end,
+        const f32 throughput, const f32 total_throughput, const f32 total_cost, const u32 maintenance_count)
+{
+    while (state->next_horizon < params->horizon_count && params->horizons[state->next_horizon] <= end)
+    {
+        horizon_sums* const sums = state->horizon + state->next_horizon;
+        sums->flow += (f64)total_throughput + (f64)throughput * ((f64)params->horizons[state->next_horizon] - (f64)begin);
+        sums->cost += (f64)total_cost;
+        sums->visits += maintenance_count;
+        state->next_horizon += 1;
+    }
+}
+
+#ifndef NDEBUG
+static void check_downed_times(const u32 node_count, const rmod_element_status* const node_status, const f32* const time_component_was_downed)
+{
+    for (u32 i = 0; i < node_count; ++i)
+    {
+        if (node_status[i] == RMOD_ELEMENT_STATUS_DOWN)
+        {
+            assert(time_component_was_downed[i] != 0.0f);
+        }
+        else
+        {
+            assert(time_component_was_downed[i] == 0.0f);
+        }
+    }
+}
+#else
+#define check_downed_times(node_count, node_status, time_component_was_downed) (void)0
+#endif
+
+static inline f32 run_simulation(const simulation_parameters* const params, simulation_state* const state, rmod_msws_state* const rng, u32* const p_maintenance_count, f32* const p_total_cost)
 {
+    const f32 simulation_duration = params->duration;
+    const f32 repair_limit = params->repair_limit;
+    const u32 node_count = params->node_count;
+    const f32* const failure_rate = params->failure_rate;
+    const f32* const effect = params->effect;
+    const u32* const parent_count = params->parent_count;
+    const rmod_graph_node_id* const* const parent_ids = params->parent_ids;
+    const u32* const child_count = params->child_count;
+    const rmod_graph_node_id* const* const child_ids = params->child_ids;
+    rmod_element_status* const node_status = state->node_status;
+    f32* const time_component_was_downed = state->time_component_was_downed;
+    f32* const value = state->value;
+
     f32 time = 0.0f;
     f32 total_throughput = 0.0f;
+    state->fatal_time = INFINITY;
     u32 maintenance_count = 0;
     f32 total_cost = 0.0f;
 
-    f32 system_failure_rate = full_fail_rate;
-    f32 throughput = full_throughput;
+    f32 system_failure_rate = params->full_fail_rate;
+    f32 throughput = params->full_throughput;
 
 #ifndef NDEBUG
     u32 ts = 0;
@@ -194,63 +499,53 @@ static inline f32 run_simulation(const f32 simulation_duration, rmod_msws_state*
         ts += 1;
 #endif
         //  Find time step
-        f32 dt = find_next_failure(rng, system_failure_rate);
+        f32 dt = find_next_failure(state, rng, system_failure_rate);
         f32 next_t = time + dt;
         if (next_t > simulation_duration)
         {
             sim_is_over:
             dt = simulation_duration - time;
+            if (state->profile)
+            {
+                add_profile_flow(params, state, time, simulation_duration, throughput);
+            }
+            cross_horizons(params, state, time, simulation_duration, throughput, total_throughput, total_cost, maintenance_count);
             time = simulation_duration;
             total_throughput += throughput * dt;
+            if (state->score)
+            {
+                add_score_exposure(params, state, dt);
+            }
             //  Simulation is done
             break;
         }
 
 
+        if (state->profile)
+        {
+            add_profile_flow(params, state, time, next_t, throughput);
+        }
+        cross_horizons(params, state, time, next_t, throughput, total_throughput, total_cost, maintenance_count);
         time = next_t;
         total_throughput += throughput * dt;
+        if (state->score)
+        {
+            add_score_exposure(params, state, dt);
+        }
 
         //  Find which failure occurs next
-        u32 fail_idx = determine_failed_component(rng, system_failure_rate, node_count, node_status, failure_rate);
-        const rmod_failure_type type = failure_type[fail_idx];
-        assert(node_status[fail_idx] == RMOD_ELEMENT_STATUS_WORK);
-        node_status[fail_idx] = RMOD_ELEMENT_STATUS_DOWN;
-        assert(time_component_was_downed[fail_idx] == 0.0f);
-        time_component_was_downed[fail_idx] = time;
-        fails_per_component[fail_idx] += 1;
+        u32 fail_idx = determine_failed_component(state, rng, system_failure_rate, node_count, node_status, failure_rate);
+        const rmod_failure_type type = fail_node(params, state, rng, fail_idx, time);
         if (type == RMOD_FAILURE_TYPE_FATAL)
         {
+            state->fatal_time = time;
             break;
         }
 
-#ifndef NDEBUG
-        for (u32 i = 0; i < node_count; ++i)
-        {
-            if (node_status[i] == RMOD_ELEMENT_STATUS_DOWN)
-            {
-                assert(time_component_was_downed[i] != 0.0f);
-            }
-            else
-            {
-                assert(time_component_was_downed[i] == 0.0f);
-            }
-        }
-#endif
+        check_downed_times(node_count, node_status, time_component_was_downed);
         bool need_maintenance = apply_failure(
                 node_count, node_status, fail_idx, &throughput, &system_failure_rate, parent_count, parent_ids, child_count, child_ids, effect, value, failure_rate);
-#ifndef NDEBUG
-        for (u32 i = 0; i < node_count; ++i)
-        {
-            if (node_status[i] == RMOD_ELEMENT_STATUS_DOWN)
-            {
-                assert(time_component_was_downed[i] != 0.0f);
-            }
-            else
-            {
-                assert(time_component_was_downed[i] == 0.0f);
-            }
-        }
-#endif
+        check_downed_times(node_count, node_status, time_component_was_downed);
 
 
         need_maintenance |= (throughput < repair_limit || type == RMOD_FAILURE_TYPE_CRITICAL);
@@ -258,10 +553,10 @@ static inline f32 run_simulation(const f32 simulation_duration, rmod_msws_state*
         {
             //  Determine time to maintenance
             //  TODO: unit test the function "find_system_time_to_maintain"
-            f32 maintenance_dt = find_system_time_to_maintain(node_count, node_status, parent_count, parent_ids, repair_time, value);
+            f32 maintenance_dt = find_system_time_to_maintain(node_count, node_status, parent_count, parent_ids, state->repair_time, value);
             f32 maintenance_time = maintenance_dt + time;
             //  Compute time to next failure
-            dt = find_next_failure(rng, system_failure_rate);
+            dt = find_next_failure(state, rng, system_failure_rate);
             next_t = dt + time;
             while (next_t <= maintenance_time)
             {
@@ -273,61 +568,43 @@ static inline f32 run_simulation(const f32 simulation_duration, rmod_msws_state*
                 }
 
                 //      Advance time
+                if (state->profile)
+                {
+                    add_profile_flow(params, state, time, next_t, throughput);
+                }
+                cross_horizons(params, state, time, next_t, throughput, total_throughput, total_cost, maintenance_count);
                 total_throughput += dt * throughput;
                 time = next_t;
+                if (state->score)
+                {
+                    add_score_exposure(params, state, dt);
+                }
 
 
-                fail_idx = determine_failed_component(rng, system_failure_rate, node_count, node_status, failure_rate);
-                assert(time_component_was_downed[fail_idx] == 0.0f);
-                time_component_was_downed[fail_idx] = time;
-                assert(node_status[fail_idx] == RMOD_ELEMENT_STATUS_WORK);
-                if (failure_type[fail_idx] == RMOD_FAILURE_TYPE_FATAL)
+                fail_idx = determine_failed_component(state, rng, system_failure_rate, node_count, node_status, failure_rate);
+                if (fail_node(params, state, rng, fail_idx, time) == RMOD_FAILURE_TYPE_FATAL)
                 {
-                    break;
+                    //  Fatal failure ends the simulation, even while waiting for maintenance
+                    state->fatal_time = time;
+                    goto sim_is_fatal;
                 }
-                node_status[fail_idx] = RMOD_ELEMENT_STATUS_DOWN;
-                fails_per_component[fail_idx] += 1;
                 //      Apply failure
 
-#ifndef NDEBUG
-                for (u32 i = 0; i < node_count; ++i)
-                {
-                    if (node_status[i] == RMOD_ELEMENT_STATUS_DOWN)
-                    {
-                        assert(time_component_was_downed[i] != 0.0f);
-                    }
-                    else
-                    {
-                        assert(time_component_was_downed[i] == 0.0f);
-                    }
-                }
-#endif
+                check_downed_times(node_count, node_status, time_component_was_downed);
                 apply_failure(
                         node_count, node_status, fail_idx, &throughput, &system_failure_rate, parent_count, parent_ids, child_count, child_ids, effect, value, failure_rate);
-#ifndef NDEBUG
-                for (u32 i = 0; i < node_count; ++i)
-                {
-                    if (node_status[i] == RMOD_ELEMENT_STATUS_DOWN)
-                    {
-                        assert(time_component_was_downed[i] != 0.0f);
-                    }
-                    else
-                    {
-                        assert(time_component_was_downed[i] == 0.0f);
-                    }
-                }
-#endif
+                check_downed_times(node_count, node_status, time_component_was_downed);
 
                 //  Repeat the loop again
                 //      Determine time to maintenance, which might have just increased due to new failure
-                f32 new_maintenance_dt = find_system_time_to_maintain(node_count, node_status, parent_count, parent_ids, repair_time, value);
+                f32 new_maintenance_dt = find_system_time_to_maintain(node_count, node_status, parent_count, parent_ids, state->repair_time, value);
                 if (new_maintenance_dt > maintenance_dt)
                 {
                     maintenance_time += new_maintenance_dt - maintenance_dt;
                     maintenance_dt = new_maintenance_dt;
                 }
                 //      Compute time to next failure
-                dt = find_next_failure(rng, system_failure_rate);
+                dt = find_next_failure(state, rng, system_failure_rate);
                 next_t = dt + time;
             }
             //  Adjust dt (in order to keep it for time of next failure)
@@ -339,7 +616,16 @@ static inline f32 run_simulation(const f32 simulation_duration, rmod_msws_state*
                 //  Simulation is over
                 goto sim_is_over;
             }
+            if (state->profile)
+            {
+                add_profile_flow(params, state, time, maintenance_time, throughput);
+            }
+            cross_horizons(params, state, time, maintenance_time, throughput, total_throughput, total_cost, maintenance_count);
             total_throughput += (maintenance_time - time) * throughput;
+            if (state->score)
+            {
+                add_score_exposure(params, state, maintenance_time - time);
+            }
             time = maintenance_time;
             //  Need to maintain, so repair all systems
             for (u32 i = 0; i < node_count; ++i)
@@ -347,10 +633,17 @@ static inline f32 run_simulation(const f32 simulation_duration, rmod_msws_state*
                 switch (node_status[i])
                 {
                 case RMOD_ELEMENT_STATUS_DOWN:
-                    total_cost += cost[i];
+                {
+                    const u32 member = state->failed_member[i];
+                    total_cost += params->member_cost[member];
                     assert(time_component_was_downed[i] != 0.0f);
-                    downtime_per_component[i] += time - time_component_was_downed[i];
+                    state->downtime_per_component[params->member_component[member]] += time - time_component_was_downed[i];
+                    for (u32 j = state->next_horizon; j < params->horizon_count; ++j)
+                    {
+                        state->horizon[j].downtime_per_component[params->member_component[member]] += time - time_component_was_downed[i];
+                    }
                     time_component_was_downed[i] = 0.0f;
+                }
                     //  Fallthrough
                 case RMOD_ELEMENT_STATUS_INACTIVE:
                 case RMOD_ELEMENT_STATUS_WORK:
@@ -359,52 +652,43 @@ static inline f32 run_simulation(const f32 simulation_duration, rmod_msws_state*
                 }
             }
             //  Restore system to previously computed failure rates
-            throughput = full_throughput;
-            system_failure_rate = full_fail_rate;
+            throughput = params->full_throughput;
+            system_failure_rate = params->full_fail_rate;
             maintenance_count += 1;
         }
     }
-
+sim_is_fatal:
+    //  Nothing flows after a fatal failure, so horizons which were not crossed get the final results
+    cross_horizons(params, state, time, INFINITY, 0.0f, total_throughput, total_cost, maintenance_count);
 
     *p_maintenance_count = maintenance_count;
     *p_total_cost = total_cost;
     return total_throughput;
 }
 
-rmod_result rmod_simulate_graph(
-        const rmod_graph* graph, f32 simulation_duration, u32 simulation_repetitions, rmod_sim_result* p_res_out,
-        f32 repair_limit)
+//  Prepares the parameters shared by all simulations of the graph. Arrays are allocated by G_LIN_JALLOCATOR.
+static rmod_result prepare_simulation_parameters(const rmod_graph* const graph, const f32 simulation_duration, const f32 repair_limit, simulation_parameters* const p_out)
 {
     RMOD_ENTER_FUNCTION;
-    rmod_result res = RMOD_RESULT_SUCCESS;
+    rmod_result res;
     void* const base = lin_jalloc_get_current(G_LIN_JALLOCATOR);
+    const u32 node_count = graph->node_count;
+    const u32 member_count = graph->member_offsets ? graph->member_offsets[node_count] : node_count;
+    simulation_parameters params =
+            {
+            .node_count = node_count,
+            .component_count = graph->member_offsets ? graph->component_count : node_count,
+            .duration = simulation_duration,
+            .repair_limit = repair_limit,
+            };
 
     //  Reliability of each element
-    const u32 node_count = graph->node_count;
     f32* const failure_rate = lin_jalloc(G_LIN_JALLOCATOR, sizeof(*failure_rate) * node_count);
     if (!failure_rate)
     {
         RMOD_ERROR("Failed lin_jalloc(%p, %zu)", G_LIN_JALLOCATOR, sizeof(*failure_rate) * node_count);
         res = RMOD_RESULT_NOMEM;
-        goto end;
-    }
-
-    //  Repair times of each element
-    f32* const repair_time = lin_jalloc(G_LIN_JALLOCATOR, sizeof(*repair_time) * node_count);
-    if (!repair_time)
-    {
-        RMOD_ERROR("Failed lin_jalloc(%p, %zu)", G_LIN_JALLOCATOR, sizeof(*repair_time) * node_count);
-        res = RMOD_RESULT_NOMEM;
-        goto end;
-    }
-
-    //  Cost of each element
-    f32* const cost = lin_jalloc(G_LIN_JALLOCATOR, sizeof(*cost) * node_count);
-    if (!cost)
-    {
-        RMOD_ERROR("Failed lin_jalloc(%p, %zu)", G_LIN_JALLOCATOR, sizeof(*cost) * node_count);
-        res = RMOD_RESULT_NOMEM;
-        goto end;
+        goto failed;
     }
 
     //  Effect of each element
@@ -413,16 +697,7 @@ rmod_result rmod_simulate_graph(
     {
         RMOD_ERROR("Failed lin_jalloc(%p, %zu)", G_LIN_JALLOCATOR, sizeof(*effect) * node_count);
         res = RMOD_RESULT_NOMEM;
-        goto end;
-    }
-
-    //  Failure type of each element
-    rmod_failure_type* const failure_type = lin_jalloc(G_LIN_JALLOCATOR, sizeof(*failure_type) * node_count);
-    if (!failure_type)
-    {
-        RMOD_ERROR("Failed lin_jalloc(%p, %zu)", G_LIN_JALLOCATOR, sizeof(*failure_type) * node_count);
-        res = RMOD_RESULT_NOMEM;
-        goto end;
+        goto failed;
     }
 
     //  Parent counts of each element
@@ -431,7 +706,7 @@ rmod_result rmod_simulate_graph(
     {
         RMOD_ERROR("Failed lin_jalloc(%p, %zu)", G_LIN_JALLOCATOR, sizeof(*parent_count) * node_count);
         res = RMOD_RESULT_NOMEM;
-        goto end;
+        goto failed;
     }
 
     //  Parent arrays of each element
@@ -440,7 +715,7 @@ rmod_result rmod_simulate_graph(
     {
         RMOD_ERROR("Failed lin_jalloc(%p, %zu)", G_LIN_JALLOCATOR, sizeof(*parent_ids) * node_count);
         res = RMOD_RESULT_NOMEM;
-        goto end;
+        goto failed;
     }
 
     //  Child counts of each element
@@ -449,7 +724,7 @@ rmod_result rmod_simulate_graph(
     {
         RMOD_ERROR("Failed lin_jalloc(%p, %zu)", G_LIN_JALLOCATOR, sizeof(*child_count) * node_count);
         res = RMOD_RESULT_NOMEM;
-        goto end;
+        goto failed;
     }
 
     //  Child arrays of each element
@@ -458,105 +733,919 @@ rmod_result rmod_simulate_graph(
     {
         RMOD_ERROR("Failed lin_jalloc(%p, %zu)", G_LIN_JALLOCATOR, sizeof(*child_ids) * node_count);
         res = RMOD_RESULT_NOMEM;
-        goto end;
+        goto failed;
     }
 
-    //  Value of each element (for computing flow through the graph)
-    f32* const value = lin_jalloc(G_LIN_JALLOCATOR, sizeof(*value) * node_count);
-    if (!value)
+    //  Offsets of members of each element
+    u32* const member_offsets = lin_jalloc(G_LIN_JALLOCATOR, sizeof(*member_offsets) * (node_count + 1));
+    if (!member_offsets)
     {
-        RMOD_ERROR("Failed lin_jalloc(%p, %zu)", G_LIN_JALLOCATOR, sizeof(*value) * node_count);
+        RMOD_ERROR("Failed lin_jalloc(%p, %zu)", G_LIN_JALLOCATOR, sizeof(*member_offsets) * (node_count + 1));
         res = RMOD_RESULT_NOMEM;
-        goto end;
+        goto failed;
     }
 
-    //  Value of each element (for computing flow through the graph)
-    f32* const time_component_was_downed = lin_jalloc(G_LIN_JALLOCATOR, sizeof(*time_component_was_downed) * node_count);
-    if (!time_component_was_downed)
+    //  Reliability of each member
+    f32* const member_failure_rate = lin_jalloc(G_LIN_JALLOCATOR, sizeof(*member_failure_rate) * member_count);
+    if (!member_failure_rate)
     {
-        RMOD_ERROR("Failed lin_jalloc(%p, %zu)", G_LIN_JALLOCATOR, sizeof(*time_component_was_downed) * node_count);
+        RMOD_ERROR("Failed lin_jalloc(%p, %zu)", G_LIN_JALLOCATOR, sizeof(*member_failure_rate) * member_count);
         res = RMOD_RESULT_NOMEM;
-        goto end;
+        goto failed;
     }
 
-    //  Status of each element (for computing flow through the graph)
-    rmod_element_status* const node_status = lin_jalloc(G_LIN_JALLOCATOR, sizeof(*node_status) * node_count);
-    if (!node_status)
+    //  Repair times of each member
+    f32* const member_repair_time = lin_jalloc(G_LIN_JALLOCATOR, sizeof(*member_repair_time) * member_count);
+    if (!member_repair_time)
     {
-        RMOD_ERROR("Failed lin_jalloc(%p, %zu)", G_LIN_JALLOCATOR, sizeof(*node_status) * node_count);
+        RMOD_ERROR("Failed lin_jalloc(%p, %zu)", G_LIN_JALLOCATOR, sizeof(*member_repair_time) * member_count);
         res = RMOD_RESULT_NOMEM;
-        goto end;
+        goto failed;
     }
 
-    u64* const fails_per_component = jalloc(sizeof(*fails_per_component) * node_count);
-    if (!fails_per_component)
+    //  Cost of each member
+    f32* const member_cost = lin_jalloc(G_LIN_JALLOCATOR, sizeof(*member_cost) * member_count);
+    if (!member_cost)
     {
-        RMOD_ERROR("Failed jalloc(%zu)", sizeof(*fails_per_component) * node_count);
+        RMOD_ERROR("Failed lin_jalloc(%p, %zu)", G_LIN_JALLOCATOR, sizeof(*member_cost) * member_count);
         res = RMOD_RESULT_NOMEM;
-        goto end;
+        goto failed;
     }
 
-    f64* const downtime_per_component = jalloc(sizeof(*downtime_per_component) * node_count);
-    if (!downtime_per_component)
+    //  Failure type of each member
+    rmod_failure_type* const member_failure_type = lin_jalloc(G_LIN_JALLOCATOR, sizeof(*member_failure_type) * member_count);
+    if (!member_failure_type)
     {
-        RMOD_ERROR("Failed jalloc(%zu)", sizeof(*downtime_per_component) * node_count);
-        jfree(fails_per_component);
+        RMOD_ERROR("Failed lin_jalloc(%p, %zu)", G_LIN_JALLOCATOR, sizeof(*member_failure_type) * member_count);
         res = RMOD_RESULT_NOMEM;
-        goto end;
+        goto failed;
     }
 
-    u32 total_children = 0, total_parents = 0;
-    //  Prepare invariant values (failure rates, cost, effect, failure, parent counts, and parent arrays)
-    for (u32 i = 0; i < node_count; ++i)
+    //  Original component of each member
+    u32* const member_component = lin_jalloc(G_LIN_JALLOCATOR, sizeof(*member_component) * member_count);
+    if (!member_component)
     {
-        const rmod_graph_node* node = graph->node_list + i;
-        const rmod_graph_node_type* type = graph->type_list + node->type_id;
-        failure_rate[i] = type->failure_rate;
-        cost[i] = type->cost;
-        effect[i] = type->effect;
-        failure_type[i] = type->failure_type;
-        repair_time[i] = type->repair_time;
-        total_parents += (parent_count[i] = node->parent_count);
-        total_children += (child_count[i] = node->child_count);
-        parent_ids[i] = node->parents;
-        child_ids[i] = node->children;
-        fails_per_component[i] = 0;
-        downtime_per_component[i] = 0.0;
-        time_component_was_downed[i] = 0.0f;
+        RMOD_ERROR("Failed lin_jalloc(%p, %zu)", G_LIN_JALLOCATOR, sizeof(*member_component) * member_count);
+        res = RMOD_RESULT_NOMEM;
+        goto failed;
     }
 
-
-    //  Simulation records
-    rmod_sim_result results =
-            {
-            .total_maintenance_visits = 0,
-            .total_flow = 0,
-            .sim_count = 0,
-            .n_components = 0,
-            .total_costs = 0,
-            .duration = 0,
-            .failures_per_component = NULL,
-            .downtime_per_component = NULL,
-            };
-
-    f32 full_fail_rate = 0.0f;
-    value[0] = effect[0];
-    f32 full_throughput;
-    //  Reset status before simulation
-    for (u32 i = 0; i < node_count; ++i)
+    //  Type of each member
+    u32* const member_type = lin_jalloc(G_LIN_JALLOCATOR, sizeof(*member_type) * member_count);
+    if (!member_type)
     {
-        node_status[i] = RMOD_ELEMENT_STATUS_WORK;
+        RMOD_ERROR("Failed lin_jalloc(%p, %zu)", G_LIN_JALLOCATOR, sizeof(*member_type) * member_count);
+        res = RMOD_RESULT_NOMEM;
+        goto failed;
     }
-    if ((full_throughput = find_system_throughput(&full_fail_rate, node_count, node_status, parent_count, parent_ids, effect, value, failure_rate)) < repair_limit)
+
+    //  Share of failure rate of its type of each member
+    f32* const member_rate_share = lin_jalloc(G_LIN_JALLOCATOR, sizeof(*member_rate_share) * member_count);
+    if (!member_rate_share)
     {
-        RMOD_ERROR("Maximum graph throughput was %g, however minimum value for repair was specified to be %g. This is most likely due to incorrect specification", full_throughput, repair_limit);
-        jfree(fails_per_component);
-        res = RMOD_RESULT_BAD_VALUE;
-        goto end;
+        RMOD_ERROR("Failed lin_jalloc(%p, %zu)", G_LIN_JALLOCATOR, sizeof(*member_rate_share) * member_count);
+        res = RMOD_RESULT_NOMEM;
+        goto failed;
     }
 
+    //  Inverse failure rate of type of each member
+    f64* const member_inverse_rate = lin_jalloc(G_LIN_JALLOCATOR, sizeof(*member_inverse_rate) * member_count);
+    if (!member_inverse_rate)
+    {
+        RMOD_ERROR("Failed lin_jalloc(%p, %zu)", G_LIN_JALLOCATOR, sizeof(*member_inverse_rate) * member_count);
+        res = RMOD_RESULT_NOMEM;
+        goto failed;
+    }
 
-    rmod_msws_state rng;
+    //  Status of each element when everything works
+    rmod_element_status* const node_status = lin_jalloc(G_LIN_JALLOCATOR, sizeof(*node_status) * node_count);
+    if (!node_status)
+    {
+        RMOD_ERROR("Failed lin_jalloc(%p, %zu)", G_LIN_JALLOCATOR, sizeof(*node_status) * node_count);
+        res = RMOD_RESULT_NOMEM;
+        goto failed;
+    }
+
+    //  Value of each element when everything works
+    f32* const value = lin_jalloc(G_LIN_JALLOCATOR, sizeof(*value) * node_count);
+    if (!value)
+    {
+        RMOD_ERROR("Failed lin_jalloc(%p, %zu)", G_LIN_JALLOCATOR, sizeof(*value) * node_count);
+        res = RMOD_RESULT_NOMEM;
+        goto failed;
+    }
+
+    //  Prepare invariant values (failure rates, effect, parent counts, and parent arrays)
+    for (u32 i = 0; i < node_count; ++i)
+    {
+        const rmod_graph_node* node = graph->node_list + i;
+        const rmod_graph_node_type* type = graph->type_list + node->type_id;
+        failure_rate[i] = type->failure_rate;
+        effect[i] = type->effect;
+        parent_count[i] = node->parent_count;
+        child_count[i] = node->child_count;
+        parent_ids[i] = node->parents;
+        child_ids[i] = node->children;
+        member_offsets[i] = graph->member_offsets ? graph->member_offsets[i] : i;
+        node_status[i] = RMOD_ELEMENT_STATUS_WORK;
+    }
+    member_offsets[node_count] = member_count;
+    //  Prepare values which depend on which member failed (failure rates, repair times, cost, and failure type)
+    for (u32 i = 0; i < member_count; ++i)
+    {
+        const rmod_graph_type_id type_id = graph->member_offsets ? graph->member_types[i] : graph->node_list[i].type_id;
+        const rmod_graph_node_type* type = graph->type_list + type_id;
+        member_failure_rate[i] = type->failure_rate;
+        member_repair_time[i] = type->repair_time;
+        member_cost[i] = type->cost;
+        member_failure_type[i] = type->failure_type;
+        member_component[i] = graph->member_offsets ? graph->member_list[i] : i;
+        member_type[i] = type_id;
+    }
+    //  Member failure rates are scaled to sum up to the failure rate of their node, since surrogate nodes fail less often
+    //  than their members combined
+    for (u32 i = 0; i < node_count; ++i)
+    {
+        f32 total = 0.0f;
+        for (u32 j = member_offsets[i]; j < member_offsets[i + 1]; ++j)
+        {
+            total += member_failure_rate[j];
+        }
+        if (total > 0.0f && total != failure_rate[i])
+        {
+            for (u32 j = member_offsets[i]; j < member_offsets[i + 1]; ++j)
+            {
+                member_failure_rate[j] *= failure_rate[i] / total;
+            }
+        }
+    }
+
+    //  Scaling of member failure rates is treated as constant when finding derivatives, which is exact unless the node
+    //  is a surrogate
+    for (u32 i = 0; i < member_count; ++i)
+    {
+        const f32 type_rate = graph->type_list[member_type[i]].failure_rate;
+        member_rate_share[i] = type_rate > 0.0f ? member_failure_rate[i] / type_rate : 1.0f;
+        member_inverse_rate[i] = type_rate > 0.0f ? 1.0 / (f64)type_rate : 0.0;
+    }
+
+    if ((params.full_throughput = find_system_throughput(&params.full_fail_rate, node_count, node_status, parent_count, parent_ids, effect, value, failure_rate)) < repair_limit)
+    {
+        RMOD_ERROR("Maximum graph throughput was %g, however minimum value for repair was specified to be %g. This is most likely due to incorrect specification", params.full_throughput, repair_limit);
+        res = RMOD_RESULT_BAD_VALUE;
+        goto failed;
+    }
+    lin_jfree(G_LIN_JALLOCATOR, node_status);
+
+    params.failure_rate = failure_rate;
+    params.effect = effect;
+    params.parent_count = parent_count;
+    params.parent_ids = parent_ids;
+    params.child_count = child_count;
+    params.child_ids = child_ids;
+    params.member_offsets = member_offsets;
+    params.member_failure_rate = member_failure_rate;
+    params.member_repair_time = member_repair_time;
+    params.member_cost = member_cost;
+    params.member_failure_type = member_failure_type;
+    params.member_component = member_component;
+    params.type_count = graph->type_count;
+    params.member_type = member_type;
+    params.member_rate_share = member_rate_share;
+    params.member_inverse_rate = member_inverse_rate;
+    *p_out = params;
+
+    RMOD_LEAVE_FUNCTION;
+    return RMOD_RESULT_SUCCESS;
+failed:
+    lin_jalloc_set_current(G_LIN_JALLOCATOR, base);
+    RMOD_LEAVE_FUNCTION;
+    return res;
+}
+
+//  Prepares state for state_count independent simulations. Arrays are allocated by G_LIN_JALLOCATOR.
+static rmod_result prepare_simulation_states(const simulation_parameters* const params, const u32 state_count, simulation_state* const states)
+{
+    RMOD_ENTER_FUNCTION;
+    rmod_result res;
+    void* const base = lin_jalloc_get_current(G_LIN_JALLOCATOR);
+    const u32 node_count = params->node_count;
+    const u32 component_count = params->component_count;
+
+    f32* const value_array = lin_jalloc(G_LIN_JALLOCATOR, sizeof(*value_array) * node_count * state_count);
+    if (!value_array)
+    {
+        RMOD_ERROR("Failed lin_jalloc(%p, %zu)", G_LIN_JALLOCATOR, sizeof(*value_array) * node_count * state_count);
+        res = RMOD_RESULT_NOMEM;
+        goto failed;
+    }
+
+    f32* const downed_time_array = lin_jalloc(G_LIN_JALLOCATOR, sizeof(*downed_time_array) * node_count * state_count);
+    if (!downed_time_array)
+    {
+        RMOD_ERROR("Failed lin_jalloc(%p, %zu)", G_LIN_JALLOCATOR, sizeof(*downed_time_array) * node_count * state_count);
+        res = RMOD_RESULT_NOMEM;
+        goto failed;
+    }
+    memset(downed_time_array, 0, sizeof(*downed_time_array) * node_count * state_count);
+
+    f32* const repair_time_array = lin_jalloc(G_LIN_JALLOCATOR, sizeof(*repair_time_array) * node_count * state_count);
+    if (!repair_time_array)
+    {
+        RMOD_ERROR("Failed lin_jalloc(%p, %zu)", G_LIN_JALLOCATOR, sizeof(*repair_time_array) * node_count * state_count);
+        res = RMOD_RESULT_NOMEM;
+        goto failed;
+    }
+    memset(repair_time_array, 0, sizeof(*repair_time_array) * node_count * state_count);
+
+    u32* const failed_member_array = lin_jalloc(G_LIN_JALLOCATOR, sizeof(*failed_member_array) * node_count * state_count);
+    if (!failed_member_array)
+    {
+        RMOD_ERROR("Failed lin_jalloc(%p, %zu)", G_LIN_JALLOCATOR, sizeof(*failed_member_array) * node_count * state_count);
+        res = RMOD_RESULT_NOMEM;
+        goto failed;
+    }
+
+    rmod_element_status* const element_status_array = lin_jalloc(
+            G_LIN_JALLOCATOR, sizeof(*element_status_array) * node_count * state_count);
+    if (!element_status_array)
+    {
+        RMOD_ERROR("Failed lin_jalloc(%p, %zu)", G_LIN_JALLOCATOR,
+                   sizeof(*element_status_array) * node_count * state_count);
+        res = RMOD_RESULT_NOMEM;
+        goto failed;
+    }
+
+    u64* const fails_array = lin_jalloc(G_LIN_JALLOCATOR, sizeof(*fails_array) * component_count * state_count);
+    if (!fails_array)
+    {
+        RMOD_ERROR("Failed lin_jalloc(%p, %zu)", G_LIN_JALLOCATOR, sizeof(*fails_array) * component_count * state_count);
+        res = RMOD_RESULT_NOMEM;
+        goto failed;
+    }
+    memset(fails_array, 0, sizeof(*fails_array) * component_count * state_count);
+
+    f64* const downtime_array = lin_jalloc(G_LIN_JALLOCATOR, sizeof(*downtime_array) * component_count * state_count);
+    if (!downtime_array)
+    {
+        RMOD_ERROR("Failed lin_jalloc(%p, %zu)", G_LIN_JALLOCATOR, sizeof(*downtime_array) * component_count * state_count);
+        res = RMOD_RESULT_NOMEM;
+        goto failed;
+    }
+    memset(downtime_array, 0, sizeof(*downtime_array) * component_count * state_count);
+
+    for (u32 i = 0; i < state_count; ++i)
+    {
+        simulation_state* const state = states + i;
+        state->value = value_array + node_count * i;
+        state->value[0] = params->effect[0];
+        state->node_status = element_status_array + node_count * i;
+        state->time_component_was_downed = downed_time_array + node_count * i;
+        state->repair_time = repair_time_array + node_count * i;
+        state->failed_member = failed_member_array + node_count * i;
+        state->fails_per_component = fails_array + component_count * i;
+        state->downtime_per_component = downtime_array + component_count * i;
+        state->score = NULL;
+        state->sensitivity = NULL;
+        state->flow_sum = 0.0;
+        state->cost_sum = 0.0;
+        state->qmc_count = 0;
+        state->qmc_used = 0;
+        state->first_replication = 0;
+        state->qmc = NULL;
+        state->profile = NULL;
+        state->fatal_per_bin = NULL;
+        state->next_horizon = 0;
+        state->horizon = NULL;
+        state->fatal_time = INFINITY;
+        state->distributions = NULL;
+    }
+
+    RMOD_LEAVE_FUNCTION;
+    return RMOD_RESULT_SUCCESS;
+failed:
+    lin_jalloc_set_current(G_LIN_JALLOCATOR, base);
+    RMOD_LEAVE_FUNCTION;
+    return res;
+}
+
+//  Prepares states to find derivatives with respect to failure rates of types. Arrays are allocated by G_LIN_JALLOCATOR.
+static rmod_result prepare_sensitivity_states(const simulation_parameters* const params, const u32 state_count, simulation_state* const states)
+{
+    RMOD_ENTER_FUNCTION;
+    rmod_result res;
+    void* const base = lin_jalloc_get_current(G_LIN_JALLOCATOR);
+    const u32 type_count = params->type_count;
+
+    f64* const score_array = lin_jalloc(G_LIN_JALLOCATOR, sizeof(*score_array) * type_count * state_count);
+    if (!score_array)
+    {
+        RMOD_ERROR("Failed lin_jalloc(%p, %zu)", G_LIN_JALLOCATOR, sizeof(*score_array) * type_count * state_count);
+        res = RMOD_RESULT_NOMEM;
+        goto failed;
+    }
+    memset(score_array, 0, sizeof(*score_array) * type_count * state_count);
+
+    sensitivity_sums* const sums_array = lin_jalloc(G_LIN_JALLOCATOR, sizeof(*sums_array) * type_count * state_count);
+    if (!sums_array)
+    {
+        RMOD_ERROR("Failed lin_jalloc(%p, %zu)", G_LIN_JALLOCATOR, sizeof(*sums_array) * type_count * state_count);
+        res = RMOD_RESULT_NOMEM;
+        goto failed;
+    }
+    memset(sums_array, 0, sizeof(*sums_array) * type_count * state_count);
+
+    for (u32 i = 0; i < state_count; ++i)
+    {
+        states[i].score = score_array + type_count * i;
+        states[i].sensitivity = sums_array + type_count * i;
+    }
+
+    RMOD_LEAVE_FUNCTION;
+    return RMOD_RESULT_SUCCESS;
+failed:
+    lin_jalloc_set_current(G_LIN_JALLOCATOR, base);
+    RMOD_LEAVE_FUNCTION;
+    return res;
+}
+
+//  Prepares states to accumulate flow and fatal failures over time. Arrays are allocated by G_LIN_JALLOCATOR.
+static rmod_result prepare_profile_states(const simulation_parameters* const params, const u32 state_count, simulation_state* const states)
+{
+    RMOD_ENTER_FUNCTION;
+    rmod_result res;
+    void* const base = lin_jalloc_get_current(G_LIN_JALLOCATOR);
+    const u32 bin_count = params->profile_bin_count;
+    f64* const profile_array = lin_jalloc(G_LIN_JALLOCATOR, sizeof(*profile_array) * bin_count * state_count);
+    if (!profile_array)
+    {
+        RMOD_ERROR("Failed lin_jalloc(%p, %zu)", G_LIN_JALLOCATOR, sizeof(*profile_array) * bin_count * state_count);
+        res = RMOD_RESULT_NOMEM;
+        goto failed;
+    }
+    memset(profile_array, 0, sizeof(*profile_array) * bin_count * state_count);
+
+    u64* const fatal_array = lin_jalloc(G_LIN_JALLOCATOR, sizeof(*fatal_array) * bin_count * state_count);
+    if (!fatal_array)
+    {
+        RMOD_ERROR("Failed lin_jalloc(%p, %zu)", G_LIN_JALLOCATOR, sizeof(*fatal_array) * bin_count * state_count);
+        res = RMOD_RESULT_NOMEM;
+        goto failed;
+    }
+    memset(fatal_array, 0, sizeof(*fatal_array) * bin_count * state_count);
+
+    for (u32 i = 0; i < state_count; ++i)
+    {
+        states[i].profile = profile_array + bin_count * i;
+        states[i].fatal_per_bin = fatal_array + bin_count * i;
+    }
+    RMOD_LEAVE_FUNCTION;
+    return RMOD_RESULT_SUCCESS;
+failed:
+    lin_jalloc_set_current(G_LIN_JALLOCATOR, base);
+    RMOD_LEAVE_FUNCTION;
+    return res;
+}
+
+static void add_replication_fatal_time(const simulation_parameters* const params, simulation_state* const state)
+{
+    if (state->fatal_time == INFINITY)
+    {
+        return;
+    }
+    u32 bin = (u32)((f64)state->fatal_time / params->profile_bin_width);
+    if (bin >= params->profile_bin_count)
+    {
+        bin = params->profile_bin_count - 1;
+    }
+    state->fatal_per_bin[bin] += 1;
+}
+
+//  Merges flow and fatal failures over time accumulated by each state into mean flow and reliability in each bin.
+//  Output is allocated by jalloc.
+static rmod_result find_profile(
+        const simulation_parameters* const params, const u32 state_count, const simulation_state* const states,
+        const u64 replication_count, rmod_sim_profile_bin** const p_out)
+{
+    RMOD_ENTER_FUNCTION;
+    const u32 bin_count = params->profile_bin_count;
+    rmod_sim_profile_bin* const profile = jalloc(sizeof(*profile) * bin_count);
+    if (!profile)
+    {
+        RMOD_ERROR("Failed jalloc(%zu)", sizeof(*profile) * bin_count);
+        RMOD_LEAVE_FUNCTION;
+        return RMOD_RESULT_NOMEM;
+    }
+    //  All replications which did not fail fatally are censored at the end of the simulation, so the number at risk
+    //  only decreases by fatal failures
+    u64 at_risk = replication_count;
+    f64 reliability = 1.0;
+    f64 greenwood_sum = 0.0;
+    for (u32 i = 0; i < bin_count; ++i)
+    {
+        f64 sum = 0.0;
+        u64 fatal_count = 0;
+        for (u32 j = 0; j < state_count; ++j)
+        {
+            sum += states[j].profile[i];
+            fatal_count += states[j].fatal_per_bin[i];
+        }
+        if (fatal_count)
+        {
+            reliability *= 1.0 - (f64)fatal_count / (f64)at_risk;
+            if (fatal_count < at_risk)
+            {
+                greenwood_sum += (f64)fatal_count / ((f64)at_risk * (f64)(at_risk - fatal_count));
+            }
+            at_risk -= fatal_count;
+        }
+        f64 lower, upper;
+        if (at_risk == replication_count)
+        {
+            //  Greenwood's variance is zero without failures, so the exact bound for zero failures is used instead
+            lower = pow(1.0 - 0.95, 1.0 / (f64)replication_count);
+            upper = 1.0;
+        }
+        else if (at_risk == 0)
+        {
+            lower = 0.0;
+            upper = 0.0;
+        }
+        else
+        {
+            const f64 spread = RMOD_CONFIDENCE_Z * sqrt(greenwood_sum) / fabs(log(reliability));
+            lower = pow(reliability, exp(spread));
+            upper = pow(reliability, exp(-spread));
+        }
+        profile[i] = (rmod_sim_profile_bin)
+                {
+                .flow = sum / (params->profile_bin_width * (f64)replication_count),
+                .fatal_count = fatal_count,
+                .reliability = reliability,
+                .reliability_lower = lower,
+                .reliability_upper = upper,
+                };
+    }
+    *p_out = profile;
+    RMOD_LEAVE_FUNCTION;
+    return RMOD_RESULT_SUCCESS;
+}
+
+//  Prepares states to record results at each horizon. Arrays are allocated by G_LIN_JALLOCATOR.
+static rmod_result prepare_horizon_states(const simulation_parameters* const params, const u32 state_count, simulation_state* const states)
+{
+    RMOD_ENTER_FUNCTION;
+    rmod_result res;
+    void* const base = lin_jalloc_get_current(G_LIN_JALLOCATOR);
+    const u32 horizon_count = params->horizon_count;
+    const u32 component_count = params->component_count;
+
+    horizon_sums* const sums_array = lin_jalloc(G_LIN_JALLOCATOR, sizeof(*sums_array) * horizon_count * state_count);
+    if (!sums_array)
+    {
+        RMOD_ERROR("Failed lin_jalloc(%p, %zu)", G_LIN_JALLOCATOR, sizeof(*sums_array) * horizon_count * state_count);
+        res = RMOD_RESULT_NOMEM;
+        goto failed;
+    }
+
+    u64* const fails_array = lin_jalloc(G_LIN_JALLOCATOR, sizeof(*fails_array) * component_count * horizon_count * state_count);
+    if (!fails_array)
+    {
+        RMOD_ERROR("Failed lin_jalloc(%p, %zu)", G_LIN_JALLOCATOR, sizeof(*fails_array) * component_count * horizon_count * state_count);
+        res = RMOD_RESULT_NOMEM;
+        goto failed;
+    }
+    memset(fails_array, 0, sizeof(*fails_array) * component_count * horizon_count * state_count);
+
+    f64* const downtime_array = lin_jalloc(G_LIN_JALLOCATOR, sizeof(*downtime_array) * component_count * horizon_count * state_count);
+    if (!downtime_array)
+    {
+        RMOD_ERROR("Failed lin_jalloc(%p, %zu)", G_LIN_JALLOCATOR, sizeof(*downtime_array) * component_count * horizon_count * state_count);
+        res = RMOD_RESULT_NOMEM;
+        goto failed;
+    }
+    memset(downtime_array, 0, sizeof(*downtime_array) * component_count * horizon_count * state_count);
+
+    for (u32 i = 0; i < horizon_count * state_count; ++i)
+    {
+        sums_array[i] = (horizon_sums)
+                {
+                .flow = 0.0,
+                .cost = 0.0,
+                .visits = 0,
+                .fails_per_component = fails_array + (u64)component_count * i,
+                .downtime_per_component = downtime_array + (u64)component_count * i,
+                };
+    }
+    for (u32 i = 0; i < state_count; ++i)
+    {
+        states[i].horizon = sums_array + horizon_count * i;
+    }
+
+    RMOD_LEAVE_FUNCTION;
+    return RMOD_RESULT_SUCCESS;
+failed:
+    lin_jalloc_set_current(G_LIN_JALLOCATOR, base);
+    RMOD_LEAVE_FUNCTION;
+    return res;
+}
+
+//  Merges results at each horizon recorded by each state. Output is allocated by jalloc as a single block, so that it
+//  can be freed by calling jfree on the array of horizons.
+static rmod_result find_horizons(
+        const simulation_parameters* const params, const u32 state_count, const simulation_state* const states,
+        const u64 replication_count, rmod_sim_horizon** const p_out)
+{
+    RMOD_ENTER_FUNCTION;
+    const u32 horizon_count = params->horizon_count;
+    const u32 component_count = params->component_count;
+    const u64 size = (sizeof(rmod_sim_horizon) + (sizeof(u64) + sizeof(f64)) * component_count) * horizon_count;
+    rmod_sim_horizon* const horizons = jalloc(size);
+    if (!horizons)
+    {
+        RMOD_ERROR("Failed jalloc(%zu)", size);
+        RMOD_LEAVE_FUNCTION;
+        return RMOD_RESULT_NOMEM;
+    }
+    u64* const fails_array = (u64*)(horizons + horizon_count);
+    f64* const downtime_array = (f64*)(fails_array + (u64)component_count * horizon_count);
+    for (u32 i = 0; i < horizon_count; ++i)
+    {
+        rmod_sim_horizon* const horizon = horizons + i;
+        *horizon = (rmod_sim_horizon)
+                {
+                .time = params->horizons[i],
+                .sim_count = replication_count,
+                .total_flow = 0.0,
+                .total_costs = 0.0,
+                .total_maintenance_visits = 0,
+                .failures_per_component = fails_array + (u64)component_count * i,
+                .downtime_per_component = downtime_array + (u64)component_count * i,
+                };
+        memset(horizon->failures_per_component, 0, sizeof(*horizon->failures_per_component) * component_count);
+        memset(horizon->downtime_per_component, 0, sizeof(*horizon->downtime_per_component) * component_count);
+        for (u32 j = 0; j < state_count; ++j)
+        {
+            const horizon_sums* const sums = states[j].horizon + i;
+            horizon->total_flow += sums->flow;
+            horizon->total_costs += sums->cost;
+            horizon->total_maintenance_visits += sums->visits;
+            for (u32 k = 0; k < component_count; ++k)
+            {
+                horizon->failures_per_component[k] += sums->fails_per_component[k];
+                horizon->downtime_per_component[k] += sums->downtime_per_component[k];
+            }
+        }
+    }
+    *p_out = horizons;
+    RMOD_LEAVE_FUNCTION;
+    return RMOD_RESULT_SUCCESS;
+}
+
+//  Checks that horizons are increasing and fall before the end of the simulation
+static rmod_result check_horizons(const u32 horizon_count, const f32* const horizons, const f32 simulation_duration)
+{
+    for (u32 i = 0; i < horizon_count; ++i)
+    {
+        if (!(horizons[i] > 0.0f && horizons[i] < simulation_duration) || (i && horizons[i] <= horizons[i - 1]))
+        {
+            RMOD_ERROR("Horizons must be increasing and between 0 and simulation duration (%g), but horizon %u was %g", simulation_duration, i, horizons[i]);
+            return RMOD_RESULT_BAD_VALUE;
+        }
+    }
+    return RMOD_RESULT_SUCCESS;
+}
+
+//  Prepares states to find distributions of results over replications. Arrays are allocated by G_LIN_JALLOCATOR.
+static rmod_result prepare_distribution_states(const u32 state_count, simulation_state* const states)
+{
+    RMOD_ENTER_FUNCTION;
+    rmod_histogram* const histogram_array = lin_jalloc(G_LIN_JALLOCATOR, sizeof(*histogram_array) * DISTRIBUTION_COUNT * state_count);
+    if (!histogram_array)
+    {
+        RMOD_ERROR("Failed lin_jalloc(%p, %zu)", G_LIN_JALLOCATOR, sizeof(*histogram_array) * DISTRIBUTION_COUNT * state_count);
+        RMOD_LEAVE_FUNCTION;
+        return RMOD_RESULT_NOMEM;
+    }
+    for (u32 i = 0; i < DISTRIBUTION_COUNT * state_count; ++i)
+    {
+        rmod_histogram_clear(histogram_array + i);
+    }
+    for (u32 i = 0; i < state_count; ++i)
+    {
+        states[i].distributions = histogram_array + DISTRIBUTION_COUNT * i;
+    }
+    RMOD_LEAVE_FUNCTION;
+    return RMOD_RESULT_SUCCESS;
+}
+
+static void add_replication_distributions(simulation_state* const state, const f64 flow, const f64 cost, const u32 visits)
+{
+    rmod_histogram_add(state->distributions + DISTRIBUTION_FLOW, flow);
+    rmod_histogram_add(state->distributions + DISTRIBUTION_COST, cost);
+    rmod_histogram_add(state->distributions + DISTRIBUTION_VISITS, (f64)visits);
+    if (state->fatal_time != INFINITY)
+    {
+        rmod_histogram_add(state->distributions + DISTRIBUTION_FATAL_TIME, state->fatal_time);
+    }
+}
+
+//  Merges histograms of all states into the first one and finds distributions from them
+static void find_distributions(const u32 state_count, simulation_state* const states, rmod_sim_result* const p_res)
+{
+    rmod_sim_distribution* const outputs[DISTRIBUTION_COUNT] =
+            {
+            [DISTRIBUTION_FLOW] = &p_res->flow_distribution,
+            [DISTRIBUTION_COST] = &p_res->cost_distribution,
+            [DISTRIBUTION_VISITS] = &p_res->visits_distribution,
+            [DISTRIBUTION_FATAL_TIME] = &p_res->fatal_time_distribution,
+            };
+    for (u32 i = 0; i < DISTRIBUTION_COUNT; ++i)
+    {
+        rmod_histogram* const histogram = states[0].distributions + i;
+        for (u32 j = 1; j < state_count; ++j)
+        {
+            rmod_histogram_merge(histogram, states[j].distributions + i);
+        }
+        rmod_sim_distribution* const out = outputs[i];
+        out->count = histogram->count;
+        out->min = histogram->min;
+        out->max = histogram->max;
+        for (u32 j = 0; j < RMOD_SIM_PERCENTILE_COUNT; ++j)
+        {
+            out->percentiles[j] = rmod_histogram_quantile(histogram, RMOD_SIM_PERCENTILES[j] / 100.0);
+        }
+    }
+}
+
+//  Prepares states to use quasi-random numbers. Arrays are allocated by G_LIN_JALLOCATOR.
+static rmod_result prepare_qmc_states(const u32 state_count, simulation_state* const states)
+{
+    RMOD_ENTER_FUNCTION;
+    qmc_sums* const sums_array = lin_jalloc(G_LIN_JALLOCATOR, sizeof(*sums_array) * RMOD_QMC_RANDOMIZATIONS * state_count);
+    if (!sums_array)
+    {
+        RMOD_ERROR("Failed lin_jalloc(%p, %zu)", G_LIN_JALLOCATOR, sizeof(*sums_array) * RMOD_QMC_RANDOMIZATIONS * state_count);
+        RMOD_LEAVE_FUNCTION;
+        return RMOD_RESULT_NOMEM;
+    }
+    memset(sums_array, 0, sizeof(*sums_array) * RMOD_QMC_RANDOMIZATIONS * state_count);
+    for (u32 i = 0; i < state_count; ++i)
+    {
+        states[i].qmc_count = RMOD_QMC_DIMENSIONS;
+        states[i].qmc = sums_array + RMOD_QMC_RANDOMIZATIONS * i;
+    }
+    RMOD_LEAVE_FUNCTION;
+    return RMOD_RESULT_SUCCESS;
+}
+
+//  Prepares quasi-random numbers of the replication and the random stream which is used once they run out. Replication
+//  i uses point i / RMOD_QMC_RANDOMIZATIONS of randomization i % RMOD_QMC_RANDOMIZATIONS, so that any range of
+//  replications is spread evenly between randomizations.
+static void begin_qmc_replication(simulation_state* const state, rmod_msws_state* const rng, const u32 replication)
+{
+    const u32 randomization = replication % RMOD_QMC_RANDOMIZATIONS;
+    rmod_sobol_point(replication / RMOD_QMC_RANDOMIZATIONS, state->qmc_count, RMOD_QMC_SEED + randomization, state->qmc_point);
+    state->qmc_used = 0;
+    rmod_msws_init_keyed(rng, RMOD_QMC_SEED, replication);
+}
+
+static void end_qmc_replication(simulation_state* const state, const u32 replication, const f64 flow, const u32 visits, const f64 cost)
+{
+    qmc_sums* const sums = state->qmc + replication % RMOD_QMC_RANDOMIZATIONS;
+    sums->count += 1;
+    sums->flow += flow;
+    sums->visits += (f64)visits;
+    sums->cost += cost;
+}
+
+//  Finds errors of results from the spread of means of independent randomizations
+static void find_qmc_errors(const u32 state_count, const simulation_state* const states, rmod_sim_result* const p_res)
+{
+    f64 mean_sum[3] = {0}, mean_sq_sum[3] = {0};
+    u32 count = 0;
+    for (u32 i = 0; i < RMOD_QMC_RANDOMIZATIONS; ++i)
+    {
+        qmc_sums sums = {0};
+        for (u32 j = 0; j < state_count; ++j)
+        {
+            sums.count += states[j].qmc[i].count;
+            sums.flow += states[j].qmc[i].flow;
+            sums.visits += states[j].qmc[i].visits;
+            sums.cost += states[j].qmc[i].cost;
+        }
+        if (!sums.count)
+        {
+            continue;
+        }
+        const f64 means[3] = {sums.flow / (f64)sums.count, sums.visits / (f64)sums.count, sums.cost / (f64)sums.count};
+        for (u32 k = 0; k < 3; ++k)
+        {
+            mean_sum[k] += means[k];
+            mean_sq_sum[k] += means[k] * means[k];
+        }
+        count += 1;
+    }
+    f64 errors[3];
+    for (u32 k = 0; k < 3; ++k)
+    {
+        if (count < 2)
+        {
+            errors[k] = INFINITY;
+            continue;
+        }
+        const f64 mean = mean_sum[k] / (f64)count;
+        f64 variance = (mean_sq_sum[k] - mean * mean_sum[k]) / (f64)(count - 1);
+        if (variance < 0.0)
+        {
+            variance = 0.0;
+        }
+        errors[k] = RMOD_QMC_T_QUANTILE * sqrt(variance / (f64)count);
+    }
+    p_res->qmc_randomizations = count;
+    p_res->qmc_flow_error = errors[0];
+    p_res->qmc_visits_error = errors[1];
+    p_res->qmc_cost_error = errors[2];
+}
+
+//  Finds the estimate of a derivative and the half-width of its confidence interval from sums over n replications. Mean
+//  of the result is subtracted before multiplying by the score, which does not change the expected value, since that of
+//  the score is zero, but reduces the variance.
+static void find_derivative(
+        const f64 value_sum, const f64 score_sum, const f64 score_sq_sum, const f64 value_score_sum,
+        const f64 value_score_sq_sum, const f64 value_sq_score_sq_sum, const u64 n, f64* const p_derivative,
+        f64* const p_error)
+{
+    if (n < 2)
+    {
+        *p_derivative = 0.0;
+        *p_error = INFINITY;
+        return;
+    }
+    const f64 mean = value_sum / (f64)n;
+    const f64 derivative = (value_score_sum - mean * score_sum) / (f64)n;
+    //  Mean of squares of (value - mean) * score
+    const f64 mean_sq = (value_sq_score_sq_sum - 2.0 * mean * value_score_sq_sum + mean * mean * score_sq_sum) / (f64)n;
+    f64 variance = (mean_sq - derivative * derivative) * (f64)n / (f64)(n - 1);
+    if (variance < 0.0)
+    {
+        variance = 0.0;
+    }
+    *p_derivative = derivative;
+    *p_error = RMOD_CONFIDENCE_Z * sqrt(variance / (f64)n);
+}
+
+//  Merges sums of all states and finds derivatives for each type. The array is allocated by jalloc.
+static rmod_result find_sensitivities(
+        const simulation_parameters* const params, const u32 state_count, const simulation_state* const states,
+        const u64 n, rmod_sim_sensitivity** const p_out)
+{
+    RMOD_ENTER_FUNCTION;
+    const u32 type_count = params->type_count;
+    rmod_sim_sensitivity* const sensitivity = jalloc(sizeof(*sensitivity) * type_count);
+    if (!sensitivity)
+    {
+        RMOD_ERROR("Failed jalloc(%zu)", sizeof(*sensitivity) * type_count);
+        RMOD_LEAVE_FUNCTION;
+        return RMOD_RESULT_NOMEM;
+    }
+    f64 flow_sum = 0.0, cost_sum = 0.0;
+    for (u32 j = 0; j < state_count; ++j)
+    {
+        flow_sum += states[j].flow_sum;
+        cost_sum += states[j].cost_sum;
+    }
+    for (u32 i = 0; i < type_count; ++i)
+    {
+        sensitivity_sums sums = {0};
+        for (u32 j = 0; j < state_count; ++j)
+        {
+            const sensitivity_sums* const s = states[j].sensitivity + i;
+            sums.score += s->score;
+            sums.score_sq += s->score_sq;
+            sums.flow_score += s->flow_score;
+            sums.flow_score_sq += s->flow_score_sq;
+            sums.flow_sq_score_sq += s->flow_sq_score_sq;
+            sums.cost_score += s->cost_score;
+            sums.cost_score_sq += s->cost_score_sq;
+            sums.cost_sq_score_sq += s->cost_sq_score_sq;
+        }
+        rmod_sim_sensitivity* const out = sensitivity + i;
+        find_derivative(flow_sum, sums.score, sums.score_sq, sums.flow_score, sums.flow_score_sq, sums.flow_sq_score_sq, n, &out->flow, &out->flow_error);
+        find_derivative(cost_sum, sums.score, sums.score_sq, sums.cost_score, sums.cost_score_sq, sums.cost_sq_score_sq, n, &out->cost, &out->cost_error);
+    }
+    *p_out = sensitivity;
+    RMOD_LEAVE_FUNCTION;
+    return RMOD_RESULT_SUCCESS;
+}
+
+static inline void reset_simulation_state(const simulation_parameters* const params, simulation_state* const state)
+{
+    //  Reset status before simulation
+    for (u32 i = 0; i < params->node_count; ++i)
+    {
+        state->node_status[i] = RMOD_ELEMENT_STATUS_WORK;
+    }
+#ifndef NDEBUG
+    memset(state->time_component_was_downed, 0, sizeof(*state->time_component_was_downed) * params->node_count);
+#endif
+    state->next_horizon = 0;
+}
+
+rmod_result rmod_simulate_graph(
+        const rmod_graph* graph, f32 simulation_duration, u32 simulation_repetitions, rmod_sim_result* p_res_out,
+        f32 repair_limit, rmod_sim_flags flags, u32 profile_bin_count, u32 horizon_count, const f32* horizons)
+{
+    RMOD_ENTER_FUNCTION;
+    rmod_result res = RMOD_RESULT_SUCCESS;
+    void* const base = lin_jalloc_get_current(G_LIN_JALLOCATOR);
+    if ((res = check_horizons(horizon_count, horizons, simulation_duration)) != RMOD_RESULT_SUCCESS)
+    {
+        goto end;
+    }
+
+    simulation_parameters params;
+    if ((res = prepare_simulation_parameters(graph, simulation_duration, repair_limit, &params)) != RMOD_RESULT_SUCCESS)
+    {
+        RMOD_ERROR("Failed preparing simulation parameters, reason: %s", rmod_result_str(res));
+        goto end;
+    }
+    params.profile_bin_count = profile_bin_count;
+    params.profile_bin_width = (f64)simulation_duration / (f64)profile_bin_count;
+    params.horizon_count = horizon_count;
+    params.horizons = horizons;
+    simulation_state state;
+    if ((res = prepare_simulation_states(&params, 1, &state)) != RMOD_RESULT_SUCCESS)
+    {
+        RMOD_ERROR("Failed preparing simulation state, reason: %s", rmod_result_str(res));
+        goto end;
+    }
+    if ((flags & RMOD_SIM_FLAGS_SENSITIVITY) && (res = prepare_sensitivity_states(&params, 1, &state)) != RMOD_RESULT_SUCCESS)
+    {
+        RMOD_ERROR("Failed preparing sensitivity state, reason: %s", rmod_result_str(res));
+        goto end;
+    }
+    if ((flags & RMOD_SIM_FLAGS_QMC) && (res = prepare_qmc_states(1, &state)) != RMOD_RESULT_SUCCESS)
+    {
+        RMOD_ERROR("Failed preparing quasi-random state, reason: %s", rmod_result_str(res));
+        goto end;
+    }
+    if (profile_bin_count && (res = prepare_profile_states(&params, 1, &state)) != RMOD_RESULT_SUCCESS)
+    {
+        RMOD_ERROR("Failed preparing flow profile state, reason: %s", rmod_result_str(res));
+        goto end;
+    }
+    if (horizon_count && (res = prepare_horizon_states(&params, 1, &state)) != RMOD_RESULT_SUCCESS)
+    {
+        RMOD_ERROR("Failed preparing horizon state, reason: %s", rmod_result_str(res));
+        goto end;
+    }
+    if ((res = prepare_distribution_states(1, &state)) != RMOD_RESULT_SUCCESS)
+    {
+        RMOD_ERROR("Failed preparing distribution state, reason: %s", rmod_result_str(res));
+        goto end;
+    }
+    const u32 component_count = params.component_count;
+
+    u64* const fails_per_component = jalloc(sizeof(*fails_per_component) * component_count);
+    if (!fails_per_component)
+    {
+        RMOD_ERROR("Failed jalloc(%zu)", sizeof(*fails_per_component) * component_count);
+        res = RMOD_RESULT_NOMEM;
+        goto end;
+    }
+
+    f64* const downtime_per_component = jalloc(sizeof(*downtime_per_component) * component_count);
+    if (!downtime_per_component)
+    {
+        RMOD_ERROR("Failed jalloc(%zu)", sizeof(*downtime_per_component) * component_count);
+        jfree(fails_per_component);
+        res = RMOD_RESULT_NOMEM;
+        goto end;
+    }
+
+
+    //  Simulation records
+    rmod_sim_result results =
+            {
+            .total_maintenance_visits = 0,
+            .total_flow = 0,
+            .sim_count = 0,
+            .n_components = 0,
+            .total_costs = 0,
+            .duration = 0,
+            .failures_per_component = NULL,
+            .downtime_per_component = NULL,
+            .n_types = 0,
+            .sensitivity_per_type = NULL,
+            .profile_bin_count = 0,
+            .profile = NULL,
+            .horizon_count = 0,
+            .horizons = NULL,
+            };
+
+
+    rmod_msws_state rng;
     rmod_msws_init(&rng, 0, 0, 0, 0);
 #ifndef _WIN32
     struct timespec t_begin;
@@ -577,29 +1666,72 @@ rmod_result rmod_simulate_graph(
     fflush(stdout);
     for (u32 sim_i = 0; sim_i < simulation_repetitions; ++sim_i)
     {
-        if (sim_i == milestones[milestone])
+        if (milestone < N_MILESTONES && sim_i == milestones[milestone])
         {
             report_sim_progress((f64)milestone / N_MILESTONES, 40);
             milestone += 1;
         }
         f32 total_cost = 0.0f;
         u32 maintenance_count = 0;
-        //  Reset status before simulation
-        for (u32 i = 0; i < node_count; ++i)
+        reset_simulation_state(&params, &state);
+        if (state.qmc)
         {
-            node_status[i] = RMOD_ELEMENT_STATUS_WORK;
+            begin_qmc_replication(&state, &rng, sim_i);
         }
-
-#ifndef NDEBUG
-        memset(time_component_was_downed, 0, sizeof(*time_component_was_downed) * node_count);
-#endif
-        f32 total_throughput = run_simulation(simulation_duration, &rng, full_fail_rate, full_throughput, node_count, node_status, failure_rate, failure_type, time_component_was_downed, fails_per_component, downtime_per_component, parent_count, parent_ids, child_count, child_ids, effect, value, repair_limit, repair_time, cost, &maintenance_count, &total_cost);
-        results.total_flow += total_throughput;
+        f32 total_throughput = run_simulation(&params, &state, &rng, &maintenance_count, &total_cost);
+        if (state.score)
+        {
+            add_replication_sensitivity(&params, &state, (f64)total_throughput / (f64)simulation_duration, (f64)total_cost);
+        }
+        if (state.qmc)
+        {
+            end_qmc_replication(&state, sim_i, (f64)total_throughput / (f64)simulation_duration, maintenance_count, (f64)total_cost);
+        }
+        add_replication_distributions(&state, (f64)total_throughput / (f64)simulation_duration, (f64)total_cost, maintenance_count);
+        if (state.fatal_per_bin)
+        {
+            add_replication_fatal_time(&params, &state);
+        }
+        results.total_flow += (f64)total_throughput;
         results.total_maintenance_visits += maintenance_count;
         results.sim_count += 1;
-        results.total_costs += total_cost;
+        results.total_costs += (f64)total_cost;
+    }
+    if (state.score && (res = find_sensitivities(&params, 1, &state, simulation_repetitions, &results.sensitivity_per_type)) != RMOD_RESULT_SUCCESS)
+    {
+        RMOD_ERROR("Failed finding sensitivities, reason: %s", rmod_result_str(res));
+        jfree(downtime_per_component);
+        jfree(fails_per_component);
+        goto end;
+    }
+    results.n_types = results.sensitivity_per_type ? params.type_count : 0;
+    if (state.profile && (res = find_profile(&params, 1, &state, simulation_repetitions, &results.profile)) != RMOD_RESULT_SUCCESS)
+    {
+        RMOD_ERROR("Failed finding flow profile, reason: %s", rmod_result_str(res));
+        jfree(results.sensitivity_per_type);
+        jfree(downtime_per_component);
+        jfree(fails_per_component);
+        goto end;
+    }
+    results.profile_bin_count = results.profile ? profile_bin_count : 0;
+    if (state.horizon && (res = find_horizons(&params, 1, &state, simulation_repetitions, &results.horizons)) != RMOD_RESULT_SUCCESS)
+    {
+        RMOD_ERROR("Failed finding results at horizons, reason: %s", rmod_result_str(res));
+        jfree(results.profile);
+        jfree(results.sensitivity_per_type);
+        jfree(downtime_per_component);
+        jfree(fails_per_component);
+        goto end;
+    }
+    results.horizon_count = results.horizons ? horizon_count : 0;
+    if (state.qmc)
+    {
+        find_qmc_errors(1, &state, &results);
     }
-    results.n_components = node_count;
+    find_distributions(1, &state, &results);
+    memcpy(fails_per_component, state.fails_per_component, sizeof(*fails_per_component) * component_count);
+    memcpy(downtime_per_component, state.downtime_per_component, sizeof(*downtime_per_component) * component_count);
+    results.n_components = component_count;
     results.failures_per_component = fails_per_component;
     results.downtime_per_component = downtime_per_component;
     report_sim_progress(1.0, 40);
@@ -608,7 +1740,7 @@ rmod_result rmod_simulate_graph(
     time_res = clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &t_end);
     assert(time_res >= 0);
     results.duration = (f32)(t_end.tv_sec - t_begin.tv_sec);
-    results.max_flow = full_throughput;
+    results.max_flow = params.full_throughput;
     {
         f64 ns = (f64)(t_end.tv_nsec - t_begin.tv_nsec);
         results.duration += (f32)(ns / 1e9);
@@ -618,49 +1750,17 @@ rmod_result rmod_simulate_graph(
     QueryPerformanceCounter(&t_end);
     QueryPerformanceFrequency(&freq);
     results.duration = (f32)((f64)(t_end.QuadPart - t_begin.QuadPart) / (f64)freq.QuadPart);
-#endif
-    fprintf(stdout, "\nSimulation took in %g seconds of CPU time\n", results.duration);
-
-
-    lin_jfree(G_LIN_JALLOCATOR, node_status);
-    lin_jfree(G_LIN_JALLOCATOR, time_component_was_downed);
-    lin_jfree(G_LIN_JALLOCATOR, value);
-    lin_jfree(G_LIN_JALLOCATOR, child_ids);
-    lin_jfree(G_LIN_JALLOCATOR, child_count);
-    lin_jfree(G_LIN_JALLOCATOR, parent_ids);
-    lin_jfree(G_LIN_JALLOCATOR, parent_count);
-    lin_jfree(G_LIN_JALLOCATOR, failure_type);
-    lin_jfree(G_LIN_JALLOCATOR, effect);
-    lin_jfree(G_LIN_JALLOCATOR, cost);
-    lin_jfree(G_LIN_JALLOCATOR, repair_time);
-    lin_jfree(G_LIN_JALLOCATOR, failure_rate);
-
-    *p_res_out = results;
-
-end:
-    lin_jalloc_set_current(G_LIN_JALLOCATOR, base);
-    RMOD_LEAVE_FUNCTION;
-    return res;
-}
-
-typedef struct
-{
-    u32 node_count;
-    u32 reps_to_do;
-    f32 duration;
-    f32 repair_limit;
-    f32 full_fail_rate;
-    f32 full_throughput;
-    const f32* failure_rate;
-    const f32* cost;
-    const f32* effect;
-    const rmod_failure_type* failure_type;
-    const u32* parent_count;
-    const rmod_graph_node_id*const* parent_ids;
-    const u32* child_count;
-    const rmod_graph_node_id* const* child_ids;
-    const f32* repair_time;
-} simulation_parameters;
+    results.max_flow = params.full_throughput;
+#endif
+    fprintf(stdout, "\nSimulation took in %g seconds of CPU time\n", results.duration);
+
+    *p_res_out = results;
+
+end:
+    lin_jalloc_set_current(G_LIN_JALLOCATOR, base);
+    RMOD_LEAVE_FUNCTION;
+    return res;
+}
 
 typedef struct
 {
@@ -671,31 +1771,13 @@ typedef struct
     //  These are invariant (shared between threads)
     const simulation_parameters* sim_params;
     //  These are variable (thread specific)
-    f32* value;
-    rmod_element_status* node_status;
-    u64* fails_per_component;
-    f64* downtime_per_component;
-    f32* time_component_was_downed;
+    simulation_state* state;
 } graph_worker_information;
 
-static rmod_result simulate_worker(const simulation_parameters* params, rmod_msws_state* const rng, u32* const pi_sim, f32* const value, f32* const time_component_was_downed, rmod_element_status* const node_status, u64*const fails_per_component, f64*const downtime_per_component, rmod_sim_result* const p_res_out)
+static rmod_result simulate_worker(const simulation_parameters* params, rmod_msws_state* const rng, u32* const pi_sim, simulation_state* const state, rmod_sim_result* const p_res_out)
 {
     RMOD_ENTER_FUNCTION;
     const u32 reps_to_do = params->reps_to_do;
-    const f32 duration = params->duration;
-    const u32 node_count = params->node_count;
-    const f32* failure_rate = params->failure_rate;
-    const f32* cost = params->cost;
-    const f32* effect = params->effect;
-    const f32* repair_time = params->repair_time;
-    const rmod_failure_type* failure_type = params->failure_type;
-    const u32* parent_count = params->parent_count;
-    const rmod_graph_node_id*const* parent_ids = params->parent_ids;
-    const u32* child_count = params->child_count;
-    const rmod_graph_node_id*const* child_ids = params->child_ids;
-    const f32 repair_limit = params->repair_limit;
-    const f32 full_throughput = params->full_throughput;
-    const f32 full_fail_rate = params->full_fail_rate;
 
 
     rmod_sim_result results =
@@ -714,27 +1796,39 @@ static rmod_result simulate_worker(const simulation_parameters* params, rmod_msw
         *pi_sim = sim_i;
         f32 total_cost = 0.0f;
         u32 maintenance_count = 0;
-        //  Reset status before simulation
-        for (u32 i = 0; i < node_count; ++i)
+        reset_simulation_state(params, state);
+        if (state->qmc)
         {
-            node_status[i] = RMOD_ELEMENT_STATUS_WORK;
+            begin_qmc_replication(state, rng, state->first_replication + sim_i);
         }
-
-#ifndef NDEBUG
-        memset(time_component_was_downed, 0, sizeof(*time_component_was_downed) * node_count);
-#endif
-        f32 total_throughput = run_simulation(params->duration, rng, full_fail_rate, full_throughput, node_count, node_status, failure_rate, failure_type, time_component_was_downed, fails_per_component, downtime_per_component, parent_count, parent_ids, child_count, child_ids, effect, value, repair_limit, repair_time, cost, &maintenance_count, &total_cost);
-        results.total_flow += total_throughput;
+        f32 total_throughput = run_simulation(params, state, rng, &maintenance_count, &total_cost);
+        if (state->score)
+        {
+            add_replication_sensitivity(params, state, (f64)total_throughput / (f64)params->duration, (f64)total_cost);
+        }
+        if (state->qmc)
+        {
+            end_qmc_replication(state, state->first_replication + sim_i, (f64)total_throughput / (f64)params->duration, maintenance_count, (f64)total_cost);
+        }
+        if (state->distributions)
+        {
+            add_replication_distributions(state, (f64)total_throughput / (f64)params->duration, (f64)total_cost, maintenance_count);
+        }
+        if (state->fatal_per_bin)
+        {
+            add_replication_fatal_time(params, state);
+        }
+        results.total_flow += (f64)total_throughput;
         results.total_maintenance_visits += maintenance_count;
         results.sim_count += 1;
-        results.total_costs += total_cost;
+        results.total_costs += (f64)total_cost;
     }
     *pi_sim = sim_i;
-    results.failures_per_component = fails_per_component;
-    results.downtime_per_component = downtime_per_component;
-    results.duration = duration;
+    results.failures_per_component = state->fails_per_component;
+    results.downtime_per_component = state->downtime_per_component;
+    results.duration = params->duration;
     results.sim_count = reps_to_do;
-    results.n_components = node_count;
+    results.n_components = params->component_count;
 
     *p_res_out = results;
 
@@ -755,7 +1849,7 @@ static void* simulate_graph_worker_wrapper(void* param)
 #endif
                            4,16);
     RMOD_ENTER_FUNCTION;
-    rmod_result res = simulate_worker(worker_info->sim_params, worker_info->p_rng_state, worker_info->p_reps_done, worker_info->value, worker_info->time_component_was_downed, worker_info->node_status, worker_info->fails_per_component, worker_info->downtime_per_component, worker_info->p_sim_results);
+    rmod_result res = simulate_worker(worker_info->sim_params, worker_info->p_rng_state, worker_info->p_reps_done, worker_info->state, worker_info->p_sim_results);
     if (res != RMOD_RESULT_SUCCESS)
     {
         RMOD_ERROR("Worker simulation thread failed, reason: %s", rmod_result_str(res));
@@ -767,14 +1861,28 @@ static void* simulate_graph_worker_wrapper(void* param)
 
 rmod_result rmod_simulate_graph_mt(
         const rmod_graph* graph, f32 simulation_duration, u32 simulation_repetitions, rmod_sim_result* p_res_out,
-        u32 thread_count, f32 repair_limit)
+        u32 thread_count, f32 repair_limit, rmod_sim_flags flags, u32 profile_bin_count, u32 horizon_count,
+        const f32* horizons)
 {
     RMOD_ENTER_FUNCTION;
     void* const base = lin_jalloc_get_current(G_LIN_JALLOCATOR);
     rmod_result res = RMOD_RESULT_SUCCESS;
+    if ((res = check_horizons(horizon_count, horizons, simulation_duration)) != RMOD_RESULT_SUCCESS)
+    {
+        goto failed;
+    }
 
     //  Setup worker parameters and work
-    simulation_parameters sim_params = {};
+    simulation_parameters sim_params;
+    if ((res = prepare_simulation_parameters(graph, simulation_duration, repair_limit, &sim_params)) != RMOD_RESULT_SUCCESS)
+    {
+        RMOD_ERROR("Failed preparing simulation parameters, reason: %s", rmod_result_str(res));
+        goto failed;
+    }
+    sim_params.profile_bin_count = profile_bin_count;
+    sim_params.profile_bin_width = (f64)simulation_duration / (f64)profile_bin_count;
+    sim_params.horizon_count = horizon_count;
+    sim_params.horizons = horizons;
     sim_params.reps_to_do = simulation_repetitions / thread_count;
     if (simulation_repetitions % thread_count)
     {
@@ -784,117 +1892,7 @@ rmod_result rmod_simulate_graph_mt(
                 simulation_repetitions % thread_count);
         simulation_repetitions = sim_params.reps_to_do * thread_count;
     }
-    sim_params.duration = simulation_duration;
-    sim_params.repair_limit = repair_limit;
-
-    //      Reliability of each element
-    const u32 node_count = graph->node_count;
-    f32* const failure_rate = lin_jalloc(G_LIN_JALLOCATOR, sizeof(*failure_rate) * node_count);
-    if (!failure_rate)
-    {
-        RMOD_ERROR("Failed lin_jalloc(%p, %zu)", G_LIN_JALLOCATOR, sizeof(*failure_rate) * node_count);
-        res = RMOD_RESULT_NOMEM;
-        goto failed;
-    }
-
-    //      Cost of each element
-    f32* const cost = lin_jalloc(G_LIN_JALLOCATOR, sizeof(*cost) * node_count);
-    if (!cost)
-    {
-        RMOD_ERROR("Failed lin_jalloc(%p, %zu)", G_LIN_JALLOCATOR, sizeof(*cost) * node_count);
-        res = RMOD_RESULT_NOMEM;
-        goto failed;
-    }
-
-    //      Effect of each element
-    f32* const effect = lin_jalloc(G_LIN_JALLOCATOR, sizeof(*effect) * node_count);
-    if (!effect)
-    {
-        RMOD_ERROR("Failed lin_jalloc(%p, %zu)", G_LIN_JALLOCATOR, sizeof(*effect) * node_count);
-        res = RMOD_RESULT_NOMEM;
-        goto failed;
-    }
-
-    //      Effect of each element
-    f32* const repair_time = lin_jalloc(G_LIN_JALLOCATOR, sizeof(*repair_time) * node_count);
-    if (!repair_time)
-    {
-        RMOD_ERROR("Failed lin_jalloc(%p, %zu)", G_LIN_JALLOCATOR, sizeof(*repair_time) * node_count);
-        res = RMOD_RESULT_NOMEM;
-        goto failed;
-    }
-
-    //      Failure type of each element
-    rmod_failure_type* const failure_type = lin_jalloc(G_LIN_JALLOCATOR, sizeof(*failure_type) * node_count);
-    if (!failure_type)
-    {
-        RMOD_ERROR("Failed lin_jalloc(%p, %zu)", G_LIN_JALLOCATOR, sizeof(*failure_type) * node_count);
-        res = RMOD_RESULT_NOMEM;
-        goto failed;
-    }
-
-    //      Parent counts of each element
-    u32* const parent_count = lin_jalloc(G_LIN_JALLOCATOR, sizeof(*parent_count) * node_count);
-    if (!parent_count)
-    {
-        RMOD_ERROR("Failed lin_jalloc(%p, %zu)", G_LIN_JALLOCATOR, sizeof(*parent_count) * node_count);
-        res = RMOD_RESULT_NOMEM;
-        goto failed;
-    }
-
-    //      Parent arrays of each element
-    const rmod_graph_node_id** const parent_ids = lin_jalloc(G_LIN_JALLOCATOR, sizeof(*parent_ids) * node_count);
-    if (!parent_ids)
-    {
-        RMOD_ERROR("Failed lin_jalloc(%p, %zu)", G_LIN_JALLOCATOR, sizeof(*parent_ids) * node_count);
-        res = RMOD_RESULT_NOMEM;
-        goto failed;
-    }
-
-    //      Child counts of each element
-    u32* const child_count = lin_jalloc(G_LIN_JALLOCATOR, sizeof(*child_count) * node_count);
-    if (!child_count)
-    {
-        RMOD_ERROR("Failed lin_jalloc(%p, %zu)", G_LIN_JALLOCATOR, sizeof(*child_count) * node_count);
-        res = RMOD_RESULT_NOMEM;
-        goto failed;
-    }
-
-    //      Child arrays of each element
-    const rmod_graph_node_id** const child_ids = lin_jalloc(G_LIN_JALLOCATOR, sizeof(*child_ids) * node_count);
-    if (!child_ids)
-    {
-        RMOD_ERROR("Failed lin_jalloc(%p, %zu)", G_LIN_JALLOCATOR, sizeof(*child_ids) * node_count);
-        res = RMOD_RESULT_NOMEM;
-        goto failed;
-    }
-
-    //      Prepare invariant values (failure rates, cost, effect, failure, parent counts, and parent arrays)
-    for (u32 i = 0; i < node_count; ++i)
-    {
-        const rmod_graph_node* node = graph->node_list + i;
-        const rmod_graph_node_type* type = graph->type_list + node->type_id;
-        failure_rate[i] = type->failure_rate;
-        cost[i] = type->cost;
-        effect[i] = type->effect;
-        repair_time[i] = type->repair_time;
-        failure_type[i] = type->failure_type;
-        parent_count[i] = node->parent_count;
-        parent_ids[i] = node->parents;
-        child_count[i] = node->child_count;
-        child_ids[i] = node->children;
-    }
-
-    sim_params.node_count = node_count;
-    sim_params.failure_rate = failure_rate;
-    sim_params.effect = effect;
-    sim_params.repair_time = repair_time;
-    sim_params.parent_count = parent_count;
-    sim_params.parent_ids = parent_ids;
-    sim_params.child_count = child_count;
-    sim_params.child_ids = child_ids;
-    sim_params.failure_type = failure_type;
-    sim_params.cost = cost;
+    const u32 component_count = sim_params.component_count;
 
 
     //  Create workers and send them to work
@@ -936,49 +1934,47 @@ rmod_result rmod_simulate_graph_mt(
     }
     memset(result_array, 0, sizeof(*result_array) * thread_count);
 
-    f32* const value_array = lin_jalloc(G_LIN_JALLOCATOR, sizeof(*value_array) * node_count * thread_count);
-    if (!value_array)
+    simulation_state* const state_array = lin_jalloc(G_LIN_JALLOCATOR, sizeof(*state_array) * thread_count);
+    if (!state_array)
     {
-        RMOD_ERROR("Failed lin_jalloc(%p, %zu)", G_LIN_JALLOCATOR, sizeof(*value_array) * node_count * thread_count);
+        RMOD_ERROR("Failed lin_jalloc(%p, %zu)", G_LIN_JALLOCATOR, sizeof(*state_array) * thread_count);
         res = RMOD_RESULT_NOMEM;
         goto failed;
     }
-
-    f32* const downed_time_array = lin_jalloc(G_LIN_JALLOCATOR, sizeof(*downed_time_array) * node_count * thread_count);
-    if (!downed_time_array)
+    if ((res = prepare_simulation_states(&sim_params, thread_count, state_array)) != RMOD_RESULT_SUCCESS)
     {
-        RMOD_ERROR("Failed lin_jalloc(%p, %zu)", G_LIN_JALLOCATOR, sizeof(*downed_time_array) * node_count * thread_count);
-        res = RMOD_RESULT_NOMEM;
+        RMOD_ERROR("Failed preparing simulation states, reason: %s", rmod_result_str(res));
         goto failed;
     }
-
-    rmod_element_status* const element_status_array = lin_jalloc(
-            G_LIN_JALLOCATOR, sizeof(*element_status_array) * node_count * thread_count);
-    if (!element_status_array)
+    if ((flags & RMOD_SIM_FLAGS_SENSITIVITY) && (res = prepare_sensitivity_states(&sim_params, thread_count, state_array)) != RMOD_RESULT_SUCCESS)
     {
-        RMOD_ERROR("Failed lin_jalloc(%p, %zu)", G_LIN_JALLOCATOR,
-                   sizeof(*element_status_array) * node_count * thread_count);
-        res = RMOD_RESULT_NOMEM;
+        RMOD_ERROR("Failed preparing sensitivity states, reason: %s", rmod_result_str(res));
         goto failed;
     }
-
-    u64* const fails_array = lin_jalloc(G_LIN_JALLOCATOR, sizeof(*fails_array) * node_count * thread_count);
-    if (!fails_array)
+    if ((flags & RMOD_SIM_FLAGS_QMC) && (res = prepare_qmc_states(thread_count, state_array)) != RMOD_RESULT_SUCCESS)
     {
-        RMOD_ERROR("Failed lin_jalloc(%p, %zu)", G_LIN_JALLOCATOR, sizeof(*fails_array) * node_count * thread_count);
-        res = RMOD_RESULT_NOMEM;
+        RMOD_ERROR("Failed preparing quasi-random states, reason: %s", rmod_result_str(res));
         goto failed;
     }
-    memset(fails_array, 0, sizeof(*fails_array) * node_count * thread_count);
-
-    f64* const downtime_array = lin_jalloc(G_LIN_JALLOCATOR, sizeof(*downtime_array) * node_count * thread_count);
-    if (!downtime_array)
+    if (profile_bin_count && (res = prepare_profile_states(&sim_params, thread_count, state_array)) != RMOD_RESULT_SUCCESS)
     {
-        RMOD_ERROR("Failed lin_jalloc(%p, %zu)", G_LIN_JALLOCATOR, sizeof(*downtime_array) * node_count * thread_count);
-        res = RMOD_RESULT_NOMEM;
+        RMOD_ERROR("Failed preparing flow profile states, reason: %s", rmod_result_str(res));
         goto failed;
     }
-    memset(downtime_array, 0, sizeof(*downtime_array) * node_count * thread_count);
+    if (horizon_count && (res = prepare_horizon_states(&sim_params, thread_count, state_array)) != RMOD_RESULT_SUCCESS)
+    {
+        RMOD_ERROR("Failed preparing horizon states, reason: %s", rmod_result_str(res));
+        goto failed;
+    }
+    if ((res = prepare_distribution_states(thread_count, state_array)) != RMOD_RESULT_SUCCESS)
+    {
+        RMOD_ERROR("Failed preparing distribution states, reason: %s", rmod_result_str(res));
+        goto failed;
+    }
+    for (u32 i = 0; i < thread_count; ++i)
+    {
+        state_array[i].first_replication = sim_params.reps_to_do * i;
+    }
 
     for (u32 i = 0; i < thread_count; ++i)
     {
@@ -992,43 +1988,18 @@ rmod_result rmod_simulate_graph_mt(
                 rng_states_by_thread + i, rmod_msws_rng(&base_rng_state), rmod_msws_rng(&base_rng_state),
                 rmod_msws_rng(&base_rng_state), rmod_msws_rng(&base_rng_state));
         info_ptr->p_sim_results = result_array + i;
-        info_ptr->value = value_array + node_count * i;
-        info_ptr->value[0] = effect[0];
-        info_ptr->node_status = element_status_array + node_count * i;
-        info_ptr->fails_per_component = fails_array + node_count * i;
-        info_ptr->downtime_per_component = downtime_array + node_count * i;
-        info_ptr->time_component_was_downed = downed_time_array + node_count * i;
+        info_ptr->state = state_array + i;
     }
     pthread_t* const worker_id_array = lin_jalloc(G_LIN_JALLOCATOR, sizeof(*worker_id_array) * thread_count);
     if (!worker_id_array)
     {
         RMOD_ERROR("Failed lin_jalloc(%p, %zu)", G_LIN_JALLOCATOR,
-                   sizeof(*worker_id_array) * node_count * thread_count);
+                   sizeof(*worker_id_array) * thread_count);
         res = RMOD_RESULT_NOMEM;
         goto failed;
     }
     memset(worker_id_array, 0, sizeof(*worker_id_array) * thread_count);
 
-
-
-    f32 full_fail_rate = 0.0f;
-    value_array[0] = effect[0];
-    f32 full_throughput;
-    //  Reset status before simulation
-    for (u32 i = 0; i < node_count; ++i)
-    {
-        element_status_array[i] = RMOD_ELEMENT_STATUS_WORK;
-    }
-    if ((full_throughput = find_system_throughput(&full_fail_rate, node_count, element_status_array, parent_count, parent_ids, effect, value_array, failure_rate)) < repair_limit)
-    {
-        RMOD_ERROR("Maximum graph throughput was %g, however minimum value for repair was specified to be %g. This is most likely due to incorrect specification", full_throughput, repair_limit);
-        res = RMOD_RESULT_BAD_VALUE;
-        goto failed;
-    }
-
-    sim_params.full_fail_rate = full_fail_rate;
-    sim_params.full_throughput = full_throughput;
-
 #ifndef _WIN32
     struct timespec t_begin;
     int time_res = clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &t_begin);
@@ -1090,25 +2061,25 @@ rmod_result rmod_simulate_graph_mt(
     lin_jfree(G_LIN_JALLOCATOR, worker_id_array);
 
     //  Merge results
-    u64* const final_failures = jalloc(sizeof*final_failures * node_count);
+    u64* const final_failures = jalloc(sizeof*final_failures * component_count);
     if (!final_failures)
     {
-        RMOD_ERROR("Failed jalloc(%zu)", sizeof*final_failures * node_count);
+        RMOD_ERROR("Failed jalloc(%zu)", sizeof*final_failures * component_count);
         res = RMOD_RESULT_NOMEM;
         goto failed;
     }
-    f64* const final_downtimes = jalloc(sizeof*final_downtimes * node_count);
+    f64* const final_downtimes = jalloc(sizeof*final_downtimes * component_count);
     if (!final_downtimes)
     {
         jfree(final_failures);
-        RMOD_ERROR("Failed jalloc(%zu)", sizeof*final_downtimes * node_count);
+        RMOD_ERROR("Failed jalloc(%zu)", sizeof*final_downtimes * component_count);
         res = RMOD_RESULT_NOMEM;
         goto failed;
     }
     rmod_sim_result final_results =
             {
             .sim_count = simulation_repetitions,
-            .n_components = node_count,
+            .n_components = component_count,
 
             .total_flow = 0,
             .total_costs = 0,
@@ -1123,12 +2094,12 @@ rmod_result rmod_simulate_graph_mt(
             .duration = (f32)((f64)(t_end.QuadPart - t_begin.QuadPart) / (f64)freq.QuadPart),
 #endif
             };
-    memset(final_failures, 0, sizeof*final_failures * node_count);
-    memset(final_downtimes, 0, sizeof*final_downtimes * node_count);
+    memset(final_failures, 0, sizeof*final_failures * component_count);
+    memset(final_downtimes, 0, sizeof*final_downtimes * component_count);
     for (u32 i = 0; i < thread_count; ++i)
     {
         rmod_sim_result* const thrd_res = result_array + i;
-        for (u32 j = 0; j < node_count; ++j)
+        for (u32 j = 0; j < component_count; ++j)
         {
             final_failures[j] += thrd_res->failures_per_component[j];
             final_downtimes[j] += thrd_res->downtime_per_component[j];
@@ -1137,27 +2108,52 @@ rmod_result rmod_simulate_graph_mt(
         final_results.total_costs += thrd_res->total_costs;
         final_results.total_flow += thrd_res->total_flow;
     }
-    final_results.max_flow = full_throughput;
+    final_results.max_flow = sim_params.full_throughput;
+    if (flags & RMOD_SIM_FLAGS_QMC)
+    {
+        find_qmc_errors(thread_count, state_array, &final_results);
+    }
+    find_distributions(thread_count, state_array, &final_results);
+    if (flags & RMOD_SIM_FLAGS_SENSITIVITY)
+    {
+        if ((res = find_sensitivities(&sim_params, thread_count, state_array, simulation_repetitions, &final_results.sensitivity_per_type)) != RMOD_RESULT_SUCCESS)
+        {
+            RMOD_ERROR("Failed finding sensitivities, reason: %s", rmod_result_str(res));
+            jfree(final_downtimes);
+            jfree(final_failures);
+            goto failed;
+        }
+        final_results.n_types = sim_params.type_count;
+    }
+    if (profile_bin_count)
+    {
+        if ((res = find_profile(&sim_params, thread_count, state_array, simulation_repetitions, &final_results.profile)) != RMOD_RESULT_SUCCESS)
+        {
+            RMOD_ERROR("Failed finding flow profile, reason: %s", rmod_result_str(res));
+            jfree(final_results.sensitivity_per_type);
+            jfree(final_downtimes);
+            jfree(final_failures);
+            goto failed;
+        }
+        final_results.profile_bin_count = profile_bin_count;
+    }
+    if (horizon_count)
+    {
+        if ((res = find_horizons(&sim_params, thread_count, state_array, simulation_repetitions, &final_results.horizons)) != RMOD_RESULT_SUCCESS)
+        {
+            RMOD_ERROR("Failed finding results at horizons, reason: %s", rmod_result_str(res));
+            jfree(final_results.profile);
+            jfree(final_results.sensitivity_per_type);
+            jfree(final_downtimes);
+            jfree(final_failures);
+            goto failed;
+        }
+        final_results.horizon_count = horizon_count;
+    }
     fprintf(stdout, "\nSimulation took %g seconds of CPU time\n", final_results.duration);
 
-    lin_jfree(G_LIN_JALLOCATOR, downtime_array);
-    lin_jfree(G_LIN_JALLOCATOR, fails_array);
-    lin_jfree(G_LIN_JALLOCATOR, element_status_array);
-    lin_jfree(G_LIN_JALLOCATOR, downed_time_array);
-    lin_jfree(G_LIN_JALLOCATOR, value_array);
-    lin_jfree(G_LIN_JALLOCATOR, result_array);
-    lin_jfree(G_LIN_JALLOCATOR, rng_states_by_thread);
-    lin_jfree(G_LIN_JALLOCATOR, reps_done_by_workers);
-    lin_jfree(G_LIN_JALLOCATOR, worker_information);
-    lin_jfree(G_LIN_JALLOCATOR, child_ids);
-    lin_jfree(G_LIN_JALLOCATOR, child_count);
-    lin_jfree(G_LIN_JALLOCATOR, parent_ids);
-    lin_jfree(G_LIN_JALLOCATOR, parent_count);
-    lin_jfree(G_LIN_JALLOCATOR, failure_type);
-    lin_jfree(G_LIN_JALLOCATOR, effect);
-    lin_jfree(G_LIN_JALLOCATOR, cost);
-    lin_jfree(G_LIN_JALLOCATOR, failure_rate);
     //  Clean up
+    lin_jalloc_set_current(G_LIN_JALLOCATOR, base);
 
     //  Return finished results
     *p_res_out = final_results;
@@ -1169,3 +2165,341 @@ failed:
     RMOD_LEAVE_FUNCTION;
     return res;
 }
+
+//  Number of sweep points which are prepared and simulated at once, which bounds the memory needed for parameters
+#define RMOD_SWEEP_BATCH_SIZE 16
+//  Seed of random number streams of the sweep, each replication uses the stream keyed by its index
+#define RMOD_SWEEP_SEED 0x5eed5eed5eed5eed
+
+//  Sums over replications used to find confidence intervals of a point
+typedef struct sweep_sums_struct sweep_sums;
+struct sweep_sums_struct
+{
+    f64 flow, flow_sq;                      //  Sums of mean flows and their squares
+    f64 d_flow, d_flow_sq;                  //  Sums of differences of mean flow from the first point
+    f64 d_visits, d_visits_sq;              //  Sums of differences of maintenance visits from the first point
+    f64 d_cost, d_cost_sq;                  //  Sums of differences of cost from the first point
+};
+
+typedef struct sweep_context_struct sweep_context;
+struct sweep_context_struct
+{
+    const simulation_parameters* params;    //  Parameters of each point of the batch
+    u32 point_count;                        //  Number of points in the batch
+    bool has_first;                         //  Batch contains the first point of the sweep
+    const simulation_state* states;         //  State of each worker
+    u32 chunk_count;                        //  Number of tasks replications are split into
+    u32 reps_to_do;                         //  Number of repetitions of each point
+    f64* first_flow;                        //  Mean flow of the first point in each replication
+    u32* first_visits;                      //  Maintenance visits of the first point in each replication
+    f32* first_cost;                        //  Cost of the first point in each replication
+    u64* fails;                             //  Failures per component of each point of each task
+    f64* downtime;                          //  Downtime per component of each point of each task
+    rmod_sim_result* slot_results;          //  Results of each point of each task
+    sweep_sums* slot_sums;                  //  Sums of each point of each task
+};
+
+//  Processor time used by the calling thread in seconds
+static f64 sweep_thread_time(void)
+{
+#ifndef _WIN32
+    struct timespec t;
+    const int time_res = clock_gettime(CLOCK_THREAD_CPUTIME_ID, &t);
+    assert(time_res >= 0);
+    (void)time_res;
+    return (f64)t.tv_sec + (f64)t.tv_nsec / 1e9;
+#else
+    LARGE_INTEGER t, freq;
+    QueryPerformanceCounter(&t);
+    QueryPerformanceFrequency(&freq);
+    return (f64)t.QuadPart / (f64)freq.QuadPart;
+#endif
+}
+
+//  Each task simulates a range of replications for all points of the batch. Every point uses the same random stream
+//  for the same replication, so differences between points are not hidden by sampling noise.
+static rmod_result sweep_task(void* param, u32 worker_idx, u32 task_idx)
+{
+    const sweep_context* const ctx = param;
+    const u32 rep_begin = (u32)((u64)ctx->reps_to_do * task_idx / ctx->chunk_count);
+    const u32 rep_end = (u32)((u64)ctx->reps_to_do * (task_idx + 1) / ctx->chunk_count);
+    const u32 component_count = ctx->params[0].component_count;
+    f64 t_last = sweep_thread_time();
+
+    //  Workers keep their state buffers between tasks, but failures and downtime are counted separately for each point
+    simulation_state state = ctx->states[worker_idx];
+    for (u32 rep = rep_begin; rep < rep_end; ++rep)
+    {
+        for (u32 i = 0; i < ctx->point_count; ++i)
+        {
+            const simulation_parameters* const params = ctx->params + i;
+            const u32 slot = i * ctx->chunk_count + task_idx;
+            rmod_sim_result* const results = ctx->slot_results + slot;
+            sweep_sums* const sums = ctx->slot_sums + slot;
+            state.fails_per_component = ctx->fails + (u64)component_count * slot;
+            state.downtime_per_component = ctx->downtime + (u64)component_count * slot;
+            rmod_msws_state rng;
+            rmod_msws_init_keyed(&rng, RMOD_SWEEP_SEED, rep);
+            f32 total_cost = 0.0f;
+            u32 maintenance_count = 0;
+            reset_simulation_state(params, &state);
+            const f32 total_flow = run_simulation(params, &state, &rng, &maintenance_count, &total_cost);
+            //  Points are simulated interleaved, so each replication is timed on its own
+            const f64 t_now = sweep_thread_time();
+            results->duration += (f32)(t_now - t_last);
+            t_last = t_now;
+            results->total_flow += (f64)total_flow;
+            results->total_maintenance_visits += maintenance_count;
+            results->total_costs += (f64)total_cost;
+            results->sim_count += 1;
+
+            const f64 flow = (f64)total_flow / (f64)params->duration;
+            sums->flow += flow;
+            sums->flow_sq += flow * flow;
+            if (ctx->has_first && i == 0)
+            {
+                ctx->first_flow[rep] = flow;
+                ctx->first_visits[rep] = maintenance_count;
+                ctx->first_cost[rep] = total_cost;
+            }
+            const f64 d_flow = flow - ctx->first_flow[rep];
+            const f64 d_visits = (f64)maintenance_count - (f64)ctx->first_visits[rep];
+            const f64 d_cost = (f64)total_cost - (f64)ctx->first_cost[rep];
+            sums->d_flow += d_flow;
+            sums->d_flow_sq += d_flow * d_flow;
+            sums->d_visits += d_visits;
+            sums->d_visits_sq += d_visits * d_visits;
+            sums->d_cost += d_cost;
+            sums->d_cost_sq += d_cost * d_cost;
+        }
+    }
+    return RMOD_RESULT_SUCCESS;
+}
+
+rmod_result rmod_simulate_sweep(
+        const rmod_graph* graph, u32 point_count, const rmod_sweep_point* points, u32 simulation_repetitions,
+        u32 thread_count, rmod_sim_result* p_res_out, rmod_paired_difference* p_diff_out)
+{
+    RMOD_ENTER_FUNCTION;
+    void* const base = lin_jalloc_get_current(G_LIN_JALLOCATOR);
+    rmod_result res = RMOD_RESULT_SUCCESS;
+    const u32 component_count = graph->member_offsets ? graph->component_count : graph->node_count;
+    if (thread_count == 0)
+    {
+        thread_count = 1;
+    }
+    const u32 chunk_count = simulation_repetitions < thread_count ? (simulation_repetitions ? simulation_repetitions : 1) : thread_count;
+    const u32 batch_slots = RMOD_SWEEP_BATCH_SIZE * chunk_count;
+    u32 points_done = 0;
+    memset(p_res_out, 0, sizeof(*p_res_out) * point_count);
+    f64 first_flow_sum = 0.0, first_flow_sq = 0.0;
+
+    u64* const fails = jalloc(sizeof(*fails) * component_count * batch_slots);
+    f64* const downtime = jalloc(sizeof(*downtime) * component_count * batch_slots);
+    f64* const first_flow = jalloc(sizeof(*first_flow) * simulation_repetitions);
+    u32* const first_visits = jalloc(sizeof(*first_visits) * simulation_repetitions);
+    f32* const first_cost = jalloc(sizeof(*first_cost) * simulation_repetitions);
+    if (!fails || !downtime || !first_flow || !first_visits || !first_cost)
+    {
+        RMOD_ERROR("Failed allocating %zu bytes for counts of the sweep",
+                   (sizeof(*fails) + sizeof(*downtime)) * component_count * batch_slots
+                   + (sizeof(*first_flow) + sizeof(*first_visits) + sizeof(*first_cost)) * simulation_repetitions);
+        res = RMOD_RESULT_NOMEM;
+        goto failed;
+    }
+
+    rmod_graph patched = *graph;
+    //  Changed component gets its own copy of its type, which is placed after all others
+    rmod_graph_node_type* const types = lin_jalloc(G_LIN_JALLOCATOR, sizeof(*types) * (graph->type_count + 1));
+    rmod_graph_node* const nodes = lin_jalloc(G_LIN_JALLOCATOR, sizeof(*nodes) * graph->node_count);
+    simulation_parameters* const params = lin_jalloc(G_LIN_JALLOCATOR, sizeof(*params) * RMOD_SWEEP_BATCH_SIZE);
+    simulation_state* const states = lin_jalloc(G_LIN_JALLOCATOR, sizeof(*states) * thread_count);
+    rmod_sim_result* const slot_results = lin_jalloc(G_LIN_JALLOCATOR, sizeof(*slot_results) * batch_slots);
+    sweep_sums* const slot_sums = lin_jalloc(G_LIN_JALLOCATOR, sizeof(*slot_sums) * batch_slots);
+    if (!types || !nodes || !params || !states || !slot_results || !slot_sums)
+    {
+        RMOD_ERROR("Failed allocating %zu bytes for parameters of the sweep from lin_jallocator %p",
+                   sizeof(*types) * (graph->type_count + 1) + sizeof(*nodes) * graph->node_count
+                   + sizeof(*params) * RMOD_SWEEP_BATCH_SIZE + sizeof(*states) * thread_count
+                   + (sizeof(*slot_results) + sizeof(*slot_sums)) * batch_slots, G_LIN_JALLOCATOR);
+        res = RMOD_RESULT_NOMEM;
+        goto failed;
+    }
+    patched.type_list = types;
+    patched.node_list = nodes;
+    memcpy(nodes, graph->node_list, sizeof(*nodes) * graph->node_count);
+    void* const batch_base = lin_jalloc_get_current(G_LIN_JALLOCATOR);
+
+    while (points_done < point_count)
+    {
+        const u32 batch_count = point_count - points_done < RMOD_SWEEP_BATCH_SIZE ? point_count - points_done : RMOD_SWEEP_BATCH_SIZE;
+        for (u32 i = 0; i < batch_count; ++i)
+        {
+            const rmod_sweep_point* const point = points + points_done + i;
+            for (u32 j = 0; j < graph->type_count; ++j)
+            {
+                types[j] = point->types ? point->types[j] : graph->type_list[j];
+                types[j].failure_rate /= point->mtbf_scale;
+            }
+            patched.type_count = graph->type_count;
+            if (point->change != RMOD_SWEEP_CHANGE_NONE)
+            {
+                if (graph->member_offsets || point->component >= graph->node_count)
+                {
+                    RMOD_ERROR("Component %u of point %u of the sweep can not be changed", point->component, points_done + i);
+                    res = RMOD_RESULT_BAD_VALUE;
+                    goto failed;
+                }
+                rmod_graph_node_type* const changed = types + graph->type_count;
+                *changed = types[graph->node_list[point->component].type_id];
+                changed->failure_rate = 0.0f;
+                if (point->change == RMOD_SWEEP_CHANGE_REMOVED)
+                {
+                    changed->effect = 0.0f;
+                }
+                nodes[point->component].type_id = graph->type_count;
+                patched.type_count += 1;
+            }
+            //  Graph with a component removed or with different types may never reach the repair limit, in which case
+            //  every failure is followed by maintenance
+            const f32 checked_limit = point->change == RMOD_SWEEP_CHANGE_REMOVED || point->types ? 0.0f : point->repair_limit;
+            res = prepare_simulation_parameters(&patched, point->simulation_duration, checked_limit, params + i);
+            if (point->change != RMOD_SWEEP_CHANGE_NONE)
+            {
+                nodes[point->component].type_id = graph->node_list[point->component].type_id;
+            }
+            if (res != RMOD_RESULT_SUCCESS)
+            {
+                RMOD_ERROR("Failed preparing simulation parameters for point %u of the sweep, reason: %s", points_done + i, rmod_result_str(res));
+                goto failed;
+            }
+            params[i].repair_limit = point->repair_limit;
+        }
+        //  States only depend on the structure of the graph, so they are shared by all points
+        if ((res = prepare_simulation_states(params, thread_count, states)) != RMOD_RESULT_SUCCESS)
+        {
+            RMOD_ERROR("Failed preparing simulation states, reason: %s", rmod_result_str(res));
+            goto failed;
+        }
+        const u32 slot_count = batch_count * chunk_count;
+        memset(fails, 0, sizeof(*fails) * component_count * slot_count);
+        memset(downtime, 0, sizeof(*downtime) * component_count * slot_count);
+        memset(slot_results, 0, sizeof(*slot_results) * slot_count);
+        memset(slot_sums, 0, sizeof(*slot_sums) * slot_count);
+
+        sweep_context ctx =
+                {
+                .params = params,
+                .point_count = batch_count,
+                .has_first = points_done == 0,
+                .states = states,
+                .chunk_count = chunk_count,
+                .reps_to_do = simulation_repetitions,
+                .first_flow = first_flow,
+                .first_visits = first_visits,
+                .first_cost = first_cost,
+                .fails = fails,
+                .downtime = downtime,
+                .slot_results = slot_results,
+                .slot_sums = slot_sums,
+                };
+        if ((res = rmod_parallel_run(thread_count, chunk_count, sweep_task, &ctx, "sweep")) != RMOD_RESULT_SUCCESS)
+        {
+            RMOD_ERROR("Failed simulating points of the sweep, reason: %s", rmod_result_str(res));
+            goto failed;
+        }
+
+        //  Merge results of tasks of each point
+        for (u32 i = 0; i < batch_count; ++i)
+        {
+            rmod_sim_result* const results = p_res_out + points_done + i;
+            results->failures_per_component = jalloc(sizeof(*results->failures_per_component) * component_count);
+            results->downtime_per_component = jalloc(sizeof(*results->downtime_per_component) * component_count);
+            if (!results->failures_per_component || !results->downtime_per_component)
+            {
+                RMOD_ERROR("Failed allocating %zu bytes for counts per component of point %u of the sweep",
+                           (sizeof(*results->failures_per_component) + sizeof(*results->downtime_per_component)) * component_count, points_done + i);
+                res = RMOD_RESULT_NOMEM;
+                points_done += i + 1;
+                goto failed;
+            }
+            memset(results->failures_per_component, 0, sizeof(*results->failures_per_component) * component_count);
+            memset(results->downtime_per_component, 0, sizeof(*results->downtime_per_component) * component_count);
+            results->n_components = component_count;
+            results->max_flow = params[i].full_throughput;
+            sweep_sums sums = {0};
+            for (u32 j = 0; j < chunk_count; ++j)
+            {
+                const u32 slot = i * chunk_count + j;
+                const rmod_sim_result* const slot_result = slot_results + slot;
+                for (u32 k = 0; k < component_count; ++k)
+                {
+                    results->failures_per_component[k] += fails[(u64)component_count * slot + k];
+                    results->downtime_per_component[k] += downtime[(u64)component_count * slot + k];
+                }
+                results->sim_count += slot_result->sim_count;
+                results->total_flow += slot_result->total_flow;
+                results->total_maintenance_visits += slot_result->total_maintenance_visits;
+                results->total_costs += slot_result->total_costs;
+                results->duration += slot_result->duration;
+                sums.flow += slot_sums[slot].flow;
+                sums.flow_sq += slot_sums[slot].flow_sq;
+                sums.d_flow += slot_sums[slot].d_flow;
+                sums.d_flow_sq += slot_sums[slot].d_flow_sq;
+                sums.d_visits += slot_sums[slot].d_visits;
+                sums.d_visits_sq += slot_sums[slot].d_visits_sq;
+                sums.d_cost += slot_sums[slot].d_cost;
+                sums.d_cost_sq += slot_sums[slot].d_cost_sq;
+            }
+            if (points_done + i == 0)
+            {
+                first_flow_sum = sums.flow;
+                first_flow_sq = sums.flow_sq;
+            }
+            if (!p_diff_out)
+            {
+                continue;
+            }
+            //  Interval of the unpaired difference shows how much is gained by using the same streams
+            const u64 n = results->sim_count;
+            const f64 first_half_width = confidence_half_width(first_flow_sum, first_flow_sq, n);
+            const f64 half_width = confidence_half_width(sums.flow, sums.flow_sq, n);
+            p_diff_out[points_done + i] = (rmod_paired_difference)
+                    {
+                    .flow = sums.d_flow / (f64)n,
+                    .flow_error = confidence_half_width(sums.d_flow, sums.d_flow_sq, n),
+                    .flow_error_independent = sqrt(first_half_width * first_half_width + half_width * half_width),
+                    .visits = sums.d_visits / (f64)n,
+                    .visits_error = confidence_half_width(sums.d_visits, sums.d_visits_sq, n),
+                    .cost = sums.d_cost / (f64)n,
+                    .cost_error = confidence_half_width(sums.d_cost, sums.d_cost_sq, n),
+                    };
+        }
+        points_done += batch_count;
+        lin_jalloc_set_current(G_LIN_JALLOCATOR, batch_base);
+    }
+
+    jfree(first_cost);
+    jfree(first_visits);
+    jfree(first_flow);
+    jfree(downtime);
+    jfree(fails);
+    lin_jalloc_set_current(G_LIN_JALLOCATOR, base);
+    RMOD_LEAVE_FUNCTION;
+    return RMOD_RESULT_SUCCESS;
+
+failed:
+    for (u32 i = 0; i < points_done; ++i)
+    {
+        jfree(p_res_out[i].failures_per_component);
+        jfree(p_res_out[i].downtime_per_component);
+    }
+    jfree(first_cost);
+    jfree(first_visits);
+    jfree(first_flow);
+    jfree(downtime);
+    jfree(fails);
+    lin_jalloc_set_current(G_LIN_JALLOCATOR, base);
+    RMOD_LEAVE_FUNCTION;
+    return res;
+}
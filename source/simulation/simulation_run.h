@@ -17,26 +17,155 @@ enum rmod_element_status_enum
                                         //  on or which it provides for are not working anymore
 };
 
+//  Likelihood ratio (score function) estimates of derivatives of results with respect to failure rate of a type. Errors
+//  are half-widths of 95% confidence intervals.
+typedef struct rmod_sim_sensitivity_struct rmod_sim_sensitivity;
+struct rmod_sim_sensitivity_struct
+{
+    f64 flow;                           //  Derivative of mean flow
+    f64 flow_error;
+    f64 cost;                           //  Derivative of costs
+    f64 cost_error;
+};
+
+//  Results of replications up to a horizon earlier than the end of the simulation. Failures, costs, and downtime only
+//  include repairs which were finished before it, same as for the whole simulation.
+typedef struct rmod_sim_horizon_struct rmod_sim_horizon;
+struct rmod_sim_horizon_struct
+{
+    f32 time;
+    u64 sim_count;
+    f64 total_flow;
+    f64 total_costs;
+    u64 total_maintenance_visits;
+    u64* failures_per_component;
+    f64* downtime_per_component;
+};
+
+//  Percentiles of results of individual replications which are reported
+#define RMOD_SIM_PERCENTILE_COUNT 3
+extern const f64 RMOD_SIM_PERCENTILES[RMOD_SIM_PERCENTILE_COUNT];
+
+//  Distribution of a result over replications, with percentiles found from a histogram over the range of its values
+typedef struct rmod_sim_distribution_struct rmod_sim_distribution;
+struct rmod_sim_distribution_struct
+{
+    u64 count;                          //  Number of replications which had the result
+    f64 min;
+    f64 max;
+    f64 percentiles[RMOD_SIM_PERCENTILE_COUNT];
+};
+
+//  Results in a bin of simulation time. Reliability is the binned Kaplan-Meier estimate of probability that no fatal
+//  failure happened before the end of the bin, with replications censored at the end of the simulation. Its bounds are
+//  those of the 95% confidence interval, found from Greenwood's variance on the log(-log) scale.
+typedef struct rmod_sim_profile_bin_struct rmod_sim_profile_bin;
+struct rmod_sim_profile_bin_struct
+{
+    f64 flow;                           //  Mean flow during the bin
+    u64 fatal_count;                    //  Number of replications which ended by a fatal failure during the bin
+    f64 reliability;
+    f64 reliability_lower;
+    f64 reliability_upper;
+};
+
 typedef struct rmod_sim_result_struct rmod_sim_result;
 struct rmod_sim_result_struct
 {
     u64 sim_count;
-    f32 total_flow;
+    f64 total_flow;
     f32 max_flow;
     u64 total_maintenance_visits;
-    f32 total_costs;
+    f64 total_costs;
     f32 duration;
     u32 n_components;
     u64* failures_per_component;
     f64* downtime_per_component;
+    u32 n_types;
+    rmod_sim_sensitivity* sensitivity_per_type;     //  NULL if derivatives were not found
+    //  Half-widths of 95% confidence intervals found from independent randomizations of quasi-random numbers
+    u32 qmc_randomizations;                         //  0 if quasi-random numbers were not used
+    f64 qmc_flow_error;
+    f64 qmc_visits_error;
+    f64 qmc_cost_error;
+    u32 profile_bin_count;
+    rmod_sim_profile_bin* profile;                  //  Each equal bin of simulation time, NULL if not found
+    u32 horizon_count;
+    rmod_sim_horizon* horizons;                     //  Single allocation, NULL if there were no horizons
+    //  Distributions of results of replications
+    rmod_sim_distribution flow_distribution;        //  Mean flow
+    rmod_sim_distribution cost_distribution;
+    rmod_sim_distribution visits_distribution;
+    rmod_sim_distribution fatal_time_distribution;  //  Time of the fatal failure, only of replications which had one
+};
+
+typedef enum rmod_sim_flags_enum rmod_sim_flags;
+enum rmod_sim_flags_enum
+{
+    RMOD_SIM_FLAGS_NONE = 0,
+    //  Estimate derivatives with respect to failure rate of each type from the same replications, by weighting their
+    //  results with the derivative of their log-likelihood
+    RMOD_SIM_FLAGS_SENSITIVITY = 1 << 0,
+    //  Take the first random numbers of each replication from a scrambled Sobol sequence indexed by the replication,
+    //  which are split between independent randomizations to estimate the error
+    RMOD_SIM_FLAGS_QMC = 1 << 1,
 };
 
+//  Simulates the graph with the given number of replications. If profile_bin_count is not zero, mean flow is also found
+//  in each of that many equal bins of simulation time, along with reliability at its end, from the same replications. Results are also recorded when each
+//  replication crosses each of the horizons, which must be increasing and shorter than the simulation duration.
 rmod_result rmod_simulate_graph(
         const rmod_graph* graph, f32 simulation_duration, u32 simulation_repetitions, rmod_sim_result* p_res_out,
-        f32 repair_limit);
+        f32 repair_limit, rmod_sim_flags flags, u32 profile_bin_count, u32 horizon_count, const f32* horizons);
 
 rmod_result rmod_simulate_graph_mt(
         const rmod_graph* graph, f32 simulation_duration, u32 simulation_repetitions, rmod_sim_result* p_res_out,
-        u32 thread_count, f32 repair_limit);
+        u32 thread_count, f32 repair_limit, rmod_sim_flags flags, u32 profile_bin_count, u32 horizon_count,
+        const f32* horizons);
+
+//  Change made to a single component of the graph for a point of a sweep
+typedef enum rmod_sweep_change_enum rmod_sweep_change;
+enum rmod_sweep_change_enum
+{
+    RMOD_SWEEP_CHANGE_NONE = 0,
+    RMOD_SWEEP_CHANGE_PERFECT,          //  Component never fails
+    RMOD_SWEEP_CHANGE_REMOVED,          //  Component never fails and provides no flow, repair limit is not checked
+};
+
+//  Parameters of a single point of a parameter sweep
+typedef struct rmod_sweep_point_struct rmod_sweep_point;
+struct rmod_sweep_point_struct
+{
+    f32 simulation_duration;
+    f32 repair_limit;
+    f32 mtbf_scale;                     //  Factor which mean time between failures of every type is multiplied by
+    rmod_sweep_change change;           //  Change made to the component, only possible for graphs which were not reduced
+    u32 component;                      //  Node which is changed
+    const rmod_graph_node_type* types;  //  Types which replace those of the graph, NULL to keep them, repair limit
+                                        //  is not checked if they are replaced
+};
+
+//  Difference of a point of the sweep from the first point, paired by replication. Errors are half-widths of 95%
+//  confidence intervals.
+typedef struct rmod_paired_difference_struct rmod_paired_difference;
+struct rmod_paired_difference_struct
+{
+    f64 flow;                           //  Difference of mean flow
+    f64 flow_error;
+    f64 flow_error_independent;         //  Error the difference of mean flow would have if runs were independent
+    f64 visits;                         //  Difference of maintenance visits
+    f64 visits_error;
+    f64 cost;                           //  Difference of costs
+    f64 cost_error;
+};
+
+//  Simulates the graph for each point of the sweep. Replications are split between thread_count tasks, each of which
+//  simulates its replications for all points, with replication i of every point using the same random stream keyed
+//  by i (common random numbers). Types of the graph are patched for each point, so the graph is compiled only once.
+//  Results of each point are written to p_res_out, and their arrays have to be freed by the caller. If p_diff_out is
+//  not NULL, differences of each point from the first are written to it.
+rmod_result rmod_simulate_sweep(
+        const rmod_graph* graph, u32 point_count, const rmod_sweep_point* points, u32 simulation_repetitions,
+        u32 thread_count, rmod_sim_result* p_res_out, rmod_paired_difference* p_diff_out);
 
 #endif //RMOD_SIMULATION_RUN_H
@@ -0,0 +1,147 @@
+//
+// Created by jan on 19.10.2026.
+//
+#include "simulation_run.h"
+#include "reduce.h"
+
+//  Checks failures which must exclude each other in every replication, so counts of failures are exact whatever random
+//  numbers are drawn, both for graphs simulated as they are and after series reduction
+
+#define ASSERT(x) if ((x) == false) {fprintf(stderr, "Failed assertion: \"" #x "\"\n"); __builtin_trap(); exit(EXIT_FAILURE);} (void)0
+#define N_REPLICATIONS 2000
+#define DURATION 100.0f
+#define MAX_NODES 8
+
+typedef struct test_graph_struct test_graph;
+struct test_graph_struct
+{
+    rmod_graph graph;
+    rmod_graph_node nodes[MAX_NODES];
+    rmod_graph_node_id children[MAX_NODES][MAX_NODES];
+    rmod_graph_node_id parents[MAX_NODES][MAX_NODES];
+};
+
+static void add_edge(test_graph* const g, const u32 parent, const u32 child)
+{
+    rmod_graph_node* const p = g->nodes + parent;
+    rmod_graph_node* const c = g->nodes + child;
+    p->children[p->child_count++] = child;
+    c->parents[c->parent_count++] = parent;
+}
+
+//  Nodes must be given in the order of flow, where every parent comes before its children
+static void make_graph(
+        test_graph* const g, const u32 node_count, const rmod_graph_type_id* const node_types, const u32 type_count,
+        rmod_graph_node_type* const types, const u32 edge_count, const u32 (* const edges)[2])
+{
+    memset(g, 0, sizeof(*g));
+    ASSERT(node_count <= MAX_NODES);
+    for (u32 i = 0; i < node_count; ++i)
+    {
+        g->nodes[i] = (rmod_graph_node){.type_id = node_types[i], .children = g->children[i], .parents = g->parents[i]};
+    }
+    for (u32 i = 0; i < edge_count; ++i)
+    {
+        add_edge(g, edges[i][0], edges[i][1]);
+    }
+    g->graph.module_name = (c8*)"simulation test";
+    g->graph.graph_type = (c8*)"test chain";
+    g->graph.node_count = node_count;
+    g->graph.node_list = g->nodes;
+    g->graph.type_count = type_count;
+    g->graph.type_list = types;
+}
+
+static void simulate(const rmod_graph* const graph, rmod_sim_result* const p_res)
+{
+    ASSERT(rmod_simulate_graph(graph, DURATION, N_REPLICATIONS, p_res, 0.0f, RMOD_SIM_FLAGS_NONE, 0, 0, NULL) == RMOD_RESULT_SUCCESS);
+    ASSERT(p_res->sim_count == N_REPLICATIONS);
+}
+
+static void release_result(rmod_sim_result* const res)
+{
+    jfree(res->failures_per_component);
+    jfree(res->downtime_per_component);
+    jfree(res->sensitivity_per_type);
+    jfree(res->profile);
+    jfree(res->horizons);
+}
+
+//  Node 0 feeds two strings, 1-3 and 2-4, which both feed node 5. Only nodes of the first string fail, and each of them
+//  leaves the other with nothing to work for, so exactly one of them fails in every replication. No failure needs
+//  maintenance, since the other string still works.
+static void check_deactivated_string(void)
+{
+    rmod_graph_node_type types[2] =
+            {
+            {.name = (c8*)"still", .failure_rate = 0.0f, .repair_time = 1.0f, .effect = 1.0f, .failure_type = RMOD_FAILURE_TYPE_ACCEPTABLE},
+            {.name = (c8*)"weak", .failure_rate = 10.0f, .repair_time = 1.0f, .effect = 1.0f, .failure_type = RMOD_FAILURE_TYPE_ACCEPTABLE},
+            };
+    const rmod_graph_type_id node_types[6] = {0, 1, 0, 1, 0, 0};
+    const u32 edges[6][2] = {{0, 1}, {0, 2}, {1, 3}, {2, 4}, {3, 5}, {4, 5}};
+    test_graph g;
+    make_graph(&g, 6, node_types, 2, types, 6, edges);
+
+    rmod_sim_result res;
+    simulate(&g.graph, &res);
+    ASSERT(res.failures_per_component[1] + res.failures_per_component[3] == N_REPLICATIONS);
+    ASSERT(res.failures_per_component[0] == 0 && res.failures_per_component[2] == 0);
+    ASSERT(res.failures_per_component[4] == 0 && res.failures_per_component[5] == 0);
+    ASSERT(res.total_maintenance_visits == 0);
+    release_result(&res);
+
+    //  Reduced graph must give the same, with failures attributed to nodes of the original graph
+    rmod_graph reduced;
+    ASSERT(rmod_reduce_graph(&g.graph, &reduced) == RMOD_RESULT_SUCCESS);
+    ASSERT(reduced.node_count < g.graph.node_count);
+    simulate(&reduced, &res);
+    ASSERT(res.n_components == 6);
+    ASSERT(res.failures_per_component[1] + res.failures_per_component[3] == N_REPLICATIONS);
+    ASSERT(res.total_maintenance_visits == 0);
+    release_result(&res);
+    rmod_destroy_graph(&reduced);
+}
+
+//  Node 0 feeds nodes 1 and 2 in parallel, which both feed node 3. Failure of node 1 needs maintenance, which comes long
+//  after the end of the simulation, and node 2 still works while it is waited for. Node 2 fails with certainty before
+//  the end, either before node 1 or while waiting, and its failure is fatal, so it must end every replication.
+static void check_fatal_while_waiting(void)
+{
+    rmod_graph_node_type types[3] =
+            {
+            {.name = (c8*)"still", .failure_rate = 0.0f, .repair_time = 1.0f, .effect = 1.0f, .failure_type = RMOD_FAILURE_TYPE_ACCEPTABLE},
+            {.name = (c8*)"critical", .failure_rate = 10.0f, .repair_time = 1e6f, .effect = 1.0f, .failure_type = RMOD_FAILURE_TYPE_CRITICAL},
+            {.name = (c8*)"fatal", .failure_rate = 1.0f, .repair_time = 1.0f, .effect = 1.0f, .failure_type = RMOD_FAILURE_TYPE_FATAL},
+            };
+    const rmod_graph_type_id node_types[4] = {0, 1, 2, 0};
+    const u32 edges[4][2] = {{0, 1}, {0, 2}, {1, 3}, {2, 3}};
+    test_graph g;
+    make_graph(&g, 4, node_types, 3, types, 4, edges);
+
+    rmod_sim_result res;
+    simulate(&g.graph, &res);
+    ASSERT(res.failures_per_component[2] == N_REPLICATIONS);
+    ASSERT(res.fatal_time_distribution.count == N_REPLICATIONS);
+    //  Node 1 failed first in most replications, so the fatal failure mostly happened while waiting
+    ASSERT(res.failures_per_component[1] > N_REPLICATIONS / 2);
+    ASSERT(res.total_maintenance_visits == 0);
+    release_result(&res);
+}
+
+int main()
+{
+    G_JALLOCATOR = jallocator_create((1 << 20), (1 << 19), 1);
+    ASSERT(G_JALLOCATOR);
+    G_LIN_JALLOCATOR = lin_jallocator_create((1 << 20));
+    ASSERT(G_LIN_JALLOCATOR);
+    rmod_error_init_thread("simulation test", RMOD_ERROR_LEVEL_NONE, 32, 32);
+
+    check_deactivated_string();
+    check_fatal_while_waiting();
+    printf("Failures which exclude each other did so in every replication\n");
+
+    rmod_error_cleanup_thread();
+    lin_jallocator_destroy(G_LIN_JALLOCATOR);
+    jallocator_destroy(G_JALLOCATOR);
+    return 0;
+}
@@ -0,0 +1,274 @@
+//
+// Created by jan on 19.10.2026.
+//
+
+#include "uncertainty.h"
+#include "simulation_run.h"
+#include "../random/msws.h"
+#include <stdlib.h>
+
+const f64 RMOD_UNCERTAINTY_PERCENTILES[RMOD_UNCERTAINTY_PERCENTILE_COUNT] = {5.0, 25.0, 50.0, 75.0, 95.0};
+
+//  Seed of random number streams used to sample parameters, each parameter uses the stream keyed by its index
+#define RMOD_UNCERTAINTY_SEED 0xe9157e3105eed
+
+//  Value of the parameter for which the cumulative distribution function is equal to u
+static f64 distribution_inverse(const rmod_parameter_distribution* const distribution, const f64 mode, const f64 u)
+{
+    const f64 a = distribution->min;
+    const f64 b = distribution->max;
+    switch (distribution->type)
+    {
+    case RMOD_DISTRIBUTION_UNIFORM:
+        return a + u * (b - a);
+    case RMOD_DISTRIBUTION_LOG_UNIFORM:
+        return exp(log(a) + u * (log(b) - log(a)));
+    case RMOD_DISTRIBUTION_TRIANGULAR:
+        if (b == a)
+        {
+            return a;
+        }
+        if (u * (b - a) < mode - a)
+        {
+            return a + sqrt(u * (b - a) * (mode - a));
+        }
+        return b - sqrt((1.0 - u) * (b - a) * (b - mode));
+    default:
+        return mode;
+    }
+}
+
+static f64 get_parameter(const rmod_graph_node_type* const type, const rmod_block_parameter parameter)
+{
+    switch (parameter)
+    {
+    case RMOD_BLOCK_PARAMETER_MTBF:
+        return type->failure_rate != 0.0f ? 1.0 / (f64)type->failure_rate : 0.0;
+    case RMOD_BLOCK_PARAMETER_MTBR:
+        return type->repair_time;
+    case RMOD_BLOCK_PARAMETER_EFFECT:
+        return type->effect;
+    case RMOD_BLOCK_PARAMETER_COST:
+        return type->cost;
+    default:
+        assert(0);
+        return 0.0;
+    }
+}
+
+static void set_parameter(rmod_graph_node_type* const type, const rmod_block_parameter parameter, const f64 value)
+{
+    switch (parameter)
+    {
+    case RMOD_BLOCK_PARAMETER_MTBF:
+        type->failure_rate = value != 0.0 ? (f32)(1.0 / value) : 0.0f;
+        break;
+    case RMOD_BLOCK_PARAMETER_MTBR:
+        type->repair_time = (f32)value;
+        break;
+    case RMOD_BLOCK_PARAMETER_EFFECT:
+        type->effect = (f32)value;
+        break;
+    case RMOD_BLOCK_PARAMETER_COST:
+        type->cost = (f32)value;
+        break;
+    default:
+        assert(0);
+        break;
+    }
+}
+
+static int compare_f64(const void* a, const void* b)
+{
+    const f64 x = *(const f64*)a;
+    const f64 y = *(const f64*)b;
+    return (x > y) - (x < y);
+}
+
+//  Sorts the values and finds their mean and percentiles, interpolating linearly between samples
+static void find_band(const u32 count, f64* const values, rmod_uncertainty_band* const p_out)
+{
+    f64 sum = 0.0;
+    for (u32 i = 0; i < count; ++i)
+    {
+        sum += values[i];
+    }
+    qsort(values, count, sizeof(*values), compare_f64);
+    p_out->mean = sum / (f64)count;
+    for (u32 i = 0; i < RMOD_UNCERTAINTY_PERCENTILE_COUNT; ++i)
+    {
+        const f64 position = RMOD_UNCERTAINTY_PERCENTILES[i] / 100.0 * (f64)(count - 1);
+        const u32 below = (u32)position;
+        const u32 above = below + 1 < count ? below + 1 : below;
+        const f64 fraction = position - (f64)below;
+        p_out->percentiles[i] = values[below] + fraction * (values[above] - values[below]);
+    }
+}
+
+rmod_result rmod_propagate_uncertainty(
+        const rmod_graph* graph, f32 simulation_duration, f32 repair_limit, u32 sample_count,
+        u32 simulation_repetitions, u32 thread_count, rmod_uncertainty_result* p_out)
+{
+    RMOD_ENTER_FUNCTION;
+    rmod_result res;
+    void* const base = lin_jalloc_get_current(G_LIN_JALLOCATOR);
+    const u32 type_count = graph->type_count;
+    rmod_graph_node_type* sample_types = NULL;
+    rmod_sweep_point* points = NULL;
+    rmod_sim_result* results = NULL;
+    u32 results_done = 0;
+    if (sample_count == 0)
+    {
+        RMOD_ERROR("At least one sample of parameters is needed");
+        res = RMOD_RESULT_BAD_VALUE;
+        goto failed;
+    }
+
+    u32 parameter_count = 0;
+    for (u32 i = 0; i < type_count; ++i)
+    {
+        for (rmod_block_parameter j = 0; j < RMOD_BLOCK_PARAMETER_COUNT; ++j)
+        {
+            parameter_count += graph->type_list[i].uncertainty[j].type != RMOD_DISTRIBUTION_NONE;
+        }
+    }
+    if (parameter_count == 0)
+    {
+        RMOD_WARN("No parameter of any type was given as a range, so all samples will be the same");
+    }
+
+    sample_types = jalloc(sizeof(*sample_types) * type_count * sample_count);
+    if (!sample_types)
+    {
+        RMOD_ERROR("Failed jalloc(%zu)", sizeof(*sample_types) * type_count * sample_count);
+        res = RMOD_RESULT_NOMEM;
+        goto failed;
+    }
+    points = jalloc(sizeof(*points) * sample_count);
+    if (!points)
+    {
+        RMOD_ERROR("Failed jalloc(%zu)", sizeof(*points) * sample_count);
+        res = RMOD_RESULT_NOMEM;
+        goto failed;
+    }
+    results = jalloc(sizeof(*results) * sample_count);
+    if (!results)
+    {
+        RMOD_ERROR("Failed jalloc(%zu)", sizeof(*results) * sample_count);
+        res = RMOD_RESULT_NOMEM;
+        goto failed;
+    }
+    u32* const strata = lin_jalloc(G_LIN_JALLOCATOR, sizeof(*strata) * sample_count);
+    if (!strata)
+    {
+        RMOD_ERROR("Failed lin_jalloc(%p, %zu)", G_LIN_JALLOCATOR, sizeof(*strata) * sample_count);
+        res = RMOD_RESULT_NOMEM;
+        goto failed;
+    }
+    f64* const values = lin_jalloc(G_LIN_JALLOCATOR, sizeof(*values) * sample_count);
+    if (!values)
+    {
+        RMOD_ERROR("Failed lin_jalloc(%p, %zu)", G_LIN_JALLOCATOR, sizeof(*values) * sample_count);
+        res = RMOD_RESULT_NOMEM;
+        goto failed;
+    }
+
+    for (u32 i = 0; i < sample_count; ++i)
+    {
+        memcpy(sample_types + (u64)type_count * i, graph->type_list, sizeof(*sample_types) * type_count);
+    }
+    //  Latin hypercube: each parameter gets its own random permutation of strata, so strata of different parameters
+    //  are paired randomly
+    u32 dimension = 0;
+    for (u32 i = 0; i < type_count; ++i)
+    {
+        const rmod_graph_node_type* const type = graph->type_list + i;
+        for (rmod_block_parameter j = 0; j < RMOD_BLOCK_PARAMETER_COUNT; ++j)
+        {
+            const rmod_parameter_distribution* const distribution = type->uncertainty + j;
+            if (distribution->type == RMOD_DISTRIBUTION_NONE)
+            {
+                continue;
+            }
+            rmod_msws_state rng;
+            rmod_msws_init_keyed(&rng, RMOD_UNCERTAINTY_SEED, dimension++);
+            for (u32 k = 0; k < sample_count; ++k)
+            {
+                strata[k] = k;
+            }
+            for (u32 k = sample_count; k > 1; --k)
+            {
+                const u32 other = (u32)(rmod_msws_rng(&rng) % k);
+                const u32 tmp = strata[k - 1];
+                strata[k - 1] = strata[other];
+                strata[other] = tmp;
+            }
+            const f64 mode = get_parameter(type, j);
+            for (u32 k = 0; k < sample_count; ++k)
+            {
+                const f64 u = ((f64)strata[k] + rmod_msws_rngf(&rng)) / (f64)sample_count;
+                set_parameter(sample_types + (u64)type_count * k + i, j, distribution_inverse(distribution, mode, u));
+            }
+        }
+    }
+
+    for (u32 i = 0; i < sample_count; ++i)
+    {
+        points[i] = (rmod_sweep_point)
+                {
+                .simulation_duration = simulation_duration,
+                .repair_limit = repair_limit,
+                .mtbf_scale = 1.0f,
+                .change = RMOD_SWEEP_CHANGE_NONE,
+                .component = 0,
+                .types = sample_types + (u64)type_count * i,
+                };
+    }
+    if ((res = rmod_simulate_sweep(graph, sample_count, points, simulation_repetitions, thread_count, results, NULL)) != RMOD_RESULT_SUCCESS)
+    {
+        RMOD_ERROR("Failed simulating samples of parameters, reason: %s", rmod_result_str(res));
+        goto failed;
+    }
+    results_done = sample_count;
+
+    rmod_uncertainty_result out =
+            {
+            .duration = 0.0f,
+            .sample_count = sample_count,
+            .parameter_count = parameter_count,
+            .replication_count = results[0].sim_count,
+            };
+    for (u32 i = 0; i < sample_count; ++i)
+    {
+        const rmod_sim_result* const result = results + i;
+        const f64 mean_flow = result->sim_count ? result->total_flow / ((f64)simulation_duration * (f64)result->sim_count) : 0.0;
+        values[i] = result->max_flow != 0.0f ? mean_flow / result->max_flow : 0.0;
+        out.duration += result->duration;
+    }
+    find_band(sample_count, values, &out.availability);
+    for (u32 i = 0; i < sample_count; ++i)
+    {
+        values[i] = results[i].sim_count ? (f64)results[i].total_maintenance_visits / (f64)results[i].sim_count : 0.0;
+    }
+    find_band(sample_count, values, &out.visits);
+    for (u32 i = 0; i < sample_count; ++i)
+    {
+        values[i] = results[i].sim_count ? (f64)results[i].total_costs / (f64)results[i].sim_count : 0.0;
+    }
+    find_band(sample_count, values, &out.cost);
+    *p_out = out;
+    res = RMOD_RESULT_SUCCESS;
+
+failed:
+    for (u32 i = 0; i < results_done; ++i)
+    {
+        jfree(results[i].failures_per_component);
+        jfree(results[i].downtime_per_component);
+    }
+    jfree(results);
+    jfree(points);
+    jfree(sample_types);
+    lin_jalloc_set_current(G_LIN_JALLOCATOR, base);
+    RMOD_LEAVE_FUNCTION;
+    return res;
+}
@@ -0,0 +1,43 @@
+//
+// Created by jan on 19.10.2026.
+//
+
+#ifndef RMOD_UNCERTAINTY_H
+#define RMOD_UNCERTAINTY_H
+#include "../common/rmod.h"
+#include "compile.h"
+
+//  Percentiles of results over samples of parameters which are reported
+#define RMOD_UNCERTAINTY_PERCENTILE_COUNT 5
+extern const f64 RMOD_UNCERTAINTY_PERCENTILES[RMOD_UNCERTAINTY_PERCENTILE_COUNT];
+
+//  Distribution of a result over samples of parameters
+typedef struct rmod_uncertainty_band_struct rmod_uncertainty_band;
+struct rmod_uncertainty_band_struct
+{
+    f64 mean;
+    f64 percentiles[RMOD_UNCERTAINTY_PERCENTILE_COUNT];
+};
+
+typedef struct rmod_uncertainty_result_struct rmod_uncertainty_result;
+struct rmod_uncertainty_result_struct
+{
+    f32 duration;                       //  Processor time used by all simulations
+    u32 sample_count;                   //  Number of samples of parameters
+    u32 parameter_count;                //  Number of parameters which are not known exactly
+    u64 replication_count;              //  Number of replications simulated for each sample
+    rmod_uncertainty_band availability; //  Mean flow divided by maximum flow of the sample
+    rmod_uncertainty_band visits;       //  Mean maintenance visits
+    rmod_uncertainty_band cost;         //  Mean costs
+};
+
+//  Propagates uncertainty of parameters of types, which are given as ranges, to results of the simulation. Parameters
+//  are sampled using a Latin hypercube, so that each of sample_count equally probable strata of every parameter is
+//  used exactly once, and each sample is then simulated with simulation_repetitions replications. Samples are simulated
+//  as points of a sweep, so they share the graph and the states of workers, and replication i uses the same random
+//  stream for every sample.
+rmod_result rmod_propagate_uncertainty(
+        const rmod_graph* graph, f32 simulation_duration, f32 repair_limit, u32 sample_count,
+        u32 simulation_repetitions, u32 thread_count, rmod_uncertainty_result* p_out);
+
+#endif //RMOD_UNCERTAINTY_H